@@ -28,9 +28,11 @@
 #include <utility>
 #include <vector>
 
+#include "builtin_interfaces/msg/duration.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "message_filters/subscriber.h"
 #include "nav2_util/lifecycle_node.hpp"
+#include "nav2_util/thread_pool.hpp"
 #include "nav2_amcl/motion_model/motion_model.hpp"
 #include "nav2_amcl/sensors/laser/laser.hpp"
 #include "nav2_msgs/msg/particle.hpp"
@@ -189,6 +191,8 @@ protected:
     pose_pub_;
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::ParticleCloud>::SharedPtr
     particle_cloud_pub_;
+  rclcpp_lifecycle::LifecyclePublisher<builtin_interfaces::msg::Duration>::SharedPtr
+    scan_processing_time_pub_;
   /*
    * @brief Handle with an initial pose estimate is received
    */
@@ -262,6 +266,10 @@ protected:
    * @brief Initialize particle filter
    */
   void initParticleFilter();
+  /*
+   * @brief Get the particle filter resampling scheme matching resample_type
+   */
+  pf_resample_type_t getResampleType() const;
   /*
    * @brief Pose-generating function used to uniformly distribute particles over the map
    */
@@ -280,6 +288,11 @@ protected:
    * @brief Create a laser object
    */
   nav2_amcl::Laser * createLaserObject();
+  /*
+   * @brief Compute the likelihood field of the map for the current laser_likelihood_max_dist,
+   * or load it from the cache directory if it was persisted before
+   */
+  void updateLikelihoodField();
   int scan_error_count_{0};
   std::vector<nav2_amcl::Laser *> lasers_;
   std::vector<bool> lasers_update_;
@@ -365,12 +378,18 @@ protected:
   double beam_skip_threshold_;
   bool do_beamskip_;
   std::string global_frame_id_;
+  std::string histogram_type_;
   double lambda_short_;
   double laser_likelihood_max_dist_;
   double laser_max_range_;
   double laser_min_range_;
   std::string sensor_model_type_;
+  std::string likelihood_field_cache_dir_;
+  int likelihood_field_threads_;
+  // Threads computing the likelihood field, kept between map updates
+  std::unique_ptr<nav2_util::ThreadPool> likelihood_field_pool_;
   int max_beams_;
+  int sensor_model_threads_;
   int max_particles_;
   int min_particles_;
   std::string odom_frame_id_;
@@ -378,7 +397,9 @@ protected:
   double pf_z_;
   double alpha_fast_;
   double alpha_slow_;
+  int random_seed_;
   int resample_interval_;
+  std::string resample_type_;
   std::string robot_model_type_;
   tf2::Duration save_pose_period_;
   double sigma_hit_;
@@ -72,6 +72,10 @@ typedef struct
   // The map data, stored as a grid
   map_cell_t * cells;
 
+  // Distances to the nearest occupied cell, packed contiguously for the
+  // likelihood field models (NULL until the cspace is computed)
+  float * occ_dist_field;
+
   // Max distance at which we care about obstacles, for constructing
   // likelihood field
   double max_occ_dist;
@@ -91,6 +95,16 @@ void map_free(map_t * map);
 // Update the cspace distances
 void map_update_cspace(map_t * map, double max_occ_dist);
 
+// Hash the geometry and occupancy of a map
+uint64_t map_hash(const map_t * map);
+
+// Write the cspace distances to file (returns 0 on success)
+int map_save_cspace(const map_t * map, const char * filename);
+
+// Read the cspace distances from a file written for the same map and
+// max_occ_dist (returns 0 on success)
+int map_load_cspace(map_t * map, double max_occ_dist, const char * filename);
+
 
 /**************************************************************************
  * Range functions
@@ -134,6 +148,14 @@ void map_draw_wifi(map_t * map, struct _rtk_fig_t * fig, int index);
 
 #ifdef __cplusplus
 }
+
+namespace nav2_util
+{
+class ThreadPool;
+}  // namespace nav2_util
+
+// Update the cspace distances, splitting the work across the threads of a pool
+void map_update_cspace_threaded(map_t * map, double max_occ_dist, nav2_util::ThreadPool * pool);
 #endif
 
 #endif  // NAV2_AMCL__MAP__MAP_HPP_
@@ -28,8 +28,11 @@
 #ifndef NAV2_AMCL__PF__PF_HPP_
 #define NAV2_AMCL__PF__PF_HPP_
 
+#include <stdint.h>
+
 #include "nav2_amcl/pf/pf_vector.hpp"
 #include "nav2_amcl/pf/pf_kdtree.hpp"
+#include "nav2_amcl/pf/pf_histogram.hpp"
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +60,30 @@ typedef double (* pf_sensor_model_fn_t) (
   struct _pf_sample_set_t * set);
 
 
+// Schemes used to draw the resampled particles
+typedef enum
+{
+  // Independent draws from the cumulative weights
+  PF_RESAMPLE_MULTINOMIAL,
+
+  // Low-variance sampler, drawing all particles from a single random offset
+  PF_RESAMPLE_SYSTEMATIC
+} pf_resample_type_t;
+
+
+// Structures used to count the histogram bins of the samples, for KLD
+// adaptive sampling, and to cluster them
+typedef enum
+{
+  // Kd tree
+  PF_HISTOGRAM_KDTREE,
+
+  // Flat hash table, clustered with union-find. It gives the same clusters as
+  // the kd tree, labelled in another order.
+  PF_HISTOGRAM_HASH
+} pf_histogram_type_t;
+
+
 // Information for a single sample
 typedef struct
 {
@@ -96,6 +123,10 @@ typedef struct _pf_sample_set_t
   // A kdtree encoding the histogram
   pf_kdtree_t * kdtree;
 
+  // A hash table encoding the histogram, used instead of the kdtree
+  // depending on the histogram type of the filter
+  pf_histogram_t * histogram;
+
   // Clusters
   int cluster_count, cluster_max_count;
   pf_cluster_t * clusters;
@@ -133,6 +164,20 @@ typedef struct _pf_t
   double dist_threshold;  // distance threshold in each axis over which the pf is considered to not
                           // be converged
   int converged;
+
+  // Scheme used to draw the resampled particles
+  pf_resample_type_t resample_type;
+
+  // Structure used to count and cluster the histogram bins of the samples
+  pf_histogram_type_t histogram_type;
+
+  // State of the random number generator used for resampling
+  uint64_t rand_state;
+
+  // Resampling workspace: cumulative weights of the current set and
+  // indices of the particles drawn by the systematic resampler
+  double * resample_cdf;
+  int * resample_indices;
 } pf_t;
 
 
@@ -145,6 +190,9 @@ pf_t * pf_alloc(
 // Free an existing filter
 void pf_free(pf_t * pf);
 
+// Seed the random number generators of the filter and of the models (drand48)
+void pf_seed(pf_t * pf, uint64_t seed);
+
 // Initialize the filter using a guassian
 void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov);
 
@@ -0,0 +1,92 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+/**************************************************************************
+ * Desc: Sample histogram backed by a flat hash table, an alternative to the
+ *       kd tree for KLD adaptive sampling and clustering
+ *************************************************************************/
+
+#ifndef NAV2_AMCL__PF__PF_HISTOGRAM_HPP_
+#define NAV2_AMCL__PF__PF_HISTOGRAM_HPP_
+
+#include "nav2_amcl/pf/pf_vector.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A histogram bin
+typedef struct
+{
+  // The key for this bin
+  int key[3];
+
+  // The value for this bin
+  double value;
+
+  // The cluster label
+  int cluster;
+
+  // Slot of the bin in the hash table
+  int slot;
+} pf_histogram_bin_t;
+
+
+// A histogram, with bins stored contiguously and indexed by an open
+// addressing (linear probing) hash table
+typedef struct
+{
+  // Cell size
+  double size[3];
+
+  // The hash table, holding bin indices or -1 for empty slots. Its size is
+  // a power of two.
+  int table_size;
+  int * table;
+
+  // The bins
+  int bin_count, bin_max_count;
+  pf_histogram_bin_t * bins;
+
+  // Union-find parents of the bins, used for clustering
+  int * parents;
+} pf_histogram_t;
+
+
+// Create a histogram
+pf_histogram_t * pf_histogram_alloc(int max_size);
+
+// Destroy a histogram
+void pf_histogram_free(pf_histogram_t * self);
+
+// Clear all entries from the histogram
+void pf_histogram_clear(pf_histogram_t * self);
+
+// Insert a pose into the histogram
+void pf_histogram_insert(pf_histogram_t * self, pf_vector_t pose, double value);
+
+// Cluster the bins of the histogram. The clusters are those of the kd tree,
+// but labelled in the insertion order of their first bin instead of in tree order.
+void pf_histogram_cluster(pf_histogram_t * self);
+
+// Determine the cluster label for the given pose
+int pf_histogram_get_cluster(pf_histogram_t * self, pf_vector_t pose);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // NAV2_AMCL__PF__PF_HISTOGRAM_HPP_
@@ -32,6 +32,9 @@
 #include <rtk.h>
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 // Info for a node in the tree
 typedef struct pf_kdtree_node
@@ -104,4 +107,8 @@ extern void pf_kdtree_draw(pf_kdtree_t * self, rtk_fig_t * fig);
 
 #endif
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif  // NAV2_AMCL__PF__PF_KDTREE_HPP_
@@ -18,7 +18,11 @@
 #ifndef NAV2_AMCL__SENSORS__LASER__LASER_HPP_
 #define NAV2_AMCL__SENSORS__LASER__LASER_HPP_
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+#include "nav2_util/thread_pool.hpp"
 #include "nav2_amcl/pf/pf.hpp"
 #include "nav2_amcl/pf/pf_pdf.hpp"
 #include "nav2_amcl/map/map.hpp"
@@ -62,7 +66,51 @@ public:
    */
   void SetLaserPose(pf_vector_t & laser_pose);
 
+  /*
+   * @brief Set the number of threads evaluating the sensor model over the samples. The
+   * threads are kept for all later updates.
+   * @param num_threads Number of threads, including the calling thread
+   */
+  void SetNumThreads(int num_threads);
+
+  /*
+   * @brief Set whether the likelihood field models project beams over batches of samples
+   * with precomputed trigonometry, or one sample at a time as the reference implementation
+   * @param enabled Whether to use the vectorizable kernel
+   */
+  void SetVectorizedField(bool enabled);
+
 protected:
+  /*
+   * @brief A beam of a scan used by the likelihood field models
+   */
+  struct FieldBeam
+  {
+    double range;
+    double bearing;
+    float cos_bearing;
+    float sin_bearing;
+    int index;  // Index of the beam among the ones considered for the scan
+  };
+
+  /*
+   * @brief Laser poses of a batch of samples, stored as a structure of arrays. The
+   * vectorizable kernel works in single precision, on positions in map cells.
+   */
+  struct SampleBatch
+  {
+    static constexpr int SIZE = 64;
+    int count;
+    double x[SIZE];
+    double y[SIZE];
+    double theta[SIZE];
+    float cell_x[SIZE];
+    float cell_y[SIZE];
+    float cos_theta[SIZE];
+    float sin_theta[SIZE];
+  };
+
+
   double z_hit_;
   double z_rand_;
   double sigma_hit_;
@@ -73,12 +121,62 @@ protected:
    * @param max_obs number of observations
    */
   void reallocTempData(int max_samples, int max_obs);
+
+  /*
+   * @brief Get the number of contiguous chunks the samples are split into by weightSamples
+   * @param sample_count Number of samples
+   * @return Number of chunks
+   */
+  int numSampleChunks(int sample_count) const;
+
+  /*
+   * @brief Weight the samples of a set in contiguous chunks, one per thread of the pool. The total
+   * weights of the chunks are summed in chunk order, so the result is deterministic for
+   * a given number of threads.
+   * @param set Sample set to weight
+   * @param weight_fn Function called with (begin, end, chunk) weighting samples
+   * [begin, end) and returning their total weight
+   * @return Total weight of the set
+   */
+  double weightSamples(
+    pf_sample_set_t * set, const std::function<double(int, int, int)> & weight_fn);
+
+  /*
+   * @brief Collect the beams of a scan considered by the likelihood field models, ignoring
+   * max range and NaN readings
+   * @param data Laser data to use
+   * @param step Step between the considered beams
+   * @param beams Output beams
+   */
+  static void collectFieldBeams(LaserData * data, int step, std::vector<FieldBeam> & beams);
+
+  /*
+   * @brief Load the laser poses of samples [begin, end) of a set into a batch
+   * @param set Sample set
+   * @param begin First sample
+   * @param end Past the last sample, at most SampleBatch::SIZE after begin
+   * @param batch Output batch
+   */
+  void loadSampleBatch(pf_sample_set_t * set, int begin, int end, SampleBatch & batch) const;
+
+  /*
+   * @brief Look up the distance to the closest obstacle at the endpoint of a beam for each
+   * sample of a batch
+   * @param batch Laser poses of the samples
+   * @param beam Beam to project
+   * @param dist Output distances, negative for endpoints outside of the map
+   */
+  void fieldDistances(const SampleBatch & batch, const FieldBeam & beam, float * dist) const;
+
   map_t * map_;
   pf_vector_t laser_pose_;
   int max_beams_;
   int max_samples_;
   int max_obs_;
   double ** temp_obs_;
+  int num_threads_;
+  std::unique_ptr<nav2_util::ThreadPool> thread_pool_;
+  bool vectorized_field_;
 };
 
 /*
@@ -23,8 +23,11 @@
 #include "nav2_amcl/amcl_node.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -97,6 +100,12 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "global_frame_id", rclcpp::ParameterValue(std::string("map")),
     "The name of the coordinate frame published by the localization system");
 
+  add_parameter(
+    "histogram_type", rclcpp::ParameterValue(std::string("kdtree")),
+    "Which structure counts the occupied pose bins for KLD adaptive sampling and clusters them, "
+    "either kdtree or hash",
+    "hash uses a flat hash table and union-find clustering, cheaper with many particles");
+
   add_parameter(
     "lambda_short", rclcpp::ParameterValue(0.1),
     "Exponential decay parameter for z_short part of model");
@@ -120,6 +129,16 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "Which model to use, either beam, likelihood_field, or likelihood_field_prob",
     "Same as likelihood_field but incorporates the beamskip feature, if enabled");
 
+  add_parameter(
+    "likelihood_field_cache_dir", rclcpp::ParameterValue(std::string("")),
+    "Directory where the likelihood fields of maps are persisted, so that they are computed "
+    "only once per map", "Empty disables persistence");
+
+  add_parameter(
+    "likelihood_field_threads", rclcpp::ParameterValue(1),
+    "Number of threads computing the likelihood field of a map",
+    "0 will use all hardware threads");
+
   add_parameter(
     "set_initial_pose", rclcpp::ParameterValue(false),
     "Causes AMCL to set initial pose from the initial_pose* parameters instead of "
@@ -160,6 +179,12 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
   add_parameter("pf_err", rclcpp::ParameterValue(0.05));
   add_parameter("pf_z", rclcpp::ParameterValue(0.99));
 
+  add_parameter(
+    "random_seed", rclcpp::ParameterValue(-1),
+    "Seed of the random number generators used for resampling, motion noise and random "
+    "poses, for reproducible runs",
+    "-1 will seed it from the current time");
+
   add_parameter(
     "recovery_alpha_fast", rclcpp::ParameterValue(0.0),
     "Exponential decay rate for the fast average weight filter, used in deciding when to recover "
@@ -176,6 +201,11 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "resample_interval", rclcpp::ParameterValue(1),
     "Number of filter updates required before resampling");
 
+  add_parameter(
+    "resample_type", rclcpp::ParameterValue(std::string("multinomial")),
+    "Which scheme to draw resampled particles with, either multinomial or systematic",
+    "systematic is the low-variance sampler, drawing all particles from a single random offset");
+
   add_parameter("robot_model_type", rclcpp::ParameterValue("nav2_amcl::DifferentialMotionModel"));
 
   add_parameter(
@@ -185,6 +215,10 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "on subsequent runs to initialize the filter",
     "-1.0 to disable");
 
+  add_parameter(
+    "sensor_model_threads", rclcpp::ParameterValue(1),
+    "Number of threads evaluating the laser sensor model over the particles");
+
   add_parameter("sigma_hit", rclcpp::ParameterValue(0.2));
 
   add_parameter(
@@ -266,6 +300,7 @@ AmclNode::on_activate(const rclcpp_lifecycle::State & /*state*/)
   // Lifecycle publishers must be explicitly activated
   pose_pub_->on_activate();
   particle_cloud_pub_->on_activate();
+  scan_processing_time_pub_->on_activate();
 
   first_pose_sent_ = false;
 
@@ -311,6 +346,7 @@ AmclNode::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
   // Lifecycle publishers must be explicitly deactivated
   pose_pub_->on_deactivate();
   particle_cloud_pub_->on_deactivate();
+  scan_processing_time_pub_->on_deactivate();
 
   // reset dynamic parameter handler
   dyn_params_handler_.reset();
@@ -345,6 +381,7 @@ AmclNode::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
     map_free(map_);
     map_ = nullptr;
   }
+  likelihood_field_pool_.reset();
   first_map_received_ = false;
   free_space_indices.resize(0);
 
@@ -355,6 +392,7 @@ AmclNode::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   // PubSub
   pose_pub_.reset();
   particle_cloud_pub_.reset();
+  scan_processing_time_pub_.reset();
 
   // Odometry
   motion_model_.reset();
@@ -642,6 +680,8 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
     return;
   }
 
+  auto start_time = std::chrono::steady_clock::now();
+
   std::string laser_scan_frame_id = nav2_util::strip_leading_slash(laser_scan->header.frame_id);
   last_laser_received_ts_ = now();
   int laser_index = -1;
@@ -740,6 +780,9 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
       sendMapToOdomTransform(transform_expiration);
     }
   }
+
+  scan_processing_time_pub_->publish(
+    rclcpp::Duration(std::chrono::steady_clock::now() - start_time).to_msg());
 }
 
 bool AmclNode::addNewScanner(
@@ -1042,22 +1085,67 @@ AmclNode::createLaserObject()
 {
   RCLCPP_INFO(get_logger(), "createLaserObject");
 
+  if (sensor_model_type_ != "beam") {
+    updateLikelihoodField();
+  }
+
+  nav2_amcl::Laser * laser;
   if (sensor_model_type_ == "beam") {
-    return new nav2_amcl::BeamModel(
+    laser = new nav2_amcl::BeamModel(
       z_hit_, z_short_, z_max_, z_rand_, sigma_hit_, lambda_short_,
       0.0, max_beams_, map_);
-  }
-
-  if (sensor_model_type_ == "likelihood_field_prob") {
-    return new nav2_amcl::LikelihoodFieldModelProb(
+  } else if (sensor_model_type_ == "likelihood_field_prob") {
+    laser = new nav2_amcl::LikelihoodFieldModelProb(
       z_hit_, z_rand_, sigma_hit_,
       laser_likelihood_max_dist_, do_beamskip_, beam_skip_distance_, beam_skip_threshold_,
       beam_skip_error_threshold_, max_beams_, map_);
+  } else {
+    laser = new nav2_amcl::LikelihoodFieldModel(
+      z_hit_, z_rand_, sigma_hit_,
+      laser_likelihood_max_dist_, max_beams_, map_);
   }
 
-  return new nav2_amcl::LikelihoodFieldModel(
-    z_hit_, z_rand_, sigma_hit_,
-    laser_likelihood_max_dist_, max_beams_, map_);
+  laser->SetNumThreads(sensor_model_threads_);
+  return laser;
+}
+
+void
+AmclNode::updateLikelihoodField()
+{
+  if (map_->occ_dist_field != NULL && map_->max_occ_dist == laser_likelihood_max_dist_) {
+    return;
+  }
+
+  std::string cache_file;
+  if (!likelihood_field_cache_dir_.empty()) {
+    std::stringstream ss;
+    ss << likelihood_field_cache_dir_ << "/amcl_likelihood_field_" << std::hex <<
+      map_hash(map_) << ".bin";
+    cache_file = ss.str();
+    if (map_load_cspace(map_, laser_likelihood_max_dist_, cache_file.c_str()) == 0) {
+      RCLCPP_INFO(get_logger(), "Loaded likelihood field from %s", cache_file.c_str());
+      return;
+    }
+  }
+
+  int num_threads = likelihood_field_threads_;
+  if (num_threads <= 0) {
+    num_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  }
+  if (!likelihood_field_pool_ ||
+    likelihood_field_pool_->size() != static_cast<size_t>(num_threads))
+  {
+    likelihood_field_pool_ = std::make_unique<nav2_util::ThreadPool>(num_threads);
+  }
+  map_update_cspace_threaded(map_, laser_likelihood_max_dist_, likelihood_field_pool_.get());
+
+  if (!cache_file.empty()) {
+    if (map_save_cspace(map_, cache_file.c_str()) == 0) {
+      RCLCPP_INFO(get_logger(), "Saved likelihood field to %s", cache_file.c_str());
+    } else {
+      RCLCPP_WARN(get_logger(), "Failed to save likelihood field to %s", cache_file.c_str());
+    }
+  }
 }
 
 void
@@ -1077,11 +1165,14 @@ AmclNode::initParameters()
   get_parameter("beam_skip_threshold", beam_skip_threshold_);
   get_parameter("do_beamskip", do_beamskip_);
   get_parameter("global_frame_id", global_frame_id_);
+  get_parameter("histogram_type", histogram_type_);
   get_parameter("lambda_short", lambda_short_);
   get_parameter("laser_likelihood_max_dist", laser_likelihood_max_dist_);
   get_parameter("laser_max_range", laser_max_range_);
   get_parameter("laser_min_range", laser_min_range_);
   get_parameter("laser_model_type", sensor_model_type_);
+  get_parameter("likelihood_field_cache_dir", likelihood_field_cache_dir_);
+  get_parameter("likelihood_field_threads", likelihood_field_threads_);
   get_parameter("set_initial_pose", set_initial_pose_);
   get_parameter("initial_pose.x", initial_pose_x_);
   get_parameter("initial_pose.y", initial_pose_y_);
@@ -1095,9 +1186,12 @@ AmclNode::initParameters()
   get_parameter("pf_z", pf_z_);
   get_parameter("recovery_alpha_fast", alpha_fast_);
   get_parameter("recovery_alpha_slow", alpha_slow_);
+  get_parameter("random_seed", random_seed_);
   get_parameter("resample_interval", resample_interval_);
+  get_parameter("resample_type", resample_type_);
   get_parameter("robot_model_type", robot_model_type_);
   get_parameter("save_pose_rate", save_pose_rate);
+  get_parameter("sensor_model_threads", sensor_model_threads_);
   get_parameter("sigma_hit", sigma_hit_);
   get_parameter("tf_broadcast", tf_broadcast_);
   get_parameter("transform_tolerance", tmp_tol);
@@ -1157,6 +1251,20 @@ AmclNode::initParameters()
     resample_interval_ = 1;
   }
 
+  if (resample_type_ != "multinomial" && resample_type_ != "systematic") {
+    RCLCPP_WARN(
+      get_logger(), "Unknown resample_type '%s', it will be set to default value multinomial.",
+      resample_type_.c_str());
+    resample_type_ = "multinomial";
+  }
+
+  if (histogram_type_ != "kdtree" && histogram_type_ != "hash") {
+    RCLCPP_WARN(
+      get_logger(), "Unknown histogram_type '%s', it will be set to default value kdtree.",
+      histogram_type_.c_str());
+    histogram_type_ = "kdtree";
+  }
+
   if (always_reset_initial_pose_) {
     initial_pose_is_known_ = false;
   }
@@ -1303,12 +1411,36 @@ AmclNode::dynamicParametersCallback(
         base_frame_id_ = parameter.as_string();
       } else if (param_name == "global_frame_id") {
         global_frame_id_ = parameter.as_string();
+      } else if (param_name == "histogram_type") {
+        const std::string histogram_type = parameter.as_string();
+        if (histogram_type != "kdtree" && histogram_type != "hash") {
+          RCLCPP_WARN(
+            get_logger(), "Unknown histogram_type '%s', keeping %s.",
+            histogram_type.c_str(), histogram_type_.c_str());
+          continue;
+        }
+        histogram_type_ = histogram_type;
+        reinit_pf = true;
       } else if (param_name == "map_topic") {
         map_topic_ = parameter.as_string();
         reinit_map = true;
       } else if (param_name == "laser_model_type") {
         sensor_model_type_ = parameter.as_string();
         reinit_laser = true;
+      } else if (param_name == "resample_type") {
+        const std::string resample_type = parameter.as_string();
+        if (resample_type != "multinomial" && resample_type != "systematic") {
+          RCLCPP_WARN(
+            get_logger(), "Unknown resample_type '%s', keeping %s.",
+            resample_type.c_str(), resample_type_.c_str());
+          continue;
+        }
+        resample_type_ = resample_type;
+        if (pf_ != NULL) {
+          pf_->resample_type = getResampleType();
+        }
+      } else if (param_name == "likelihood_field_cache_dir") {
+        likelihood_field_cache_dir_ = parameter.as_string();
       } else if (param_name == "odom_frame_id") {
         odom_frame_id_ = parameter.as_string();
         reinit_laser = true;
@@ -1334,6 +1466,11 @@ AmclNode::dynamicParametersCallback(
       if (param_name == "max_beams") {
         max_beams_ = parameter.as_int();
         reinit_laser = true;
+      } else if (param_name == "sensor_model_threads") {
+        sensor_model_threads_ = parameter.as_int();
+        reinit_laser = true;
+      } else if (param_name == "likelihood_field_threads") {
+        likelihood_field_threads_ = parameter.as_int();
       } else if (param_name == "max_particles") {
         max_particles_ = parameter.as_int();
         reinit_pf = true;
@@ -1342,6 +1479,9 @@ AmclNode::dynamicParametersCallback(
         reinit_pf = true;
       } else if (param_name == "resample_interval") {
         resample_interval_ = parameter.as_int();
+      } else if (param_name == "random_seed") {
+        random_seed_ = parameter.as_int();
+        reinit_pf = true;
       }
     }
   }
@@ -1554,6 +1694,10 @@ AmclNode::initPubSub()
     "amcl_pose",
     rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable());
 
+  scan_processing_time_pub_ = create_publisher<builtin_interfaces::msg::Duration>(
+    "scan_processing_time",
+    rclcpp::SensorDataQoS());
+
   initial_pose_sub_ = create_subscription<geometry_msgs::msg::PoseWithCovarianceStamped>(
     "initialpose", rclcpp::SystemDefaultsQoS(),
     std::bind(&AmclNode::initialPoseReceived, this, std::placeholders::_1));
@@ -1617,6 +1761,12 @@ AmclNode::initParticleFilter()
     (pf_init_model_fn_t)AmclNode::uniformPoseGenerator);
   pf_->pop_err = pf_err_;
   pf_->pop_z = pf_z_;
+  pf_->resample_type = getResampleType();
+  pf_->histogram_type =
+    histogram_type_ == "hash" ? PF_HISTOGRAM_HASH : PF_HISTOGRAM_KDTREE;
+  if (random_seed_ >= 0) {
+    pf_seed(pf_, random_seed_);
+  }
 
   // Initialize the filter
   pf_vector_t pf_init_pose_mean = pf_vector_zero();
@@ -1636,6 +1786,12 @@ AmclNode::initParticleFilter()
   memset(&pf_odom_pose_, 0, sizeof(pf_odom_pose_));
 }
 
+pf_resample_type_t
+AmclNode::getResampleType() const
+{
+  return resample_type_ == "systematic" ? PF_RESAMPLE_SYSTEMATIC : PF_RESAMPLE_MULTINOMIAL;
+}
+
 void
 AmclNode::initLaserScan()
 {
@@ -52,6 +52,7 @@ map_t * map_alloc(void)
 
   // Allocate storage for main map
   map->cells = (map_cell_t *) NULL;
+  map->occ_dist_field = (float *) NULL;
 
   return map;
 }
@@ -61,5 +62,6 @@ map_t * map_alloc(void)
 void map_free(map_t * map)
 {
   free(map->cells);
+  free(map->occ_dist_field);
   free(map);
 }
@@ -20,194 +20,299 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <queue>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "nav2_amcl/map/map.hpp"
+#include "nav2_util/thread_pool.hpp"
 
-/*
- * @class CellData
- * @brief Data about map cells
- */
-class CellData
+namespace
+{
+
+// Distance of cells with no obstacle along their column, in cells
+const int32_t FAR_CELLS = std::numeric_limits<int32_t>::max();
+
+// Squared distance of cells with no obstacle along their column or row
+const double FAR_DISTANCE = std::numeric_limits<double>::infinity();
+
+// Header of the files cspace distances are persisted to
+const char CSPACE_FILE_MAGIC[8] = {'A', 'M', 'C', 'L', 'C', 'S', 'P', '1'};
+
+struct CspaceFileHeader
 {
-public:
-  map_t * map_;
-  unsigned int i_, j_;
-  unsigned int src_i_, src_j_;
+  char magic[8];
+  uint64_t hash;
+  int32_t size_x;
+  int32_t size_y;
+  double scale;
+  double max_occ_dist;
 };
 
 /*
- * @class CachedDistanceMap
- * @brief Cached map with distances
+ * @brief Compute the distance in cells from each cell of a range of columns to the
+ * closest obstacle of its column. The columns are swept together, row by row, to
+ * keep memory accesses contiguous.
+ * @param map Map to use
+ * @param begin First column
+ * @param end Past the last column
+ * @param column_dists Distances, indexed as the map cells, FAR_CELLS without obstacle
  */
-class CachedDistanceMap
+void column_distances(const map_t * map, int begin, int end, int32_t * column_dists)
 {
-public:
-  /*
-   * @brief CachedDistanceMap constructor
-   */
-  CachedDistanceMap(double scale, double max_dist)
-  : distances_(NULL), scale_(scale), max_dist_(max_dist)
-  {
-    cell_radius_ = max_dist / scale;
-    distances_ = new double *[cell_radius_ + 2];
-    for (int i = 0; i <= cell_radius_ + 1; i++) {
-      distances_[i] = new double[cell_radius_ + 2];
-      for (int j = 0; j <= cell_radius_ + 1; j++) {
-        distances_[i][j] = sqrt(i * i + j * j);
+  // Forward pass, distance to the closest obstacle below
+  for (int j = 0; j < map->size_y; j++) {
+    for (int i = begin; i < end; i++) {
+      int32_t dist = FAR_CELLS;
+      if (map->cells[MAP_INDEX(map, i, j)].occ_state == +1) {
+        dist = 0;
+      } else if (j > 0 && column_dists[MAP_INDEX(map, i, j - 1)] != FAR_CELLS) {
+        dist = column_dists[MAP_INDEX(map, i, j - 1)] + 1;
       }
+      column_dists[MAP_INDEX(map, i, j)] = dist;
     }
   }
 
-  /*
-   * @brief CachedDistanceMap destructor
-   */
-  ~CachedDistanceMap()
-  {
-    if (distances_) {
-      for (int i = 0; i <= cell_radius_ + 1; i++) {
-        delete[] distances_[i];
+  // Backward pass, distance to the closest obstacle above
+  for (int j = map->size_y - 2; j >= 0; j--) {
+    for (int i = begin; i < end; i++) {
+      const int32_t above = column_dists[MAP_INDEX(map, i, j + 1)];
+      if (above != FAR_CELLS && above + 1 < column_dists[MAP_INDEX(map, i, j)]) {
+        column_dists[MAP_INDEX(map, i, j)] = above + 1;
       }
-      delete[] distances_;
     }
   }
-  double ** distances_;
-  double scale_;
-  double max_dist_;
-  int cell_radius_;
-};
+}
 
 /*
- * @brief operator<
+ * @brief Compute the exact distances of the cells of a row to the closest obstacle,
+ * as the lower envelope of the parabolas rooted at the column distances
+ * (Felzenszwalb & Huttenlocher, Distance Transforms of Sampled Functions)
+ * @param map Map to update
+ * @param j Row
+ * @param column_dists Column distances, indexed as the map cells
+ * @param cell_radius Distance in cells past which cells keep the max distance
+ * @param f Scratch buffer for the squared column distances of the row, of size_x elements
+ * @param sites Scratch buffer for the parabola roots, of size_x elements
+ * @param bounds Scratch buffer for the envelope boundaries, of size_x + 1 elements
  */
-bool operator<(const CellData & a, const CellData & b)
+void row_distances(
+  map_t * map, int j, const int32_t * column_dists, int cell_radius,
+  double * f, int * sites, double * bounds)
 {
-  return a.map_->cells[MAP_INDEX(
-             a.map_, a.i_,
-             a.j_)].occ_dist > a.map_->cells[MAP_INDEX(b.map_, b.i_, b.j_)].occ_dist;
+  const int32_t * row = column_dists + MAP_INDEX(map, 0, j);
+  for (int q = 0; q < map->size_x; q++) {
+    f[q] = row[q] == FAR_CELLS ? FAR_DISTANCE : static_cast<double>(row[q]) * row[q];
+  }
+
+  // Build the lower envelope of the parabolas of the columns with an obstacle
+  int k = -1;
+  for (int q = 0; q < map->size_x; q++) {
+    if (f[q] == FAR_DISTANCE) {
+      continue;
+    }
+    double s = -FAR_DISTANCE;
+    while (k >= 0) {
+      const int v = sites[k];
+      s = ((f[q] + q * q) - (f[v] + v * v)) / (2.0 * (q - v));
+      if (s > bounds[k]) {
+        break;
+      }
+      k--;
+    }
+    k++;
+    sites[k] = q;
+    bounds[k] = k == 0 ? -FAR_DISTANCE : s;
+    bounds[k + 1] = FAR_DISTANCE;
+  }
+
+  int e = 0;
+  for (int i = 0; i < map->size_x; i++) {
+    double distance = FAR_DISTANCE;
+    if (k >= 0) {
+      while (bounds[e + 1] < i) {
+        e++;
+      }
+      const double dx = i - sites[e];
+      distance = sqrt(dx * dx + f[sites[e]]);
+    }
+
+    map_cell_t & cell = map->cells[MAP_INDEX(map, i, j)];
+    if (distance > cell_radius) {
+      cell.occ_dist = map->max_occ_dist;
+    } else {
+      cell.occ_dist = distance * map->scale;
+    }
+  }
 }
 
 /*
- * @brief get_distance_map
- * @param scale of cost information wrt distance
- * @param max_dist Maximum distance to cache from occupied information
- * @return Pointer to cached distance map
+ * @brief Pack the cspace distances contiguously for the likelihood field lookups
+ * @param map Map to update
  */
-CachedDistanceMap *
-get_distance_map(double scale, double max_dist)
+void pack_distances(map_t * map)
 {
-  static CachedDistanceMap * cdm = NULL;
-
-  if (!cdm || (cdm->scale_ != scale) || (cdm->max_dist_ != max_dist)) {
-    if (cdm) {
-      delete cdm;
-    }
-    cdm = new CachedDistanceMap(scale, max_dist);
+  int num_cells = map->size_x * map->size_y;
+  free(map->occ_dist_field);
+  map->occ_dist_field = static_cast<float *>(malloc(sizeof(float) * num_cells));
+  for (int i = 0; i < num_cells; i++) {
+    map->occ_dist_field[i] = map->cells[i].occ_dist;
   }
+}
+
+}  // namespace
 
-  return cdm;
+/*
+ * @brief Update the cspace distance values
+ * @param map Map to update
+ * @param max_occ_distance Maximum distance for occpuancy interest
+ */
+void map_update_cspace(map_t * map, double max_occ_dist)
+{
+  map_update_cspace_threaded(map, max_occ_dist, nullptr);
 }
 
 /*
- * @brief enqueue cell data for caching
+ * @brief Update the cspace distance values with an exact Euclidean distance
+ * transform, separable in a column and a row pass each split across threads
+ * @param map Map to update
+ * @param max_occ_distance Maximum distance for occpuancy interest
+ * @param pool Thread pool to split the passes across, or nullptr to run them serially
  */
-void enqueue(
-  map_t * map, int i, int j,
-  int src_i, int src_j,
-  std::priority_queue<CellData> & Q,
-  CachedDistanceMap * cdm,
-  unsigned char * marked)
+void map_update_cspace_threaded(map_t * map, double max_occ_dist, nav2_util::ThreadPool * pool)
 {
-  if (marked[MAP_INDEX(map, i, j)]) {
-    return;
-  }
+  map->max_occ_dist = max_occ_dist;
+  const int cell_radius = max_occ_dist / map->scale;
 
-  int di = abs(i - src_i);
-  int dj = abs(j - src_j);
-  double distance = cdm->distances_[di][dj];
+  std::vector<int32_t> column_dists(static_cast<size_t>(map->size_x) * map->size_y);
 
-  if (distance > cdm->cell_radius_) {
-    return;
-  }
+  nav2_util::parallelFor(
+    pool, map->size_x, [&](size_t begin, size_t end) {
+      column_distances(map, begin, end, column_dists.data());
+    });
 
-  map->cells[MAP_INDEX(map, i, j)].occ_dist = distance * map->scale;
+  nav2_util::parallelFor(
+    pool, map->size_y, [&](size_t begin, size_t end) {
+      std::vector<double> f(map->size_x);
+      std::vector<int> sites(map->size_x);
+      std::vector<double> bounds(map->size_x + 1);
+      for (size_t j = begin; j < end; j++) {
+        row_distances(
+          map, j, column_dists.data(), cell_radius, f.data(), sites.data(), bounds.data());
+      }
+    });
 
-  CellData cell;
-  cell.map_ = map;
-  cell.i_ = i;
-  cell.j_ = j;
-  cell.src_i_ = src_i;
-  cell.src_j_ = src_j;
+  pack_distances(map);
+}
 
-  Q.push(cell);
+/*
+ * @brief Hash the geometry and occupancy of a map (64 bit FNV-1a)
+ * @param map Map to hash
+ * @return Hash of the map
+ */
+uint64_t map_hash(const map_t * map)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto hash_bytes = [&hash](const void * data, size_t size) {
+      const unsigned char * bytes = static_cast<const unsigned char *>(data);
+      for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+      }
+    };
 
-  marked[MAP_INDEX(map, i, j)] = 1;
+  hash_bytes(&map->size_x, sizeof(map->size_x));
+  hash_bytes(&map->size_y, sizeof(map->size_y));
+  hash_bytes(&map->scale, sizeof(map->scale));
+  for (int i = 0; i < map->size_x * map->size_y; i++) {
+    hash_bytes(&map->cells[i].occ_state, sizeof(map->cells[i].occ_state));
+  }
+  return hash;
 }
 
 /*
- * @brief Update the cspace distance values
- * @param map Map to update
- * @param max_occ_distance Maximum distance for occpuancy interest
+ * @brief Write the cspace distances of a map to file
+ * @param map Map with computed cspace distances
+ * @param filename File to write
+ * @return 0 on success, -1 on failure
  */
-void map_update_cspace(map_t * map, double max_occ_dist)
+int map_save_cspace(const map_t * map, const char * filename)
 {
-  unsigned char * marked;
-  std::priority_queue<CellData> Q;
+  if (map->occ_dist_field == NULL) {
+    return -1;
+  }
 
-  marked = new unsigned char[map->size_x * map->size_y];
-  memset(marked, 0, sizeof(unsigned char) * map->size_x * map->size_y);
+  CspaceFileHeader header;
+  memcpy(header.magic, CSPACE_FILE_MAGIC, sizeof(header.magic));
+  header.hash = map_hash(map);
+  header.size_x = map->size_x;
+  header.size_y = map->size_y;
+  header.scale = map->scale;
+  header.max_occ_dist = map->max_occ_dist;
 
-  map->max_occ_dist = max_occ_dist;
+  // Write to a temporary file first so that readers never see a partial file
+  const std::string tmp_filename = std::string(filename) + ".tmp";
+  FILE * file = fopen(tmp_filename.c_str(), "wb");
+  if (file == NULL) {
+    return -1;
+  }
 
-  CachedDistanceMap * cdm = get_distance_map(map->scale, map->max_occ_dist);
+  const size_t num_cells = static_cast<size_t>(map->size_x) * map->size_y;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(map->occ_dist_field, sizeof(float), num_cells, file) == num_cells;
+  ok = (fclose(file) == 0) && ok;
 
-  // Enqueue all the obstacle cells
-  CellData cell;
-  cell.map_ = map;
-  for (int i = 0; i < map->size_x; i++) {
-    cell.src_i_ = cell.i_ = i;
-    for (int j = 0; j < map->size_y; j++) {
-      if (map->cells[MAP_INDEX(map, i, j)].occ_state == +1) {
-        map->cells[MAP_INDEX(map, i, j)].occ_dist = 0.0;
-        cell.src_j_ = cell.j_ = j;
-        marked[MAP_INDEX(map, i, j)] = 1;
-        Q.push(cell);
-      } else {
-        map->cells[MAP_INDEX(map, i, j)].occ_dist = max_occ_dist;
-      }
-    }
+  if (!ok || rename(tmp_filename.c_str(), filename) != 0) {
+    remove(tmp_filename.c_str());
+    return -1;
   }
+  return 0;
+}
 
-  while (!Q.empty()) {
-    CellData current_cell = Q.top();
-    if (current_cell.i_ > 0) {
-      enqueue(
-        map, current_cell.i_ - 1, current_cell.j_,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (current_cell.j_ > 0) {
-      enqueue(
-        map, current_cell.i_, current_cell.j_ - 1,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (static_cast<int>(current_cell.i_) < map->size_x - 1) {
-      enqueue(
-        map, current_cell.i_ + 1, current_cell.j_,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (static_cast<int>(current_cell.j_) < map->size_y - 1) {
-      enqueue(
-        map, current_cell.i_, current_cell.j_ + 1,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
+/*
+ * @brief Read the cspace distances of a map from file
+ * @param map Map to update
+ * @param max_occ_dist Maximum distance for occupancy interest the file must match
+ * @param filename File to read
+ * @return 0 on success, -1 if the file is missing, unreadable or was written for another
+ * map or distance
+ */
+int map_load_cspace(map_t * map, double max_occ_dist, const char * filename)
+{
+  FILE * file = fopen(filename, "rb");
+  if (file == NULL) {
+    return -1;
+  }
 
-    Q.pop();
+  CspaceFileHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+    memcmp(header.magic, CSPACE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+    header.size_x != map->size_x || header.size_y != map->size_y ||
+    header.scale != map->scale || header.max_occ_dist != max_occ_dist ||
+    header.hash != map_hash(map))
+  {
+    fclose(file);
+    return -1;
   }
 
-  delete[] marked;
+  const size_t num_cells = static_cast<size_t>(map->size_x) * map->size_y;
+  float * field = static_cast<float *>(malloc(sizeof(float) * num_cells));
+  const bool ok = fread(field, sizeof(float), num_cells, file) == num_cells;
+  fclose(file);
+  if (!ok) {
+    free(field);
+    return -1;
+  }
+
+  free(map->occ_dist_field);
+  map->occ_dist_field = field;
+  map->max_occ_dist = max_occ_dist;
+  for (size_t i = 0; i < num_cells; i++) {
+    map->cells[i].occ_dist = field[i];
+  }
+  return 0;
 }
@@ -42,6 +42,24 @@
 // with samples in them.
 static int pf_resample_limit(pf_t * pf, int k);
 
+// Draw a uniform random number in [0, 1) from the filter generator
+static double pf_random(pf_t * pf);
+
+// Clear the histogram of a sample set
+static void pf_bins_clear(pf_t * pf, pf_sample_set_t * set);
+
+// Add a sample pose to the histogram of a sample set
+static void pf_bins_insert(pf_t * pf, pf_sample_set_t * set, pf_vector_t pose, double value);
+
+// Count the occupied bins of the histogram of a sample set
+static int pf_bins_count(pf_t * pf, pf_sample_set_t * set);
+
+// Cluster the bins of the histogram of a sample set
+static void pf_bins_cluster(pf_t * pf, pf_sample_set_t * set);
+
+// Determine the cluster label of a sample pose
+static int pf_bins_get_cluster(pf_t * pf, pf_sample_set_t * set, pf_vector_t pose);
+
 
 // Create a new filter
 pf_t * pf_alloc(
@@ -54,8 +72,6 @@ pf_t * pf_alloc(
   pf_sample_set_t * set;
   pf_sample_t * sample;
 
-  srand48(time(NULL));
-
   pf = calloc(1, sizeof(pf_t));
 
   pf->random_pose_fn = random_pose_fn;
@@ -89,6 +105,7 @@ pf_t * pf_alloc(
 
     // HACK: is 3 times max_samples enough?
     set->kdtree = pf_kdtree_alloc(3 * max_samples);
+    set->histogram = pf_histogram_alloc(max_samples);
 
     set->cluster_count = 0;
     set->cluster_max_count = max_samples;
@@ -104,6 +121,12 @@ pf_t * pf_alloc(
   pf->alpha_slow = alpha_slow;
   pf->alpha_fast = alpha_fast;
 
+  pf->resample_type = PF_RESAMPLE_MULTINOMIAL;
+  pf->histogram_type = PF_HISTOGRAM_KDTREE;
+  pf_seed(pf, time(NULL));
+  pf->resample_cdf = calloc(max_samples + 1, sizeof(double));
+  pf->resample_indices = calloc(max_samples, sizeof(int));
+
   // set converged to 0
   pf_init_converged(pf);
 
@@ -118,11 +141,87 @@ void pf_free(pf_t * pf)
   for (i = 0; i < 2; i++) {
     free(pf->sets[i].clusters);
     pf_kdtree_free(pf->sets[i].kdtree);
+    pf_histogram_free(pf->sets[i].histogram);
     free(pf->sets[i].samples);
   }
+  free(pf->resample_cdf);
+  free(pf->resample_indices);
   free(pf);
 }
 
+// Seed the random number generators of the filter and of the models
+void pf_seed(pf_t * pf, uint64_t seed)
+{
+  // The motion noise, the initial and the random poses are drawn from drand48
+  srand48(seed);
+
+  // Scramble the seed (splitmix64) so that close seeds give unrelated sequences
+  seed += 0x9E3779B97F4A7C15ULL;
+  seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+  seed ^= seed >> 31;
+
+  // The generator state must not be zero
+  pf->rand_state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+// Draw a uniform random number in [0, 1) from the filter generator (xorshift64*)
+double pf_random(pf_t * pf)
+{
+  pf->rand_state ^= pf->rand_state >> 12;
+  pf->rand_state ^= pf->rand_state << 25;
+  pf->rand_state ^= pf->rand_state >> 27;
+  return ((pf->rand_state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Clear the histogram of a sample set
+void pf_bins_clear(pf_t * pf, pf_sample_set_t * set)
+{
+  if (pf->histogram_type == PF_HISTOGRAM_HASH) {
+    pf_histogram_clear(set->histogram);
+  } else {
+    pf_kdtree_clear(set->kdtree);
+  }
+}
+
+// Add a sample pose to the histogram of a sample set
+void pf_bins_insert(pf_t * pf, pf_sample_set_t * set, pf_vector_t pose, double value)
+{
+  if (pf->histogram_type == PF_HISTOGRAM_HASH) {
+    pf_histogram_insert(set->histogram, pose, value);
+  } else {
+    pf_kdtree_insert(set->kdtree, pose, value);
+  }
+}
+
+// Count the occupied bins of the histogram of a sample set
+int pf_bins_count(pf_t * pf, pf_sample_set_t * set)
+{
+  if (pf->histogram_type == PF_HISTOGRAM_HASH) {
+    return set->histogram->bin_count;
+  }
+  return set->kdtree->leaf_count;
+}
+
+// Cluster the bins of the histogram of a sample set
+void pf_bins_cluster(pf_t * pf, pf_sample_set_t * set)
+{
+  if (pf->histogram_type == PF_HISTOGRAM_HASH) {
+    pf_histogram_cluster(set->histogram);
+  } else {
+    pf_kdtree_cluster(set->kdtree);
+  }
+}
+
+// Determine the cluster label of a sample pose
+int pf_bins_get_cluster(pf_t * pf, pf_sample_set_t * set, pf_vector_t pose)
+{
+  if (pf->histogram_type == PF_HISTOGRAM_HASH) {
+    return pf_histogram_get_cluster(set->histogram, pose);
+  }
+  return pf_kdtree_get_cluster(set->kdtree, pose);
+}
+
 // Initialize the filter using a guassian
 void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov)
 {
@@ -134,7 +233,7 @@ void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov)
   set = pf->sets + pf->current_set;
 
   // Create the kd tree for adaptive sampling
-  pf_kdtree_clear(set->kdtree);
+  pf_bins_clear(pf, set);
 
   set->sample_count = pf->max_samples;
 
@@ -147,7 +246,7 @@ void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov)
     sample->pose = pf_pdf_gaussian_sample(pdf);
 
     // Add sample to histogram
-    pf_kdtree_insert(set->kdtree, sample->pose, sample->weight);
+    pf_bins_insert(pf, set, sample->pose, sample->weight);
   }
 
   pf->w_slow = pf->w_fast = 0.0;
@@ -172,7 +271,7 @@ void pf_init_model(pf_t * pf, pf_init_model_fn_t init_fn, void * init_data)
   set = pf->sets + pf->current_set;
 
   // Create the kd tree for adaptive sampling
-  pf_kdtree_clear(set->kdtree);
+  pf_bins_clear(pf, set);
 
   set->sample_count = pf->max_samples;
 
@@ -183,7 +282,7 @@ void pf_init_model(pf_t * pf, pf_init_model_fn_t init_fn, void * init_data)
     sample->pose = (*init_fn)(init_data);
 
     // Add sample to histogram
-    pf_kdtree_insert(set->kdtree, sample->pose, sample->weight);
+    pf_bins_insert(pf, set, sample->pose, sample->weight);
   }
 
   pf->w_slow = pf->w_fast = 0.0;
@@ -292,15 +391,14 @@ void pf_update_sensor(pf_t * pf, pf_sensor_model_fn_t sensor_fn, void * sensor_d
 // Resample the distribution
 void pf_update_resample(pf_t * pf, void * random_pose_data)
 {
-  int i;
+  int i, j, m, lo, hi, mid;
+  int drawn;
   double total;
+  double r, step;
   pf_sample_set_t * set_a, * set_b;
   pf_sample_t * sample_a, * sample_b;
-
-  // double r,c,U;
-  // int m;
-  // double count_inv;
   double * c;
+  int * indices;
 
   double w_diff;
 
@@ -308,16 +406,35 @@ void pf_update_resample(pf_t * pf, void * random_pose_data)
   set_b = pf->sets + (pf->current_set + 1) % 2;
 
   // Build up cumulative probability table for resampling.
-  // TODO(?): Replace this with a more efficient procedure
-  // (e.g., http://www.network-theory.co.uk/docs/gslref/GeneralDiscreteDistributions.html)
-  c = (double *)malloc(sizeof(double) * (set_a->sample_count + 1));
+  c = pf->resample_cdf;
   c[0] = 0.0;
   for (i = 0; i < set_a->sample_count; i++) {
     c[i + 1] = c[i] + set_a->samples[i].weight;
   }
 
+  // Low-variance resampler, taken from Probabilistic Robotics, p110: draw
+  // max_samples particles from a single random offset and evenly spaced
+  // pointers into the cumulative table. KLD adaptive sampling may stop before
+  // all of them are used, so they are consumed in random order (incremental
+  // Fisher-Yates shuffle) to not favor the first particles of the set. A set
+  // cut short this way is a random subset of the draws, which is no longer
+  // low-variance.
+  indices = pf->resample_indices;
+  drawn = 0;
+  if (pf->resample_type == PF_RESAMPLE_SYSTEMATIC) {
+    step = c[set_a->sample_count] / pf->max_samples;
+    r = pf_random(pf);
+    i = 0;
+    for (m = 0; m < pf->max_samples; m++) {
+      while (i < set_a->sample_count - 1 && c[i + 1] <= (r + m) * step) {
+        i++;
+      }
+      indices[m] = i;
+    }
+  }
+
   // Create the kd tree for adaptive sampling
-  pf_kdtree_clear(set_b->kdtree);
+  pf_bins_clear(pf, set_b);
 
   // Draw samples from set a to create set b.
   total = 0;
@@ -329,53 +446,33 @@ void pf_update_resample(pf_t * pf, void * random_pose_data)
   }
   // printf("w_diff: %9.6f\n", w_diff);
 
-  // Can't (easily) combine low-variance sampler with KLD adaptive
-  // sampling, so we'll take the more traditional route.
-  /*
-  // Low-variance resampler, taken from Probabilistic Robotics, p110
-  count_inv = 1.0/set_a->sample_count;
-  r = drand48() * count_inv;
-  c = set_a->samples[0].weight;
-  i = 0;
-  m = 0;
-  */
   while (set_b->sample_count < pf->max_samples) {
     sample_b = set_b->samples + set_b->sample_count++;
 
-    if (drand48() < w_diff) {
+    if (pf_random(pf) < w_diff) {
       sample_b->pose = (pf->random_pose_fn)(random_pose_data);
     } else {
-      // Can't (easily) combine low-variance sampler with KLD adaptive
-      // sampling, so we'll take the more traditional route.
-      /*
-      // Low-variance resampler, taken from Probabilistic Robotics, p110
-      U = r + m * count_inv;
-      while(U>c)
-      {
-        i++;
-        // Handle wrap-around by resetting counters and picking a new random
-        // number
-        if(i >= set_a->sample_count)
-        {
-          r = drand48() * count_inv;
-          c = set_a->samples[0].weight;
-          i = 0;
-          m = 0;
-          U = r + m * count_inv;
-          continue;
-        }
-        c += set_a->samples[i].weight;
-      }
-      m++;
-      */
-
-      // Naive discrete event sampler
-      double r;
-      r = drand48();
-      for (i = 0; i < set_a->sample_count; i++) {
-        if ((c[i] <= r) && (r < c[i + 1])) {
-          break;
+      if (pf->resample_type == PF_RESAMPLE_SYSTEMATIC) {
+        // Pick one of the remaining low-variance draws
+        j = drawn + (int)(pf_random(pf) * (pf->max_samples - drawn));
+        i = indices[j];
+        indices[j] = indices[drawn];
+        indices[drawn] = i;
+        drawn++;
+      } else {
+        // Naive discrete event sampler, looking up the draw in the cumulative table
+        r = pf_random(pf) * c[set_a->sample_count];
+        lo = 0;
+        hi = set_a->sample_count - 1;
+        while (lo < hi) {
+          mid = (lo + hi) / 2;
+          if (c[mid + 1] <= r) {
+            lo = mid + 1;
+          } else {
+            hi = mid;
+          }
         }
+        i = lo;
       }
       assert(i < set_a->sample_count);
 
@@ -391,10 +488,10 @@ void pf_update_resample(pf_t * pf, void * random_pose_data)
     total += sample_b->weight;
 
     // Add sample to histogram
-    pf_kdtree_insert(set_b->kdtree, sample_b->pose, sample_b->weight);
+    pf_bins_insert(pf, set_b, sample_b->pose, sample_b->weight);
 
     // See if we have enough samples yet
-    if (set_b->sample_count > pf_resample_limit(pf, set_b->kdtree->leaf_count)) {
+    if (set_b->sample_count > pf_resample_limit(pf, pf_bins_count(pf, set_b))) {
       break;
     }
   }
@@ -419,8 +516,6 @@ void pf_update_resample(pf_t * pf, void * random_pose_data)
   pf->current_set = (pf->current_set + 1) % 2;
 
   pf_update_converged(pf);
-
-  free(c);
 }
 
 
@@ -456,7 +551,6 @@ int pf_resample_limit(pf_t * pf, int k)
 // Re-compute the cluster statistics for a sample set
 void pf_cluster_stats(pf_t * pf, pf_sample_set_t * set)
 {
-  (void)pf;
   int i, j, k, cidx;
   pf_sample_t * sample;
   pf_cluster_t * cluster;
@@ -466,7 +560,7 @@ void pf_cluster_stats(pf_t * pf, pf_sample_set_t * set)
   double weight;
 
   // Cluster the samples
-  pf_kdtree_cluster(set->kdtree);
+  pf_bins_cluster(pf, set);
 
   // Initialize cluster stats
   set->cluster_count = 0;
@@ -507,7 +601,7 @@ void pf_cluster_stats(pf_t * pf, pf_sample_set_t * set)
     // printf("%d %f %f %f\n", i, sample->pose.v[0], sample->pose.v[1], sample->pose.v[2]);
 
     // Get the cluster label for this sample
-    cidx = pf_kdtree_get_cluster(set->kdtree, sample->pose);
+    cidx = pf_bins_get_cluster(pf, set, sample->pose);
     assert(cidx >= 0);
     if (cidx >= set->cluster_max_count) {
       continue;
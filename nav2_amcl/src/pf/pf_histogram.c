@@ -0,0 +1,246 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+/**************************************************************************
+ * Desc: Sample histogram backed by a flat hash table
+ *************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nav2_amcl/pf/pf_histogram.hpp"
+
+
+// Compute the key of the bin containing a pose
+static void pf_histogram_key(pf_histogram_t * self, pf_vector_t pose, int key[]);
+
+// Find the slot holding a key, or the empty slot where it would be inserted
+static int pf_histogram_find_slot(pf_histogram_t * self, const int key[]);
+
+// Find the root of the union-find tree of a bin, compressing the path
+static int pf_histogram_find_root(pf_histogram_t * self, int bin);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Create a histogram
+pf_histogram_t * pf_histogram_alloc(int max_size)
+{
+  int i;
+  pf_histogram_t * self;
+
+  self = calloc(1, sizeof(pf_histogram_t));
+
+  // Same cells as the kd tree
+  self->size[0] = 0.50;
+  self->size[1] = 0.50;
+  self->size[2] = (10 * M_PI / 180);
+
+  // Keep the load factor at most 1/2
+  self->table_size = 1;
+  while (self->table_size < 2 * max_size) {
+    self->table_size *= 2;
+  }
+  self->table = malloc(self->table_size * sizeof(int));
+  for (i = 0; i < self->table_size; i++) {
+    self->table[i] = -1;
+  }
+
+  self->bin_count = 0;
+  self->bin_max_count = max_size;
+  self->bins = calloc(self->bin_max_count, sizeof(pf_histogram_bin_t));
+  self->parents = calloc(self->bin_max_count, sizeof(int));
+
+  return self;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Destroy a histogram
+void pf_histogram_free(pf_histogram_t * self)
+{
+  free(self->table);
+  free(self->bins);
+  free(self->parents);
+  free(self);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Clear all entries from the histogram
+void pf_histogram_clear(pf_histogram_t * self)
+{
+  int i;
+
+  // Only the slots of the bins in use need to be emptied
+  for (i = 0; i < self->bin_count; i++) {
+    self->table[self->bins[i].slot] = -1;
+  }
+  self->bin_count = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Insert a pose into the histogram
+void pf_histogram_insert(pf_histogram_t * self, pf_vector_t pose, double value)
+{
+  int key[3];
+  int slot;
+  pf_histogram_bin_t * bin;
+
+  pf_histogram_key(self, pose, key);
+  slot = pf_histogram_find_slot(self, key);
+
+  if (self->table[slot] >= 0) {
+    self->bins[self->table[slot]].value += value;
+    return;
+  }
+
+  assert(self->bin_count < self->bin_max_count);
+  bin = self->bins + self->bin_count;
+  bin->key[0] = key[0];
+  bin->key[1] = key[1];
+  bin->key[2] = key[2];
+  bin->value = value;
+  bin->cluster = -1;
+  bin->slot = slot;
+  self->table[slot] = self->bin_count++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Cluster the bins of the histogram. Bins are connected to their 26
+// neighbors, as with the kd tree, and labelled with union-find.
+void pf_histogram_cluster(pf_histogram_t * self)
+{
+  int i, j, slot;
+  int nkey[3];
+  int root, nroot, cluster_count;
+  pf_histogram_bin_t * bin;
+
+  for (i = 0; i < self->bin_count; i++) {
+    self->parents[i] = i;
+  }
+
+  // Union each bin with the neighbors following it in key order; the other
+  // neighbors are covered when visiting them
+  for (i = 0; i < self->bin_count; i++) {
+    bin = self->bins + i;
+    for (j = 14; j < 3 * 3 * 3; j++) {
+      nkey[0] = bin->key[0] + (j / 9) - 1;
+      nkey[1] = bin->key[1] + ((j % 9) / 3) - 1;
+      nkey[2] = bin->key[2] + ((j % 9) % 3) - 1;
+
+      slot = pf_histogram_find_slot(self, nkey);
+      if (self->table[slot] < 0) {
+        continue;
+      }
+
+      root = pf_histogram_find_root(self, i);
+      nroot = pf_histogram_find_root(self, self->table[slot]);
+      if (root != nroot) {
+        // Keep the lowest bin as root, so labels follow insertion order
+        if (root < nroot) {
+          self->parents[nroot] = root;
+        } else {
+          self->parents[root] = nroot;
+        }
+      }
+    }
+  }
+
+  // Label the clusters. Roots come before the other bins of their cluster.
+  cluster_count = 0;
+  for (i = 0; i < self->bin_count; i++) {
+    root = pf_histogram_find_root(self, i);
+    if (root == i) {
+      self->bins[i].cluster = cluster_count++;
+    } else {
+      self->bins[i].cluster = self->bins[root].cluster;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Determine the cluster label for the given pose
+int pf_histogram_get_cluster(pf_histogram_t * self, pf_vector_t pose)
+{
+  int key[3];
+  int slot;
+
+  pf_histogram_key(self, pose, key);
+  slot = pf_histogram_find_slot(self, key);
+  if (self->table[slot] < 0) {
+    return -1;
+  }
+  return self->bins[self->table[slot]].cluster;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Compute the key of the bin containing a pose
+void pf_histogram_key(pf_histogram_t * self, pf_vector_t pose, int key[])
+{
+  key[0] = floor(pose.v[0] / self->size[0]);
+  key[1] = floor(pose.v[1] / self->size[1]);
+  key[2] = floor(pose.v[2] / self->size[2]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Find the slot holding a key, or the empty slot where it would be inserted
+int pf_histogram_find_slot(pf_histogram_t * self, const int key[])
+{
+  int slot, bin;
+  uint32_t hash;
+
+  hash = (uint32_t)key[0] * 73856093u ^ (uint32_t)key[1] * 19349663u ^
+    (uint32_t)key[2] * 83492791u;
+  hash *= 2654435761u;
+  slot = (hash ^ (hash >> 16)) & (self->table_size - 1);
+
+  while (1) {
+    bin = self->table[slot];
+    if (bin < 0 ||
+      (self->bins[bin].key[0] == key[0] && self->bins[bin].key[1] == key[1] &&
+      self->bins[bin].key[2] == key[2]))
+    {
+      return slot;
+    }
+    slot = (slot + 1) & (self->table_size - 1);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Find the root of the union-find tree of a bin, compressing the path
+int pf_histogram_find_root(pf_histogram_t * self, int bin)
+{
+  int root, next;
+
+  root = bin;
+  while (self->parents[root] != root) {
+    root = self->parents[root];
+  }
+  while (self->parents[bin] != root) {
+    next = self->parents[bin];
+    self->parents[bin] = root;
+    bin = next;
+  }
+  return root;
+}
@@ -36,9 +36,6 @@
 
 #include "nav2_amcl/portable_utils.hpp"
 
-// Random number generator seed value
-static unsigned int pf_pdf_seed;
-
 
 /**************************************************************************
  * Gaussian
@@ -63,10 +60,8 @@ pf_pdf_gaussian_t * pf_pdf_gaussian_alloc(pf_vector_t x, pf_matrix_t cx)
   pdf->cd.v[1] = sqrt(cd.m[1][1]);
   pdf->cd.v[2] = sqrt(cd.m[2][2]);
 
-  // Initialize the random number generator
-  // pdf->rng = gsl_rng_alloc(gsl_rng_taus);
-  // gsl_rng_set(pdf->rng, ++pf_pdf_seed);
-  srand48(++pf_pdf_seed);
+  // The samples are drawn from drand48, seeded by pf_seed() rather than here so that
+  // a seeded filter is reproducible
 
   return pdf;
 }
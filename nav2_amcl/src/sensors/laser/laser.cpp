@@ -24,13 +24,25 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
 namespace nav2_amcl
 {
 
+// Round down to an integer. Unlike floor(), the compilers vectorize it without -ffast-math.
+static inline int floorToInt(float value)
+{
+  int truncated = static_cast<int>(value);
+  return truncated - (value < truncated);
+}
+
 Laser::Laser(size_t max_beams, map_t * map)
-: max_samples_(0), max_obs_(0), temp_obs_(NULL)
+: max_samples_(0), max_obs_(0), temp_obs_(NULL), num_threads_(1),
+  vectorized_field_(true)
 {
   max_beams_ = max_beams;
   map_ = map;
@@ -70,4 +82,136 @@ Laser::SetLaserPose(pf_vector_t & laser_pose)
   laser_pose_ = laser_pose;
 }
 
+void
+Laser::SetNumThreads(int num_threads)
+{
+  num_threads_ = std::max(num_threads, 1);
+  if (num_threads_ > 1) {
+    thread_pool_ = std::make_unique<nav2_util::ThreadPool>(num_threads_);
+  } else {
+    thread_pool_.reset();
+  }
+}
+
+void
+Laser::SetVectorizedField(bool enabled)
+{
+  vectorized_field_ = enabled;
+}
+
+int
+Laser::numSampleChunks(int sample_count) const
+{
+  return std::max(std::min(num_threads_, sample_count), 1);
+}
+
+double
+Laser::weightSamples(
+  pf_sample_set_t * set, const std::function<double(int, int, int)> & weight_fn)
+{
+  const int num_chunks = numSampleChunks(set->sample_count);
+  if (num_chunks == 1) {
+    return weight_fn(0, set->sample_count, 0);
+  }
+
+  const int chunk_size = (set->sample_count + num_chunks - 1) / num_chunks;
+  std::vector<double> chunk_weights(num_chunks, 0.0);
+  auto weight_chunk = [&](int chunk) {
+      const int begin = std::min(chunk * chunk_size, set->sample_count);
+      const int end = std::min(begin + chunk_size, set->sample_count);
+      chunk_weights[chunk] = weight_fn(begin, end, chunk);
+    };
+
+  // One chunk per thread, the calling thread weights the first chunk
+  thread_pool_->parallelTasks(
+    num_chunks, [&](size_t chunk) {
+      weight_chunk(static_cast<int>(chunk));
+    });
+
+  double total_weight = 0.0;
+  for (const double weight : chunk_weights) {
+    total_weight += weight;
+  }
+  return total_weight;
+}
+
+void
+Laser::collectFieldBeams(LaserData * data, int step, std::vector<FieldBeam> & beams)
+{
+  beams.clear();
+  int index = 0;
+  for (int i = 0; i < data->range_count; i += step, index++) {
+    FieldBeam beam;
+    beam.range = data->ranges[i][0];
+
+    // Max range readings are ignored, as are NaNs
+    if (beam.range >= data->range_max || beam.range != beam.range) {
+      continue;
+    }
+
+    beam.bearing = data->ranges[i][1];
+    beam.cos_bearing = static_cast<float>(cos(beam.bearing));
+    beam.sin_bearing = static_cast<float>(sin(beam.bearing));
+    beam.index = index;
+    beams.push_back(beam);
+  }
+}
+
+void
+Laser::loadSampleBatch(pf_sample_set_t * set, int begin, int end, SampleBatch & batch) const
+{
+  assert(end - begin <= SampleBatch::SIZE);
+  batch.count = end - begin;
+  for (int k = 0; k < batch.count; k++) {
+    // Take account of the laser pose relative to the robot
+    pf_vector_t pose = pf_vector_coord_add(laser_pose_, set->samples[begin + k].pose);
+    batch.x[k] = pose.v[0];
+    batch.y[k] = pose.v[1];
+    batch.theta[k] = pose.v[2];
+    // Position in cells from the cell at the origin, offset to round to the nearest cell
+    batch.cell_x[k] = static_cast<float>((pose.v[0] - map_->origin_x) / map_->scale + 0.5);
+    batch.cell_y[k] = static_cast<float>((pose.v[1] - map_->origin_y) / map_->scale + 0.5);
+    batch.cos_theta[k] = static_cast<float>(cos(pose.v[2]));
+    batch.sin_theta[k] = static_cast<float>(sin(pose.v[2]));
+  }
+}
+
+void
+Laser::fieldDistances(const SampleBatch & batch, const FieldBeam & beam, float * dist) const
+{
+  const map_t * map = map_;
+  const float * field = map->occ_dist_field;
+  int hit_i[SampleBatch::SIZE];
+  int hit_j[SampleBatch::SIZE];
+
+  // Compute the cells of the endpoints of the beam. The vectorizable path rotates the beam
+  // in single precision with the precomputed trigonometry of the sample headings and of the
+  // bearing, which changes the rounding of the endpoints with respect to the reference path.
+  if (vectorized_field_) {
+    const float range_cells = static_cast<float>(beam.range / map->scale);
+    const int half_size_x = map->size_x / 2;
+    const int half_size_y = map->size_y / 2;
+    for (int k = 0; k < batch.count; k++) {
+      float cos_angle = batch.cos_theta[k] * beam.cos_bearing -
+        batch.sin_theta[k] * beam.sin_bearing;
+      float sin_angle = batch.sin_theta[k] * beam.cos_bearing +
+        batch.cos_theta[k] * beam.sin_bearing;
+      hit_i[k] = floorToInt(batch.cell_x[k] + range_cells * cos_angle) + half_size_x;
+      hit_j[k] = floorToInt(batch.cell_y[k] + range_cells * sin_angle) + half_size_y;
+    }
+  } else {
+    for (int k = 0; k < batch.count; k++) {
+      hit_i[k] = MAP_GXWX(map, batch.x[k] + beam.range * cos(batch.theta[k] + beam.bearing));
+      hit_j[k] = MAP_GYWY(map, batch.y[k] + beam.range * sin(batch.theta[k] + beam.bearing));
+    }
+  }
+
+  // Gather the distances from the packed field
+  for (int k = 0; k < batch.count; k++) {
+    int mi = hit_i[k];
+    int mj = hit_j[k];
+    dist[k] = MAP_VALID(map, mi, mj) ? field[MAP_INDEX(map, mi, mj)] : -1.0f;
+  }
+}
+
 }  // namespace nav2_amcl
@@ -22,6 +22,10 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
 namespace nav2_amcl
@@ -35,27 +39,25 @@ LikelihoodFieldModel::LikelihoodFieldModel(
   z_hit_ = z_hit;
   z_rand_ = z_rand;
   sigma_hit_ = sigma_hit;
-  map_update_cspace(map, max_occ_dist);
+
+  // The cspace distances may already have been computed for the map, e.g. for another laser
+  if (map->occ_dist_field == NULL || map->max_occ_dist != max_occ_dist) {
+    map_update_cspace(map, max_occ_dist);
+  }
 }
 
 double
 LikelihoodFieldModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
 {
   LikelihoodFieldModel * self;
-  int i, j, step;
-  double z, pz;
-  double p;
-  double obs_range, obs_bearing;
-  double total_weight;
-  pf_sample_t * sample;
-  pf_vector_t pose;
-  pf_vector_t hit;
+  int step;
 
   self = reinterpret_cast<LikelihoodFieldModel *>(data->laser);
 
   // Pre-compute a couple of things
   double z_hit_denom = 2 * self->sigma_hit_ * self->sigma_hit_;
   double z_rand_mult = 1.0 / data->range_max;
+  double z_rand_term = self->z_rand_ * z_rand_mult;
 
   step = (data->range_count - 1) / (self->max_beams_ - 1);
 
@@ -64,71 +66,76 @@ LikelihoodFieldModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
     step = 1;
   }
 
-  total_weight = 0.0;
-
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++) {
-    sample = set->samples + j;
-    pose = sample->pose;
-
-    // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose_, pose);
-
-    p = 1.0;
-
-    for (i = 0; i < data->range_count; i += step) {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
-
-      // This model ignores max range readings
-      if (obs_range >= data->range_max) {
-        continue;
+  // Pre-compute the beams of the scan to consider
+  std::vector<FieldBeam> beams;
+  collectFieldBeams(data, step, beams);
+
+  // Compute the sample weights, a batch of samples at a time
+  auto weight_fn = [&](int begin, int end, int /*chunk*/) {
+      SampleBatch batch;
+      float dist[SampleBatch::SIZE];
+      double p[SampleBatch::SIZE];
+      double chunk_weight = 0.0;
+      pf_sample_t * sample;
+
+      // Weight the samples of the batch with a beam. The vectorizable kernel computes the
+      // probabilities in single precision to fit more samples in a vector, and only
+      // accumulates them in double precision.
+      auto weigh_beam = [&](auto zero) {
+          using Real = decltype(zero);
+          const Real max_occ_dist = self->map_->max_occ_dist;
+          const Real z_hit = self->z_hit_;
+          const Real denom = z_hit_denom;
+          const Real rand_term = z_rand_term;
+          for (int k = 0; k < batch.count; k++) {
+            // Off-map penalized as max distance
+            Real z = dist[k] < 0.0f ? max_occ_dist : dist[k];
+
+            // Gaussian model
+            // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
+            // Part 2: random measurements
+            Real pz = z_hit * std::exp(-(z * z) / denom) + rand_term;
+
+            // TODO(?): outlier rejection for short readings
+
+            assert(pz <= 1.0);
+            assert(pz >= 0.0);
+            //      p *= pz;
+            // here we have an ad-hoc weighting scheme for combining beam probs
+            // works well, though...
+            p[k] += pz * pz * pz;
+          }
+        };
+
+      for (int batch_begin = begin; batch_begin < end; batch_begin += SampleBatch::SIZE) {
+        self->loadSampleBatch(
+          set, batch_begin, std::min(batch_begin + SampleBatch::SIZE, end), batch);
+
+        for (int k = 0; k < batch.count; k++) {
+          p[k] = 1.0;
+        }
+
+        for (const FieldBeam & beam : beams) {
+          // Part 1: Get distance from the hit to closest obstacle.
+          self->fieldDistances(batch, beam, dist);
+
+          if (self->vectorized_field_) {
+            weigh_beam(0.0f);
+          } else {
+            weigh_beam(0.0);
+          }
+        }
+
+        for (int k = 0; k < batch.count; k++) {
+          sample = set->samples + batch_begin + k;
+          sample->weight *= p[k];
+          chunk_weight += sample->weight;
+        }
       }
+      return chunk_weight;
+    };
 
-      // Check for NaN
-      if (obs_range != obs_range) {
-        continue;
-      }
-
-      pz = 0.0;
-
-      // Compute the endpoint of the beam
-      hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-      hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
-
-      // Convert to map grid coords.
-      int mi, mj;
-      mi = MAP_GXWX(self->map_, hit.v[0]);
-      mj = MAP_GYWY(self->map_, hit.v[1]);
-
-      // Part 1: Get distance from the hit to closest obstacle.
-      // Off-map penalized as max distance
-      if (!MAP_VALID(self->map_, mi, mj)) {
-        z = self->map_->max_occ_dist;
-      } else {
-        z = self->map_->cells[MAP_INDEX(self->map_, mi, mj)].occ_dist;
-      }
-      // Gaussian model
-      // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
-      pz += self->z_hit_ * exp(-(z * z) / z_hit_denom);
-      // Part 2: random measurements
-      pz += self->z_rand_ * z_rand_mult;
-
-      // TODO(?): outlier rejection for short readings
-
-      assert(pz <= 1.0);
-      assert(pz >= 0.0);
-      //      p *= pz;
-      // here we have an ad-hoc weighting scheme for combining beam probs
-      // works well, though...
-      p += pz * pz * pz;
-    }
-
-    sample->weight *= p;
-    total_weight += sample->weight;
-  }
-
-  return total_weight;
+  return self->weightSamples(set, weight_fn);
 }
 
 
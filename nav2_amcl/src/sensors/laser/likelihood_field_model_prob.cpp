@@ -23,6 +23,10 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
 namespace nav2_amcl
@@ -44,7 +48,11 @@ LikelihoodFieldModelProb::LikelihoodFieldModelProb(
   beam_skip_distance_ = beam_skip_distance;
   beam_skip_threshold_ = beam_skip_threshold;
   beam_skip_error_threshold_ = beam_skip_error_threshold;
-  map_update_cspace(map, max_occ_dist);
+
+  // The cspace distances may already have been computed for the map, e.g. for another laser
+  if (map->occ_dist_field == NULL || map->max_occ_dist != max_occ_dist) {
+    map_update_cspace(map, max_occ_dist);
+  }
 }
 
 // Determine the probability for the given pose
@@ -52,19 +60,11 @@ double
 LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set)
 {
   LikelihoodFieldModelProb * self;
-  int i, j, step;
-  double z, pz;
-  double log_p;
-  double obs_range, obs_bearing;
+  int step;
   double total_weight;
-  pf_sample_t * sample;
-  pf_vector_t pose;
-  pf_vector_t hit;
 
   self = reinterpret_cast<LikelihoodFieldModelProb *>(data->laser);
 
-  total_weight = 0.0;
-
   step = ceil((data->range_count) / static_cast<double>(self->max_beams_));
 
   // Step size must be at least 1
@@ -75,6 +75,7 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
   // Pre-compute a couple of things
   double z_hit_denom = 2 * self->sigma_hit_ * self->sigma_hit_;
   double z_rand_mult = 1.0 / data->range_max;
+  double z_rand_term = self->z_rand_ * z_rand_mult;
 
   double max_dist_prob = exp(-(self->map_->max_occ_dist * self->map_->max_occ_dist) / z_hit_denom);
 
@@ -91,15 +92,16 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
     do_beamskip = false;
   }
 
-  // we need a count the no of particles for which the beam agreed with the map
+  // we need a count the no of particles for which the beam agreed with the map,
+  // accumulated separately for each chunk of samples weighted in parallel
+  int num_chunks = self->numSampleChunks(set->sample_count);
   int * obs_count = new int[self->max_beams_]();
+  int * obs_count_chunks = new int[num_chunks * self->max_beams_]();
 
   // we also need a mask of which observations to integrate (to decide which beams to integrate to
   // all particles)
   bool * obs_mask = new bool[self->max_beams_]();
 
-  int beam_ind = 0;
-
   // realloc indicates if we need to reallocate the temp data structure needed to do beamskipping
   bool realloc = false;
 
@@ -118,76 +120,97 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
     }
   }
 
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++) {
-    sample = set->samples + j;
-    pose = sample->pose;
-
-    // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose_, pose);
-
-    log_p = 0;
-
-    beam_ind = 0;
-
-    for (i = 0; i < data->range_count; i += step, beam_ind++) {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
-
-      // This model ignores max range readings
-      if (obs_range >= data->range_max) {
-        continue;
-      }
-
-      // Check for NaN
-      if (obs_range != obs_range) {
-        continue;
-      }
-
-      pz = 0.0;
-
-      // Compute the endpoint of the beam
-      hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-      hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
+  // Pre-compute the beams of the scan to consider
+  std::vector<FieldBeam> beams;
+  collectFieldBeams(data, step, beams);
+
+  // Compute the sample weights, a batch of samples at a time
+  auto weight_fn = [&](int begin, int end, int chunk) {
+      SampleBatch batch;
+      float dist[SampleBatch::SIZE];
+      double log_p[SampleBatch::SIZE];
+      double chunk_weight = 0.0;
+      int * chunk_obs_count = obs_count_chunks + chunk * self->max_beams_;
+      pf_sample_t * sample;
+
+      // Weight the samples of the batch with a beam. The vectorizable kernel computes the
+      // probabilities in single precision to fit more samples in a vector, and only
+      // accumulates them in double precision.
+      auto weigh_beam = [&](const FieldBeam & beam, int batch_begin, auto zero) {
+          using Real = decltype(zero);
+          const Real z_hit = self->z_hit_;
+          const Real denom = z_hit_denom;
+          const Real rand_term = z_rand_term;
+          const Real off_map_prob = z_hit * static_cast<Real>(max_dist_prob);
+          const Real skip_distance = beam_skip_distance;
+          for (int k = 0; k < batch.count; k++) {
+            Real pz;
+
+            // Off-map penalized as max distance
+            if (dist[k] < 0.0f) {
+              pz = off_map_prob;
+            } else {
+              Real z = dist[k];
+              if (z < skip_distance) {
+                chunk_obs_count[beam.index] += 1;
+              }
+              pz = z_hit * std::exp(-(z * z) / denom);
+            }
+
+            // Gaussian model
+            // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
+
+            // Part 2: random measurements
+            pz += rand_term;
+
+            assert(pz <= 1.0);
+            assert(pz >= 0.0);
+
+            // TODO(?): outlier rejection for short readings
+
+            if (!do_beamskip) {
+              log_p[k] += std::log(pz);
+            } else {
+              self->temp_obs_[batch_begin + k][beam.index] = pz;
+            }
+          }
+        };
+
+      for (int batch_begin = begin; batch_begin < end; batch_begin += SampleBatch::SIZE) {
+        self->loadSampleBatch(
+          set, batch_begin, std::min(batch_begin + SampleBatch::SIZE, end), batch);
+
+        for (int k = 0; k < batch.count; k++) {
+          log_p[k] = 0;
+        }
 
-      // Convert to map grid coords.
-      int mi, mj;
-      mi = MAP_GXWX(self->map_, hit.v[0]);
-      mj = MAP_GYWY(self->map_, hit.v[1]);
+        for (const FieldBeam & beam : beams) {
+          // Part 1: Get distance from the hit to closest obstacle.
+          self->fieldDistances(batch, beam, dist);
 
-      // Part 1: Get distance from the hit to closest obstacle.
-      // Off-map penalized as max distance
+          if (self->vectorized_field_) {
+            weigh_beam(beam, batch_begin, 0.0f);
+          } else {
+            weigh_beam(beam, batch_begin, 0.0);
+          }
+        }
 
-      if (!MAP_VALID(self->map_, mi, mj)) {
-        pz += self->z_hit_ * max_dist_prob;
-      } else {
-        z = self->map_->cells[MAP_INDEX(self->map_, mi, mj)].occ_dist;
-        if (z < beam_skip_distance) {
-          obs_count[beam_ind] += 1;
+        if (!do_beamskip) {
+          for (int k = 0; k < batch.count; k++) {
+            sample = set->samples + batch_begin + k;
+            sample->weight *= exp(log_p[k]);
+            chunk_weight += sample->weight;
+          }
         }
-        pz += self->z_hit_ * exp(-(z * z) / z_hit_denom);
       }
+      return chunk_weight;
+    };
+  total_weight = self->weightSamples(set, weight_fn);
 
-      // Gaussian model
-      // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
-
-      // Part 2: random measurements
-      pz += self->z_rand_ * z_rand_mult;
-
-      assert(pz <= 1.0);
-      assert(pz >= 0.0);
-
-      // TODO(?): outlier rejection for short readings
-
-      if (!do_beamskip) {
-        log_p += log(pz);
-      } else {
-        self->temp_obs_[j][beam_ind] = pz;
-      }
-    }
-    if (!do_beamskip) {
-      sample->weight *= exp(log_p);
-      total_weight += sample->weight;
+  int beam_ind = 0;
+  for (int chunk = 0; chunk < num_chunks; chunk++) {
+    for (beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
+      obs_count[beam_ind] += obs_count_chunks[chunk * self->max_beams_ + beam_ind];
     }
   }
 
@@ -217,25 +240,33 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
       error = true;
     }
 
-    for (j = 0; j < set->sample_count; j++) {
-      sample = set->samples + j;
-      pose = sample->pose;
+    auto skip_weight_fn = [&](int begin, int end, int /*chunk*/) {
+        double log_p;
+        double chunk_weight = 0.0;
+        pf_sample_t * sample;
 
-      log_p = 0;
+        for (int j = begin; j < end; j++) {
+          sample = set->samples + j;
 
-      for (beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
-        if (error || obs_mask[beam_ind]) {
-          log_p += log(self->temp_obs_[j][beam_ind]);
-        }
-      }
+          log_p = 0;
 
-      sample->weight *= exp(log_p);
+          for (int i = 0; i < self->max_beams_; i++) {
+            if (error || obs_mask[i]) {
+              log_p += log(self->temp_obs_[j][i]);
+            }
+          }
 
-      total_weight += sample->weight;
-    }
+          sample->weight *= exp(log_p);
+
+          chunk_weight += sample->weight;
+        }
+        return chunk_weight;
+      };
+    total_weight += self->weightSamples(set, skip_weight_fn);
   }
 
   delete[] obs_count;
+  delete[] obs_count_chunks;
   delete[] obs_mask;
   return total_weight;
 }
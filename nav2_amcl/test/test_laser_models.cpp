@@ -0,0 +1,161 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <math.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_amcl/map/map.hpp"
+#include "nav2_amcl/pf/pf.hpp"
+#include "nav2_amcl/sensors/laser/laser.hpp"
+
+using nav2_amcl::Laser;
+using nav2_amcl::LaserData;
+
+static constexpr int SAMPLE_COUNT = 500;
+static constexpr int RANGE_COUNT = 181;
+
+// A 5 m square room, with a box in the middle
+map_t * makeMap()
+{
+  map_t * map = map_alloc();
+  map->size_x = 100;
+  map->size_y = 100;
+  map->scale = 0.05;
+  map->cells = static_cast<map_cell_t *>(calloc(map->size_x * map->size_y, sizeof(map_cell_t)));
+  for (int j = 0; j < map->size_y; j++) {
+    for (int i = 0; i < map->size_x; i++) {
+      bool wall = i == 0 || j == 0 || i == map->size_x - 1 || j == map->size_y - 1;
+      bool box = i >= 60 && i < 70 && j >= 40 && j < 55;
+      map->cells[i + j * map->size_x].occ_state = wall || box ? 1 : -1;
+    }
+  }
+  return map;
+}
+
+// A scan seen from the center of the room, with max range and NaN readings
+void makeScan(LaserData & data, Laser * laser)
+{
+  data.laser = laser;
+  data.range_count = RANGE_COUNT;
+  data.range_max = 4.0;
+  data.ranges = new double[RANGE_COUNT][2];
+  for (int i = 0; i < RANGE_COUNT; i++) {
+    double bearing = -M_PI / 2 + M_PI * i / (RANGE_COUNT - 1);
+    data.ranges[i][0] = 2.0 + 0.4 * sin(5 * bearing);
+    data.ranges[i][1] = bearing;
+  }
+  data.ranges[7][0] = data.range_max;
+  data.ranges[42][0] = std::numeric_limits<double>::quiet_NaN();
+}
+
+// Weight a deterministic spread of samples around the center of the room
+std::vector<double> weightSamples(Laser & laser, int num_threads)
+{
+  pf_t * pf = pf_alloc(SAMPLE_COUNT, SAMPLE_COUNT, 0.001, 0.1, nullptr);
+  pf_sample_set_t * set = pf->sets + pf->current_set;
+  for (int i = 0; i < set->sample_count; i++) {
+    set->samples[i].pose.v[0] = 0.8 * sin(0.37 * i);
+    set->samples[i].pose.v[1] = 0.8 * cos(0.53 * i);
+    set->samples[i].pose.v[2] = fmod(0.71 * i, 2 * M_PI) - M_PI;
+    set->samples[i].weight = 1.0 / set->sample_count;
+  }
+
+  LaserData data;
+  makeScan(data, &laser);
+  laser.SetNumThreads(num_threads);
+  EXPECT_TRUE(laser.sensorUpdate(pf, &data));
+
+  std::vector<double> weights;
+  for (int i = 0; i < set->sample_count; i++) {
+    weights.push_back(set->samples[i].weight);
+  }
+  pf_free(pf);
+  return weights;
+}
+
+// The chunk totals are summed in a different order, so the normalized weights may differ
+// by rounding only
+void expectSameWeights(
+  const std::vector<double> & expected, const std::vector<double> & actual,
+  double tolerance = 1e-12)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(expected[i], actual[i], tolerance * expected[i]);
+  }
+}
+
+TEST(LaserModels, ThreadedBeamModel)
+{
+  map_t * map = makeMap();
+  nav2_amcl::BeamModel laser(0.5, 0.05, 0.05, 0.5, 0.2, 0.1, 0.05, 60, map);
+  auto single = weightSamples(laser, 1);
+  expectSameWeights(single, weightSamples(laser, 4));
+  expectSameWeights(single, weightSamples(laser, 3));
+  // The threads are kept between updates
+  expectSameWeights(single, weightSamples(laser, 3));
+  map_free(map);
+}
+
+TEST(LaserModels, ThreadedLikelihoodFieldModel)
+{
+  map_t * map = makeMap();
+  nav2_amcl::LikelihoodFieldModel laser(0.5, 0.5, 0.2, 2.0, 60, map);
+  auto single = weightSamples(laser, 1);
+  expectSameWeights(single, weightSamples(laser, 4));
+  expectSameWeights(single, weightSamples(laser, 3));
+  expectSameWeights(single, weightSamples(laser, 3));
+  map_free(map);
+}
+
+TEST(LaserModels, ThreadedLikelihoodFieldModelProb)
+{
+  map_t * map = makeMap();
+  // Beam skipping counts the beams matched over all of the samples
+  nav2_amcl::LikelihoodFieldModelProb laser(
+    0.5, 0.5, 0.2, 2.0, true, 0.5, 0.3, 0.9, 60, map);
+  auto single = weightSamples(laser, 1);
+  expectSameWeights(single, weightSamples(laser, 4));
+  expectSameWeights(single, weightSamples(laser, 3));
+  expectSameWeights(single, weightSamples(laser, 3));
+  map_free(map);
+}
+
+// The vectorizable kernel rotates the beams with precomputed trigonometry and computes the
+// beam probabilities in single precision, which only changes their rounding with respect to
+// the reference kernel. The relative errors of the beams add up over the scan.
+TEST(LaserModels, VectorizedLikelihoodField)
+{
+  map_t * map = makeMap();
+  nav2_amcl::LikelihoodFieldModel laser(0.5, 0.5, 0.2, 2.0, 60, map);
+  auto vectorized = weightSamples(laser, 1);
+  laser.SetVectorizedField(false);
+  expectSameWeights(vectorized, weightSamples(laser, 1), 1e-5);
+  map_free(map);
+}
+
+TEST(LaserModels, VectorizedLikelihoodFieldProb)
+{
+  map_t * map = makeMap();
+  nav2_amcl::LikelihoodFieldModelProb laser(
+    0.5, 0.5, 0.2, 2.0, true, 0.5, 0.3, 0.9, 60, map);
+  auto vectorized = weightSamples(laser, 4);
+  laser.SetVectorizedField(false);
+  expectSameWeights(vectorized, weightSamples(laser, 4), 1e-5);
+  map_free(map);
+}
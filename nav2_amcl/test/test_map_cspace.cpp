@@ -0,0 +1,132 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_amcl/map/map.hpp"
+#include "nav2_util/thread_pool.hpp"
+
+// A map with sparse random obstacles, and a column and a row without any
+map_t * makeMap(int size_x, int size_y)
+{
+  map_t * map = map_alloc();
+  map->size_x = size_x;
+  map->size_y = size_y;
+  map->scale = 0.05;
+  map->cells = static_cast<map_cell_t *>(calloc(size_x * size_y, sizeof(map_cell_t)));
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> value(0, 199);
+  for (int j = 0; j < size_y; j++) {
+    for (int i = 0; i < size_x; i++) {
+      bool occupied = value(generator) == 0 && i != size_x / 3 && j != size_y / 2;
+      map->cells[MAP_INDEX(map, i, j)].occ_state = occupied ? +1 : -1;
+    }
+  }
+  return map;
+}
+
+// Distance of every cell to the closest obstacle, searched exhaustively
+std::vector<float> bruteForceDistances(const map_t * map, double max_occ_dist)
+{
+  const int cell_radius = max_occ_dist / map->scale;
+  std::vector<float> distances;
+  for (int j = 0; j < map->size_y; j++) {
+    for (int i = 0; i < map->size_x; i++) {
+      double closest = INFINITY;
+      for (int oj = 0; oj < map->size_y; oj++) {
+        for (int oi = 0; oi < map->size_x; oi++) {
+          if (map->cells[MAP_INDEX(map, oi, oj)].occ_state == +1) {
+            closest = std::min(closest, hypot(i - oi, j - oj));
+          }
+        }
+      }
+      distances.push_back(closest > cell_radius ? max_occ_dist : closest * map->scale);
+    }
+  }
+  return distances;
+}
+
+void expectDistances(const map_t * map, const std::vector<float> & expected)
+{
+  for (int i = 0; i < map->size_x * map->size_y; i++) {
+    EXPECT_FLOAT_EQ(map->cells[i].occ_dist, expected[i]) << "at cell " << i;
+    EXPECT_EQ(map->occ_dist_field[i], map->cells[i].occ_dist) << "at cell " << i;
+  }
+}
+
+TEST(MapCspace, ExactDistanceTransform)
+{
+  map_t * map = makeMap(83, 61);
+  const std::vector<float> expected = bruteForceDistances(map, 0.5);
+
+  map_update_cspace(map, 0.5);
+  EXPECT_EQ(map->max_occ_dist, 0.5);
+  expectDistances(map, expected);
+
+  nav2_util::ThreadPool pool(4);
+  map_update_cspace_threaded(map, 0.5, &pool);
+  expectDistances(map, expected);
+
+  // Without any obstacle all of the cells are at the max distance
+  for (int i = 0; i < map->size_x * map->size_y; i++) {
+    map->cells[i].occ_state = -1;
+  }
+  map_update_cspace_threaded(map, 0.5, &pool);
+  expectDistances(map, std::vector<float>(map->size_x * map->size_y, 0.5));
+  map_free(map);
+}
+
+TEST(MapCspace, SaveAndLoad)
+{
+  const std::string filename = "/tmp/test_map_cspace.bin";
+  map_t * map = makeMap(40, 30);
+
+  // Nothing to save before the distances are computed
+  EXPECT_EQ(map_save_cspace(map, filename.c_str()), -1);
+  map_update_cspace(map, 0.5);
+  ASSERT_EQ(map_save_cspace(map, filename.c_str()), 0);
+  const std::vector<float> expected(map->occ_dist_field, map->occ_dist_field + 40 * 30);
+
+  // The distances are read back for the same map and distance
+  map_t * loaded = makeMap(40, 30);
+  ASSERT_EQ(map_load_cspace(loaded, 0.5, filename.c_str()), 0);
+  EXPECT_EQ(loaded->max_occ_dist, 0.5);
+  expectDistances(loaded, expected);
+  map_free(loaded);
+
+  // Files written for another distance or another map are rejected
+  map_t * other = makeMap(40, 30);
+  EXPECT_EQ(map_load_cspace(other, 1.0, filename.c_str()), -1);
+  EXPECT_EQ(other->occ_dist_field, nullptr);
+  other->cells[MAP_INDEX(other, 40 / 3, 7)].occ_state = +1;
+  EXPECT_EQ(map_load_cspace(other, 0.5, filename.c_str()), -1);
+  EXPECT_EQ(other->occ_dist_field, nullptr);
+  map_free(other);
+
+  map_t * resized = makeMap(30, 40);
+  EXPECT_EQ(map_load_cspace(resized, 0.5, filename.c_str()), -1);
+  map_free(resized);
+
+  EXPECT_EQ(map_load_cspace(map, 0.5, "/tmp/test_map_cspace_missing.bin"), -1);
+  remove(filename.c_str());
+  map_free(map);
+}
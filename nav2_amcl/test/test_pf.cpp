@@ -0,0 +1,282 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_amcl/pf/pf.hpp"
+#include "nav2_amcl/pf/pf_pdf.hpp"
+#include "nav2_amcl/portable_utils.hpp"
+
+static constexpr int MIN_SAMPLES = 100;
+static constexpr int MAX_SAMPLES = 2000;
+
+// A filter with a deterministic spread of weighted samples, in a few groups
+pf_t * makeFilter(pf_resample_type_t resample_type, uint64_t seed)
+{
+  pf_t * pf = pf_alloc(MIN_SAMPLES, MAX_SAMPLES, 0.001, 0.1, nullptr);
+  pf->resample_type = resample_type;
+  pf_seed(pf, seed);
+
+  pf_sample_set_t * set = pf->sets + pf->current_set;
+  double total = 0.0;
+  for (int i = 0; i < set->sample_count; i++) {
+    const int group = i % 3;
+    set->samples[i].pose.v[0] = 4.0 * group + 0.3 * sin(0.37 * i);
+    set->samples[i].pose.v[1] = -2.0 * group + 0.3 * cos(0.53 * i);
+    set->samples[i].pose.v[2] = fmod(0.71 * i, 2 * M_PI) - M_PI;
+    set->samples[i].weight = 1.0 + (group + 1) * sin(0.11 * i) * sin(0.11 * i);
+    total += set->samples[i].weight;
+  }
+  for (int i = 0; i < set->sample_count; i++) {
+    set->samples[i].weight /= total;
+  }
+
+  // No random poses are injected
+  pf->w_slow = pf->w_fast = 0.5;
+  return pf;
+}
+
+std::vector<pf_vector_t> currentPoses(const pf_t * pf)
+{
+  const pf_sample_set_t * set = pf->sets + pf->current_set;
+  std::vector<pf_vector_t> poses;
+  for (int i = 0; i < set->sample_count; i++) {
+    poses.push_back(set->samples[i].pose);
+  }
+  return poses;
+}
+
+void expectSamePoses(const std::vector<pf_vector_t> & expected, const pf_t * pf)
+{
+  const std::vector<pf_vector_t> poses = currentPoses(pf);
+  ASSERT_EQ(poses.size(), expected.size());
+  for (size_t i = 0; i < poses.size(); i++) {
+    for (int k = 0; k < 3; k++) {
+      EXPECT_EQ(poses[i].v[k], expected[i].v[k]) << "at sample " << i;
+    }
+  }
+}
+
+bool samePoses(const std::vector<pf_vector_t> & expected, const pf_t * pf)
+{
+  const std::vector<pf_vector_t> poses = currentPoses(pf);
+  if (poses.size() != expected.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < poses.size(); i++) {
+    for (int k = 0; k < 3; k++) {
+      if (poses[i].v[k] != expected[i].v[k]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(ParticleFilter, SeededResamplingIsReproducible)
+{
+  for (pf_resample_type_t type : {PF_RESAMPLE_MULTINOMIAL, PF_RESAMPLE_SYSTEMATIC}) {
+    pf_t * pf = makeFilter(type, 42);
+    pf_t * same_seed = makeFilter(type, 42);
+    pf_t * other_seed = makeFilter(type, 43);
+
+    // Resample a few times, the filters are reseeded only once
+    for (int update = 0; update < 3; update++) {
+      pf_update_resample(pf, nullptr);
+      pf_update_resample(same_seed, nullptr);
+      pf_update_resample(other_seed, nullptr);
+
+      const std::vector<pf_vector_t> poses = currentPoses(pf);
+      EXPECT_GE(poses.size(), static_cast<size_t>(MIN_SAMPLES));
+      expectSamePoses(poses, same_seed);
+      EXPECT_FALSE(samePoses(poses, other_seed)) << "resample type " << type;
+    }
+
+    pf_free(pf);
+    pf_free(same_seed);
+    pf_free(other_seed);
+  }
+}
+
+// Random pose drawn from drand48, as AmclNode::uniformPoseGenerator does
+pf_vector_t randomPose(void *)
+{
+  pf_vector_t pose;
+  pose.v[0] = -10.0 + drand48() * 20.0;
+  pose.v[1] = -10.0 + drand48() * 20.0;
+  pose.v[2] = drand48() * 2 * M_PI - M_PI;
+  return pose;
+}
+
+// Poses of a filter initialized, moved with noise and resampled with random poses
+std::vector<pf_vector_t> runFilter(uint64_t seed)
+{
+  pf_t * pf = pf_alloc(MIN_SAMPLES, MAX_SAMPLES, 0.001, 0.1, randomPose);
+  pf->resample_type = PF_RESAMPLE_SYSTEMATIC;
+  pf_seed(pf, seed);
+
+  pf_vector_t mean = pf_vector_zero();
+  pf_matrix_t cov = pf_matrix_zero();
+  cov.m[0][0] = cov.m[1][1] = 0.25;
+  cov.m[2][2] = 0.07;
+  pf_init(pf, mean, cov);
+
+  for (int update = 0; update < 3; update++) {
+    // Motion noise, as the motion models add it
+    pf_sample_set_t * set = pf->sets + pf->current_set;
+    double total = 0.0;
+    for (int i = 0; i < set->sample_count; i++) {
+      set->samples[i].pose.v[0] += 0.1 + pf_ran_gaussian(0.05);
+      set->samples[i].pose.v[1] += pf_ran_gaussian(0.05);
+      set->samples[i].pose.v[2] += pf_ran_gaussian(0.02);
+      set->samples[i].weight = exp(-set->samples[i].pose.v[1] * set->samples[i].pose.v[1]);
+      total += set->samples[i].weight;
+    }
+    for (int i = 0; i < set->sample_count; i++) {
+      set->samples[i].weight /= total;
+    }
+
+    // Some random poses are injected
+    pf->w_slow = 1.0;
+    pf->w_fast = 0.8;
+    pf_update_resample(pf, nullptr);
+  }
+
+  std::vector<pf_vector_t> poses = currentPoses(pf);
+  pf_free(pf);
+  return poses;
+}
+
+TEST(ParticleFilter, SeededRunIsReproducible)
+{
+  const std::vector<pf_vector_t> poses = runFilter(42);
+  EXPECT_GE(poses.size(), static_cast<size_t>(MIN_SAMPLES));
+
+  const std::vector<pf_vector_t> same_seed_poses = runFilter(42);
+  ASSERT_EQ(same_seed_poses.size(), poses.size());
+  for (size_t i = 0; i < poses.size(); i++) {
+    for (int k = 0; k < 3; k++) {
+      EXPECT_EQ(same_seed_poses[i].v[k], poses[i].v[k]) << "at sample " << i;
+    }
+  }
+
+  const std::vector<pf_vector_t> other_seed_poses = runFilter(43);
+  EXPECT_FALSE(
+    other_seed_poses.size() == poses.size() &&
+    std::equal(
+      poses.begin(), poses.end(), other_seed_poses.begin(),
+      [](const pf_vector_t & a, const pf_vector_t & b) {
+        return a.v[0] == b.v[0] && a.v[1] == b.v[1] && a.v[2] == b.v[2];
+      }));
+}
+
+TEST(ParticleFilter, HistogramClustersMatchKdTree)
+{
+  // Blobs of poses of various spreads, some of them touching
+  std::mt19937 generator(3);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  const double blobs[][4] = {
+    {0.0, 0.0, 0.0, 0.2}, {1.2, 0.1, 0.5, 0.3}, {-5.0, 3.0, -2.0, 0.6},
+    {6.0, -4.0, 3.0, 0.1}, {6.0, 4.0, 1.0, 1.0}};
+  std::vector<pf_vector_t> poses;
+  for (int i = 0; i < MAX_SAMPLES; i++) {
+    const double * blob = blobs[i % 5];
+    pf_vector_t pose;
+    pose.v[0] = blob[0] + blob[3] * noise(generator);
+    pose.v[1] = blob[1] + blob[3] * noise(generator);
+    pose.v[2] = blob[2] + blob[3] * noise(generator);
+    poses.push_back(pose);
+  }
+
+  pf_kdtree_t * kdtree = pf_kdtree_alloc(3 * MAX_SAMPLES);
+  pf_histogram_t * histogram = pf_histogram_alloc(MAX_SAMPLES);
+  for (const pf_vector_t & pose : poses) {
+    pf_kdtree_insert(kdtree, pose, 1.0);
+    pf_histogram_insert(histogram, pose, 1.0);
+  }
+  EXPECT_EQ(histogram->bin_count, kdtree->leaf_count);
+  pf_kdtree_cluster(kdtree);
+  pf_histogram_cluster(histogram);
+
+  // The labels differ, but two poses are in the same cluster for both or for neither
+  std::vector<int> kdtree_labels, histogram_labels;
+  int cluster_count = 0;
+  for (const pf_vector_t & pose : poses) {
+    kdtree_labels.push_back(pf_kdtree_get_cluster(kdtree, pose));
+    histogram_labels.push_back(pf_histogram_get_cluster(histogram, pose));
+    ASSERT_GE(kdtree_labels.back(), 0);
+    ASSERT_GE(histogram_labels.back(), 0);
+    cluster_count = std::max(cluster_count, histogram_labels.back() + 1);
+  }
+  EXPECT_GT(cluster_count, 1);
+  std::vector<int> label_map(cluster_count, -1);
+  std::vector<int> inverse_map(3 * MAX_SAMPLES, -1);
+  for (size_t i = 0; i < poses.size(); i++) {
+    int & mapped = label_map[histogram_labels[i]];
+    int & inverse = inverse_map[kdtree_labels[i]];
+    if (mapped < 0 && inverse < 0) {
+      mapped = kdtree_labels[i];
+      inverse = histogram_labels[i];
+    }
+    EXPECT_EQ(mapped, kdtree_labels[i]) << "at pose " << i;
+    EXPECT_EQ(inverse, histogram_labels[i]) << "at pose " << i;
+  }
+
+  pf_kdtree_free(kdtree);
+  pf_histogram_free(histogram);
+}
+
+TEST(ParticleFilter, HistogramClusterStatsMatchKdTree)
+{
+  // Cluster statistics of the same samples, sorted by position since the clusters
+  // are labelled in another order
+  auto clusterStats = [](pf_histogram_type_t type) {
+      pf_t * pf = makeFilter(PF_RESAMPLE_MULTINOMIAL, 42);
+      pf->histogram_type = type;
+      pf_sample_set_t * set = pf->sets + pf->current_set;
+      for (int i = 0; i < set->sample_count; i++) {
+        if (type == PF_HISTOGRAM_HASH) {
+          pf_histogram_insert(set->histogram, set->samples[i].pose, set->samples[i].weight);
+        } else {
+          pf_kdtree_insert(set->kdtree, set->samples[i].pose, set->samples[i].weight);
+        }
+      }
+      pf_cluster_stats(pf, set);
+      std::vector<pf_cluster_t> clusters(set->clusters, set->clusters + set->cluster_count);
+      std::sort(
+        clusters.begin(), clusters.end(), [](const pf_cluster_t & a, const pf_cluster_t & b) {
+          return a.mean.v[0] < b.mean.v[0] ||
+          (a.mean.v[0] == b.mean.v[0] && a.mean.v[1] < b.mean.v[1]);
+        });
+      pf_free(pf);
+      return clusters;
+    };
+
+  const std::vector<pf_cluster_t> kdtree_clusters = clusterStats(PF_HISTOGRAM_KDTREE);
+  const std::vector<pf_cluster_t> histogram_clusters = clusterStats(PF_HISTOGRAM_HASH);
+  ASSERT_EQ(histogram_clusters.size(), kdtree_clusters.size());
+  EXPECT_GT(kdtree_clusters.size(), 1u);
+  for (size_t i = 0; i < kdtree_clusters.size(); i++) {
+    EXPECT_EQ(histogram_clusters[i].count, kdtree_clusters[i].count);
+    EXPECT_NEAR(histogram_clusters[i].weight, kdtree_clusters[i].weight, 1e-12);
+    for (int k = 0; k < 3; k++) {
+      EXPECT_NEAR(histogram_clusters[i].mean.v[k], kdtree_clusters[i].mean.v[k], 1e-9);
+    }
+  }
+}
@@ -68,6 +68,22 @@ public:
    */
   int getPointsInside(const std::vector<Point> & points) const override;
 
+  /**
+   * @brief Gets number of points inside circle, from a batch of points
+   * @param points Input batch of points to be checked
+   * @return Number of points inside circle. If there are no points,
+   * returns zero value.
+   */
+  int getPointsInsideBatch(const PointsBatch & points) const override;
+
+  /**
+   * @brief Gets the axis-aligned bounding box of the circle
+   * @param min Output lower corner of the box
+   * @param max Output upper corner of the box
+   * @return False if circle radius is not set, otherwise true
+   */
+  bool getBoundingBox(Point & min, Point & max) const override;
+
   /**
    * @brief Returns true if circle radius is set.
    * Otherwise, prints a warning and returns false.
@@ -95,6 +111,16 @@ protected:
    */
   void createSubscription(std::string & polygon_sub_topic) override;
 
+  /**
+   * @brief Obtains the time at which a point enters circle, as the robot
+   * moves with a constant velocity
+   * @param point Given point to check
+   * @param velocity Robot velocity
+   * @return Zero if the point is already inside circle, entry time if it enters circle
+   * within one turn of the robot, otherwise infinity
+   */
+  double getPointEntryTime(const Point & point, const Velocity & velocity) const override;
+
   /**
    * @brief Updates polygon from radius value
    * @param radius New circle radius to update polygon
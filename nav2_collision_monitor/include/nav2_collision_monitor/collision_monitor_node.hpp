@@ -159,14 +159,15 @@ protected:
   /**
    * @brief Processes the polygon of STOP, SLOWDOWN and LIMIT action type
    * @param polygon Polygon to process
-   * @param collision_points Array of 2D obstacle points
+   * @param collision_points Batch of 2D obstacle points, which may omit the points
+   * outside of the polygon bounding box
    * @param velocity Desired robot velocity
    * @param robot_action Output processed robot action
    * @return True if returned action is caused by current polygon, otherwise false
    */
   bool processStopSlowdownLimit(
     const std::shared_ptr<Polygon> polygon,
-    const std::vector<Point> & collision_points,
+    const PointsBatch & collision_points,
     const Velocity & velocity,
     Action & robot_action) const;
 
@@ -41,6 +41,32 @@ void transformPoints(const Pose & pose, std::vector<Point> & points);
  */
 void projectState(const double & dt, Pose & pose, Velocity & velocity);
 
+/**
+ * @brief Obtains the time at which a static obstacle point crosses a segment fixed to the robot,
+ * as the robot moves with a constant velocity. The robot then follows an arc, and in the robot
+ * frame the point turns around its instantaneous center of rotation,
+ * or moves on a line for a zero twist.
+ * @param point Obstacle point in the robot frame at time zero
+ * @param velocity Constant velocity of the robot
+ * @param start First end of the segment in the robot frame
+ * @param end Second end of the segment in the robot frame
+ * @return Earliest crossing time (within one turn of the robot), or infinity if the point never
+ * crosses the segment
+ */
+double getSegmentCrossingTime(
+  const Point & point, const Velocity & velocity, const Point & start, const Point & end);
+
+/**
+ * @brief Obtains the time at which a static obstacle point crosses a circle centered
+ * on the robot, as the robot moves with a constant velocity
+ * @param point Obstacle point in the robot frame at time zero
+ * @param velocity Constant velocity of the robot
+ * @param radius Radius of the circle
+ * @return Earliest crossing time (within one turn of the robot), or infinity if the point never
+ * crosses the circle
+ */
+double getCircleCrossingTime(const Point & point, const Velocity & velocity, double radius);
+
 }  // namespace nav2_collision_monitor
 
 #endif  // NAV2_COLLISION_MONITOR__KINEMATICS_HPP_
@@ -145,9 +145,28 @@ public:
    */
   virtual int getPointsInside(const std::vector<Point> & points) const;
 
+  /**
+   * @brief Gets number of points inside given polygon, from a batch of points
+   * @param points Input batch of points to be checked
+   * @return Number of points inside polygon. If there are no points,
+   * returns zero value.
+   */
+  virtual int getPointsInsideBatch(const PointsBatch & points) const;
+
+  /**
+   * @brief Gets the axis-aligned bounding box of the shape. Points outside of it
+   * are never inside the shape.
+   * @param min Output lower corner of the box
+   * @param max Output upper corner of the box
+   * @return False if the shape is not set, otherwise true
+   */
+  virtual bool getBoundingBox(Point & min, Point & max) const;
+
   /**
    * @brief Obtains estimated (simulated) time before a collision.
-   * Applicable for APPROACH model.
+   * Applicable for APPROACH model. With analytic_collision_time parameter set,
+   * the time is calculated for each point as the robot follows a constant velocity arc,
+   * instead of simulating the robot movement.
    * @param collision_points Array of 2D obstacle points
    * @param velocity Simulated robot velocity
    * @return Estimated time before a collision. If there is no collision,
@@ -227,6 +246,31 @@ protected:
    */
   bool isPointInside(const Point & point) const;
 
+  /**
+   * @brief Obtains the time at which a point enters polygon, as the robot
+   * moves with a constant velocity
+   * @param point Given point to check
+   * @param velocity Robot velocity
+   * @return Zero if the point is already inside polygon, entry time if it enters polygon
+   * within one turn of the robot, otherwise infinity
+   */
+  virtual double getPointEntryTime(const Point & point, const Velocity & velocity) const;
+
+  /**
+   * @brief Counts the points inside polygon among a block of points. Points outside
+   * the bounding box of polygon are dropped, then the remaining ones are checked against
+   * each edge of polygon at once.
+   * @param xs X coordinates of the points
+   * @param ys Y coordinates of the points
+   * @param size Number of points, at most POINTS_BLOCK_SIZE
+   * @param min Lower corner of the bounding box of polygon
+   * @param max Upper corner of the bounding box of polygon
+   * @return Number of points inside polygon
+   */
+  int getPointsInsideBlock(
+    const double * xs, const double * ys, std::size_t size,
+    const Point & min, const Point & max) const;
+
   /**
    * @brief Extracts Polygon points from a string with of the form [[x1,y1],[x2,y2],[x3,y3]...]
    * @param poly_string Input String containing the verteceis of the polygon
@@ -237,6 +281,12 @@ protected:
 
   // ----- Variables -----
 
+  /// @brief Number of points checked at once against polygon edges
+  static constexpr std::size_t POINTS_BLOCK_SIZE = 256;
+  /// @brief Whether points are checked with vector instructions where the compiler
+  /// supports them, otherwise with the scalar fallback
+  bool vectorized_points_check_{true};
+
   /// @brief Collision Monitor node
   nav2_util::LifecycleNode::WeakPtr node_;
   /// @brief Collision monitor node logger stored for further usage
@@ -261,6 +311,8 @@ protected:
   double time_before_collision_;
   /// @brief Time step for robot movement simulation
   double simulation_time_step_;
+  /// @brief Whether to calculate time before collision analytically instead of simulating
+  bool analytic_collision_time_;
   /// @brief Whether polygon is enabled
   bool enabled_;
   /// @brief Wether the subscription to polygon topic has transient local QoS durability
@@ -15,7 +15,9 @@
 #ifndef NAV2_COLLISION_MONITOR__TYPES_HPP_
 #define NAV2_COLLISION_MONITOR__TYPES_HPP_
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace nav2_collision_monitor
 {
@@ -53,6 +55,30 @@ struct Point
   double y;  // y-coordinate of point
 };
 
+/// @brief 2D points stored as a structure of arrays, for batched processing
+struct PointsBatch
+{
+  std::vector<double> x;  // x-coordinates of points
+  std::vector<double> y;  // y-coordinates of points
+
+  inline std::size_t size() const
+  {
+    return x.size();
+  }
+
+  inline void clear()
+  {
+    x.clear();
+    y.clear();
+  }
+
+  inline void push_back(const Point & point)
+  {
+    x.push_back(point.x);
+    y.push_back(point.y);
+  }
+};
+
 /// @brief 2D Pose
 struct Pose
 {
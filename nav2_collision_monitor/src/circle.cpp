@@ -20,6 +20,8 @@
 
 #include "nav2_util/node_utils.hpp"
 
+#include "nav2_collision_monitor/kinematics.hpp"
+
 namespace nav2_collision_monitor
 {
 
@@ -70,6 +72,28 @@ int Circle::getPointsInside(const std::vector<Point> & points) const
   return num;
 }
 
+int Circle::getPointsInsideBatch(const PointsBatch & points) const
+{
+  const double * xs = points.x.data();
+  const double * ys = points.y.data();
+  int num = 0;
+  for (std::size_t i = 0; i < points.size(); i++) {
+    num += xs[i] * xs[i] + ys[i] * ys[i] < radius_squared_;
+  }
+
+  return num;
+}
+
+bool Circle::getBoundingBox(Point & min, Point & max) const
+{
+  if (radius_squared_ == -1.0) {
+    return false;
+  }
+  min = {-radius_, -radius_};
+  max = {radius_, radius_};
+  return true;
+}
+
 bool Circle::isShapeSet()
 {
   if (radius_squared_ == -1.0) {
@@ -148,6 +172,14 @@ void Circle::createSubscription(std::string & polygon_sub_topic)
   }
 }
 
+double Circle::getPointEntryTime(const Point & point, const Velocity & velocity) const
+{
+  if (point.x * point.x + point.y * point.y < radius_squared_) {
+    return 0.0;
+  }
+  return getCircleCrossingTime(point, velocity, radius_);
+}
+
 void Circle::updatePolygon(double radius)
 {
   // Update circle radius
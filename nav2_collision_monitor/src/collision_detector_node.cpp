@@ -365,14 +365,22 @@ void CollisionDetector::process()
     collision_points_marker_pub_->publish(std::move(marker_array));
   }
 
+  // Points are checked against all polygons as a batch
+  PointsBatch points_batch;
+  points_batch.x.reserve(collision_points.size());
+  points_batch.y.reserve(collision_points.size());
+  for (const Point & point : collision_points) {
+    points_batch.push_back(point);
+  }
+
   for (std::shared_ptr<Polygon> polygon : polygons_) {
     if (!polygon->getEnabled()) {
       continue;
     }
     state_msg->polygons.push_back(polygon->getName());
     state_msg->detections.push_back(
-      polygon->getPointsInside(
-        collision_points) >= polygon->getMinPoints());
+      polygon->getPointsInsideBatch(
+        points_batch) >= polygon->getMinPoints());
   }
 
   state_pub_->publish(std::move(state_msg));
@@ -14,7 +14,9 @@
 
 #include "nav2_collision_monitor/collision_monitor_node.hpp"
 
+#include <algorithm>
 #include <exception>
+#include <limits>
 #include <utility>
 #include <functional>
 
@@ -464,6 +466,40 @@ void CollisionMonitor::process(const Velocity & cmd_vel_in, const std_msgs::msg:
     collision_points_marker_pub_->publish(std::move(marker_array));
   }
 
+  // Points inside the bounding boxes of STOP/SLOWDOWN/LIMIT polygons, as other points
+  // can not be inside any of them
+  PointsBatch zone_points;
+  if (robot_action.action_type != STOP) {
+    Point zone_min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    Point zone_max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for (std::shared_ptr<Polygon> polygon : polygons_) {
+      if (!polygon->getEnabled()) {
+        continue;
+      }
+
+      // Update polygon coordinates
+      polygon->updatePolygon(cmd_vel_in);
+
+      const ActionType at = polygon->getActionType();
+      Point min, max;
+      if ((at == STOP || at == SLOWDOWN || at == LIMIT) && polygon->getBoundingBox(min, max)) {
+        zone_min.x = std::min(zone_min.x, min.x);
+        zone_min.y = std::min(zone_min.y, min.y);
+        zone_max.x = std::max(zone_max.x, max.x);
+        zone_max.y = std::max(zone_max.y, max.y);
+      }
+    }
+    zone_points.x.reserve(collision_points.size());
+    zone_points.y.reserve(collision_points.size());
+    for (const Point & point : collision_points) {
+      if (point.x >= zone_min.x && point.x <= zone_max.x &&
+        point.y >= zone_min.y && point.y <= zone_max.y)
+      {
+        zone_points.push_back(point);
+      }
+    }
+  }
+
   for (std::shared_ptr<Polygon> polygon : polygons_) {
     if (!polygon->getEnabled()) {
       continue;
@@ -473,13 +509,10 @@ void CollisionMonitor::process(const Velocity & cmd_vel_in, const std_msgs::msg:
       break;
     }
 
-    // Update polygon coordinates
-    polygon->updatePolygon(cmd_vel_in);
-
     const ActionType at = polygon->getActionType();
     if (at == STOP || at == SLOWDOWN || at == LIMIT) {
       // Process STOP/SLOWDOWN for the selected polygon
-      if (processStopSlowdownLimit(polygon, collision_points, cmd_vel_in, robot_action)) {
+      if (processStopSlowdownLimit(polygon, zone_points, cmd_vel_in, robot_action)) {
         action_polygon = polygon;
       }
     } else if (at == APPROACH) {
@@ -506,7 +539,7 @@ void CollisionMonitor::process(const Velocity & cmd_vel_in, const std_msgs::msg:
 
 bool CollisionMonitor::processStopSlowdownLimit(
   const std::shared_ptr<Polygon> polygon,
-  const std::vector<Point> & collision_points,
+  const PointsBatch & collision_points,
   const Velocity & velocity,
   Action & robot_action) const
 {
@@ -514,7 +547,7 @@ bool CollisionMonitor::processStopSlowdownLimit(
     return false;
   }
 
-  if (polygon->getPointsInside(collision_points) >= polygon->getMinPoints()) {
+  if (polygon->getPointsInsideBatch(collision_points) >= polygon->getMinPoints()) {
     if (polygon->getActionType() == STOP) {
       // Setting up zero velocity for STOP model
       robot_action.polygon_name = polygon->getName();
@@ -14,11 +14,46 @@
 
 #include "nav2_collision_monitor/kinematics.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace nav2_collision_monitor
 {
 
+namespace
+{
+
+// Robots turning slower than this (rad/s) are considered as moving straight: the center
+// of rotation is then too far away for the crossing points to be computed accurately,
+// while the arcs hardly differ from straight lines
+constexpr double MIN_TURNING_TWIST = 1e-6;
+
+/**
+ * @brief Obtains the time for a point turning around center with -twist angular velocity,
+ * as the robot turns with twist, to go from its initial position to target
+ */
+double getTurningTime(
+  const Point & point, const Point & target, const Point & center, double twist)
+{
+  const double from_x = point.x - center.x;
+  const double from_y = point.y - center.y;
+  const double to_x = target.x - center.x;
+  const double to_y = target.y - center.y;
+  // Counter-clockwise angle from the initial position to target, in [-pi, pi]
+  double angle = std::atan2(from_x * to_y - from_y * to_x, from_x * to_x + from_y * to_y);
+  if (twist > 0.0) {
+    // The point turns clockwise
+    angle = -angle;
+  }
+  if (angle < 0.0) {
+    angle += 2 * M_PI;
+  }
+  return angle / std::abs(twist);
+}
+
+}  // namespace
+
 void transformPoints(const Pose & pose, std::vector<Point> & points)
 {
   const double cos_theta = std::cos(pose.theta);
@@ -67,4 +102,103 @@ void projectState(const double & dt, Pose & pose, Velocity & velocity)
   velocity.y = velocity_upd_y;
 }
 
+double getSegmentCrossingTime(
+  const Point & point, const Velocity & velocity, const Point & start, const Point & end)
+{
+  const double edge_x = end.x - start.x;
+  const double edge_y = end.y - start.y;
+
+  if (std::abs(velocity.tw) < MIN_TURNING_TWIST) {
+    // The point moves on a line with -velocity: point - velocity * t = start + edge * s
+    // is solved for t >= 0 and s in [0, 1]
+    const double det = edge_x * velocity.y - edge_y * velocity.x;
+    if (det == 0.0) {
+      // Moving parallel to the segment, or not moving at all
+      return std::numeric_limits<double>::infinity();
+    }
+    const double diff_x = start.x - point.x;
+    const double diff_y = start.y - point.y;
+    const double t = (edge_y * diff_x - edge_x * diff_y) / det;
+    const double s = (velocity.x * diff_y - velocity.y * diff_x) / det;
+    if (t < 0.0 || s < 0.0 || s > 1.0) {
+      return std::numeric_limits<double>::infinity();
+    }
+    return t;
+  }
+
+  // The point turns around the instantaneous center of rotation of the robot:
+  // |start + edge * s - center| = radius is solved for s in [0, 1]
+  const Point center{-velocity.y / velocity.tw, velocity.x / velocity.tw};
+  const double radius_sq =
+    (point.x - center.x) * (point.x - center.x) + (point.y - center.y) * (point.y - center.y);
+  const double diff_x = start.x - center.x;
+  const double diff_y = start.y - center.y;
+  const double a = edge_x * edge_x + edge_y * edge_y;
+  const double b = edge_x * diff_x + edge_y * diff_y;
+  const double c = diff_x * diff_x + diff_y * diff_y - radius_sq;
+  const double discriminant = b * b - a * c;
+  if (a == 0.0 || discriminant < 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  double time = std::numeric_limits<double>::infinity();
+  const double sqrt_discriminant = std::sqrt(discriminant);
+  for (const double s : {(-b - sqrt_discriminant) / a, (-b + sqrt_discriminant) / a}) {
+    if (s >= 0.0 && s <= 1.0) {
+      const Point target{start.x + edge_x * s, start.y + edge_y * s};
+      time = std::min(time, getTurningTime(point, target, center, velocity.tw));
+    }
+  }
+  return time;
+}
+
+double getCircleCrossingTime(const Point & point, const Velocity & velocity, double radius)
+{
+  if (std::abs(velocity.tw) < MIN_TURNING_TWIST) {
+    // The point moves on a line with -velocity: |point - velocity * t| = radius
+    // is solved for t >= 0
+    const double a = velocity.x * velocity.x + velocity.y * velocity.y;
+    const double b = -(point.x * velocity.x + point.y * velocity.y);
+    const double c = point.x * point.x + point.y * point.y - radius * radius;
+    const double discriminant = b * b - a * c;
+    if (a == 0.0 || discriminant < 0.0) {
+      return std::numeric_limits<double>::infinity();
+    }
+    const double sqrt_discriminant = std::sqrt(discriminant);
+    for (const double t : {(-b - sqrt_discriminant) / a, (-b + sqrt_discriminant) / a}) {
+      if (t >= 0.0) {
+        return t;
+      }
+    }
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // The point turns around the instantaneous center of rotation of the robot, on a circle
+  // intersecting the one centered on the robot
+  const Point center{-velocity.y / velocity.tw, velocity.x / velocity.tw};
+  const double center_dist = std::hypot(center.x, center.y);
+  const double turn_radius = std::hypot(point.x - center.x, point.y - center.y);
+  if (center_dist == 0.0 || center_dist > radius + turn_radius ||
+    center_dist < std::abs(radius - turn_radius))
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  // Intersections lie at along distance from the robot on the line to the center,
+  // and at across distance on both sides of it
+  const double along =
+    (radius * radius - turn_radius * turn_radius + center_dist * center_dist) /
+    (2 * center_dist);
+  const double across = std::sqrt(std::max(radius * radius - along * along, 0.0));
+  const double dir_x = center.x / center_dist;
+  const double dir_y = center.y / center_dist;
+
+  double time = std::numeric_limits<double>::infinity();
+  for (const double side : {-1.0, 1.0}) {
+    const Point target{
+      along * dir_x - side * across * dir_y, along * dir_y + side * across * dir_x};
+    time = std::min(time, getTurningTime(point, target, center, velocity.tw));
+  }
+  return time;
+}
+
 }  // namespace nav2_collision_monitor
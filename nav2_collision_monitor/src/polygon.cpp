@@ -14,7 +14,11 @@
 
 #include "nav2_collision_monitor/polygon.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <limits>
 #include <utility>
 
 #include "geometry_msgs/msg/point.hpp"
@@ -30,6 +34,21 @@
 namespace nav2_collision_monitor
 {
 
+namespace
+{
+
+#if defined(__GNUC__)
+// Coordinates of points processed at once with GCC / Clang vector extensions, which are
+// lowered to SSE2 or NEON instructions. Comparisons give masks of all ones or zeros per point.
+using PointCoordinates = double __attribute__((vector_size(16)));
+using PointMasks = std::int64_t __attribute__((vector_size(16)));
+constexpr std::size_t POINTS_PER_VECTOR = sizeof(PointCoordinates) / sizeof(double);
+#else
+constexpr std::size_t POINTS_PER_VECTOR = 1;
+#endif
+
+}  // namespace
+
 Polygon::Polygon(
   const nav2_util::LifecycleNode::WeakPtr & node,
   const std::string & polygon_name,
@@ -37,7 +56,7 @@ Polygon::Polygon(
   const std::string & base_frame_id,
   const tf2::Duration & transform_tolerance)
 : node_(node), polygon_name_(polygon_name), action_type_(DO_NOTHING),
-  slowdown_ratio_(0.0), linear_limit_(0.0), angular_limit_(0.0),
+  slowdown_ratio_(0.0), linear_limit_(0.0), angular_limit_(0.0), analytic_collision_time_(false),
   footprint_sub_(nullptr), tf_buffer_(tf_buffer),
   base_frame_id_(base_frame_id), transform_tolerance_(transform_tolerance)
 {
@@ -220,19 +239,84 @@ void Polygon::updatePolygon(const Velocity & /*cmd_vel_in*/)
 
 int Polygon::getPointsInside(const std::vector<Point> & points) const
 {
+  Point min, max;
+  if (!getBoundingBox(min, max)) {
+    return 0;
+  }
+
+  // Points are checked by blocks, laid out as a structure of arrays
+  double xs[POINTS_BLOCK_SIZE];
+  double ys[POINTS_BLOCK_SIZE];
   int num = 0;
-  for (const Point & point : points) {
-    if (isPointInside(point)) {
-      num++;
+  for (std::size_t start = 0; start < points.size(); start += POINTS_BLOCK_SIZE) {
+    const std::size_t size = std::min(POINTS_BLOCK_SIZE, points.size() - start);
+    for (std::size_t k = 0; k < size; k++) {
+      xs[k] = points[start + k].x;
+      ys[k] = points[start + k].y;
     }
+    num += getPointsInsideBlock(xs, ys, size, min, max);
+  }
+  return num;
+}
+
+int Polygon::getPointsInsideBatch(const PointsBatch & points) const
+{
+  Point min, max;
+  if (!getBoundingBox(min, max)) {
+    return 0;
+  }
+
+  int num = 0;
+  for (std::size_t start = 0; start < points.size(); start += POINTS_BLOCK_SIZE) {
+    const std::size_t size = std::min(POINTS_BLOCK_SIZE, points.size() - start);
+    num += getPointsInsideBlock(
+      points.x.data() + start, points.y.data() + start, size, min, max);
   }
   return num;
 }
 
+bool Polygon::getBoundingBox(Point & min, Point & max) const
+{
+  if (poly_.empty()) {
+    return false;
+  }
+  min = max = poly_[0];
+  for (const Point & vertex : poly_) {
+    min.x = std::min(min.x, vertex.x);
+    min.y = std::min(min.y, vertex.y);
+    max.x = std::max(max.x, vertex.x);
+    max.y = std::max(max.y, vertex.y);
+  }
+  return true;
+}
+
 double Polygon::getCollisionTime(
   const std::vector<Point> & collision_points,
   const Velocity & velocity) const
 {
+  if (analytic_collision_time_) {
+    if (min_points_ <= 0) {
+      return 0.0;
+    }
+    // Collision occurs when min_points_ points have entered polygon.
+    // Points leaving polygon before that are still counted, which is conservative.
+    std::vector<double> entry_times;
+    entry_times.reserve(collision_points.size());
+    for (const Point & point : collision_points) {
+      const double entry_time = getPointEntryTime(point, velocity);
+      if (entry_time <= time_before_collision_) {
+        entry_times.push_back(entry_time);
+      }
+    }
+    if (entry_times.size() < static_cast<std::size_t>(min_points_)) {
+      // There is no collision
+      return -1.0;
+    }
+    std::nth_element(
+      entry_times.begin(), entry_times.begin() + (min_points_ - 1), entry_times.end());
+    return entry_times[min_points_ - 1];
+  }
+
   // Initial robot pose is {0,0} in base_footprint coordinates
   Pose pose = {0.0, 0.0, 0.0};
   Velocity vel = velocity;
@@ -359,6 +443,10 @@ bool Polygon::getCommonParameters(
         node, polygon_name_ + ".simulation_time_step", rclcpp::ParameterValue(0.1));
       simulation_time_step_ =
         node->get_parameter(polygon_name_ + ".simulation_time_step").as_double();
+      nav2_util::declare_parameter_if_not_declared(
+        node, polygon_name_ + ".analytic_collision_time", rclcpp::ParameterValue(false));
+      analytic_collision_time_ =
+        node->get_parameter(polygon_name_ + ".analytic_collision_time").as_bool();
     }
 
     nav2_util::declare_parameter_if_not_declared(
@@ -538,7 +626,7 @@ void Polygon::polygonCallback(geometry_msgs::msg::PolygonStamped::ConstSharedPtr
   updatePolygon(msg);
 }
 
-inline bool Polygon::isPointInside(const Point & point) const
+bool Polygon::isPointInside(const Point & point) const
 {
   // Adaptation of Shimrat, Moshe. "Algorithm 112: position of point relative to polygon."
   // Communications of the ACM 5.8 (1962): 434.
@@ -570,6 +658,81 @@ inline bool Polygon::isPointInside(const Point & point) const
   return res;
 }
 
+double Polygon::getPointEntryTime(const Point & point, const Velocity & velocity) const
+{
+  if (isPointInside(point)) {
+    return 0.0;
+  }
+
+  // Outside point enters polygon when it first crosses one of its edges
+  double entry_time = std::numeric_limits<double>::infinity();
+  const std::size_t poly_size = poly_.size();
+  for (std::size_t i = poly_size - 1, j = 0; j < poly_size; i = j++) {
+    entry_time = std::min(
+      entry_time, getSegmentCrossingTime(point, velocity, poly_[i], poly_[j]));
+  }
+  return entry_time;
+}
+
+int Polygon::getPointsInsideBlock(
+  const double * xs, const double * ys, std::size_t size,
+  const Point & min, const Point & max) const
+{
+  // Keep only the points inside the bounding box, without branching
+  double in_xs[POINTS_BLOCK_SIZE];
+  double in_ys[POINTS_BLOCK_SIZE];
+  std::size_t in_size = 0;
+  for (std::size_t k = 0; k < size; k++) {
+    in_xs[in_size] = xs[k];
+    in_ys[in_size] = ys[k];
+    in_size += (xs[k] >= min.x) & (xs[k] <= max.x) & (ys[k] >= min.y) & (ys[k] <= max.y);
+  }
+  // Pad the points to a whole number of vectors. Padding points are never counted.
+  const std::size_t padded_size =
+    (in_size + POINTS_PER_VECTOR - 1) / POINTS_PER_VECTOR * POINTS_PER_VECTOR;
+  std::fill(in_xs + in_size, in_xs + padded_size, 0.0);
+  std::fill(in_ys + in_size, in_ys + padded_size, 0.0);
+
+  // Same ray crossings algorithm as isPointInside(), with the loops swapped: every edge
+  // is checked against all the points. Intersections are computed for all the points but
+  // only counted for the edges they are crossing. Inside points have a mask of all ones.
+  std::int64_t inside[POINTS_BLOCK_SIZE] = {};
+  const std::size_t poly_size = poly_.size();
+  for (std::size_t i = poly_size - 1, j = 0; j < poly_size; i = j++) {
+    const double x_i = poly_[i].x;
+    const double y_i = poly_[i].y;
+    const double x_j = poly_[j].x;
+    const double y_j = poly_[j].y;
+#if defined(__GNUC__)
+    if (vectorized_points_check_) {
+      for (std::size_t k = 0; k < padded_size; k += POINTS_PER_VECTOR) {
+        PointCoordinates x, y;
+        PointMasks parity;
+        std::memcpy(&x, in_xs + k, sizeof(x));
+        std::memcpy(&y, in_ys + k, sizeof(y));
+        std::memcpy(&parity, inside + k, sizeof(parity));
+        const PointMasks crossing = (y <= y_i) == (y > y_j);
+        const PointCoordinates x_inter = x_i + (y - y_i) * (x_j - x_i) / (y_j - y_i);
+        parity ^= crossing & (x_inter > x);
+        std::memcpy(inside + k, &parity, sizeof(parity));
+      }
+      continue;
+    }
+#endif
+    for (std::size_t k = 0; k < in_size; k++) {
+      const bool crossing = (in_ys[k] <= y_i) == (in_ys[k] > y_j);
+      const double x_inter = x_i + (in_ys[k] - y_i) * (x_j - x_i) / (y_j - y_i);
+      inside[k] ^= -static_cast<std::int64_t>(crossing && x_inter > in_xs[k]);
+    }
+  }
+
+  int num = 0;
+  for (std::size_t k = 0; k < in_size; k++) {
+    num -= static_cast<int>(inside[k]);
+  }
+  return num;
+}
+
 bool Polygon::getPolygonFromString(
   std::string & poly_string,
   std::vector<Point> & polygon)
@@ -96,3 +96,78 @@ TEST(KinematicsTest, testProjectState)
   EXPECT_NEAR(vel.y, std::sin(rotated_vel_angle), EPSILON);
   EXPECT_NEAR(vel.tw, M_PI / 4.0, EPSILON);  // should be the same
 }
+
+TEST(KinematicsTest, testGetSegmentCrossingTime)
+{
+  // Segment of 1.0 m length, 0.5 m ahead of the robot
+  const nav2_collision_monitor::Point start{0.5, -0.5};
+  const nav2_collision_monitor::Point end{0.5, 0.5};
+
+  // Straight movement: point 0.2 m ahead of the segment is reached in 0.2 m / 0.5 m/s
+  nav2_collision_monitor::Velocity vel{0.5, 0.0, 0.0};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.1}, vel, start, end), 0.4, EPSILON);
+  // Turning too slowly to matter is handled as a straight movement
+  vel = {0.5, 0.0, 1e-16};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.1}, vel, start, end), 0.4, EPSILON);
+  // Point moving away from the segment never crosses it
+  vel = {-0.5, 0.0, 0.0};
+  EXPECT_TRUE(
+    std::isinf(nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.1}, vel, start, end)));
+  // Point moving parallel to the segment never crosses it
+  vel = {0.0, 0.5, 0.0};
+  EXPECT_TRUE(
+    std::isinf(nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.1}, vel, start, end)));
+
+  // Rotation: point 0.7 m ahead of the robot turns clockwise around it, and reaches
+  // the segment when turned on acos(0.5 / 0.7) rad
+  vel = {0.0, 0.0, 1.0};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.0}, vel, start, end),
+    std::acos(0.5 / 0.7), EPSILON);
+  // Turning counter-clockwise, the point reaches the segment on the same angle
+  vel = {0.0, 0.0, -2.0};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getSegmentCrossingTime({0.7, 0.0}, vel, start, end),
+    std::acos(0.5 / 0.7) / 2.0, EPSILON);
+  // Point turning further than the ends of the segment never crosses it
+  vel = {0.0, 0.0, 1.0};
+  EXPECT_TRUE(
+    std::isinf(nav2_collision_monitor::getSegmentCrossingTime({1.0, 0.0}, vel, start, end)));
+}
+
+TEST(KinematicsTest, testGetCircleCrossingTime)
+{
+  const double radius = 0.5;
+
+  // Straight movement: point 0.2 m ahead of the circle is reached in 0.2 m / 0.5 m/s
+  nav2_collision_monitor::Velocity vel{0.5, 0.0, 0.0};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getCircleCrossingTime({0.7, 0.0}, vel, radius), 0.4, EPSILON);
+  // Point passing by the circle never crosses it
+  EXPECT_TRUE(
+    std::isinf(nav2_collision_monitor::getCircleCrossingTime({0.7, 0.6}, vel, radius)));
+  // Turning too slowly to matter is handled as a straight movement: point reaches the
+  // circle when 0.7 - 0.5 * t = sqrt(0.5^2 - 0.1^2)
+  for (double tw : {1e-16, -1e-16, 1e-9}) {
+    vel = {0.5, 0.0, tw};
+    EXPECT_NEAR(
+      nav2_collision_monitor::getCircleCrossingTime({0.7, 0.1}, vel, radius),
+      (0.7 - std::sqrt(0.24)) / 0.5, EPSILON) << "twist: " << tw;
+  }
+
+  // Pure rotation keeps the distance to the robot, so the point never crosses the circle
+  vel = {0.0, 0.0, 1.0};
+  EXPECT_TRUE(
+    std::isinf(nav2_collision_monitor::getCircleCrossingTime({0.7, 0.0}, vel, radius)));
+
+  // Movement on a circle of 1.0 m radius turning left: point on this circle ahead of
+  // the robot by 1.0 rad is reached by the circle when the robot has turned on
+  // 1.0 - 2 * asin(0.25) rad, as the chord from the robot to the point is then 0.5 m
+  vel = {1.0, 0.0, 1.0};
+  EXPECT_NEAR(
+    nav2_collision_monitor::getCircleCrossingTime(
+      {std::sin(1.0), 1.0 - std::cos(1.0)}, vel, radius),
+    1.0 - 2.0 * std::asin(0.25), EPSILON);
+}
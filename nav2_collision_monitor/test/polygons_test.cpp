@@ -16,6 +16,8 @@
 
 #include <math.h>
 #include <chrono>
+#include <cmath>
+#include <random>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -200,6 +202,26 @@ public:
   {
     return visualize_;
   }
+
+  void setPolygonPoints(const std::vector<nav2_collision_monitor::Point> & poly)
+  {
+    poly_ = poly;
+  }
+
+  void setVectorizedPointsCheck(bool vectorized)
+  {
+    vectorized_points_check_ = vectorized;
+  }
+
+  // Reference number of points inside polygon, checked one by one
+  int getPointsInsideReference(const std::vector<nav2_collision_monitor::Point> & points) const
+  {
+    int num = 0;
+    for (const auto & point : points) {
+      num += isPointInside(point);
+    }
+    return num;
+  }
 };  // PolygonWrapper
 
 class CircleWrapper : public nav2_collision_monitor::Circle
@@ -849,6 +871,95 @@ TEST_F(Tester, testCircleGetPointsInside)
   ASSERT_EQ(circle_->getPointsInside(points), 1);
 }
 
+TEST_F(Tester, testGetPointsInsideBatch)
+{
+  // Non-convex polygon made of [-1.0, 1.0] x [-1.0, 1.0] and [1.0, 2.0] x [-1.0, 0.0] squares
+  setCommonParameters(POLYGON_NAME, "stop");
+  setPolygonParameters(ARBITRARY_POLYGON_STR, true);
+  polygon_ = std::make_shared<PolygonWrapper>(
+    test_node_, POLYGON_NAME,
+    tf_buffer_, BASE_FRAME_ID, TRANSFORM_TOLERANCE);
+  ASSERT_TRUE(polygon_->configure());
+  createCircle("stop", true);
+
+  nav2_collision_monitor::Point min, max;
+  ASSERT_TRUE(polygon_->getBoundingBox(min, max));
+  EXPECT_NEAR(min.x, -1.0, EPSILON);
+  EXPECT_NEAR(min.y, -1.0, EPSILON);
+  EXPECT_NEAR(max.x, 2.0, EPSILON);
+  EXPECT_NEAR(max.y, 1.0, EPSILON);
+  ASSERT_TRUE(circle_->getBoundingBox(min, max));
+  EXPECT_NEAR(min.x, -CIRCLE_RADIUS, EPSILON);
+  EXPECT_NEAR(max.y, CIRCLE_RADIUS, EPSILON);
+
+  // Random points, spanning several blocks of points and mostly outside of the shapes
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(-3.0, 3.0);
+  std::vector<nav2_collision_monitor::Point> points;
+  nav2_collision_monitor::PointsBatch points_batch;
+  int polygon_inside = 0;
+  int circle_inside = 0;
+  for (int i = 0; i < 1001; i++) {
+    const nav2_collision_monitor::Point point{coordinate(generator), coordinate(generator)};
+    points.push_back(point);
+    points_batch.push_back(point);
+    if ((std::abs(point.x) < 1.0 && std::abs(point.y) < 1.0) ||
+      (point.x > 1.0 && point.x < 2.0 && point.y > -1.0 && point.y < 0.0))
+    {
+      polygon_inside++;
+    }
+    if (std::hypot(point.x, point.y) < CIRCLE_RADIUS) {
+      circle_inside++;
+    }
+  }
+  ASSERT_GT(polygon_inside, 0);
+  ASSERT_GT(circle_inside, 0);
+  EXPECT_EQ(polygon_->getPointsInsideReference(points), polygon_inside);
+  EXPECT_EQ(circle_->getPointsInside(points), circle_inside);
+  EXPECT_EQ(circle_->getPointsInsideBatch(points_batch), circle_inside);
+
+  // Points on the lines of polygon edges and on its vertices, then points around a star
+  // shaped polygon with many edges
+  std::vector<nav2_collision_monitor::Point> grid_points;
+  for (double x = -2.0; x <= 3.0; x += 0.5) {
+    for (double y = -2.0; y <= 2.0; y += 0.5) {
+      grid_points.push_back({x, y});
+    }
+  }
+  std::vector<nav2_collision_monitor::Point> star;
+  for (int i = 0; i < 26; i++) {
+    const double angle = M_PI * i / 13;
+    const double radius = i % 2 == 0 ? 2.5 : 0.7;
+    star.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+  }
+
+  // The vectorized and scalar checks both count the same points as isPointInside()
+  for (bool vectorized : {true, false}) {
+    polygon_->setVectorizedPointsCheck(vectorized);
+    EXPECT_EQ(polygon_->getPointsInsideBatch(points_batch), polygon_inside);
+    EXPECT_EQ(polygon_->getPointsInside(points), polygon_inside);
+
+    nav2_collision_monitor::PointsBatch grid_batch;
+    for (const auto & point : grid_points) {
+      grid_batch.push_back(point);
+    }
+    EXPECT_EQ(
+      polygon_->getPointsInsideBatch(grid_batch),
+      polygon_->getPointsInsideReference(grid_points)) << "vectorized: " << vectorized;
+    EXPECT_EQ(polygon_->getPointsInsideBatch(nav2_collision_monitor::PointsBatch()), 0);
+  }
+
+  polygon_->setPolygonPoints(star);
+  const int star_inside = polygon_->getPointsInsideReference(points);
+  ASSERT_GT(star_inside, 0);
+  ASSERT_LT(star_inside, static_cast<int>(points.size()));
+  for (bool vectorized : {true, false}) {
+    polygon_->setVectorizedPointsCheck(vectorized);
+    EXPECT_EQ(polygon_->getPointsInsideBatch(points_batch), star_inside) <<
+      "vectorized: " << vectorized;
+  }
+}
+
 TEST_F(Tester, testPolygonGetCollisionTime)
 {
   createPolygon("approach", false);
@@ -917,6 +1028,89 @@ TEST_F(Tester, testPolygonGetCollisionTime)
   EXPECT_LT(polygon_->getCollisionTime(points, vel), 0.0);
 }
 
+TEST_F(Tester, testPolygonGetCollisionTimeAnalytic)
+{
+  test_node_->declare_parameter(
+    std::string(POLYGON_NAME) + ".analytic_collision_time", rclcpp::ParameterValue(true));
+  test_node_->declare_parameter(
+    std::string(CIRCLE_NAME) + ".analytic_collision_time", rclcpp::ParameterValue(true));
+  createPolygon("approach", false);
+  createCircle("approach", true);
+
+  // Set footprint for Polygon
+  test_node_->publishFootprint();
+  std::vector<nav2_collision_monitor::Point> footprint;
+  ASSERT_TRUE(waitFootprint(500ms, footprint));
+  ASSERT_EQ(footprint.size(), 4u);
+
+  // Forward movement check
+  nav2_collision_monitor::Velocity vel{0.5, 0.0, 0.0};  // 0.5 m/s forward movement
+  // Two points 0.2 m ahead the footprint (0.5 m)
+  std::vector<nav2_collision_monitor::Point> points{{0.7, -0.01}, {0.7, 0.01}};
+  // Collision is expected to be 0.2 m / 0.5 m/s seconds, with no simulation error
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), 0.4, EPSILON);
+  // Points enter the circle where its border is at sqrt(0.5^2 - 0.01^2) m
+  double exp_res = (0.7 - std::sqrt(0.5 * 0.5 - 0.01 * 0.01)) / 0.5;
+  EXPECT_NEAR(circle_->getCollisionTime(points, vel), exp_res, EPSILON);
+
+  // Backward movement check
+  vel = {-0.5, 0.0, 0.0};  // 0.5 m/s backward movement
+  // Two points 0.2 m behind the footprint (0.5 m)
+  points = {{-0.7, -0.01}, {-0.7, 0.01}};
+  // Collision is expected to be in 0.2 m / 0.5 m/s seconds
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), 0.4, EPSILON);
+
+  // Sideway movement check
+  vel = {0.0, 0.5, 0.0};  // 0.5 m/s sideway movement
+  // Two points 0.1 m ahead the footprint (0.5 m)
+  points = {{-0.01, 0.6}, {0.01, 0.6}};
+  // Collision is expected to be in 0.1 m / 0.5 m/s seconds
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), 0.2, EPSILON);
+
+  // Rotation check
+  vel = {0.0, 0.0, 1.0};  // 1.0 rad/s rotation
+  // Two points 0.1 m ahead the footprint are turning clockwise around the robot,
+  // until they reach the front edge of the footprint
+  points = {{0.6, -0.01}, {0.6, 0.01}};
+  // Collision occurs when the last point enters the footprint
+  const double dist = std::hypot(0.6, 0.01);
+  exp_res = std::atan2(0.01, 0.6) + std::acos(0.5 / dist);
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), exp_res, EPSILON);
+  // Points are turning on a circle around the robot, never reaching the circle
+  EXPECT_LT(circle_->getCollisionTime(points, vel), 0.0);
+
+  // Movement along an arc check
+  vel = {0.5, 0.0, 0.5};  // Turning left on a circle of 1.0 m radius
+  // Points reached by the middle of the front edge of the footprint (0.5 m)
+  // in 0.4 and 0.5 seconds, when the robot is turned on 0.2 and 0.25 rad
+  points.clear();
+  for (const double theta : {0.2, 0.25}) {
+    points.push_back(
+      {std::sin(theta) + 0.5 * std::cos(theta), 1.0 - std::cos(theta) + 0.5 * std::sin(theta)});
+  }
+  // Collision occurs when the last point enters the footprint
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), 0.5, EPSILON);
+
+  // Two points are already inside footprint
+  vel = {0.5, 0.0, 0.0};  // 0.5 m/s forward movement
+  // Two points inside
+  points = {{0.1, -0.01}, {0.1, 0.01}};
+  // Collision already appeared: collision time should be 0
+  EXPECT_NEAR(polygon_->getCollisionTime(points, vel), 0.0, EPSILON);
+  EXPECT_NEAR(circle_->getCollisionTime(points, vel), 0.0, EPSILON);
+
+  // Only one point enters the footprint, which is less than min_points
+  points = {{0.7, 0.0}, {0.0, 1.0}};
+  EXPECT_LT(polygon_->getCollisionTime(points, vel), 0.0);
+
+  // All points are out of prediction time
+  // Two points 0.6 m ahead the footprint (0.5 m)
+  points = {{1.1, -0.01}, {1.1, 0.01}};
+  // There is no collision: return value should be negative
+  EXPECT_LT(polygon_->getCollisionTime(points, vel), 0.0);
+  EXPECT_LT(circle_->getCollisionTime(points, vel), 0.0);
+}
+
 TEST_F(Tester, testPolygonPublish)
 {
   createPolygon("stop", true);
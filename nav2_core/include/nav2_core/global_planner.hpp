@@ -78,6 +78,38 @@ public:
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal,
     std::function<bool()> cancel_checker) = 0;
+
+  /**
+   * @brief Whether separate instances of the planner may plan at the same time, each one
+   * with createPlanOnCostmap() on its own costmap. Instances must not share any mutable state.
+   * A leg through poses planned ahead from its viapoint is used as long as the previous leg
+   * ends close enough to it, so the plan must not depend on the start orientation.
+   * @return True if concurrent planning is supported, false by default
+   */
+  virtual bool supportsConcurrentPlanning()
+  {
+    return false;
+  }
+
+  /**
+   * @brief Method create the plan from a starting and ending goal on a given costmap,
+   * instead of the costmap the planner was configured with. Only called on planners
+   * supporting concurrent planning.
+   * @param start The starting pose of the robot
+   * @param goal  The goal pose of the robot
+   * @param cancel_checker Function to check if the action has been canceled
+   * @param costmap Costmap to plan on, of the same frame as the configured costmap.
+   * It is owned by the caller and used by this planner only for the duration of the call.
+   * @return      The sequence of poses to get from start to goal, if any
+   */
+  virtual nav_msgs::msg::Path createPlanOnCostmap(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker,
+    nav2_costmap_2d::Costmap2D & /*costmap*/)
+  {
+    return createPlan(start, goal, cancel_checker);
+  }
 };
 
 }  // namespace nav2_core
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+// Merges of a layer into the master grid of a global costmap, reported in bytes
+// of layer merged per second. Arguments are the costmap size in cells per side and
+// the number of layer update threads.
+
+class MergeLayer : public nav2_costmap_2d::CostmapLayer
+{
+public:
+  explicit MergeLayer(nav2_costmap_2d::LayeredCostmap * layers)
+  {
+    layered_costmap_ = layers;
+    enabled_ = true;
+    matchSize();
+  }
+
+  void reset() override {}
+  bool isClearable() override {return false;}
+  void updateBounds(double, double, double, double *, double *, double *, double *) override {}
+  void updateCosts(nav2_costmap_2d::Costmap2D &, int, int, int, int) override {}
+
+  using nav2_costmap_2d::CostmapLayer::updateWithTrueOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithMax;
+  using nav2_costmap_2d::CostmapLayer::updateWithMaxWithoutUnknownOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithAddition;
+};
+
+// Fills a grid with random costs, a quarter of them unknown
+static void fillCosts(nav2_costmap_2d::Costmap2D & costmap, unsigned int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> cost(0, nav2_costmap_2d::LETHAL_OBSTACLE);
+  std::uniform_int_distribution<int> unknown(0, 3);
+  unsigned char * data = costmap.getCharMap();
+  const unsigned int size = costmap.getSizeInCellsX() * costmap.getSizeInCellsY();
+  for (unsigned int i = 0; i != size; i++) {
+    data[i] = unknown(gen) == 0 ? nav2_costmap_2d::NO_INFORMATION : cost(gen);
+  }
+}
+
+template<typename MergeFunction>
+static void BM_LayerMerge(benchmark::State & state, MergeFunction merge)
+{
+  const unsigned int size = static_cast<unsigned int>(state.range(0));
+  nav2_costmap_2d::LayeredCostmap layers("map", false, true);
+  layers.resizeMap(size, size, 0.05, 0.0, 0.0);
+  layers.setLayerUpdateThreads(static_cast<unsigned int>(state.range(1)));
+
+  MergeLayer layer(&layers);
+  fillCosts(layer, 1u);
+  nav2_costmap_2d::Costmap2D & master = *layers.getCostmap();
+  fillCosts(master, 2u);
+
+  const int cells = static_cast<int>(size);
+  for (auto _ : state) {
+    merge(layer, master, cells);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size * size);
+}
+
+static void mergeTrueOverwrite(MergeLayer & layer, nav2_costmap_2d::Costmap2D & master, int n)
+{
+  layer.updateWithTrueOverwrite(master, 0, 0, n, n);
+}
+
+static void mergeOverwrite(MergeLayer & layer, nav2_costmap_2d::Costmap2D & master, int n)
+{
+  layer.updateWithOverwrite(master, 0, 0, n, n);
+}
+
+static void mergeMax(MergeLayer & layer, nav2_costmap_2d::Costmap2D & master, int n)
+{
+  layer.updateWithMax(master, 0, 0, n, n);
+}
+
+static void mergeMaxWithoutUnknownOverwrite(
+  MergeLayer & layer, nav2_costmap_2d::Costmap2D & master, int n)
+{
+  layer.updateWithMaxWithoutUnknownOverwrite(master, 0, 0, n, n);
+}
+
+static void mergeAddition(MergeLayer & layer, nav2_costmap_2d::Costmap2D & master, int n)
+{
+  layer.updateWithAddition(master, 0, 0, n, n);
+}
+
+static void layerMergeArgs(benchmark::internal::Benchmark * b)
+{
+  b->ArgsProduct({{1000, 4000, 8000}, {1, 2, 4}})->ArgNames({"size", "threads"});
+  b->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+BENCHMARK_CAPTURE(BM_LayerMerge, true_overwrite, mergeTrueOverwrite)->Apply(layerMergeArgs);
+BENCHMARK_CAPTURE(BM_LayerMerge, overwrite, mergeOverwrite)->Apply(layerMergeArgs);
+BENCHMARK_CAPTURE(BM_LayerMerge, max, mergeMax)->Apply(layerMergeArgs);
+BENCHMARK_CAPTURE(
+  BM_LayerMerge, max_without_unknown_overwrite,
+  mergeMaxWithoutUnknownOverwrite)->Apply(layerMergeArgs);
+BENCHMARK_CAPTURE(BM_LayerMerge, addition, mergeAddition)->Apply(layerMergeArgs);
+
+BENCHMARK_MAIN();
@@ -42,13 +42,16 @@
 #include <algorithm>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/shared_costmap.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "map_msgs/msg/occupancy_grid_update.hpp"
 #include "nav2_msgs/msg/costmap.hpp"
 #include "nav2_msgs/msg/costmap_update.hpp"
+#include "nav2_msgs/msg/costmap_delta_update.hpp"
 #include "nav2_msgs/srv/get_costmap.hpp"
 #include "tf2/transform_datatypes.h"
 #include "nav2_util/lifecycle_node.hpp"
@@ -93,6 +96,7 @@ public:
     costmap_update_pub_->on_activate();
     costmap_raw_pub_->on_activate();
     costmap_raw_update_pub_->on_activate();
+    costmap_raw_delta_update_pub_->on_activate();
   }
 
   /**
@@ -104,6 +108,11 @@ public:
     costmap_update_pub_->on_deactivate();
     costmap_raw_pub_->on_deactivate();
     costmap_raw_update_pub_->on_deactivate();
+    costmap_raw_delta_update_pub_->on_deactivate();
+    // Consumers in this process stop reading the costmap until it is shared again
+    // after activation
+    shared_costmap_->clear();
+    shared_consumer_count_ = 0;
   }
 
   /**
@@ -111,14 +120,8 @@ public:
    */
   void on_cleanup() {}
 
-  /** @brief Include the given bounds in the changed-rectangle. */
-  void updateBounds(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
-  {
-    x0_ = std::min(x0, x0_);
-    xn_ = std::max(xn, xn_);
-    y0_ = std::min(y0, y0_);
-    yn_ = std::max(yn, yn_);
-  }
+  /** @brief Include the given bounds in the changed-rectangle and the dirty rectangles. */
+  void updateBounds(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
 
   /**
    * @brief  Publishes the visualization data over ROS
@@ -143,6 +146,17 @@ private:
   std::unique_ptr<map_msgs::msg::OccupancyGridUpdate> createGridUpdateMsg();
   /** @brief Prepare CostmapUpdate msg for publication. */
   std::unique_ptr<nav2_msgs::msg::CostmapUpdate> createCostmapUpdateMsg();
+  /**
+   * @brief Prepare CostmapDeltaUpdate msg for publication, with the cells of the dirty
+   * rectangles that changed since the last publication, and record them as published.
+   * @return The message, nullptr if no cell changed
+   */
+  std::unique_ptr<nav2_msgs::msg::CostmapDeltaUpdate> createCostmapDeltaUpdateMsg();
+  /**
+   * @brief Prepare a CostmapDeltaUpdate keyframe holding the whole costmap, which brings
+   * the delta update subscribers back in sync, and record it as published.
+   */
+  std::unique_ptr<nav2_msgs::msg::CostmapDeltaUpdate> createCostmapDeltaKeyframeMsg();
 
   /** @brief Publish the latest full costmap to the new subscriber. */
   // void onNewSubscription(const ros::SingleSubscriberPublisher& pub);
@@ -162,6 +176,26 @@ private:
   std::string global_frame_;
   std::string topic_name_;
   unsigned int x0_, xn_, y0_, yn_;
+
+  using DirtyRect = CellBounds;
+  // Rectangles updated since the last publication, collapsed into their bounding box
+  // when there are more than max_dirty_rects_
+  std::vector<DirtyRect> dirty_rects_;
+  static constexpr size_t max_dirty_rects_ = 16;
+  // Costs as last sent to the delta update subscribers, which the dirty rectangles
+  // are compared against
+  std::vector<unsigned char> published_costs_;
+  size_t delta_subscription_count_;
+  // Sequence number of the last delta update, and number of delta updates sent since the
+  // last keyframe, which is sent again every delta_keyframe_period_ updates
+  uint64_t delta_sequence_;
+  unsigned int deltas_since_keyframe_;
+  static constexpr unsigned int delta_keyframe_period_ = 50;
+  // Costmap shared with the consumers in this process, only updated while there are some
+  std::shared_ptr<SharedCostmap> shared_costmap_;
+  size_t shared_consumer_count_;
+  // Subscribers of the raw costmap other than the shared costmap consumers
+  size_t unshared_raw_subscription_count_;
   double saved_origin_x_;
   double saved_origin_y_;
   bool active_;
@@ -176,6 +210,9 @@ private:
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::Costmap>::SharedPtr costmap_raw_pub_;
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CostmapUpdate>::SharedPtr
     costmap_raw_update_pub_;
+  // Publisher for the raw costmap cells changed since the previous publication
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CostmapDeltaUpdate>::SharedPtr
+    costmap_raw_delta_update_pub_;
 
   // Service for getting the costmaps
   rclcpp::Service<nav2_msgs::srv::GetCostmap>::SharedPtr costmap_service_;
@@ -386,6 +386,7 @@ protected:
   float footprint_padding_{0};
   std::string global_frame_;                ///< The global frame for the costmap
   int map_height_meters_{0};
+  int layer_update_threads_{1};  ///< Threads updating independent layers, 0 for hardware
   double map_publish_frequency_{0};
   double map_update_frequency_{0};
   int map_width_meters_{0};
@@ -157,6 +157,18 @@ protected:
     nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
     int max_j);
 
+  /*
+   * Combines this layer into the master_grid within the specified
+   * bounding box, row by row. Bands of rows are processed in parallel
+   * on the layer update threads of the LayeredCostmap for large windows.
+   *
+   * row_fn(master_row, layer_row, n) combines n cells of a row.
+   */
+  template<typename RowFunction>
+  void mergeWindow(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j, RowFunction row_fn);
+
   /**
    * Updates the bounding box specified in the parameters to include
    * the location (x,y)
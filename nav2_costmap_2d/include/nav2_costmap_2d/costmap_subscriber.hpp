@@ -20,8 +20,10 @@
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/shared_costmap.hpp"
 #include "nav2_msgs/msg/costmap.hpp"
 #include "nav2_msgs/msg/costmap_update.hpp"
+#include "nav2_msgs/msg/costmap_delta_update.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 
 namespace nav2_costmap_2d
@@ -35,17 +37,23 @@ class CostmapSubscriber
 public:
   /**
    * @brief A constructor
+   * @param use_delta_updates Whether to follow the compact delta updates of the costmap
+   * instead of its rectangular updates
    */
   CostmapSubscriber(
     const nav2_util::LifecycleNode::WeakPtr & parent,
-    const std::string & topic_name);
+    const std::string & topic_name,
+    bool use_delta_updates = false);
 
   /**
    * @brief A constructor
+   * @param use_delta_updates Whether to follow the compact delta updates of the costmap
+   * instead of its rectangular updates
    */
   CostmapSubscriber(
     const rclcpp::Node::WeakPtr & parent,
-    const std::string & topic_name);
+    const std::string & topic_name,
+    bool use_delta_updates = false);
 
   /**
    * @brief A destructor
@@ -53,9 +61,16 @@ public:
   ~CostmapSubscriber() {}
 
   /**
-   * @brief Get current costmap
+   * @brief Get current costmap. The cells of a costmap shared in this process are copied
+   * into it when they changed, getCostmapSnapshot() reads it without any copy.
    */
   std::shared_ptr<Costmap2D> getCostmap();
+  /**
+   * @brief Get the latest snapshot of the costmap, without copying it, when it is published
+   * from the same process and the node uses intra-process communications
+   * @return The snapshot, nullptr if the costmap is not shared with this subscriber
+   */
+  std::shared_ptr<const CostmapSnapshot> getCostmapSnapshot();
   /**
    * @brief Callback for the costmap topic
    */
@@ -64,9 +79,20 @@ public:
    * @brief Callback for the costmap's update topic
    */
   void costmapUpdateCallback(const nav2_msgs::msg::CostmapUpdate::SharedPtr update_msg);
+  /**
+   * @brief Callback for the costmap's delta update topic. Updates following a lost one are
+   * discarded until the next keyframe.
+   */
+  void costmapDeltaUpdateCallback(
+    const nav2_msgs::msg::CostmapDeltaUpdate::SharedPtr update_msg);
 
 protected:
   bool isCostmapReceived() {return costmap_ != nullptr;}
+  /**
+   * @brief Whether the costmap is shared by a publisher in the same process, in which
+   * case the costmap messages are ignored
+   */
+  bool isCostmapShared() {return getCostmapSnapshot() != nullptr;}
   void processCurrentCostmapMsg();
 
   bool haveCostmapParametersChanged();
@@ -76,9 +102,18 @@ protected:
 
   rclcpp::Subscription<nav2_msgs::msg::Costmap>::SharedPtr costmap_sub_;
   rclcpp::Subscription<nav2_msgs::msg::CostmapUpdate>::SharedPtr costmap_update_sub_;
+  rclcpp::Subscription<nav2_msgs::msg::CostmapDeltaUpdate>::SharedPtr
+    costmap_delta_update_sub_;
 
   std::shared_ptr<Costmap2D> costmap_;
   nav2_msgs::msg::Costmap::SharedPtr costmap_msg_;
+  std::shared_ptr<SharedCostmap> shared_costmap_;
+  // Version of the shared snapshot last copied into costmap_
+  uint64_t shared_costmap_version_{0};
+  // Sequence number of the last delta update or full costmap received, valid while in sync
+  // with the keyframes
+  uint64_t delta_sequence_{0};
+  bool delta_synced_{false};
 
   std::string topic_name_;
   std::mutex costmap_msg_mutex_;
@@ -29,6 +29,7 @@
 #include "nav2_costmap_2d/footprint_collision_checker.hpp"
 #include "nav2_costmap_2d/costmap_subscriber.hpp"
 #include "nav2_costmap_2d/footprint_subscriber.hpp"
+#include "nav2_costmap_2d/shared_costmap.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -92,6 +93,10 @@ protected:
   CostmapSubscriber & costmap_sub_;
   FootprintSubscriber & footprint_sub_;
   FootprintCollisionChecker<std::shared_ptr<Costmap2D>> collision_checker_;
+  // Checker reading the costmap shared by its publisher in this process, used instead of
+  // collision_checker_ while there is a snapshot, without copying it
+  FootprintCollisionChecker<std::shared_ptr<const CostmapSnapshot>> snapshot_collision_checker_;
+  bool use_snapshot_{false};
   rclcpp::Clock::SharedPtr clock_;
   Footprint footprint_;
 };
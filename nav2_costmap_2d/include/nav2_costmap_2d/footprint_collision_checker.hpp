@@ -32,6 +32,20 @@ namespace nav2_costmap_2d
 {
 typedef std::vector<geometry_msgs::msg::Point> Footprint;
 
+/**
+ * @struct FootprintStencil
+ * @brief Cells covered by a footprint at one orientation, as offsets from the cell
+ * containing the footprint's origin
+ */
+struct FootprintStencil
+{
+  std::vector<int> dx, dy;
+  // Offsets into the char map, computed with the stencil for a costmap of width size_x
+  std::vector<int> offsets;
+  unsigned int size_x{0};
+  int min_dx{0}, min_dy{0}, max_dx{0}, max_dy{0};
+};
+
 /**
  * @class FootprintCollisionChecker
  * @brief Checker for collision with a footprint on a costmap
@@ -56,6 +70,35 @@ public:
    * @brief Find the footprint cost a a post with an unoriented footprint
    */
   double footprintCostAtPose(double x, double y, double theta, const Footprint & footprint);
+  /**
+   * @brief Precompute the cell offsets covered by a footprint for uniformly spaced
+   * orientations, to be checked with footprintCostAtCell. The footprint is rasterized
+   * with its origin at the center of a cell, so costs may be off by up to half a cell
+   * compared to footprintCostAtPose. Must be called again if the resolution changes,
+   * and should be if the costmap width changes to keep the precomputed offsets in use.
+   * @param footprint Unoriented footprint
+   * @param num_angle_bins Number of orientations over [0, 2 * pi)
+   * @param fill_interior Whether to also cover the interior of the footprint, filling
+   * each row of cells between the outermost outline cells
+   */
+  void setFootprintStencils(
+    const Footprint & footprint, unsigned int num_angle_bins, bool fill_interior = false);
+  /**
+   * @brief Get the orientation bin of the footprint stencils closest to an angle
+   */
+  unsigned int getAngleBin(double theta) const;
+  /**
+   * @brief Find the footprint cost with the footprint's origin in a cell using the
+   * precomputed stencils. Cells outside of the map are lethal.
+   * @param mx X coordinate of the cell
+   * @param my Y coordinate of the cell
+   * @param angle_bin Orientation bin of the stencil to use
+   */
+  double footprintCostAtCell(unsigned int mx, unsigned int my, unsigned int angle_bin) const;
+  /**
+   * @brief Find the footprint cost at a pose using the precomputed stencils
+   */
+  double footprintStencilCostAtPose(double x, double y, double theta);
   /**
    * @brief Get the cost for a line segment
    */
@@ -82,6 +125,7 @@ public:
 
 protected:
   CostmapT costmap_;
+  std::vector<FootprintStencil> stencils_;
 };
 
 }  // namespace nav2_costmap_2d
@@ -48,6 +48,7 @@
 #include "nav2_costmap_2d/layer.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_util/thread_pool.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -260,6 +261,44 @@ protected:
     return layered_costmap_->getCostmap()->cellDistance(world_dist);
   }
 
+  /**
+   * @brief Update the costs in the master costmap in the window, re-propagating
+   * the persistent inflation costs only around cells whose obstacle status changed
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void updateCostsIncremental(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Update the costs in the master costmap in the window from an exact Euclidean
+   * distance transform, computed with separable column and row passes in parallel
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void updateCostsDistanceTransform(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Whether a value of the inflation_mode parameter is supported
+   * @param mode Inflation mode
+   */
+  static bool isValidInflationMode(const std::string & mode);
+
+  /**
+   * @brief Move the persistent incremental inflation state along with a rolling costmap
+   * @param master_grid The master costmap grid whose origin the state follows
+   */
+  void updateIncrementalOrigin(const nav2_costmap_2d::Costmap2D & master_grid);
+
   /**
    * @brief Enqueue new cells in cache distance update search
    */
@@ -276,6 +315,7 @@ protected:
 
   double inflation_radius_, inscribed_radius_, cost_scaling_factor_;
   bool inflate_unknown_, inflate_around_unknown_;
+  std::string inflation_mode_;
   unsigned int cell_inflation_radius_;
   unsigned int cached_cell_inflation_radius_;
   std::vector<std::vector<CellData>> inflation_cells_;
@@ -284,8 +324,23 @@ protected:
 
   std::vector<bool> seen_;
 
+  // Persistent state of the incremental inflation mode: the obstacle cells known to the
+  // layer and the inflation cost they induce on each cell, before merging with the master
+  std::vector<bool> obstacles_;
+  std::vector<unsigned char> inflation_costs_;
+  double incremental_origin_x_, incremental_origin_y_;
+  bool need_incremental_reset_;
+
+  // Distance transform mode: squared distance to the nearest obstacle in the same column
+  // for each cell of the window, and the workers computing it
+  std::vector<int> column_distances_;
+  int distance_transform_threads_;
+  std::unique_ptr<nav2_util::ThreadPool> thread_pool_;
+
   std::vector<unsigned char> cached_costs_;
   std::vector<double> cached_distances_;
+  // Costs indexed by squared cell distance, for the distance transform mode
+  std::vector<unsigned char> squared_distance_costs_;
   std::vector<std::vector<int>> distance_matrix_;
   unsigned int cache_length_;
   double last_min_x_, last_min_y_, last_max_x_, last_max_y_;
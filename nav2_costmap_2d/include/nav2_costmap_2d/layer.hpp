@@ -111,6 +111,15 @@ public:
     Costmap2D & master_grid,
     int min_i, int min_j, int max_i, int max_j) = 0;
 
+  /**
+   * @brief If this layer is independent of the other layers during updateBounds(), i.e.
+   *        it only expands the bounds with its own, and only reads or writes its own state
+   *        and grid there. Independent layers may run updateBounds() concurrently with
+   *        each other when the LayeredCostmap uses more than one layer update thread.
+   *        updateCosts() is always called sequentially in plugin order.
+   */
+  virtual bool isIndependent() {return false;}
+
   /** @brief Implement this to make this layer match the size of the parent costmap. */
   virtual void matchSize() {}
 
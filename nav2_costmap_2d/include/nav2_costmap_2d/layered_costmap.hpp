@@ -45,6 +45,7 @@
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_costmap_2d/layer.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_util/thread_pool.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -211,7 +212,43 @@ public:
   * of poorly configured setups. */
   bool isOutofBounds(double robot_x, double robot_y);
 
+  /**
+   * @brief Set the number of threads running updateBounds() of consecutive independent
+   * plugins concurrently. Plugins are merged into the costmap sequentially regardless.
+   * @param num_threads Number of threads, 1 to update all plugins sequentially and
+   * 0 to use the hardware concurrency
+   */
+  void setLayerUpdateThreads(unsigned int num_threads);
+
+  /**
+   * @brief Get the pool of layer update threads, which plugins may use to split their
+   * work within updateCosts()
+   * @return Pointer to the thread pool, nullptr when layers are updated sequentially
+   */
+  nav2_util::ThreadPool * getThreadPool()
+  {
+    return thread_pool_.get();
+  }
+
 private:
+  /**
+   * @brief Update the bounds of plugins [begin, end), all of them independent, concurrently.
+   * Each plugin expands its own copy of the current bounds, then those are merged
+   * in plugin order.
+   */
+  void updateIndependentBounds(
+    std::vector<std::shared_ptr<Layer>>::iterator begin,
+    std::vector<std::shared_ptr<Layer>>::iterator end,
+    double robot_x, double robot_y, double robot_yaw);
+
+  /**
+   * @brief Warn about a plugin or filter shrinking the bounds, which is not allowed
+   */
+  void checkBoundsChange(
+    const Layer & layer, const char * kind,
+    double prev_minx, double prev_miny, double prev_maxx, double prev_maxy,
+    double minx, double miny, double maxx, double maxy) const;
+
   // primary_costmap_ is a bottom costmap used by plugins when costmap filters were enabled.
   // combined_costmap_ is a final costmap where all results produced by plugins and filters (if any)
   // to be merged.
@@ -233,6 +270,8 @@ private:
   bool size_locked_;
   std::atomic<double> circumscribed_radius_, inscribed_radius_;
   std::shared_ptr<std::vector<geometry_msgs::msg::Point>> footprint_;
+
+  std::unique_ptr<nav2_util::ThreadPool> thread_pool_;
 };
 
 }  // namespace nav2_costmap_2d
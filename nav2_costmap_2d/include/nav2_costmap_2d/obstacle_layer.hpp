@@ -131,6 +131,12 @@ public:
    */
   virtual bool isClearable() {return true;}
 
+  /**
+   * @brief Marking and raytracing only touch this layer's own grid, so its bounds
+   * can be updated concurrently with other independent layers
+   */
+  virtual bool isIndependent() {return true;}
+
   /**
    * @brief Callback executed when a parameter change is detected
    * @param event ParameterEvent message
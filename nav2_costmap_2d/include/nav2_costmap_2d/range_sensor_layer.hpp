@@ -123,6 +123,12 @@ public:
    */
   virtual bool isClearable() {return true;}
 
+  /**
+   * @brief Range readings are only integrated into this layer's own grid, so its bounds
+   * can be updated concurrently with other independent layers
+   */
+  virtual bool isIndependent() {return true;}
+
   /**
    * @brief Handle an incoming Range message to populate into costmap
    */
@@ -0,0 +1,201 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__SHARED_COSTMAP_HPP_
+#define NAV2_COSTMAP_2D__SHARED_COSTMAP_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "builtin_interfaces/msg/time.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/** @brief Half-open rectangle of cells [x0, xn) x [y0, yn) */
+struct CellBounds
+{
+  unsigned int x0, xn, y0, yn;
+};
+
+/**
+ * @class nav2_costmap_2d::CostmapSnapshot
+ * @brief Read-only copy of a costmap at a given version. A snapshot is never modified
+ * once shared, so it can be read from any thread without locking.
+ */
+class CostmapSnapshot
+{
+public:
+  /**
+   * @brief Get the version of the snapshot, increasing with every snapshot of a costmap
+   */
+  uint64_t getVersion() const {return version_;}
+
+  /**
+   * @brief Get the frame of the costmap
+   */
+  const std::string & getFrameId() const {return frame_id_;}
+
+  /**
+   * @brief Get the time the snapshot was taken
+   */
+  const builtin_interfaces::msg::Time & getStamp() const {return stamp_;}
+
+  unsigned int getSizeInCellsX() const {return size_x_;}
+  unsigned int getSizeInCellsY() const {return size_y_;}
+  double getResolution() const {return resolution_;}
+  double getOriginX() const {return origin_x_;}
+  double getOriginY() const {return origin_y_;}
+
+  /**
+   * @brief Get the char map of the costmap, of getSizeInCellsX() * getSizeInCellsY() cells
+   */
+  const unsigned char * getCharMap() const {return data_.data();}
+
+  /**
+   * @brief Get the cost of a cell
+   * @param mx The x coordinate of the cell
+   * @param my The y coordinate of the cell
+   * @return The cost of the cell
+   */
+  unsigned char getCost(unsigned int mx, unsigned int my) const
+  {
+    return data_[my * size_x_ + mx];
+  }
+
+  /**
+   * @brief Convert from world coordinates to map coordinates
+   * @param wx The x world coordinate
+   * @param wy The y world coordinate
+   * @param mx Will be set to the associated map x coordinate
+   * @param my Will be set to the associated map y coordinate
+   * @return True if the conversion was successful (legal bounds) false otherwise
+   */
+  bool worldToMap(double wx, double wy, unsigned int & mx, unsigned int & my) const;
+
+  /**
+   * @brief Copy the snapshot into a costmap, resizing it if needed
+   * @param costmap Costmap to overwrite, whose mutex must be held by the caller
+   */
+  void copyTo(Costmap2D & costmap) const;
+
+  /**
+   * @brief Copy the cells changed since the previous snapshot into a costmap holding it
+   * @param costmap Costmap to update, whose mutex must be held by the caller
+   * @param version Version of the snapshot the costmap holds
+   * @return False if nothing was copied, because the costmap does not hold the previous
+   * snapshot or its changes are not known, in which case copyTo() must be used instead
+   */
+  bool copyChangesTo(Costmap2D & costmap, uint64_t version) const;
+
+protected:
+  friend class SharedCostmap;
+
+  uint64_t version_{0};
+  std::string frame_id_;
+  builtin_interfaces::msg::Time stamp_;
+  unsigned int size_x_{0};
+  unsigned int size_y_{0};
+  double resolution_{0.0};
+  double origin_x_{0.0};
+  double origin_y_{0.0};
+  std::vector<unsigned char> data_;
+  // Bounds of the cells changed since the previous snapshot, if they are known
+  std::vector<CellBounds> changes_;
+  bool changes_known_{false};
+};
+
+/**
+ * @class nav2_costmap_2d::SharedCostmap
+ * @brief Costmap shared between the publisher and the consumers of a costmap topic living
+ * in the same process, such as in a component container. The publisher swaps in a new
+ * CostmapSnapshot at each publication, and consumers hold on to the snapshots they read
+ * for as long as they need them, without copying nor blocking the publisher.
+ */
+class SharedCostmap
+{
+public:
+  /**
+   * @brief Get the shared costmap of a topic in this process, creating it if needed
+   * @param topic_name Fully qualified name of the costmap topic
+   * @return The shared costmap, alive for as long as anyone holds it
+   */
+  static std::shared_ptr<SharedCostmap> get(const std::string & topic_name);
+
+  /**
+   * @brief Get the latest snapshot of the costmap
+   * @return The snapshot, nullptr if the costmap was never shared yet
+   */
+  std::shared_ptr<const CostmapSnapshot> getSnapshot() const;
+
+  /**
+   * @brief Share a new snapshot of a costmap, reusing the memory of an older snapshot
+   * when no consumer holds it anymore
+   * @param costmap Costmap to share, whose mutex must be held by the caller
+   * @param frame_id Frame of the costmap
+   * @param stamp Time of the snapshot
+   */
+  void share(
+    const Costmap2D & costmap, const std::string & frame_id,
+    const builtin_interfaces::msg::Time & stamp);
+
+  /**
+   * @brief Share a new snapshot of a costmap which only changed within some bounds since
+   * the last one shared. When the memory of the previous snapshot is reused, only the cells
+   * changed since it was shared are copied, otherwise the whole costmap is.
+   * @param costmap Costmap to share, whose mutex must be held by the caller
+   * @param frame_id Frame of the costmap
+   * @param stamp Time of the snapshot
+   * @param changes Bounds of the cells changed since the last snapshot shared
+   */
+  void shareChanges(
+    const Costmap2D & costmap, const std::string & frame_id,
+    const builtin_interfaces::msg::Time & stamp, const std::vector<CellBounds> & changes);
+
+  /**
+   * @brief Drop the latest snapshot, when the publisher of the costmap goes away or is
+   * deactivated. The next snapshot shared is a full copy of the costmap.
+   */
+  void clear();
+
+protected:
+  /**
+   * @brief Share a new snapshot of a costmap
+   * @param changes Bounds of the cells changed since the last snapshot shared, nullptr
+   * to copy the whole costmap
+   */
+  void shareSnapshot(
+    const Costmap2D & costmap, const std::string & frame_id,
+    const builtin_interfaces::msg::Time & stamp, const std::vector<CellBounds> * changes);
+
+  mutable std::mutex snapshot_mutex_;
+  std::shared_ptr<CostmapSnapshot> snapshot_;
+  // Previous snapshot, whose memory is reused for the next one once released by consumers.
+  // Only accessed by the publishing thread.
+  std::shared_ptr<CostmapSnapshot> spare_snapshot_;
+  // Cells changed in the latest snapshot with respect to the spare one, which need to be
+  // copied along with the next changes when the spare snapshot is reused.
+  // Only accessed by the publishing thread.
+  std::vector<CellBounds> last_changes_;
+  bool last_change_full_{true};
+  uint64_t version_{0};
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__SHARED_COSTMAP_HPP_
@@ -37,11 +37,15 @@
  *********************************************************************/
 #include "nav2_costmap_2d/inflation_layer.hpp"
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <vector>
 #include <algorithm>
 #include <utility>
+#include <string>
+#include <thread>
 
 #include "nav2_costmap_2d/costmap_math.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
@@ -68,6 +72,10 @@ InflationLayer::InflationLayer()
   cached_cell_inflation_radius_(0),
   resolution_(0),
   cache_length_(0),
+  incremental_origin_x_(0),
+  incremental_origin_y_(0),
+  need_incremental_reset_(true),
+  distance_transform_threads_(0),
   last_min_x_(std::numeric_limits<double>::lowest()),
   last_min_y_(std::numeric_limits<double>::lowest()),
   last_max_x_(std::numeric_limits<double>::max()),
@@ -90,6 +98,8 @@ InflationLayer::onInitialize()
   declareParameter("cost_scaling_factor", rclcpp::ParameterValue(10.0));
   declareParameter("inflate_unknown", rclcpp::ParameterValue(false));
   declareParameter("inflate_around_unknown", rclcpp::ParameterValue(false));
+  declareParameter("inflation_mode", rclcpp::ParameterValue(std::string("full")));
+  declareParameter("distance_transform_threads", rclcpp::ParameterValue(0));
 
   {
     auto node = node_.lock();
@@ -101,6 +111,14 @@ InflationLayer::onInitialize()
     node->get_parameter(name_ + "." + "cost_scaling_factor", cost_scaling_factor_);
     node->get_parameter(name_ + "." + "inflate_unknown", inflate_unknown_);
     node->get_parameter(name_ + "." + "inflate_around_unknown", inflate_around_unknown_);
+    node->get_parameter(name_ + "." + "inflation_mode", inflation_mode_);
+    if (!isValidInflationMode(inflation_mode_)) {
+      RCLCPP_WARN(
+        logger_, "Unknown inflation mode %s, valid modes are full, incremental and "
+        "distance_transform. Using full.", inflation_mode_.c_str());
+      inflation_mode_ = "full";
+    }
+    node->get_parameter(name_ + "." + "distance_transform_threads", distance_transform_threads_);
 
     dyn_params_handler_ = node->add_on_set_parameters_callback(
       std::bind(
@@ -126,6 +144,9 @@ InflationLayer::matchSize()
   cell_inflation_radius_ = cellDistance(inflation_radius_);
   computeCaches();
   seen_ = std::vector<bool>(costmap->getSizeInCellsX() * costmap->getSizeInCellsY(), false);
+  // The resized map has to be inflated again as a whole
+  need_reinflation_ = true;
+  need_incremental_reset_ = true;
 }
 
 void
@@ -145,6 +166,7 @@ InflationLayer::updateBounds(
     *max_x = std::numeric_limits<double>::max();
     *max_y = std::numeric_limits<double>::max();
     need_reinflation_ = false;
+    need_incremental_reset_ = true;
   } else {
     double tmp_min_x = last_min_x_;
     double tmp_min_y = last_min_y_;
@@ -197,6 +219,14 @@ InflationLayer::updateCosts(
     return;
   }
 
+  if (inflation_mode_ == "incremental") {
+    updateCostsIncremental(master_grid, min_i, min_j, max_i, max_j);
+    return;
+  } else if (inflation_mode_ == "distance_transform") {
+    updateCostsDistanceTransform(master_grid, min_i, min_j, max_i, max_j);
+    return;
+  }
+
   // make sure the inflation list is empty at the beginning of the cycle (should always be true)
   for (auto & dist : inflation_cells_) {
     RCLCPP_FATAL_EXPRESSION(
@@ -316,6 +346,318 @@ InflationLayer::updateCosts(
   current_ = true;
 }
 
+void
+InflationLayer::updateCostsIncremental(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  unsigned char * master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  if (seen_.size() != size_x * size_y) {
+    RCLCPP_WARN(
+      logger_, "InflationLayer::updateCostsIncremental(): seen_ vector size is wrong");
+    seen_ = std::vector<bool>(size_x * size_y, false);
+  }
+
+  if (need_incremental_reset_ || obstacles_.size() != size_x * size_y) {
+    obstacles_.assign(size_x * size_y, false);
+    inflation_costs_.assign(size_x * size_y, FREE_SPACE);
+    incremental_origin_x_ = master_grid.getOriginX();
+    incremental_origin_y_ = master_grid.getOriginY();
+    std::fill(begin(seen_), end(seen_), false);
+    need_incremental_reset_ = false;
+  } else {
+    updateIncrementalOrigin(master_grid);
+  }
+
+  // Only the window holds fresh obstacle information from the layers below, so find the
+  // cells in it whose obstacle status changed since the last update
+  int dirty_min_i = std::numeric_limits<int>::max();
+  int dirty_min_j = std::numeric_limits<int>::max();
+  int dirty_max_i = std::numeric_limits<int>::lowest();
+  int dirty_max_j = std::numeric_limits<int>::lowest();
+  for (int j = min_j; j < max_j; j++) {
+    for (int i = min_i; i < max_i; i++) {
+      unsigned int index = master_grid.getIndex(i, j);
+      unsigned char cost = master_array[index];
+      bool is_obstacle =
+        cost == LETHAL_OBSTACLE || (inflate_around_unknown_ && cost == NO_INFORMATION);
+      if (is_obstacle != obstacles_[index]) {
+        obstacles_[index] = is_obstacle;
+        dirty_min_i = std::min(dirty_min_i, i);
+        dirty_min_j = std::min(dirty_min_j, j);
+        dirty_max_i = std::max(dirty_max_i, i + 1);
+        dirty_max_j = std::max(dirty_max_j, j + 1);
+      }
+    }
+  }
+
+  if (dirty_min_i < dirty_max_i) {
+    // Only cells within the inflation radius of a changed cell may change cost,
+    // and only obstacles within the inflation radius of those can reach them
+    const int r = static_cast<int>(cell_inflation_radius_);
+    dirty_min_i = std::max(0, dirty_min_i - r);
+    dirty_min_j = std::max(0, dirty_min_j - r);
+    dirty_max_i = std::min(static_cast<int>(size_x), dirty_max_i + r);
+    dirty_max_j = std::min(static_cast<int>(size_y), dirty_max_j + r);
+    const int src_min_i = std::max(0, dirty_min_i - r);
+    const int src_min_j = std::max(0, dirty_min_j - r);
+    const int src_max_i = std::min(static_cast<int>(size_x), dirty_max_i + r);
+    const int src_max_j = std::min(static_cast<int>(size_y), dirty_max_j + r);
+
+    for (int j = dirty_min_j; j < dirty_max_j; j++) {
+      unsigned int row = master_grid.getIndex(dirty_min_i, j);
+      std::fill_n(inflation_costs_.begin() + row, dirty_max_i - dirty_min_i, FREE_SPACE);
+    }
+
+    auto & obs_bin = inflation_cells_[0];
+    obs_bin.reserve(200);
+    for (int j = src_min_j; j < src_max_j; j++) {
+      for (int i = src_min_i; i < src_max_i; i++) {
+        if (obstacles_[master_grid.getIndex(i, j)]) {
+          obs_bin.emplace_back(i, j, i, j);
+        }
+      }
+    }
+
+    for (auto & dist_bin : inflation_cells_) {
+      dist_bin.reserve(200);
+      for (std::size_t i = 0; i < dist_bin.size(); ++i) {
+        // Do not use iterator or for-range based loops to
+        // iterate though dist_bin, since it's size might
+        // change when a new cell is enqueued, invalidating all iterators
+        const CellData & cell = dist_bin[i];
+        unsigned int mx = cell.x_;
+        unsigned int my = cell.y_;
+        unsigned int sx = cell.src_x_;
+        unsigned int sy = cell.src_y_;
+        unsigned int index = master_grid.getIndex(mx, my);
+
+        if (seen_[index]) {
+          continue;
+        }
+
+        seen_[index] = true;
+
+        if (static_cast<int>(mx) >= dirty_min_i &&
+          static_cast<int>(my) >= dirty_min_j &&
+          static_cast<int>(mx) < dirty_max_i &&
+          static_cast<int>(my) < dirty_max_j)
+        {
+          inflation_costs_[index] = costLookup(mx, my, sx, sy);
+        }
+
+        if (mx > 0) {
+          enqueue(index - 1, mx - 1, my, sx, sy);
+        }
+        if (my > 0) {
+          enqueue(index - size_x, mx, my - 1, sx, sy);
+        }
+        if (mx < size_x - 1) {
+          enqueue(index + 1, mx + 1, my, sx, sy);
+        }
+        if (my < size_y - 1) {
+          enqueue(index + size_x, mx, my + 1, sx, sy);
+        }
+      }
+      dist_bin = std::vector<CellData>();
+    }
+
+    // Cells are visited at most the inflation radius away from their sources, so only
+    // this neighborhood of the sources needs to be cleared rather than the full seen_
+    const int seen_min_i = std::max(0, src_min_i - r - 1);
+    const int seen_min_j = std::max(0, src_min_j - r - 1);
+    const int seen_max_i = std::min(static_cast<int>(size_x), src_max_i + r + 1);
+    const int seen_max_j = std::min(static_cast<int>(size_y), src_max_j + r + 1);
+    for (int j = seen_min_j; j < seen_max_j; j++) {
+      unsigned int row = master_grid.getIndex(seen_min_i, j);
+      std::fill_n(seen_.begin() + row, seen_max_i - seen_min_i, false);
+    }
+  }
+
+  for (int j = min_j; j < max_j; j++) {
+    for (int i = min_i; i < max_i; i++) {
+      unsigned int index = master_grid.getIndex(i, j);
+      unsigned char cost = inflation_costs_[index];
+      unsigned char old_cost = master_array[index];
+      if (old_cost == NO_INFORMATION &&
+        (inflate_unknown_ ? (cost > FREE_SPACE) : (cost >= INSCRIBED_INFLATED_OBSTACLE)))
+      {
+        master_array[index] = cost;
+      } else {
+        master_array[index] = std::max(old_cost, cost);
+      }
+    }
+  }
+
+  current_ = true;
+}
+
+void
+InflationLayer::updateCostsDistanceTransform(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  if (!thread_pool_) {
+    unsigned int num_threads = distance_transform_threads_ > 0 ?
+      static_cast<unsigned int>(distance_transform_threads_) :
+      std::max(std::thread::hardware_concurrency(), 1u);
+    thread_pool_ = std::make_unique<nav2_util::ThreadPool>(num_threads);
+  }
+
+  unsigned char * master_array = master_grid.getCharMap();
+  const int size_x = static_cast<int>(master_grid.getSizeInCellsX());
+  const int size_y = static_cast<int>(master_grid.getSizeInCellsY());
+  const int r = static_cast<int>(cell_inflation_radius_);
+
+  // Obstacles up to the inflation radius outside of the window still influence it
+  const int src_min_i = std::max(0, min_i - r);
+  const int src_min_j = std::max(0, min_j - r);
+  const int src_max_i = std::min(size_x, max_i + r);
+  const int src_max_j = std::min(size_y, max_j + r);
+  const int width = src_max_i - src_min_i;
+  const int height = src_max_j - src_min_j;
+  if (width <= 0 || height <= 0 || max_i <= min_i || max_j <= min_j) {
+    current_ = true;
+    return;
+  }
+
+  // Cells further than the inflation radius from any obstacle are not inflated
+  const int unreachable = std::numeric_limits<int>::max();
+  column_distances_.resize(static_cast<size_t>(width) * height);
+
+  // Squared distance to the nearest obstacle within the same column
+  thread_pool_->parallelFor(
+    width, [&](size_t begin, size_t end) {
+      for (int c = static_cast<int>(begin); c < static_cast<int>(end); ++c) {
+        int last_obstacle = -1;
+        for (int k = 0; k < height; ++k) {
+          unsigned char cost = master_array[(src_min_j + k) * size_x + src_min_i + c];
+          if (cost == LETHAL_OBSTACLE || (inflate_around_unknown_ && cost == NO_INFORMATION)) {
+            last_obstacle = k;
+          }
+          column_distances_[k * width + c] =
+            last_obstacle < 0 ? unreachable : k - last_obstacle;
+        }
+        last_obstacle = -1;
+        for (int k = height - 1; k >= 0; --k) {
+          int & dist = column_distances_[k * width + c];
+          if (dist == 0) {
+            last_obstacle = k;
+          } else if (last_obstacle >= 0) {
+            dist = std::min(dist, last_obstacle - k);
+          }
+          dist = dist <= r ? dist * dist : unreachable;
+        }
+      }
+    });
+
+  // Lower envelope of the column parabolas along each row of the window
+  thread_pool_->parallelFor(
+    max_j - min_j, [&](size_t begin, size_t end) {
+      std::vector<int> v(width);
+      std::vector<double> z(width + 1);
+      for (int j = min_j + static_cast<int>(begin); j < min_j + static_cast<int>(end); ++j) {
+        const int * f = &column_distances_[(j - src_min_j) * width];
+        int k = -1;
+        for (int q = 0; q < width; ++q) {
+          if (f[q] == unreachable) {
+            continue;
+          }
+          const int64_t fq = f[q] + static_cast<int64_t>(q) * q;
+          double s = -std::numeric_limits<double>::infinity();
+          while (k >= 0) {
+            const int64_t fv = f[v[k]] + static_cast<int64_t>(v[k]) * v[k];
+            s = static_cast<double>(fq - fv) / (2.0 * (q - v[k]));
+            if (s > z[k]) {
+              break;
+            }
+            k--;
+          }
+          k++;
+          v[k] = q;
+          z[k] = k == 0 ? -std::numeric_limits<double>::infinity() : s;
+        }
+        if (k >= 0) {
+          z[k + 1] = std::numeric_limits<double>::infinity();
+        }
+
+        int p = 0;
+        for (int i = min_i; i < max_i; ++i) {
+          unsigned char cost = FREE_SPACE;
+          if (k >= 0) {
+            const int q = i - src_min_i;
+            while (z[p + 1] < q) {
+              p++;
+            }
+            const int64_t dist = static_cast<int64_t>(q - v[p]) * (q - v[p]) + f[v[p]];
+            if (dist < static_cast<int64_t>(squared_distance_costs_.size())) {
+              cost = squared_distance_costs_[dist];
+            }
+          }
+
+          const int index = j * size_x + i;
+          unsigned char old_cost = master_array[index];
+          if (old_cost == NO_INFORMATION &&
+            (inflate_unknown_ ? (cost > FREE_SPACE) : (cost >= INSCRIBED_INFLATED_OBSTACLE)))
+          {
+            master_array[index] = cost;
+          } else {
+            master_array[index] = std::max(old_cost, cost);
+          }
+        }
+      }
+    });
+
+  current_ = true;
+}
+
+bool
+InflationLayer::isValidInflationMode(const std::string & mode)
+{
+  return mode == "full" || mode == "incremental" || mode == "distance_transform";
+}
+
+void
+InflationLayer::updateIncrementalOrigin(const nav2_costmap_2d::Costmap2D & master_grid)
+{
+  const double resolution = master_grid.getResolution();
+  const int cell_ox = static_cast<int>(
+    std::round((master_grid.getOriginX() - incremental_origin_x_) / resolution));
+  const int cell_oy = static_cast<int>(
+    std::round((master_grid.getOriginY() - incremental_origin_y_) / resolution));
+  if (cell_ox == 0 && cell_oy == 0) {
+    return;
+  }
+
+  incremental_origin_x_ = master_grid.getOriginX();
+  incremental_origin_y_ = master_grid.getOriginY();
+
+  // Keep the overlap of the old and new windows, as Costmap2D::updateOrigin does
+  const int size_x = static_cast<int>(master_grid.getSizeInCellsX());
+  const int size_y = static_cast<int>(master_grid.getSizeInCellsY());
+  std::vector<bool> obstacles(obstacles_.size(), false);
+  std::vector<unsigned char> inflation_costs(inflation_costs_.size(), FREE_SPACE);
+  const int lower_x = std::max(0, cell_ox);
+  const int lower_y = std::max(0, cell_oy);
+  const int upper_x = std::min(size_x, size_x + cell_ox);
+  const int upper_y = std::min(size_y, size_y + cell_oy);
+  for (int j = lower_y; j < upper_y; j++) {
+    for (int i = lower_x; i < upper_x; i++) {
+      const unsigned int old_index = j * size_x + i;
+      const unsigned int new_index = (j - cell_oy) * size_x + (i - cell_ox);
+      obstacles[new_index] = obstacles_[old_index];
+      inflation_costs[new_index] = inflation_costs_[old_index];
+    }
+  }
+
+  obstacles_.swap(obstacles);
+  inflation_costs_.swap(inflation_costs);
+}
+
 /**
  * @brief  Given an index of a cell in the costmap, place it into a list pending for obstacle inflation
  * @param  grid The costmap
@@ -379,6 +721,17 @@ InflationLayer::computeCaches()
     }
   }
 
+  // Same costs as the cache for the offsets within the inflation radius
+  squared_distance_costs_.assign(
+    cell_inflation_radius_ * cell_inflation_radius_ + 1, FREE_SPACE);
+  for (unsigned int i = 0; i <= cell_inflation_radius_; ++i) {
+    for (unsigned int j = 0; j <= cell_inflation_radius_; ++j) {
+      if (cached_distances_[i * cache_length_ + j] <= cell_inflation_radius_) {
+        squared_distance_costs_[i * i + j * j] = cached_costs_[i * cache_length_ + j];
+      }
+    }
+  }
+
   int max_dist = generateIntegerDistances();
   inflation_cells_.clear();
   inflation_cells_.resize(max_dist + 1);
@@ -471,6 +824,20 @@ InflationLayer::dynamicParametersCallback(
         inflate_around_unknown_ = parameter.as_bool();
         need_reinflation_ = true;
       }
+    } else if (param_type == ParameterType::PARAMETER_STRING) {
+      if (param_name == name_ + "." + "inflation_mode" &&
+        inflation_mode_ != parameter.as_string())
+      {
+        if (!isValidInflationMode(parameter.as_string())) {
+          RCLCPP_WARN(
+            logger_, "Unknown inflation mode %s, valid modes are full, incremental and "
+            "distance_transform. Keeping %s.", parameter.as_string().c_str(),
+            inflation_mode_.c_str());
+          continue;
+        }
+        inflation_mode_ = parameter.as_string();
+        need_reinflation_ = true;
+      }
     }
   }
 
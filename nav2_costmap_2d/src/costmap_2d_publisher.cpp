@@ -38,6 +38,7 @@
  *********************************************************************/
 #include "nav2_costmap_2d/costmap_2d_publisher.hpp"
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <utility>
@@ -58,6 +59,11 @@ Costmap2DPublisher::Costmap2DPublisher(
 : costmap_(costmap),
   global_frame_(global_frame),
   topic_name_(topic_name),
+  delta_subscription_count_(0),
+  delta_sequence_(0),
+  deltas_since_keyframe_(0),
+  shared_consumer_count_(0),
+  unshared_raw_subscription_count_(0),
   active_(false),
   always_send_full_costmap_(always_send_full_costmap)
 {
@@ -78,6 +84,9 @@ Costmap2DPublisher::Costmap2DPublisher(
     topic_name + "_updates", custom_qos);
   costmap_raw_update_pub_ = node->create_publisher<nav2_msgs::msg::CostmapUpdate>(
     topic_name + "_raw_updates", custom_qos);
+  costmap_raw_delta_update_pub_ = node->create_publisher<nav2_msgs::msg::CostmapDeltaUpdate>(
+    topic_name + "_raw_delta_updates", custom_qos);
+  shared_costmap_ = SharedCostmap::get(costmap_raw_pub_->get_topic_name());
 
   // Create a service that will use the callback function to handle requests.
   costmap_service_ = node->create_service<nav2_msgs::srv::GetCostmap>(
@@ -107,7 +116,44 @@ Costmap2DPublisher::Costmap2DPublisher(
   y0_ = costmap_->getSizeInCellsY();
 }
 
-Costmap2DPublisher::~Costmap2DPublisher() {}
+Costmap2DPublisher::~Costmap2DPublisher()
+{
+  shared_costmap_->clear();
+}
+
+void Costmap2DPublisher::updateBounds(
+  unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  x0_ = std::min(x0, x0_);
+  xn_ = std::max(xn, xn_);
+  y0_ = std::min(y0, y0_);
+  yn_ = std::max(yn, yn_);
+
+  if (x0 >= xn || y0 >= yn) {
+    return;
+  }
+
+  const DirtyRect rect{x0, xn, y0, yn};
+  auto contains = [](const DirtyRect & outer, const DirtyRect & inner) {
+      return outer.x0 <= inner.x0 && inner.xn <= outer.xn &&
+             outer.y0 <= inner.y0 && inner.yn <= outer.yn;
+    };
+  for (const auto & dirty_rect : dirty_rects_) {
+    if (contains(dirty_rect, rect)) {
+      return;
+    }
+  }
+  dirty_rects_.erase(
+    std::remove_if(
+      dirty_rects_.begin(), dirty_rects_.end(),
+      [&](const DirtyRect & dirty_rect) {return contains(rect, dirty_rect);}),
+    dirty_rects_.end());
+  dirty_rects_.push_back(rect);
+
+  if (dirty_rects_.size() > max_dirty_rects_) {
+    dirty_rects_.assign(1, DirtyRect{x0_, xn_, y0_, yn_});
+  }
+}
 
 // TODO(bpwilcox): find equivalent/workaround to ros::SingleSubscriberPublishr
 /*
@@ -180,14 +226,12 @@ void Costmap2DPublisher::prepareCostmap()
   costmap_raw_->metadata.origin.position.z = 0.0;
   costmap_raw_->metadata.origin.orientation.w = 1.0;
 
-  costmap_raw_->data.resize(costmap_raw_->metadata.size_x * costmap_raw_->metadata.size_y);
-
   unsigned char * data = costmap_->getCharMap();
-  for (unsigned int i = 0; i < costmap_raw_->data.size(); i++) {
-    costmap_raw_->data[i] = data[i];
-  }
+  costmap_raw_->data.assign(
+    data, data + costmap_raw_->metadata.size_x * costmap_raw_->metadata.size_y);
 }
 
+
 std::unique_ptr<map_msgs::msg::OccupancyGridUpdate> Costmap2DPublisher::createGridUpdateMsg()
 {
   auto update = std::make_unique<map_msgs::msg::OccupancyGridUpdate>();
@@ -200,11 +244,13 @@ std::unique_ptr<map_msgs::msg::OccupancyGridUpdate> Costmap2DPublisher::createGr
   update->height = yn_ - y0_;
   update->data.resize(update->width * update->height);
 
-  std::uint32_t i = 0;
+  const unsigned char * data = costmap_->getCharMap();
+  const std::uint32_t size_x = costmap_->getSizeInCellsX();
+  auto out = update->data.begin();
   for (std::uint32_t y = y0_; y < yn_; y++) {
-    for (std::uint32_t x = x0_; x < xn_; x++) {
-      update->data[i++] = cost_translation_table_[costmap_->getCost(x, y)];
-    }
+    out = std::transform(
+      data + y * size_x + x0_, data + y * size_x + xn_, out,
+      [](unsigned char cost) {return cost_translation_table_[cost];});
   }
   return update;
 }
@@ -221,19 +267,129 @@ std::unique_ptr<nav2_msgs::msg::CostmapUpdate> Costmap2DPublisher::createCostmap
   msg->size_y = yn_ - y0_;
   msg->data.resize(msg->size_x * msg->size_y);
 
-  std::uint32_t i = 0;
+  const unsigned char * data = costmap_->getCharMap();
+  const std::uint32_t size_x = costmap_->getSizeInCellsX();
+  auto out = msg->data.begin();
   for (std::uint32_t y = y0_; y < yn_; y++) {
-    for (std::uint32_t x = x0_; x < xn_; x++) {
-      msg->data[i++] = costmap_->getCost(x, y);
+    out = std::copy(data + y * size_x + x0_, data + y * size_x + xn_, out);
+  }
+  return msg;
+}
+
+std::unique_ptr<nav2_msgs::msg::CostmapDeltaUpdate>
+Costmap2DPublisher::createCostmapDeltaUpdateMsg()
+{
+  // Changed cells separated by at most this many unchanged cells share a run, as
+  // sending them costs less than the start and length of a new run
+  constexpr std::uint32_t max_run_gap = 8;
+
+  auto msg = std::make_unique<nav2_msgs::msg::CostmapDeltaUpdate>();
+
+  msg->header.stamp = clock_->now();
+  msg->header.frame_id = global_frame_;
+  msg->size_x = costmap_->getSizeInCellsX();
+  msg->size_y = costmap_->getSizeInCellsY();
+
+  const unsigned char * data = costmap_->getCharMap();
+  unsigned char * published = published_costs_.data();
+  for (const auto & rect : dirty_rects_) {
+    for (std::uint32_t y = rect.y0; y < rect.yn; y++) {
+      const std::uint32_t row = y * msg->size_x;
+      std::uint32_t x = rect.x0;
+      while (x < rect.xn) {
+        // Skip to the next changed cell, then extend the run up to its last changed cell
+        while (x < rect.xn && data[row + x] == published[row + x]) {
+          x++;
+        }
+        if (x == rect.xn) {
+          break;
+        }
+        std::uint32_t run_end = x + 1;
+        for (std::uint32_t i = run_end; i < rect.xn && i - run_end < max_run_gap; i++) {
+          if (data[row + i] != published[row + i]) {
+            run_end = i + 1;
+          }
+        }
+
+        msg->run_start.push_back(row + x);
+        msg->run_length.push_back(run_end - x);
+        msg->data.insert(msg->data.end(), data + row + x, data + row + run_end);
+        std::copy(data + row + x, data + row + run_end, published + row + x);
+        x = run_end;
+      }
     }
   }
+
+  if (msg->run_start.empty()) {
+    return nullptr;
+  }
+  msg->base_sequence = delta_sequence_;
+  msg->sequence = ++delta_sequence_;
+  deltas_since_keyframe_++;
+  return msg;
+}
+
+std::unique_ptr<nav2_msgs::msg::CostmapDeltaUpdate>
+Costmap2DPublisher::createCostmapDeltaKeyframeMsg()
+{
+  auto msg = std::make_unique<nav2_msgs::msg::CostmapDeltaUpdate>();
+
+  msg->header.stamp = clock_->now();
+  msg->header.frame_id = global_frame_;
+  msg->size_x = costmap_->getSizeInCellsX();
+  msg->size_y = costmap_->getSizeInCellsY();
+
+  const unsigned char * data = costmap_->getCharMap();
+  published_costs_.assign(data, data + msg->size_x * msg->size_y);
+  msg->run_start.push_back(0);
+  msg->run_length.push_back(published_costs_.size());
+  msg->data = published_costs_;
+
+  msg->sequence = ++delta_sequence_;
+  msg->base_sequence = msg->sequence;
+  deltas_since_keyframe_ = 0;
   return msg;
 }
 
 void Costmap2DPublisher::publishCostmap()
 {
+  // Delta updates only apply on top of a keyframe, which is sent along with the full
+  // costmap to bring new delta update subscribers in sync
+  const size_t delta_subscription_count =
+    costmap_raw_delta_update_pub_->get_subscription_count();
+  const bool new_delta_subscriber = delta_subscription_count > delta_subscription_count_;
+  delta_subscription_count_ = delta_subscription_count;
+  if (delta_subscription_count == 0 && !published_costs_.empty()) {
+    // The costs are published again along with a keyframe for the next subscriber
+    std::vector<unsigned char>().swap(published_costs_);
+  }
+
+  // Consumers in this process hold the shared costmap, which is brought up to date when
+  // the costmap changed or new consumers appeared
+  const size_t shared_consumer_count = static_cast<size_t>(shared_costmap_.use_count() - 1);
+  const bool new_shared_consumer = shared_consumer_count > shared_consumer_count_;
+  shared_consumer_count_ = shared_consumer_count;
+
+  // These consumers subscribe to the raw costmap and to one of its update topics, but ignore
+  // the messages, which are only built for the other subscribers. Those get the full costmap
+  // as they appear, since it is not left on the topic while only shared consumers follow it.
+  const size_t raw_subscription_count = costmap_raw_pub_->get_subscription_count();
+  const size_t unshared_raw_subscription_count = raw_subscription_count > shared_consumer_count ?
+    raw_subscription_count - shared_consumer_count : 0;
+  const bool new_unshared_raw_subscriber =
+    unshared_raw_subscription_count > unshared_raw_subscription_count_;
+  unshared_raw_subscription_count_ = unshared_raw_subscription_count;
+  const bool publish_raw_updates =
+    costmap_raw_update_pub_->get_subscription_count() + delta_subscription_count >
+    shared_consumer_count;
+  if (delta_subscription_count > 0 && !publish_raw_updates) {
+    // The delta updates resume from a keyframe once sent to other subscribers again
+    deltas_since_keyframe_ = delta_keyframe_period_;
+  }
+
   float resolution = costmap_->getResolution();
-  if (always_send_full_costmap_ || grid_resolution_ != resolution ||
+  if (always_send_full_costmap_ || new_delta_subscriber || new_unshared_raw_subscriber ||
+    grid_resolution_ != resolution ||
     grid_width_ != costmap_->getSizeInCellsX() ||
     grid_height_ != costmap_->getSizeInCellsY() ||
     saved_origin_x_ != costmap_->getOriginX() ||
@@ -244,21 +400,57 @@ void Costmap2DPublisher::publishCostmap()
       prepareGrid();
       costmap_pub_->publish(std::move(grid_));
     }
-    if (costmap_raw_pub_->get_subscription_count() > 0) {
+    std::unique_ptr<nav2_msgs::msg::CostmapDeltaUpdate> keyframe;
+    if (delta_subscription_count > 0 && publish_raw_updates) {
+      std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      keyframe = createCostmapDeltaKeyframeMsg();
+    }
+    if (unshared_raw_subscription_count > 0) {
       prepareCostmap();
+      // Delta update subscribers resume from the full costmap as they would from the keyframe
+      costmap_raw_->delta_sequence = keyframe ? keyframe->sequence : 0;
       costmap_raw_pub_->publish(std::move(costmap_raw_));
     }
+    if (keyframe) {
+      costmap_raw_delta_update_pub_->publish(std::move(keyframe));
+    }
+    if (shared_consumer_count > 0) {
+      std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      shared_costmap_->share(*costmap_, global_frame_, clock_->now());
+    }
   } else if (x0_ < xn_) {
     // Publish just update msgs
     std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
     if (costmap_update_pub_->get_subscription_count() > 0) {
       costmap_update_pub_->publish(createGridUpdateMsg());
     }
-    if (costmap_raw_update_pub_->get_subscription_count() > 0) {
+    if (costmap_raw_update_pub_->get_subscription_count() > 0 && publish_raw_updates) {
       costmap_raw_update_pub_->publish(createCostmapUpdateMsg());
     }
+    if (delta_subscription_count > 0 && publish_raw_updates) {
+      // Periodic keyframes resynchronize the subscribers which lost a delta update
+      if (deltas_since_keyframe_ >= delta_keyframe_period_) {
+        costmap_raw_delta_update_pub_->publish(createCostmapDeltaKeyframeMsg());
+      } else {
+        auto delta_msg = createCostmapDeltaUpdateMsg();
+        if (delta_msg) {
+          costmap_raw_delta_update_pub_->publish(std::move(delta_msg));
+        }
+      }
+    }
+    // The shared costmap was kept up to date unless there were no consumers, in which
+    // case it is shared again in full
+    if (new_shared_consumer) {
+      shared_costmap_->share(*costmap_, global_frame_, clock_->now());
+    } else if (shared_consumer_count > 0) {
+      shared_costmap_->shareChanges(*costmap_, global_frame_, clock_->now(), dirty_rects_);
+    }
+  } else if (new_shared_consumer) {
+    std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+    shared_costmap_->share(*costmap_, global_frame_, clock_->now());
   }
 
+  dirty_rects_.clear();
   xn_ = yn_ = 0;
   x0_ = costmap_->getSizeInCellsX();
   y0_ = costmap_->getSizeInCellsY();
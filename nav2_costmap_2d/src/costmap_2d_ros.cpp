@@ -38,6 +38,7 @@
 
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <chrono>
 #include <string>
@@ -115,6 +116,7 @@ void Costmap2DROS::init()
   declare_parameter("global_frame", rclcpp::ParameterValue(std::string("map")));
   declare_parameter("height", rclcpp::ParameterValue(5));
   declare_parameter("width", rclcpp::ParameterValue(5));
+  declare_parameter("layer_update_threads", rclcpp::ParameterValue(1));
   declare_parameter("lethal_cost_threshold", rclcpp::ParameterValue(100));
   declare_parameter("observation_sources", rclcpp::ParameterValue(std::string("")));
   declare_parameter("origin_x", rclcpp::ParameterValue(0.0));
@@ -157,6 +159,8 @@ Costmap2DROS::on_configure(const rclcpp_lifecycle::State & /*state*/)
   // Create the costmap itself
   layered_costmap_ = std::make_unique<LayeredCostmap>(
     global_frame_, rolling_window_, track_unknown_space_);
+  layered_costmap_->setLayerUpdateThreads(
+    static_cast<unsigned int>(std::max(layer_update_threads_, 0)));
 
   if (!layered_costmap_->isSizeLocked()) {
     layered_costmap_->resizeMap(
@@ -390,6 +394,7 @@ Costmap2DROS::getParameters()
   get_parameter("footprint_padding", footprint_padding_);
   get_parameter("global_frame", global_frame_);
   get_parameter("height", map_height_meters_);
+  get_parameter("layer_update_threads", layer_update_threads_);
   get_parameter("origin_x", origin_x_);
   get_parameter("origin_y", origin_y_);
   get_parameter("publish_frequency", map_publish_frequency_);
@@ -39,10 +39,75 @@
 #include <nav2_costmap_2d/costmap_layer.hpp>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 
 namespace nav2_costmap_2d
 {
 
+namespace
+{
+
+// Windows smaller than this are merged by the calling thread only, as waking up
+// the workers would cost more than the merge itself
+constexpr size_t MIN_PARALLEL_MERGE_CELLS = 1u << 16;
+
+#if defined(__GNUC__)
+// Block of cells processed at once with GCC / Clang vector extensions, which are lowered
+// to SSE2 or NEON instructions. Comparisons give masks of all ones or zeros per cell.
+using CellBlock = unsigned char __attribute__((vector_size(16)));
+
+template<typename Mask>
+inline CellBlock selectCells(Mask mask, CellBlock a, CellBlock b)
+{
+  const CellBlock m = reinterpret_cast<CellBlock>(mask);
+  return (a & m) | (b & ~m);
+}
+
+/**
+ * @brief Combine a row of a layer into the master grid, block by block then cell by cell
+ * @param master Start of the row in the master grid
+ * @param layer Start of the row in the layer
+ * @param n Number of cells in the row
+ * @param block_op Function combining a block of master and layer costs
+ * @param cell_op Function combining a master and a layer cost
+ */
+template<typename BlockOp, typename CellOp>
+inline void mergeRow(
+  unsigned char * master, const unsigned char * layer, size_t n,
+  BlockOp block_op, CellOp cell_op)
+{
+  size_t i = 0;
+  for (; i + sizeof(CellBlock) <= n; i += sizeof(CellBlock)) {
+    CellBlock old_cost, cost;
+    std::memcpy(&old_cost, master + i, sizeof(CellBlock));
+    std::memcpy(&cost, layer + i, sizeof(CellBlock));
+    const CellBlock result = block_op(old_cost, cost);
+    std::memcpy(master + i, &result, sizeof(CellBlock));
+  }
+  for (; i < n; i++) {
+    master[i] = cell_op(master[i], layer[i]);
+  }
+}
+#else
+/**
+ * @brief Combine a row of a layer into the master grid cell by cell
+ * @param master Start of the row in the master grid
+ * @param layer Start of the row in the layer
+ * @param n Number of cells in the row
+ * @param cell_op Function combining a master and a layer cost
+ */
+template<typename CellOp>
+inline void mergeRow(
+  unsigned char * master, const unsigned char * layer, size_t n, CellOp cell_op)
+{
+  for (size_t i = 0; i < n; i++) {
+    master[i] = cell_op(master[i], layer[i]);
+  }
+}
+#endif
+
+}  // namespace
+
 void CostmapLayer::touch(
   double x, double y, double * min_x, double * min_y, double * max_x,
   double * max_y)
@@ -116,24 +181,23 @@ void CostmapLayer::updateWithMax(
     return;
   }
 
-  unsigned char * master_array = master_grid.getCharMap();
-  unsigned int span = master_grid.getSizeInCellsX();
-
-  for (int j = min_j; j < max_j; j++) {
-    unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] == NO_INFORMATION) {
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION || old_cost < costmap_[it]) {
-        master_array[it] = costmap_[it];
-      }
-      it++;
-    }
-  }
+  mergeWindow(
+    master_grid, min_i, min_j, max_i, max_j,
+    [](unsigned char * master, const unsigned char * layer, size_t n) {
+      mergeRow(
+        master, layer, n,
+#if defined(__GNUC__)
+        [](CellBlock old_cost, CellBlock cost) {
+          return selectCells(
+            (cost != NO_INFORMATION) & ((old_cost == NO_INFORMATION) | (old_cost < cost)),
+            cost, old_cost);
+        },
+#endif
+        [](unsigned char old_cost, unsigned char cost) {
+          return cost != NO_INFORMATION && (old_cost == NO_INFORMATION || old_cost < cost) ?
+          cost : old_cost;
+        });
+    });
 }
 
 void CostmapLayer::updateWithMaxWithoutUnknownOverwrite(
@@ -145,24 +209,23 @@ void CostmapLayer::updateWithMaxWithoutUnknownOverwrite(
     return;
   }
 
-  unsigned char * master_array = master_grid.getCharMap();
-  unsigned int span = master_grid.getSizeInCellsX();
-
-  for (int j = min_j; j < max_j; j++) {
-    unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] == NO_INFORMATION) {
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost != NO_INFORMATION && old_cost < costmap_[it]) {
-        master_array[it] = costmap_[it];
-      }
-      it++;
-    }
-  }
+  mergeWindow(
+    master_grid, min_i, min_j, max_i, max_j,
+    [](unsigned char * master, const unsigned char * layer, size_t n) {
+      mergeRow(
+        master, layer, n,
+#if defined(__GNUC__)
+        [](CellBlock old_cost, CellBlock cost) {
+          return selectCells(
+            (cost != NO_INFORMATION) & (old_cost != NO_INFORMATION) & (old_cost < cost),
+            cost, old_cost);
+        },
+#endif
+        [](unsigned char old_cost, unsigned char cost) {
+          return cost != NO_INFORMATION && old_cost != NO_INFORMATION && old_cost < cost ?
+          cost : old_cost;
+        });
+    });
 }
 
 void CostmapLayer::updateWithTrueOverwrite(
@@ -179,16 +242,11 @@ void CostmapLayer::updateWithTrueOverwrite(
     throw std::runtime_error("Can't update costmap layer: It has't been initialized yet!");
   }
 
-  unsigned char * master = master_grid.getCharMap();
-  unsigned int span = master_grid.getSizeInCellsX();
-
-  for (int j = min_j; j < max_j; j++) {
-    unsigned int it = span * j + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      master[it] = costmap_[it];
-      it++;
-    }
-  }
+  mergeWindow(
+    master_grid, min_i, min_j, max_i, max_j,
+    [](unsigned char * master, const unsigned char * layer, size_t n) {
+      std::memcpy(master, layer, n);
+    });
 }
 
 void CostmapLayer::updateWithOverwrite(
@@ -198,18 +256,21 @@ void CostmapLayer::updateWithOverwrite(
   if (!enabled_) {
     return;
   }
-  unsigned char * master = master_grid.getCharMap();
-  unsigned int span = master_grid.getSizeInCellsX();
 
-  for (int j = min_j; j < max_j; j++) {
-    unsigned int it = span * j + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] != NO_INFORMATION) {
-        master[it] = costmap_[it];
-      }
-      it++;
-    }
-  }
+  mergeWindow(
+    master_grid, min_i, min_j, max_i, max_j,
+    [](unsigned char * master, const unsigned char * layer, size_t n) {
+      mergeRow(
+        master, layer, n,
+#if defined(__GNUC__)
+        [](CellBlock old_cost, CellBlock cost) {
+          return selectCells(cost != NO_INFORMATION, cost, old_cost);
+        },
+#endif
+        [](unsigned char old_cost, unsigned char cost) {
+          return cost != NO_INFORMATION ? cost : old_cost;
+        });
+    });
 }
 
 void CostmapLayer::updateWithAddition(
@@ -219,30 +280,64 @@ void CostmapLayer::updateWithAddition(
   if (!enabled_) {
     return;
   }
+
+  mergeWindow(
+    master_grid, min_i, min_j, max_i, max_j,
+    [](unsigned char * master, const unsigned char * layer, size_t n) {
+      mergeRow(
+        master, layer, n,
+#if defined(__GNUC__)
+        [](CellBlock old_cost, CellBlock cost) {
+          // Both costs are known, so the sum only wraps around when it exceeds 255
+          const CellBlock sum = old_cost + cost;
+          const CellBlock limit = CellBlock{} + (INSCRIBED_INFLATED_OBSTACLE - 1);
+          const CellBlock capped = selectCells((sum < old_cost) | (sum > limit), limit, sum);
+          return selectCells(
+            cost == NO_INFORMATION, old_cost,
+            selectCells(old_cost == NO_INFORMATION, cost, capped));
+        },
+#endif
+        [](unsigned char old_cost, unsigned char cost) {
+          if (cost == NO_INFORMATION) {
+            return old_cost;
+          }
+          if (old_cost == NO_INFORMATION) {
+            return cost;
+          }
+          return static_cast<unsigned char>(
+            std::min(old_cost + cost, INSCRIBED_INFLATED_OBSTACLE - 1));
+        });
+    });
+}
+
+template<typename RowFunction>
+void CostmapLayer::mergeWindow(
+  nav2_costmap_2d::Costmap2D & master_grid,
+  int min_i, int min_j, int max_i, int max_j, RowFunction row_fn)
+{
+  if (max_i <= min_i || max_j <= min_j) {
+    return;
+  }
+
   unsigned char * master_array = master_grid.getCharMap();
-  unsigned int span = master_grid.getSizeInCellsX();
+  const unsigned char * layer_array = costmap_;
+  const size_t span = master_grid.getSizeInCellsX();
+  const size_t width = static_cast<size_t>(max_i - min_i);
+  const size_t height = static_cast<size_t>(max_j - min_j);
 
-  for (int j = min_j; j < max_j; j++) {
-    unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] == NO_INFORMATION) {
-        it++;
-        continue;
+  auto merge_rows = [&](size_t begin, size_t end) {
+      for (size_t j = begin; j != end; j++) {
+        const size_t it = (min_j + j) * span + min_i;
+        row_fn(master_array + it, layer_array + it, width);
       }
+    };
 
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION) {
-        master_array[it] = costmap_[it];
-      } else {
-        int sum = old_cost + costmap_[it];
-        if (sum >= nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE) {
-          master_array[it] = nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1;
-        } else {
-          master_array[it] = sum;
-        }
-      }
-      it++;
-    }
+  nav2_util::ThreadPool * thread_pool =
+    layered_costmap_ ? layered_costmap_->getThreadPool() : nullptr;
+  if (thread_pool && width * height >= MIN_PARALLEL_MERGE_CELLS) {
+    thread_pool->parallelFor(height, merge_rows);
+  } else {
+    merge_rows(0, height);
   }
 }
 
@@ -25,7 +25,8 @@ constexpr int costmapUpdateQueueDepth = 10;
 
 CostmapSubscriber::CostmapSubscriber(
   const nav2_util::LifecycleNode::WeakPtr & parent,
-  const std::string & topic_name)
+  const std::string & topic_name,
+  bool use_delta_updates)
 : topic_name_(topic_name)
 {
   auto node = parent.lock();
@@ -34,15 +35,29 @@ CostmapSubscriber::CostmapSubscriber(
     topic_name_,
     rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
     std::bind(&CostmapSubscriber::costmapCallback, this, std::placeholders::_1));
-  costmap_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapUpdate>(
-    topic_name_ + "_updates",
-    rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
-    std::bind(&CostmapSubscriber::costmapUpdateCallback, this, std::placeholders::_1));
+  if (use_delta_updates) {
+    costmap_delta_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapDeltaUpdate>(
+      topic_name_ + "_delta_updates",
+      rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
+      std::bind(
+        &CostmapSubscriber::costmapDeltaUpdateCallback, this, std::placeholders::_1));
+  } else {
+    costmap_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapUpdate>(
+      topic_name_ + "_updates",
+      rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
+      std::bind(&CostmapSubscriber::costmapUpdateCallback, this, std::placeholders::_1));
+  }
+  // Nodes composed with intra-process communications read the costmap directly from its
+  // publisher when it runs in the same process
+  if (node->get_node_options().use_intra_process_comms()) {
+    shared_costmap_ = SharedCostmap::get(costmap_sub_->get_topic_name());
+  }
 }
 
 CostmapSubscriber::CostmapSubscriber(
   const rclcpp::Node::WeakPtr & parent,
-  const std::string & topic_name)
+  const std::string & topic_name,
+  bool use_delta_updates)
 : topic_name_(topic_name)
 {
   auto node = parent.lock();
@@ -51,14 +66,45 @@ CostmapSubscriber::CostmapSubscriber(
     topic_name_,
     rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
     std::bind(&CostmapSubscriber::costmapCallback, this, std::placeholders::_1));
-  costmap_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapUpdate>(
-    topic_name_ + "_updates",
-    rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
-    std::bind(&CostmapSubscriber::costmapUpdateCallback, this, std::placeholders::_1));
+  if (use_delta_updates) {
+    costmap_delta_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapDeltaUpdate>(
+      topic_name_ + "_delta_updates",
+      rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
+      std::bind(
+        &CostmapSubscriber::costmapDeltaUpdateCallback, this, std::placeholders::_1));
+  } else {
+    costmap_update_sub_ = node->create_subscription<nav2_msgs::msg::CostmapUpdate>(
+      topic_name_ + "_updates",
+      rclcpp::QoS(rclcpp::KeepLast(costmapUpdateQueueDepth)).transient_local().reliable(),
+      std::bind(&CostmapSubscriber::costmapUpdateCallback, this, std::placeholders::_1));
+  }
+  // Nodes composed with intra-process communications read the costmap directly from its
+  // publisher when it runs in the same process
+  if (node->get_node_options().use_intra_process_comms()) {
+    shared_costmap_ = SharedCostmap::get(costmap_sub_->get_topic_name());
+  }
 }
 
 std::shared_ptr<Costmap2D> CostmapSubscriber::getCostmap()
 {
+  auto snapshot = getCostmapSnapshot();
+  if (snapshot) {
+    if (!isCostmapReceived()) {
+      costmap_ = std::make_shared<Costmap2D>(
+        snapshot->getSizeInCellsX(), snapshot->getSizeInCellsY(),
+        snapshot->getResolution(), snapshot->getOriginX(), snapshot->getOriginY());
+    }
+    if (snapshot->getVersion() != shared_costmap_version_) {
+      std::lock_guard<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      // Only the changed cells are copied when the costmap holds the previous snapshot
+      if (!snapshot->copyChangesTo(*costmap_, shared_costmap_version_)) {
+        snapshot->copyTo(*costmap_);
+      }
+      shared_costmap_version_ = snapshot->getVersion();
+    }
+    return costmap_;
+  }
+
   if (!isCostmapReceived()) {
     throw std::runtime_error("Costmap is not available");
   }
@@ -68,12 +114,25 @@ std::shared_ptr<Costmap2D> CostmapSubscriber::getCostmap()
   return costmap_;
 }
 
+std::shared_ptr<const CostmapSnapshot> CostmapSubscriber::getCostmapSnapshot()
+{
+  return shared_costmap_ ? shared_costmap_->getSnapshot() : nullptr;
+}
+
 void CostmapSubscriber::costmapCallback(const nav2_msgs::msg::Costmap::SharedPtr msg)
 {
+  if (isCostmapShared()) {
+    return;
+  }
+
   {
     std::lock_guard<std::mutex> lock(costmap_msg_mutex_);
     costmap_msg_ = msg;
   }
+  // The full costmap holds the same costs as the keyframe it is sent along with, so the
+  // delta updates resume from it
+  delta_sequence_ = msg->delta_sequence;
+  delta_synced_ = msg->delta_sequence != 0;
   if (!isCostmapReceived()) {
     costmap_ = std::make_shared<Costmap2D>(
       msg->metadata.size_x, msg->metadata.size_y,
@@ -87,6 +146,10 @@ void CostmapSubscriber::costmapCallback(const nav2_msgs::msg::Costmap::SharedPtr
 void CostmapSubscriber::costmapUpdateCallback(
   const nav2_msgs::msg::CostmapUpdate::SharedPtr update_msg)
 {
+  if (isCostmapShared()) {
+    return;
+  }
+
   if (isCostmapReceived()) {
     if (costmap_msg_) {
       processCurrentCostmapMsg();
@@ -121,6 +184,64 @@ void CostmapSubscriber::costmapUpdateCallback(
   }
 }
 
+void CostmapSubscriber::costmapDeltaUpdateCallback(
+  const nav2_msgs::msg::CostmapDeltaUpdate::SharedPtr update_msg)
+{
+  if (isCostmapShared()) {
+    return;
+  }
+
+  if (isCostmapReceived()) {
+    if (costmap_msg_) {
+      processCurrentCostmapMsg();
+    }
+
+    std::lock_guard<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+
+    const bool keyframe = update_msg->base_sequence == update_msg->sequence;
+    if (!keyframe && (!delta_synced_ || update_msg->base_sequence != delta_sequence_)) {
+      if (delta_synced_) {
+        RCLCPP_WARN_STREAM(
+          logger_, "Delta update " << update_msg->sequence <<
+            " follows a lost update, discarding the delta updates until the next keyframe.");
+      }
+      delta_synced_ = false;
+      return;
+    }
+
+    if (costmap_->getSizeInCellsX() != update_msg->size_x ||
+      costmap_->getSizeInCellsY() != update_msg->size_y ||
+      update_msg->run_start.size() != update_msg->run_length.size())
+    {
+      RCLCPP_WARN(
+        logger_, "Delta update does not match the costmap. Costmap bounds: %d X %d, "
+        "Update bounds: %d X %d", costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY(),
+        update_msg->size_x, update_msg->size_y);
+      delta_synced_ = false;
+      return;
+    }
+
+    const size_t map_size = static_cast<size_t>(update_msg->size_x) * update_msg->size_y;
+    unsigned char * master_array = costmap_->getCharMap();
+    size_t offset = 0;
+    for (size_t i = 0; i < update_msg->run_start.size(); ++i) {
+      const size_t start = update_msg->run_start[i];
+      const size_t length = update_msg->run_length[i];
+      if (start + length > map_size || offset + length > update_msg->data.size()) {
+        RCLCPP_WARN(logger_, "Delta update run %zu outside of original map area.", i);
+        delta_synced_ = false;
+        return;
+      }
+      std::copy_n(update_msg->data.begin() + offset, length, &master_array[start]);
+      offset += length;
+    }
+    delta_sequence_ = update_msg->sequence;
+    delta_synced_ = true;
+  } else {
+    RCLCPP_WARN(logger_, "No costmap received.");
+  }
+}
+
 void CostmapSubscriber::processCurrentCostmapMsg()
 {
   std::scoped_lock lock(*(costmap_->getMutex()), costmap_msg_mutex_);
@@ -39,7 +39,8 @@ CostmapTopicCollisionChecker::CostmapTopicCollisionChecker(
 : name_(name),
   costmap_sub_(costmap_sub),
   footprint_sub_(footprint_sub),
-  collision_checker_(nullptr)
+  collision_checker_(nullptr),
+  snapshot_collision_checker_(nullptr)
 {}
 
 bool CostmapTopicCollisionChecker::isCollisionFree(
@@ -68,20 +69,32 @@ double CostmapTopicCollisionChecker::scorePose(
   bool fetch_costmap_and_footprint)
 {
   if (fetch_costmap_and_footprint) {
-    try {
-      collision_checker_.setCostmap(costmap_sub_.getCostmap());
-    } catch (const std::runtime_error & e) {
-      throw CollisionCheckerException(e.what());
+    auto snapshot = costmap_sub_.getCostmapSnapshot();
+    use_snapshot_ = snapshot != nullptr;
+    if (use_snapshot_) {
+      snapshot_collision_checker_.setCostmap(snapshot);
+    } else {
+      try {
+        collision_checker_.setCostmap(costmap_sub_.getCostmap());
+      } catch (const std::runtime_error & e) {
+        throw CollisionCheckerException(e.what());
+      }
     }
   }
 
   unsigned int cell_x, cell_y;
-  if (!collision_checker_.worldToMap(pose.x, pose.y, cell_x, cell_y)) {
+  bool on_grid = use_snapshot_ ?
+    snapshot_collision_checker_.worldToMap(pose.x, pose.y, cell_x, cell_y) :
+    collision_checker_.worldToMap(pose.x, pose.y, cell_x, cell_y);
+  if (!on_grid) {
     RCLCPP_DEBUG(rclcpp::get_logger(name_), "Map Cell: [%d, %d]", cell_x, cell_y);
     throw IllegalPoseException(name_, "Pose Goes Off Grid.");
   }
 
-  return collision_checker_.footprintCost(getFootprint(pose, fetch_costmap_and_footprint));
+  Footprint footprint = getFootprint(pose, fetch_costmap_and_footprint);
+  return use_snapshot_ ?
+         snapshot_collision_checker_.footprintCost(footprint) :
+         collision_checker_.footprintCost(footprint);
 }
 
 Footprint CostmapTopicCollisionChecker::getFootprint(
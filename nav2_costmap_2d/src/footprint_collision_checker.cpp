@@ -18,12 +18,16 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <utility>
+#include <iterator>
 
 #include "nav2_costmap_2d/footprint_collision_checker.hpp"
 
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_costmap_2d/exceptions.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
+#include "nav2_costmap_2d/shared_costmap.hpp"
 #include "nav2_util/line_iterator.hpp"
 
 using namespace std::chrono_literals;
@@ -143,8 +147,159 @@ double FootprintCollisionChecker<CostmapT>::footprintCostAtPose(
   return footprintCost(oriented_footprint);
 }
 
+template<typename CostmapT>
+void FootprintCollisionChecker<CostmapT>::setFootprintStencils(
+  const Footprint & footprint, unsigned int num_angle_bins, bool fill_interior)
+{
+  stencils_.clear();
+  stencils_.resize(std::max(num_angle_bins, 1u));
+  const double resolution = costmap_->getResolution();
+  const unsigned int size_x = costmap_->getSizeInCellsX();
+  const double bin_size = 2.0 * M_PI / static_cast<double>(stencils_.size());
+
+  for (unsigned int bin = 0; bin != stencils_.size(); ++bin) {
+    const double cos_th = cos(bin_size * bin);
+    const double sin_th = sin(bin_size * bin);
+
+    // Footprint vertices in cells, from the center of the origin's cell
+    std::vector<std::pair<int, int>> vertices;
+    vertices.reserve(footprint.size());
+    for (const auto & pt : footprint) {
+      vertices.emplace_back(
+        static_cast<int>(std::floor((pt.x * cos_th - pt.y * sin_th) / resolution + 0.5)),
+        static_cast<int>(std::floor((pt.x * sin_th + pt.y * cos_th) / resolution + 0.5)));
+    }
+    if (vertices.empty()) {
+      vertices.emplace_back(0, 0);
+    }
+
+    // Edges are rasterized as in footprintCost, the closing one from the first point
+    // to the last, so that stencils cover the same cells
+    std::vector<std::pair<int, int>> cells;
+    for (unsigned int i = 0; i != vertices.size(); ++i) {
+      const bool closing = i + 1 == vertices.size();
+      const auto & start = closing ? vertices.front() : vertices[i];
+      const auto & end = closing ? vertices.back() : vertices[i + 1];
+      for (nav2_util::LineIterator line(start.first, start.second, end.first, end.second);
+        line.isValid(); line.advance())
+      {
+        // Ordered by row for memory locality
+        cells.emplace_back(line.getY(), line.getX());
+      }
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    if (fill_interior) {
+      std::vector<std::pair<int, int>> filled;
+      for (auto row_start = cells.begin(); row_start != cells.end(); ) {
+        auto row_end = row_start;
+        while (row_end != cells.end() && row_end->first == row_start->first) {
+          ++row_end;
+        }
+        for (int x = row_start->second; x <= std::prev(row_end)->second; ++x) {
+          filled.emplace_back(row_start->first, x);
+        }
+        row_start = row_end;
+      }
+      cells.swap(filled);
+    }
+
+    FootprintStencil & stencil = stencils_[bin];
+    stencil.dx.reserve(cells.size());
+    stencil.dy.reserve(cells.size());
+    stencil.offsets.reserve(cells.size());
+    stencil.size_x = size_x;
+    stencil.min_dx = stencil.max_dx = cells.front().second;
+    stencil.min_dy = stencil.max_dy = cells.front().first;
+    for (const auto & cell : cells) {
+      stencil.dx.push_back(cell.second);
+      stencil.dy.push_back(cell.first);
+      stencil.offsets.push_back(cell.first * static_cast<int>(size_x) + cell.second);
+      stencil.min_dx = std::min(stencil.min_dx, cell.second);
+      stencil.max_dx = std::max(stencil.max_dx, cell.second);
+      stencil.min_dy = std::min(stencil.min_dy, cell.first);
+      stencil.max_dy = std::max(stencil.max_dy, cell.first);
+    }
+  }
+}
+
+template<typename CostmapT>
+unsigned int FootprintCollisionChecker<CostmapT>::getAngleBin(double theta) const
+{
+  const int num_bins = static_cast<int>(std::max(stencils_.size(), size_t{1}));
+  int bin = static_cast<int>(std::floor(theta / (2.0 * M_PI) * num_bins + 0.5)) % num_bins;
+  return static_cast<unsigned int>(bin < 0 ? bin + num_bins : bin);
+}
+
+template<typename CostmapT>
+double FootprintCollisionChecker<CostmapT>::footprintCostAtCell(
+  unsigned int mx, unsigned int my, unsigned int angle_bin) const
+{
+  const FootprintStencil & stencil = stencils_[angle_bin];
+  const int size_x = static_cast<int>(costmap_->getSizeInCellsX());
+  const int size_y = static_cast<int>(costmap_->getSizeInCellsY());
+  const int x = static_cast<int>(mx);
+  const int y = static_cast<int>(my);
+
+  // Partially outside of the map, check each cell on its own
+  if (x + stencil.min_dx < 0 || y + stencil.min_dy < 0 ||
+    x + stencil.max_dx >= size_x || y + stencil.max_dy >= size_y)
+  {
+    double footprint_cost = 0.0;
+    for (unsigned int i = 0; i != stencil.dx.size(); ++i) {
+      const int cx = x + stencil.dx[i];
+      const int cy = y + stencil.dy[i];
+      if (cx < 0 || cy < 0 || cx >= size_x || cy >= size_y) {
+        return static_cast<double>(LETHAL_OBSTACLE);
+      }
+      footprint_cost = std::max(pointCost(cx, cy), footprint_cost);
+      if (footprint_cost == static_cast<double>(LETHAL_OBSTACLE)) {
+        return footprint_cost;
+      }
+    }
+    return footprint_cost;
+  }
+
+  const unsigned char * char_map = costmap_->getCharMap() + y * size_x + x;
+  unsigned char footprint_cost = 0;
+
+  // The costmap width changed since the stencils were made, offsets are computed as used
+  if (stencil.size_x != static_cast<unsigned int>(size_x)) {
+    for (unsigned int i = 0; i != stencil.dx.size(); ++i) {
+      const unsigned char cost = char_map[stencil.dy[i] * size_x + stencil.dx[i]];
+      if (cost == LETHAL_OBSTACLE) {
+        return static_cast<double>(LETHAL_OBSTACLE);
+      }
+      footprint_cost = std::max(cost, footprint_cost);
+    }
+    return static_cast<double>(footprint_cost);
+  }
+
+  for (const int offset : stencil.offsets) {
+    const unsigned char cost = char_map[offset];
+    if (cost == LETHAL_OBSTACLE) {
+      return static_cast<double>(LETHAL_OBSTACLE);
+    }
+    footprint_cost = std::max(cost, footprint_cost);
+  }
+  return static_cast<double>(footprint_cost);
+}
+
+template<typename CostmapT>
+double FootprintCollisionChecker<CostmapT>::footprintStencilCostAtPose(
+  double x, double y, double theta)
+{
+  unsigned int mx, my;
+  if (!worldToMap(x, y, mx, my)) {
+    return static_cast<double>(LETHAL_OBSTACLE);
+  }
+  return footprintCostAtCell(mx, my, getAngleBin(theta));
+}
+
 // declare our valid template parameters
 template class FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>;
 template class FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>;
+template class FootprintCollisionChecker<std::shared_ptr<const nav2_costmap_2d::CostmapSnapshot>>;
 
 }  // namespace nav2_costmap_2d
@@ -38,9 +38,11 @@
 #include "nav2_costmap_2d/layered_costmap.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <limits>
 
@@ -158,23 +160,32 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   minx_ = miny_ = std::numeric_limits<double>::max();
   maxx_ = maxy_ = std::numeric_limits<double>::lowest();
 
+  const bool concurrent = thread_pool_ && thread_pool_->size() > 1u;
   for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
-    plugin != plugins_.end(); ++plugin)
+    plugin != plugins_.end(); )
   {
+    if (concurrent && (*plugin)->isIndependent()) {
+      // Group consecutive independent plugins, as a dependent one may rely on
+      // the bounds of all the plugins before it
+      vector<std::shared_ptr<Layer>>::iterator group_end = plugin;
+      while (group_end != plugins_.end() && (*group_end)->isIndependent()) {
+        ++group_end;
+      }
+      if (group_end - plugin > 1) {
+        updateIndependentBounds(plugin, group_end, robot_x, robot_y, robot_yaw);
+        plugin = group_end;
+        continue;
+      }
+    }
+
     double prev_minx = minx_;
     double prev_miny = miny_;
     double prev_maxx = maxx_;
     double prev_maxy = maxy_;
     (*plugin)->updateBounds(robot_x, robot_y, robot_yaw, &minx_, &miny_, &maxx_, &maxy_);
-    if (minx_ > prev_minx || miny_ > prev_miny || maxx_ < prev_maxx || maxy_ < prev_maxy) {
-      RCLCPP_WARN(
-        rclcpp::get_logger(
-          "nav2_costmap_2d"), "Illegal bounds change, was [tl: (%f, %f), br: (%f, %f)], but "
-        "is now [tl: (%f, %f), br: (%f, %f)]. The offending layer is %s",
-        prev_minx, prev_miny, prev_maxx, prev_maxy,
-        minx_, miny_, maxx_, maxy_,
-        (*plugin)->getName().c_str());
-    }
+    checkBoundsChange(
+      **plugin, "layer", prev_minx, prev_miny, prev_maxx, prev_maxy, minx_, miny_, maxx_, maxy_);
+    ++plugin;
   }
   for (vector<std::shared_ptr<Layer>>::iterator filter = filters_.begin();
     filter != filters_.end(); ++filter)
@@ -184,15 +195,8 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     double prev_maxx = maxx_;
     double prev_maxy = maxy_;
     (*filter)->updateBounds(robot_x, robot_y, robot_yaw, &minx_, &miny_, &maxx_, &maxy_);
-    if (minx_ > prev_minx || miny_ > prev_miny || maxx_ < prev_maxx || maxy_ < prev_maxy) {
-      RCLCPP_WARN(
-        rclcpp::get_logger(
-          "nav2_costmap_2d"), "Illegal bounds change, was [tl: (%f, %f), br: (%f, %f)], but "
-        "is now [tl: (%f, %f), br: (%f, %f)]. The offending filter is %s",
-        prev_minx, prev_miny, prev_maxx, prev_maxy,
-        minx_, miny_, maxx_, maxy_,
-        (*filter)->getName().c_str());
-    }
+    checkBoundsChange(
+      **filter, "filter", prev_minx, prev_miny, prev_maxx, prev_maxy, minx_, miny_, maxx_, maxy_);
   }
 
   int x0, xn, y0, yn;
@@ -257,6 +261,64 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   initialized_ = true;
 }
 
+void LayeredCostmap::updateIndependentBounds(
+  vector<std::shared_ptr<Layer>>::iterator begin,
+  vector<std::shared_ptr<Layer>>::iterator end,
+  double robot_x, double robot_y, double robot_yaw)
+{
+  const size_t num_plugins = static_cast<size_t>(end - begin);
+  vector<std::array<double, 4>> bounds(num_plugins, {minx_, miny_, maxx_, maxy_});
+
+  thread_pool_->parallelTasks(
+    num_plugins, [&](size_t i) {
+      std::array<double, 4> & b = bounds[i];
+      (*(begin + i))->updateBounds(robot_x, robot_y, robot_yaw, &b[0], &b[1], &b[2], &b[3]);
+    });
+
+  const double prev_minx = minx_;
+  const double prev_miny = miny_;
+  const double prev_maxx = maxx_;
+  const double prev_maxy = maxy_;
+  for (size_t i = 0; i != num_plugins; i++) {
+    const std::array<double, 4> & b = bounds[i];
+    checkBoundsChange(
+      **(begin + i), "layer", prev_minx, prev_miny, prev_maxx, prev_maxy, b[0], b[1], b[2], b[3]);
+    minx_ = std::min(minx_, b[0]);
+    miny_ = std::min(miny_, b[1]);
+    maxx_ = std::max(maxx_, b[2]);
+    maxy_ = std::max(maxy_, b[3]);
+  }
+}
+
+void LayeredCostmap::checkBoundsChange(
+  const Layer & layer, const char * kind,
+  double prev_minx, double prev_miny, double prev_maxx, double prev_maxy,
+  double minx, double miny, double maxx, double maxy) const
+{
+  if (minx > prev_minx || miny > prev_miny || maxx < prev_maxx || maxy < prev_maxy) {
+    RCLCPP_WARN(
+      rclcpp::get_logger(
+        "nav2_costmap_2d"), "Illegal bounds change, was [tl: (%f, %f), br: (%f, %f)], but "
+      "is now [tl: (%f, %f), br: (%f, %f)]. The offending %s is %s",
+      prev_minx, prev_miny, prev_maxx, prev_maxy,
+      minx, miny, maxx, maxy,
+      kind, layer.getName().c_str());
+  }
+}
+
+void LayeredCostmap::setLayerUpdateThreads(unsigned int num_threads)
+{
+  std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  if (num_threads > 1u) {
+    thread_pool_ = std::make_unique<nav2_util::ThreadPool>(num_threads);
+  } else {
+    thread_pool_.reset();
+  }
+}
+
 bool LayeredCostmap::isCurrent()
 {
   current_ = true;
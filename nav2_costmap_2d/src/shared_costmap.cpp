@@ -0,0 +1,180 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/shared_costmap.hpp"
+
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace nav2_costmap_2d
+{
+
+bool CostmapSnapshot::worldToMap(
+  double wx, double wy, unsigned int & mx, unsigned int & my) const
+{
+  if (wx < origin_x_ || wy < origin_y_) {
+    return false;
+  }
+
+  mx = static_cast<unsigned int>((wx - origin_x_) / resolution_);
+  my = static_cast<unsigned int>((wy - origin_y_) / resolution_);
+
+  return mx < size_x_ && my < size_y_;
+}
+
+void CostmapSnapshot::copyTo(Costmap2D & costmap) const
+{
+  if (costmap.getSizeInCellsX() != size_x_ || costmap.getSizeInCellsY() != size_y_ ||
+    costmap.getResolution() != resolution_ ||
+    costmap.getOriginX() != origin_x_ || costmap.getOriginY() != origin_y_)
+  {
+    costmap.resizeMap(size_x_, size_y_, resolution_, origin_x_, origin_y_);
+  }
+  std::copy(data_.begin(), data_.end(), costmap.getCharMap());
+}
+
+bool CostmapSnapshot::copyChangesTo(Costmap2D & costmap, uint64_t version) const
+{
+  if (!changes_known_ || version + 1 != version_ ||
+    costmap.getSizeInCellsX() != size_x_ || costmap.getSizeInCellsY() != size_y_ ||
+    costmap.getResolution() != resolution_ ||
+    costmap.getOriginX() != origin_x_ || costmap.getOriginY() != origin_y_)
+  {
+    return false;
+  }
+
+  unsigned char * charmap = costmap.getCharMap();
+  for (const auto & bounds : changes_) {
+    const unsigned int xn = std::min(bounds.xn, size_x_);
+    const unsigned int yn = std::min(bounds.yn, size_y_);
+    for (unsigned int y = bounds.y0; y < yn && bounds.x0 < xn; y++) {
+      std::copy(
+        data_.begin() + y * size_x_ + bounds.x0, data_.begin() + y * size_x_ + xn,
+        charmap + y * size_x_ + bounds.x0);
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<SharedCostmap> SharedCostmap::get(const std::string & topic_name)
+{
+  // Only weak references are kept, so that a shared costmap is released along with
+  // the last publisher or consumer of its topic
+  static std::mutex registry_mutex;
+  static std::unordered_map<std::string, std::weak_ptr<SharedCostmap>> registry;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto & entry = registry[topic_name];
+  auto shared_costmap = entry.lock();
+  if (!shared_costmap) {
+    shared_costmap = std::make_shared<SharedCostmap>();
+    entry = shared_costmap;
+  }
+  return shared_costmap;
+}
+
+std::shared_ptr<const CostmapSnapshot> SharedCostmap::getSnapshot() const
+{
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  return snapshot_;
+}
+
+void SharedCostmap::share(
+  const Costmap2D & costmap, const std::string & frame_id,
+  const builtin_interfaces::msg::Time & stamp)
+{
+  shareSnapshot(costmap, frame_id, stamp, nullptr);
+}
+
+void SharedCostmap::shareChanges(
+  const Costmap2D & costmap, const std::string & frame_id,
+  const builtin_interfaces::msg::Time & stamp, const std::vector<CellBounds> & changes)
+{
+  shareSnapshot(costmap, frame_id, stamp, &changes);
+}
+
+void SharedCostmap::shareSnapshot(
+  const Costmap2D & costmap, const std::string & frame_id,
+  const builtin_interfaces::msg::Time & stamp, const std::vector<CellBounds> * changes)
+{
+  // Consumers can only acquire the current snapshot, so once the spare one is released
+  // by all of them it can safely be written again
+  std::shared_ptr<CostmapSnapshot> snapshot;
+  const bool reuse = spare_snapshot_ && spare_snapshot_.use_count() == 1;
+  if (reuse) {
+    snapshot = std::move(spare_snapshot_);
+  } else {
+    snapshot = std::make_shared<CostmapSnapshot>();
+  }
+
+  const unsigned int size_x = costmap.getSizeInCellsX();
+  const unsigned int size_y = costmap.getSizeInCellsY();
+  // The spare snapshot is two changes behind the costmap, and can only be patched when
+  // both of them are known and the geometry is the same
+  const bool patch = reuse && changes && !last_change_full_ &&
+    snapshot->version_ + 1 == version_ &&
+    snapshot->size_x_ == size_x && snapshot->size_y_ == size_y &&
+    snapshot->resolution_ == costmap.getResolution() &&
+    snapshot->origin_x_ == costmap.getOriginX() &&
+    snapshot->origin_y_ == costmap.getOriginY() && snapshot->frame_id_ == frame_id;
+
+  snapshot->version_ = ++version_;
+  snapshot->frame_id_ = frame_id;
+  snapshot->stamp_ = stamp;
+  snapshot->size_x_ = size_x;
+  snapshot->size_y_ = size_y;
+  snapshot->resolution_ = costmap.getResolution();
+  snapshot->origin_x_ = costmap.getOriginX();
+  snapshot->origin_y_ = costmap.getOriginY();
+  const unsigned char * data = costmap.getCharMap();
+  if (patch) {
+    auto copy = [&](const CellBounds & bounds) {
+        const unsigned int xn = std::min(bounds.xn, size_x);
+        const unsigned int yn = std::min(bounds.yn, size_y);
+        for (unsigned int y = bounds.y0; y < yn && bounds.x0 < xn; y++) {
+          std::copy(
+            data + y * size_x + bounds.x0, data + y * size_x + xn,
+            snapshot->data_.begin() + y * size_x + bounds.x0);
+        }
+      };
+    std::for_each(last_changes_.begin(), last_changes_.end(), copy);
+    std::for_each(changes->begin(), changes->end(), copy);
+  } else {
+    snapshot->data_.assign(data, data + size_x * size_y);
+  }
+  if (changes) {
+    last_changes_ = *changes;
+    snapshot->changes_ = *changes;
+  } else {
+    snapshot->changes_.clear();
+  }
+  last_change_full_ = !changes;
+  snapshot->changes_known_ = changes != nullptr;
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  spare_snapshot_ = std::move(snapshot_);
+  snapshot_ = std::move(snapshot);
+}
+
+void SharedCostmap::clear()
+{
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  snapshot_.reset();
+  last_change_full_ = true;
+}
+
+}  // namespace nav2_costmap_2d
@@ -34,8 +34,10 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <limits>
 #include <map>
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -599,6 +601,222 @@ TEST_F(TestNode, testInflation3)
   ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 4u);
 }
 
+/**
+ * Test that incremental inflation matches a full reinflation of the same obstacles
+ */
+TEST_F(TestNode, testIncrementalInflation)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.cost_scaling_factor", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_mode", std::string("incremental")));
+  initNode(parameters);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1);
+
+  std::shared_ptr<nav2_costmap_2d::StaticLayer> slayer = nullptr;
+  addStaticLayer(layers, tf, node_, slayer);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+  layers.setFootprint(polygon);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  waitForMap(slayer);
+
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 20u);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 28u);
+
+  addObservation(olayer, 0, 0, 0.4);
+  layers.updateMap(0, 0, 0);
+  addObservation(olayer, 2, 0);
+  layers.updateMap(0, 0, 0);
+  addObservation(olayer, 1, 9);
+  layers.updateMap(0, 0, 0);
+  addObservation(olayer, 0, 9);
+  layers.updateMap(0, 0, 0);
+
+  ASSERT_EQ(costmap->getCost(0, 9), nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(costmap->getCost(2, 9), nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+
+  nav2_costmap_2d::Costmap2D incremental(*costmap);
+
+  node_->set_parameter(rclcpp::Parameter("inflation.inflation_mode", std::string("full")));
+  layers.updateMap(0, 0, 0);
+
+  for (unsigned int j = 0; j < costmap->getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < costmap->getSizeInCellsX(); ++i) {
+      EXPECT_EQ(incremental.getCost(i, j), costmap->getCost(i, j));
+    }
+  }
+}
+
+/**
+ * Test that resizing the map requests a full reinflation
+ */
+TEST_F(TestNode, testReinflationAfterResize)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_mode", std::string("incremental")));
+  initNode(parameters);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+
+  layers.updateMap(0, 0, 0);
+
+  // Once inflated, only the bounds around changes are updated
+  double min_x = 1.0, min_y = 1.0, max_x = 2.0, max_y = 2.0;
+  ilayer->updateBounds(0, 0, 0, &min_x, &min_y, &max_x, &max_y);
+  EXPECT_GT(min_x, std::numeric_limits<double>::lowest());
+  EXPECT_LT(max_x, std::numeric_limits<double>::max());
+
+  layers.resizeMap(20, 20, 1, 0, 0);
+  ilayer->updateBounds(0, 0, 0, &min_x, &min_y, &max_x, &max_y);
+  EXPECT_EQ(min_x, std::numeric_limits<double>::lowest());
+  EXPECT_EQ(min_y, std::numeric_limits<double>::lowest());
+  EXPECT_EQ(max_x, std::numeric_limits<double>::max());
+  EXPECT_EQ(max_y, std::numeric_limits<double>::max());
+}
+
+/**
+ * Test that the distance transform inflation matches the default inflation
+ */
+TEST_F(TestNode, testDistanceTransformInflation)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.cost_scaling_factor", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 1.0));
+  parameters.push_back(
+    rclcpp::Parameter("inflation.inflation_mode", std::string("distance_transform")));
+  parameters.push_back(rclcpp::Parameter("inflation.distance_transform_threads", 2));
+  initNode(parameters);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1);
+
+  std::shared_ptr<nav2_costmap_2d::StaticLayer> slayer = nullptr;
+  addStaticLayer(layers, tf, node_, slayer);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+  layers.setFootprint(polygon);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  waitForMap(slayer);
+
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 20u);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 28u);
+
+  addObservation(olayer, 0, 0, 0.4);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(
+    countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE) +
+    countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 51u);
+
+  addObservation(olayer, 2, 0);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(
+    countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE) +
+    countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 54u);
+
+  nav2_costmap_2d::Costmap2D distance_transform(*costmap);
+
+  node_->set_parameter(rclcpp::Parameter("inflation.inflation_mode", std::string("full")));
+  layers.updateMap(0, 0, 0);
+
+  for (unsigned int j = 0; j < costmap->getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < costmap->getSizeInCellsX(); ++i) {
+      EXPECT_EQ(distance_transform.getCost(i, j), costmap->getCost(i, j));
+    }
+  }
+}
+
+/**
+ * Test that the distance transform never gives lower costs than the bin queue on random maps.
+ * The bin queue propagates obstacles through neighbors, so it may miss the nearest one, while
+ * the distance transform always finds it.
+ */
+TEST_F(TestNode, testDistanceTransformInflationOnRandomMaps)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.cost_scaling_factor", 3.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 1.2));
+  parameters.push_back(rclcpp::Parameter("inflation.distance_transform_threads", 4));
+  initNode(parameters);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(230, 170, 0.05, 0.0, 0.0);
+
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+  setRadii(layers, 0.25, 0.25);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+  std::mt19937 generator(7);
+  for (double density : {0.002, 0.01, 0.05}) {
+    // Scattered obstacles and a few walls
+    nav2_costmap_2d::Costmap2D map(*costmap);
+    map.resetMap(0, 0, size_x, size_y);
+    std::bernoulli_distribution obstacle(density);
+    for (unsigned int j = 0; j < size_y; ++j) {
+      for (unsigned int i = 0; i < size_x; ++i) {
+        if (obstacle(generator)) {
+          map.setCost(i, j, nav2_costmap_2d::LETHAL_OBSTACLE);
+        }
+      }
+    }
+    std::uniform_int_distribution<unsigned int> wall_x(0, size_x - 1), wall_y(0, size_y - 1);
+    for (int wall = 0; wall < 4; ++wall) {
+      const unsigned int x = wall_x(generator), y = wall_y(generator);
+      for (unsigned int i = x; i < std::min(size_x, x + 40); ++i) {
+        map.setCost(i, y, nav2_costmap_2d::LETHAL_OBSTACLE);
+      }
+    }
+
+    node_->set_parameter(
+      rclcpp::Parameter("inflation.inflation_mode", std::string("distance_transform")));
+    *costmap = map;
+    ilayer->updateCosts(*costmap, 0, 0, size_x, size_y);
+    nav2_costmap_2d::Costmap2D distance_transform(*costmap);
+
+    node_->set_parameter(rclcpp::Parameter("inflation.inflation_mode", std::string("full")));
+    *costmap = map;
+    ilayer->updateCosts(*costmap, 0, 0, size_x, size_y);
+
+    unsigned int inflated = 0;
+    for (unsigned int j = 0; j < size_y; ++j) {
+      for (unsigned int i = 0; i < size_x; ++i) {
+        ASSERT_GE(distance_transform.getCost(i, j), costmap->getCost(i, j))
+          << "at cell " << i << ", " << j << " with density " << density;
+        if (costmap->getCost(i, j) != nav2_costmap_2d::FREE_SPACE &&
+          costmap->getCost(i, j) != nav2_costmap_2d::LETHAL_OBSTACLE)
+        {
+          inflated++;
+        }
+      }
+    }
+    EXPECT_GT(inflated, 0u);
+  }
+}
+
 /**
  * Test dynamic parameter setting of inflation layer
  */
@@ -622,6 +840,7 @@ TEST_F(TestNode, testDynParamsSet)
     rclcpp::Parameter("inflation_layer.cost_scaling_factor", 0.0),
     rclcpp::Parameter("inflation_layer.inflate_unknown", true),
     rclcpp::Parameter("inflation_layer.inflate_around_unknown", true),
+    rclcpp::Parameter("inflation_layer.inflation_mode", std::string("incremental")),
     rclcpp::Parameter("inflation_layer.enabled", false)
   });
 
@@ -633,6 +852,8 @@ TEST_F(TestNode, testDynParamsSet)
   EXPECT_EQ(costmap->get_parameter("inflation_layer.cost_scaling_factor").as_double(), 0.0);
   EXPECT_EQ(costmap->get_parameter("inflation_layer.inflate_unknown").as_bool(), true);
   EXPECT_EQ(costmap->get_parameter("inflation_layer.inflate_around_unknown").as_bool(), true);
+  EXPECT_EQ(
+    costmap->get_parameter("inflation_layer.inflation_mode").as_string(), "incremental");
   EXPECT_EQ(costmap->get_parameter("inflation_layer.enabled").as_bool(), false);
 
   costmap->on_deactivate(rclcpp_lifecycle::State());
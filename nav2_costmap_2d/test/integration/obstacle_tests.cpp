@@ -408,6 +408,52 @@ TEST_F(TestNode, testRaytracing) {
   ASSERT_EQ(lethal_count, 1);
 }
 
+/**
+ * Test that updating independent layers concurrently gives the same costmap as sequentially
+ */
+TEST_F(TestNode, testConcurrentLayerUpdates) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  nav2_costmap_2d::LayeredCostmap sequential_layers("frame", false, false);
+  nav2_costmap_2d::LayeredCostmap concurrent_layers("frame", false, false);
+  concurrent_layers.setLayerUpdateThreads(3);
+
+  for (nav2_costmap_2d::LayeredCostmap * layers : {&sequential_layers, &concurrent_layers}) {
+    layers->resizeMap(10, 10, 1, 0, 0);
+
+    std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer1 = nullptr;
+    std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer2 = nullptr;
+    std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer3 = nullptr;
+    addObstacleLayer(*layers, tf, node_, olayer1);
+    addObstacleLayer(*layers, tf, node_, olayer2);
+    addObstacleLayer(*layers, tf, node_, olayer3);
+
+    addObservation(olayer1, 2.0, 3.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+    addObservation(olayer2, 7.0, 1.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+    addObservation(olayer3, 5.0, 8.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+
+    layers->updateMap(0, 0, 0);
+  }
+
+  double seq_minx, seq_miny, seq_maxx, seq_maxy;
+  double con_minx, con_miny, con_maxx, con_maxy;
+  sequential_layers.getUpdatedBounds(seq_minx, seq_miny, seq_maxx, seq_maxy);
+  concurrent_layers.getUpdatedBounds(con_minx, con_miny, con_maxx, con_maxy);
+  EXPECT_DOUBLE_EQ(seq_minx, con_minx);
+  EXPECT_DOUBLE_EQ(seq_miny, con_miny);
+  EXPECT_DOUBLE_EQ(seq_maxx, con_maxx);
+  EXPECT_DOUBLE_EQ(seq_maxy, con_maxy);
+
+  nav2_costmap_2d::Costmap2D * sequential = sequential_layers.getCostmap();
+  nav2_costmap_2d::Costmap2D * concurrent = concurrent_layers.getCostmap();
+  ASSERT_EQ(countValues(*sequential, nav2_costmap_2d::LETHAL_OBSTACLE), 3);
+  for (unsigned int j = 0; j < sequential->getSizeInCellsY(); j++) {
+    for (unsigned int i = 0; i < sequential->getSizeInCellsX(); i++) {
+      ASSERT_EQ(sequential->getCost(i, j), concurrent->getCost(i, j));
+    }
+  }
+}
+
 /**
  * Test dynamic parameter setting of obstacle layer
  */
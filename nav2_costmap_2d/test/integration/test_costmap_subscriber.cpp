@@ -17,6 +17,8 @@
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d_publisher.hpp"
 #include "nav2_costmap_2d/costmap_subscriber.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/footprint_collision_checker.hpp"
 
 class RclCppFixture
 {
@@ -190,6 +192,388 @@ TEST_F(TestCostmapSubscriberShould, handleCostmapUpdateMsgs)
   costmapPublisher->on_deactivate();
 }
 
+TEST_F(TestCostmapSubscriberShould, handleCostmapDeltaUpdateMsgs)
+{
+  bool always_send_full_costmap = false;
+
+  std::vector<std::vector<std::uint8_t>> expectedCostmaps;
+  std::vector<std::vector<std::uint8_t>> recievedCostmaps;
+
+  std::size_t deltaCostmapMsgCount = 0;
+  std::size_t deltaCostmapCellCount = 0;
+  auto dummyCostmapDeltaUpdateMsgSubscriber =
+    node->create_subscription<nav2_msgs::msg::CostmapDeltaUpdate>(
+    topicName + "_raw_delta_updates", 10,
+    [&](const nav2_msgs::msg::CostmapDeltaUpdate::SharedPtr msg) {
+      deltaCostmapMsgCount++;
+      deltaCostmapCellCount += msg->data.size();
+    });
+  costmapSubscriber =
+    std::make_unique<nav2_costmap_2d::CostmapSubscriber>(node, topicName + "_raw", true);
+
+  auto costmapPublisher = std::make_shared<nav2_costmap_2d::Costmap2DPublisher>(
+    node, costmapToSend.get(), "", topicName, always_send_full_costmap);
+  costmapPublisher->on_activate();
+
+  for (const auto & mapChange : mapChanges) {
+    for (const auto & observation : mapChange.observations) {
+      costmapToSend->setCost(observation.x, observation.y, observation.cost);
+    }
+
+    expectedCostmaps.emplace_back(getCurrentCharMapToSend());
+
+    costmapPublisher->updateBounds(mapChange.x0, mapChange.xn, mapChange.y0, mapChange.yn);
+    costmapPublisher->publishCostmap();
+
+    rclcpp::spin_some(node->get_node_base_interface());
+
+    recievedCostmaps.emplace_back(getCurrentCharMapFromSubscriber());
+  }
+
+  ASSERT_EQ(fullCostmapMsgCount, 1);
+  // A keyframe along with the full costmap, then the deltas
+  ASSERT_EQ(deltaCostmapMsgCount, mapChanges.size());
+  // Only the changed cells are sent, not the whole updated bounds
+  ASSERT_EQ(deltaCostmapCellCount, 100u + 5u);
+
+  ASSERT_EQ(expectedCostmaps, recievedCostmaps);
+
+  costmapPublisher->on_deactivate();
+}
+
+TEST_F(TestCostmapSubscriberShould, discardDeltaUpdatesAfterLostOneUntilKeyframe)
+{
+  costmapSubscriber =
+    std::make_unique<nav2_costmap_2d::CostmapSubscriber>(node, topicName + "_raw", true);
+
+  auto costmapMsg = std::make_shared<nav2_msgs::msg::Costmap>();
+  costmapMsg->metadata.size_x = 10;
+  costmapMsg->metadata.size_y = 10;
+  costmapMsg->metadata.resolution = 1.0;
+  costmapMsg->data.assign(100, 0);
+  costmapSubscriber->costmapCallback(costmapMsg);
+
+  auto deltaMsg = [](uint64_t sequence, uint64_t base_sequence, std::uint32_t cell,
+      std::uint8_t cost) {
+      auto msg = std::make_shared<nav2_msgs::msg::CostmapDeltaUpdate>();
+      msg->sequence = sequence;
+      msg->base_sequence = base_sequence;
+      msg->size_x = 10;
+      msg->size_y = 10;
+      msg->run_start.push_back(cell);
+      msg->run_length.push_back(1);
+      msg->data.push_back(cost);
+      return msg;
+    };
+  auto keyframeMsg = [](uint64_t sequence, const std::vector<std::uint8_t> & costs) {
+      auto msg = std::make_shared<nav2_msgs::msg::CostmapDeltaUpdate>();
+      msg->sequence = sequence;
+      msg->base_sequence = sequence;
+      msg->size_x = 10;
+      msg->size_y = 10;
+      msg->run_start.push_back(0);
+      msg->run_length.push_back(costs.size());
+      msg->data = costs;
+      return msg;
+    };
+
+  std::vector<std::uint8_t> expected(100, 0);
+  expected[1] = 1;
+  costmapSubscriber->costmapDeltaUpdateCallback(keyframeMsg(1, expected));
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(2, 1, 5, 5));
+  expected[5] = 5;
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), expected);
+
+  // Update 3 is lost, the updates following it are discarded
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(4, 3, 7, 7));
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(5, 4, 8, 8));
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), expected);
+
+  // Until the next keyframe, which the updates apply on top of again
+  std::vector<std::uint8_t> keyframe(100, 0);
+  keyframe[3] = 3;
+  keyframe[7] = 7;
+  keyframe[8] = 8;
+  costmapSubscriber->costmapDeltaUpdateCallback(keyframeMsg(6, keyframe));
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), keyframe);
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(7, 6, 9, 9));
+  keyframe[9] = 9;
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), keyframe);
+}
+
+TEST_F(TestCostmapSubscriberShould, resumeDeltaUpdatesFromFullCostmap)
+{
+  costmapSubscriber =
+    std::make_unique<nav2_costmap_2d::CostmapSubscriber>(node, topicName + "_raw", true);
+
+  auto costmapMsg = [](uint64_t delta_sequence, const std::vector<std::uint8_t> & costs) {
+      auto msg = std::make_shared<nav2_msgs::msg::Costmap>();
+      msg->metadata.size_x = 10;
+      msg->metadata.size_y = 10;
+      msg->metadata.resolution = 1.0;
+      msg->delta_sequence = delta_sequence;
+      msg->data = costs;
+      return msg;
+    };
+  auto deltaMsg = [](uint64_t sequence, uint64_t base_sequence, std::uint32_t cell,
+      std::uint8_t cost) {
+      auto msg = std::make_shared<nav2_msgs::msg::CostmapDeltaUpdate>();
+      msg->sequence = sequence;
+      msg->base_sequence = base_sequence;
+      msg->size_x = 10;
+      msg->size_y = 10;
+      msg->run_start.push_back(cell);
+      msg->run_length.push_back(1);
+      msg->data.push_back(cost);
+      return msg;
+    };
+
+  // The full costmap stands for the keyframe it is sent along with
+  std::vector<std::uint8_t> expected(100, 0);
+  expected[2] = 2;
+  costmapSubscriber->costmapCallback(costmapMsg(4, expected));
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(5, 4, 5, 5));
+  expected[5] = 5;
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), expected);
+
+  // So later ones resynchronize the delta updates as well
+  expected[3] = 3;
+  costmapSubscriber->costmapCallback(costmapMsg(9, expected));
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(10, 9, 6, 6));
+  expected[6] = 6;
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), expected);
+
+  // Unless no delta updates were published along with them
+  std::vector<std::uint8_t> unsynced(100, 1);
+  costmapSubscriber->costmapCallback(costmapMsg(0, unsynced));
+  costmapSubscriber->costmapDeltaUpdateCallback(deltaMsg(11, 10, 7, 7));
+  ASSERT_EQ(getCurrentCharMapFromSubscriber(), unsynced);
+}
+
+TEST_F(TestCostmapSubscriberShould, sendDeltaUpdateKeyframesPeriodically)
+{
+  std::vector<nav2_msgs::msg::CostmapDeltaUpdate::SharedPtr> deltaMsgs;
+  auto dummyCostmapDeltaUpdateMsgSubscriber =
+    node->create_subscription<nav2_msgs::msg::CostmapDeltaUpdate>(
+    topicName + "_raw_delta_updates", 100,
+    [&](const nav2_msgs::msg::CostmapDeltaUpdate::SharedPtr msg) {
+      deltaMsgs.push_back(msg);
+    });
+
+  auto costmapPublisher = std::make_shared<nav2_costmap_2d::Costmap2DPublisher>(
+    node, costmapToSend.get(), "", topicName, false);
+  costmapPublisher->on_activate();
+
+  for (unsigned int i = 0; i < 60; i++) {
+    costmapToSend->setCost(i % 10, 0, i + 1);
+    costmapPublisher->updateBounds(i % 10, i % 10 + 1, 0, 1);
+    costmapPublisher->publishCostmap();
+    rclcpp::spin_some(node->get_node_base_interface());
+  }
+
+  // A keyframe first, then another one after 50 deltas, in an unbroken sequence
+  ASSERT_EQ(deltaMsgs.size(), 60u);
+  for (size_t i = 0; i < deltaMsgs.size(); i++) {
+    const bool keyframe = i == 0 || i == 51;
+    EXPECT_EQ(deltaMsgs[i]->sequence, i + 1);
+    EXPECT_EQ(deltaMsgs[i]->base_sequence, keyframe ? i + 1 : i);
+    EXPECT_EQ(deltaMsgs[i]->data.size(), keyframe ? 100u : 1u);
+  }
+
+  costmapPublisher->on_deactivate();
+}
+
+TEST_F(TestCostmapSubscriberShould, readSharedCostmapOfPublisherInSameProcess)
+{
+  bool always_send_full_costmap = false;
+
+  auto intraProcessNode = rclcpp::Node::make_shared(
+    "test_shared_subscriber", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto sharedCostmapSubscriber = std::make_unique<nav2_costmap_2d::CostmapSubscriber>(
+    intraProcessNode, topicName + "_raw");
+  ASSERT_EQ(sharedCostmapSubscriber->getCostmapSnapshot(), nullptr);
+
+  auto costmapPublisher = std::make_shared<nav2_costmap_2d::Costmap2DPublisher>(
+    node, costmapToSend.get(), "", topicName, always_send_full_costmap);
+  costmapPublisher->on_activate();
+
+  std::shared_ptr<const nav2_costmap_2d::CostmapSnapshot> previousSnapshot;
+  std::vector<std::uint8_t> previousCostmap;
+  for (const auto & mapChange : mapChanges) {
+    for (const auto & observation : mapChange.observations) {
+      costmapToSend->setCost(observation.x, observation.y, observation.cost);
+    }
+
+    costmapPublisher->updateBounds(mapChange.x0, mapChange.xn, mapChange.y0, mapChange.yn);
+    costmapPublisher->publishCostmap();
+
+    // The snapshot is available without spinning, and left untouched by later updates
+    auto snapshot = sharedCostmapSubscriber->getCostmapSnapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshot->getSizeInCellsX(), costmapToSend->getSizeInCellsX());
+    ASSERT_EQ(snapshot->getSizeInCellsY(), costmapToSend->getSizeInCellsY());
+    ASSERT_EQ(
+      std::vector<std::uint8_t>(
+        snapshot->getCharMap(),
+        snapshot->getCharMap() + snapshot->getSizeInCellsX() * snapshot->getSizeInCellsY()),
+      getCurrentCharMapToSend());
+    if (previousSnapshot) {
+      ASSERT_GT(snapshot->getVersion(), previousSnapshot->getVersion());
+      ASSERT_EQ(
+        std::vector<std::uint8_t>(
+          previousSnapshot->getCharMap(),
+          previousSnapshot->getCharMap() + previousCostmap.size()),
+        previousCostmap);
+    }
+
+    auto costmap = sharedCostmapSubscriber->getCostmap();
+    ASSERT_EQ(
+      std::vector<std::uint8_t>(
+        costmap->getCharMap(),
+        costmap->getCharMap() + costmap->getSizeInCellsX() * costmap->getSizeInCellsY()),
+      getCurrentCharMapToSend());
+
+    previousSnapshot = snapshot;
+    previousCostmap = getCurrentCharMapToSend();
+  }
+
+  costmapPublisher->on_deactivate();
+  costmapPublisher.reset();
+  ASSERT_EQ(sharedCostmapSubscriber->getCostmapSnapshot(), nullptr);
+}
+
+TEST_F(TestCostmapSubscriberShould, shareChangedCellsOfCostmapUntilDeactivated)
+{
+  bool always_send_full_costmap = false;
+
+  auto intraProcessNode = rclcpp::Node::make_shared(
+    "test_shared_subscriber", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto sharedCostmapSubscriber = std::make_unique<nav2_costmap_2d::CostmapSubscriber>(
+    intraProcessNode, topicName + "_raw");
+
+  auto costmapPublisher = std::make_shared<nav2_costmap_2d::Costmap2DPublisher>(
+    node, costmapToSend.get(), "", topicName, always_send_full_costmap);
+  costmapPublisher->on_activate();
+
+  auto snapshotCharMap = [](const nav2_costmap_2d::CostmapSnapshot & snapshot) {
+      return std::vector<std::uint8_t>(
+        snapshot.getCharMap(),
+        snapshot.getCharMap() + snapshot.getSizeInCellsX() * snapshot.getSizeInCellsY());
+    };
+
+  // Snapshots are released right away, so that their memory is reused and only the
+  // changed cells are copied into it
+  for (unsigned int i = 0; i < 20; i++) {
+    const unsigned int x = i % 10;
+    const unsigned int y = (3 * i) % 10;
+    costmapToSend->setCost(x, y, static_cast<unsigned char>(10 * i + 1));
+    if (i % 4 == 3) {
+      costmapToSend->setCost(9 - x, 9 - y, static_cast<unsigned char>(10 * i + 2));
+      costmapPublisher->updateBounds(9 - x, 10 - x, 9 - y, 10 - y);
+    }
+    costmapPublisher->updateBounds(x, x + 1, y, y + 1);
+    costmapPublisher->publishCostmap();
+
+    auto snapshot = sharedCostmapSubscriber->getCostmapSnapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshotCharMap(*snapshot), getCurrentCharMapToSend()) << "at update " << i;
+
+    // The changed cells are patched into the costmap of the subscriber as well
+    auto costmap = sharedCostmapSubscriber->getCostmap();
+    ASSERT_EQ(
+      std::vector<std::uint8_t>(
+        costmap->getCharMap(),
+        costmap->getCharMap() + costmap->getSizeInCellsX() * costmap->getSizeInCellsY()),
+      getCurrentCharMapToSend()) << "at update " << i;
+  }
+
+  // Collisions are checked on the snapshot directly
+  costmapToSend->setCost(5, 5, nav2_costmap_2d::LETHAL_OBSTACLE);
+  costmapPublisher->updateBounds(5, 6, 5, 6);
+  costmapPublisher->publishCostmap();
+  nav2_costmap_2d::FootprintCollisionChecker<
+    std::shared_ptr<const nav2_costmap_2d::CostmapSnapshot>> collisionChecker(
+    sharedCostmapSubscriber->getCostmapSnapshot());
+  nav2_costmap_2d::Footprint footprint(4);
+  footprint[0].x = footprint[1].x = -0.3;
+  footprint[2].x = footprint[3].x = 0.3;
+  footprint[0].y = footprint[3].y = -0.3;
+  footprint[1].y = footprint[2].y = 0.3;
+  ASSERT_EQ(
+    collisionChecker.footprintCostAtPose(5.5, 5.5, 0.0, footprint),
+    static_cast<double>(nav2_costmap_2d::LETHAL_OBSTACLE));
+  ASSERT_LT(
+    collisionChecker.footprintCostAtPose(2.5, 7.5, 0.0, footprint),
+    static_cast<double>(nav2_costmap_2d::LETHAL_OBSTACLE));
+
+  // No snapshot is left behind by a deactivated publisher, and the costmap is shared
+  // again in full once it is activated
+  costmapPublisher->on_deactivate();
+  ASSERT_EQ(sharedCostmapSubscriber->getCostmapSnapshot(), nullptr);
+  costmapToSend->setCost(0, 9, 42);
+  costmapPublisher->on_activate();
+  costmapPublisher->publishCostmap();
+  auto snapshot = sharedCostmapSubscriber->getCostmapSnapshot();
+  ASSERT_NE(snapshot, nullptr);
+  ASSERT_EQ(snapshotCharMap(*snapshot), getCurrentCharMapToSend());
+
+  costmapPublisher->on_deactivate();
+}
+
+TEST_F(TestCostmapSubscriberShould, skipCostmapMessagesWhileOnlySharedConsumersFollowThem)
+{
+  const std::string sharedTopicName = "/shared_costmap";
+  auto intraProcessNode = rclcpp::Node::make_shared(
+    "test_shared_only_subscriber", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto sharedCostmapSubscriber = std::make_unique<nav2_costmap_2d::CostmapSubscriber>(
+    intraProcessNode, sharedTopicName + "_raw");
+
+  auto costmapPublisher = std::make_shared<nav2_costmap_2d::Costmap2DPublisher>(
+    node, costmapToSend.get(), "", sharedTopicName, false);
+  costmapPublisher->on_activate();
+
+  for (const auto & mapChange : mapChanges) {
+    for (const auto & observation : mapChange.observations) {
+      costmapToSend->setCost(observation.x, observation.y, observation.cost);
+    }
+    costmapPublisher->updateBounds(mapChange.x0, mapChange.xn, mapChange.y0, mapChange.yn);
+    costmapPublisher->publishCostmap();
+
+    auto costmap = sharedCostmapSubscriber->getCostmap();
+    ASSERT_EQ(
+      std::vector<std::uint8_t>(
+        costmap->getCharMap(),
+        costmap->getCharMap() + costmap->getSizeInCellsX() * costmap->getSizeInCellsY()),
+      getCurrentCharMapToSend());
+  }
+
+  // No full costmap was built, so none is left on the topic for a later subscriber
+  std::vector<nav2_msgs::msg::Costmap::SharedPtr> costmapMsgs;
+  auto lateCostmapMsgSubscriber = node->create_subscription<nav2_msgs::msg::Costmap>(
+    sharedTopicName + "_raw", rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
+    [&](const nav2_msgs::msg::Costmap::SharedPtr msg) {costmapMsgs.push_back(msg);});
+  for (int i = 0; i < 100 && node->count_subscribers(sharedTopicName + "_raw") < 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(node->count_subscribers(sharedTopicName + "_raw"), 2u);
+  for (int i = 0; i < 20; i++) {
+    rclcpp::spin_some(node->get_node_base_interface());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(costmapMsgs.empty());
+
+  // It gets the full costmap with the next publication instead
+  costmapPublisher->publishCostmap();
+  for (int i = 0; i < 100 && costmapMsgs.empty(); i++) {
+    rclcpp::spin_some(node->get_node_base_interface());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(costmapMsgs.size(), 1u);
+  ASSERT_EQ(costmapMsgs[0]->data, getCurrentCharMapToSend());
+
+  costmapPublisher->on_deactivate();
+}
+
 TEST_F(
   TestCostmapSubscriberShould,
   throwExceptionIfGetCostmapMethodIsCalledBeforeAnyCostmapMsgReceived)
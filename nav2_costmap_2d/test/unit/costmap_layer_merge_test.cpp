@@ -0,0 +1,178 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+using nav2_costmap_2d::NO_INFORMATION;
+using nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+class MergeLayer : public nav2_costmap_2d::CostmapLayer
+{
+public:
+  explicit MergeLayer(nav2_costmap_2d::LayeredCostmap * layers)
+  {
+    layered_costmap_ = layers;
+    enabled_ = true;
+    matchSize();
+  }
+
+  void reset() override {}
+  bool isClearable() override {return false;}
+  void updateBounds(double, double, double, double *, double *, double *, double *) override {}
+  void updateCosts(nav2_costmap_2d::Costmap2D &, int, int, int, int) override {}
+
+  using nav2_costmap_2d::CostmapLayer::updateWithTrueOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithMax;
+  using nav2_costmap_2d::CostmapLayer::updateWithMaxWithoutUnknownOverwrite;
+  using nav2_costmap_2d::CostmapLayer::updateWithAddition;
+};
+
+using MergeFunction = std::function<void (MergeLayer &, nav2_costmap_2d::Costmap2D &,
+    int, int, int, int)>;
+using CellFunction = std::function<unsigned char (unsigned char, unsigned char)>;
+
+// Fills a grid with random costs, with unknown and high costs being frequent
+// to exercise the special cases of the merges
+void fillCosts(nav2_costmap_2d::Costmap2D & costmap, unsigned int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> cost(0, 255);
+  unsigned char * data = costmap.getCharMap();
+  const unsigned int size = costmap.getSizeInCellsX() * costmap.getSizeInCellsY();
+  for (unsigned int i = 0; i != size; i++) {
+    const int c = cost(gen);
+    data[i] = c < 64 ? NO_INFORMATION : c;
+  }
+}
+
+// Merges a random layer into a random master grid within a window not aligned on the
+// vectorized blocks, and checks every cell against the expected cell by cell result
+void testMerge(unsigned int threads, const MergeFunction & merge, const CellFunction & cell)
+{
+  const unsigned int size = 301;
+  nav2_costmap_2d::LayeredCostmap layers("map", false, true);
+  layers.resizeMap(size, size, 0.05, 0.0, 0.0);
+  layers.setLayerUpdateThreads(threads);
+
+  MergeLayer layer(&layers);
+  fillCosts(layer, 1u);
+  nav2_costmap_2d::Costmap2D & master = *layers.getCostmap();
+  fillCosts(master, 2u);
+
+  const unsigned char * layer_data = layer.getCharMap();
+  const std::vector<unsigned char> initial(
+    master.getCharMap(), master.getCharMap() + size * size);
+
+  const int min_i = 3, min_j = 5, max_i = 298, max_j = 299;
+  merge(layer, master, min_i, min_j, max_i, max_j);
+
+  for (unsigned int j = 0; j < size; j++) {
+    for (unsigned int i = 0; i < size; i++) {
+      const unsigned int it = j * size + i;
+      const bool inside = static_cast<int>(i) >= min_i && static_cast<int>(i) < max_i &&
+        static_cast<int>(j) >= min_j && static_cast<int>(j) < max_j;
+      const unsigned char expected = inside ? cell(initial[it], layer_data[it]) : initial[it];
+      ASSERT_EQ(master.getCost(i, j), expected) << "at (" << i << ", " << j << ")";
+    }
+  }
+}
+
+class MergeTest : public ::testing::TestWithParam<unsigned int>
+{
+};
+
+TEST_P(MergeTest, trueOverwrite)
+{
+  testMerge(
+    GetParam(),
+    [](MergeLayer & l, nav2_costmap_2d::Costmap2D & m, int x0, int y0, int xn, int yn) {
+      l.updateWithTrueOverwrite(m, x0, y0, xn, yn);
+    },
+    [](unsigned char, unsigned char cost) {return cost;});
+}
+
+TEST_P(MergeTest, overwrite)
+{
+  testMerge(
+    GetParam(),
+    [](MergeLayer & l, nav2_costmap_2d::Costmap2D & m, int x0, int y0, int xn, int yn) {
+      l.updateWithOverwrite(m, x0, y0, xn, yn);
+    },
+    [](unsigned char old_cost, unsigned char cost) {
+      return cost == NO_INFORMATION ? old_cost : cost;
+    });
+}
+
+TEST_P(MergeTest, max)
+{
+  testMerge(
+    GetParam(),
+    [](MergeLayer & l, nav2_costmap_2d::Costmap2D & m, int x0, int y0, int xn, int yn) {
+      l.updateWithMax(m, x0, y0, xn, yn);
+    },
+    [](unsigned char old_cost, unsigned char cost) {
+      if (cost == NO_INFORMATION) {
+        return old_cost;
+      }
+      return old_cost == NO_INFORMATION ? cost : std::max(old_cost, cost);
+    });
+}
+
+TEST_P(MergeTest, maxWithoutUnknownOverwrite)
+{
+  testMerge(
+    GetParam(),
+    [](MergeLayer & l, nav2_costmap_2d::Costmap2D & m, int x0, int y0, int xn, int yn) {
+      l.updateWithMaxWithoutUnknownOverwrite(m, x0, y0, xn, yn);
+    },
+    [](unsigned char old_cost, unsigned char cost) {
+      if (cost == NO_INFORMATION || old_cost == NO_INFORMATION) {
+        return old_cost;
+      }
+      return std::max(old_cost, cost);
+    });
+}
+
+TEST_P(MergeTest, addition)
+{
+  testMerge(
+    GetParam(),
+    [](MergeLayer & l, nav2_costmap_2d::Costmap2D & m, int x0, int y0, int xn, int yn) {
+      l.updateWithAddition(m, x0, y0, xn, yn);
+    },
+    [](unsigned char old_cost, unsigned char cost) {
+      if (cost == NO_INFORMATION) {
+        return old_cost;
+      }
+      if (old_cost == NO_INFORMATION) {
+        return cost;
+      }
+      const int sum = old_cost + cost;
+      return static_cast<unsigned char>(
+        sum >= INSCRIBED_INFLATED_OBSTACLE ? INSCRIBED_INFLATED_OBSTACLE - 1 : sum);
+    });
+}
+
+// Merges on the calling thread only, then split over the layer update threads
+INSTANTIATE_TEST_SUITE_P(LayerMerge, MergeTest, ::testing::Values(1u, 4u));
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <string>
 #include <vector>
 #include <memory>
@@ -158,6 +159,74 @@ TEST(collision_footprint, test_point_and_line_cost)
   EXPECT_NEAR(right_value, 254.0, 0.001);
 }
 
+TEST(collision_footprint, test_footprint_stencils)
+{
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> costmap_ =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(100, 100, 0.1, 0, 0, 254);
+
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmap_->setCost(i, j, 0);
+    }
+  }
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -1.0;
+  p1.y = 1.0;
+  geometry_msgs::msg::Point p2;
+  p2.x = 1.0;
+  p2.y = 1.0;
+  geometry_msgs::msg::Point p3;
+  p3.x = 1.0;
+  p3.y = -1.0;
+  geometry_msgs::msg::Point p4;
+  p4.x = -1.0;
+  p4.y = -1.0;
+
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  collision_checker(costmap_);
+  collision_checker.setFootprintStencils(footprint, 16);
+
+  EXPECT_EQ(collision_checker.getAngleBin(0.0), 0u);
+  EXPECT_EQ(collision_checker.getAngleBin(-0.01), 0u);
+  EXPECT_EQ(collision_checker.getAngleBin(M_PI), 8u);
+  EXPECT_EQ(collision_checker.getAngleBin(2.0 * M_PI - 0.01), 0u);
+  EXPECT_EQ(collision_checker.getAngleBin(-M_PI / 2.0), 12u);
+
+  // Same results as rasterizing the footprint at the pose
+  EXPECT_NEAR(collision_checker.footprintStencilCostAtPose(5.0, 5.0, 0.0), 0.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintStencilCostAtPose(5.0, 4.9, 0.0), 254.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintStencilCostAtPose(5.2, 5.0, 0.0), 254.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 4), 0.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 2), 254.0, 0.001);
+
+  // Outside of the map is in collision
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(5, 50, 0), 254.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintStencilCostAtPose(-1.0, 5.0, 0.0), 254.0, 0.001);
+
+  // Only a filled footprint covers its interior
+  costmap_->setCost(50, 50, 100);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 0), 0.0, 0.001);
+  collision_checker.setFootprintStencils(footprint, 16, true);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 0), 100.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(51, 51, 0), 254.0, 0.001);
+
+  // A costmap of another width than the stencils were made for is still checked correctly
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> wider_costmap =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(120, 100, 0.1, 0, 0, 254);
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      wider_costmap->setCost(i, j, 0);
+    }
+  }
+  collision_checker.setCostmap(wider_costmap);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 0), 0.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(51, 51, 0), 254.0, 0.001);
+  EXPECT_NEAR(collision_checker.footprintCostAtCell(50, 50, 2), 254.0, 0.001);
+}
+
 TEST(collision_footprint, not_enough_points)
 {
   geometry_msgs::msg::Point p1;
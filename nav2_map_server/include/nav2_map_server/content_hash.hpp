@@ -0,0 +1,65 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_MAP_SERVER__CONTENT_HASH_HPP_
+#define NAV2_MAP_SERVER__CONTENT_HASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace nav2_map_server
+{
+
+/**
+ * @class nav2_map_server::ContentHash
+ * @brief 64 bits FNV-1a hash of the content of a map file, updated with the bytes of the
+ * file in order as they are written, so that no extra pass over the file is needed
+ */
+class ContentHash
+{
+public:
+  /**
+   * @brief Hash the next bytes of the file
+   * @param data Bytes to hash
+   * @param size Number of bytes
+   */
+  void update(const char * data, size_t size)
+  {
+    for (size_t i = 0; i < size; i++) {
+      hash_ ^= static_cast<unsigned char>(data[i]);
+      hash_ *= 1099511628211ull;
+    }
+  }
+
+  /**
+   * @brief Get the hash of the bytes so far
+   * @return The hash, as 16 hexadecimal digits
+   */
+  std::string toString() const
+  {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash_;
+    return ss.str();
+  }
+
+private:
+  uint64_t hash_{14695981039346656037ull};
+};
+
+}  // namespace nav2_map_server
+
+#endif  // NAV2_MAP_SERVER__CONTENT_HASH_HPP_
@@ -37,6 +37,8 @@ struct LoadParameters
   double occupied_thresh;
   MapMode mode;
   bool negate;
+  // Hash of the image file, to key caches of data derived from the map. Empty if unknown.
+  std::string content_hash;
 };
 
 typedef enum
@@ -82,6 +84,8 @@ LOAD_MAP_STATUS loadMapFromYaml(
 struct SaveParameters
 {
   std::string map_file_name{""};
+  // pgm images and tmap tiled maps are streamed from the map, band by band, while
+  // other formats are built as a whole image in memory before being written
   std::string image_format{""};
   double free_thresh{0.0};
   double occupied_thresh{0.0};
@@ -98,6 +102,14 @@ bool saveMapToFile(
   const nav_msgs::msg::OccupancyGrid & map,
   const SaveParameters & save_parameters);
 
+/**
+ * @brief Compute the content hash of a map image file, as written in its YAML file
+ * @param file_name Name of the map image file
+ * @return 64 bits FNV-1a hash of the file, as 16 hexadecimal digits
+ * @throw std::runtime_error if the file could not be read
+ */
+std::string computeMapContentHash(const std::string & file_name);
+
 /**
  * @brief Expand ~/ to home user dir.
  * @param yaml_filename Name of input YAML file.
@@ -24,6 +24,9 @@
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "nav_msgs/srv/get_map.hpp"
 #include "nav2_msgs/srv/load_map.hpp"
+#include "nav2_msgs/srv/get_map_region.hpp"
+#include "nav2_map_server/map_io.hpp"
+#include "nav2_map_server/tiled_map.hpp"
 
 namespace nav2_map_server
 {
@@ -91,6 +94,27 @@ protected:
     const std::string & yaml_file,
     std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response);
 
+  /**
+   * @brief Load the map YAML and open its tiled map file instead of loading the whole map,
+   * so that regions of it are read on demand. Maps which are not tiled are loaded whole.
+   * Update msg_ class variable, whose data stays empty for tiled maps.
+   * @param yaml_file name of input YAML file
+   * @return status of map loaded
+   */
+  LOAD_MAP_STATUS loadTiledMapFromYaml(const std::string & yaml_file);
+
+  /**
+   * @brief Copy a window of the map, from the tiled map file if any
+   * @param x0 First column of the window
+   * @param y0 First row of the window
+   * @param width Number of columns of the window
+   * @param height Number of rows of the window
+   * @param data Output buffer of width * height cells, row-major
+   */
+  void copyMapRegion(
+    unsigned int x0, unsigned int y0, unsigned int width, unsigned int height,
+    int8_t * data) const;
+
   /**
    * @brief Method correcting msg_ header when it belongs to instantiated object
    */
@@ -118,9 +142,23 @@ protected:
     const std::shared_ptr<nav2_msgs::srv::LoadMap::Request> request,
     std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response);
 
+  /**
+   * @brief Map region getting service callback
+   * @param request_header Service request header
+   * @param request Service request
+   * @param response Service response
+   */
+  void getMapRegionCallback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<nav2_msgs::srv::GetMapRegion::Request> request,
+    std::shared_ptr<nav2_msgs::srv::GetMapRegion::Response> response);
+
   // The name of the service for getting a map
   const std::string service_name_{"map"};
 
+  // The name of the service for getting a region of the map
+  const std::string map_region_service_name_{"map_region"};
+
   // The name of the service for loading a map
   const std::string load_map_service_name_{"load_map"};
 
@@ -130,6 +168,9 @@ protected:
   // A service to load the occupancy grid from file at run time (LoadMap)
   rclcpp::Service<nav2_msgs::srv::LoadMap>::SharedPtr load_map_service_;
 
+  // A service to provide the cells of the occupancy grid around a region (GetMapRegion)
+  rclcpp::Service<nav2_msgs::srv::GetMapRegion>::SharedPtr map_region_service_;
+
   // A topic on which the occupancy grid will be published
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::OccupancyGrid>::SharedPtr occ_pub_;
 
@@ -141,6 +182,12 @@ protected:
 
   // true if msg_ was initialized
   bool map_available_;
+
+  // true if tiled maps are read on demand, rather than loaded and published whole
+  bool serve_map_regions_;
+
+  // The tiled map file msg_ is read from, when serving map regions
+  std::unique_ptr<TiledMap> tiled_map_;
 };
 
 }  // namespace nav2_map_server
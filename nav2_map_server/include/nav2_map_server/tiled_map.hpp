@@ -0,0 +1,137 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Tiled binary map format */
+
+#ifndef NAV2_MAP_SERVER__TILED_MAP_HPP_
+#define NAV2_MAP_SERVER__TILED_MAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nav_msgs/msg/occupancy_grid.hpp"
+
+namespace nav2_map_server
+{
+
+/**
+ * @class nav2_map_server::TiledMap
+ * @brief Map stored as occupancy values (-1, 0-100) in square tiles of cells, which is
+ * memory-mapped so that only the tiles actually read are loaded from the disk.
+ *
+ * The file starts with a header page, followed by the tiles in row-major order, the first
+ * one holding the cell (0, 0) of the OccupancyGrid. Cells are row-major in each tile, and
+ * tiles overhanging the map are padded with unknown cells. The resolution and origin of
+ * the map are given by its YAML file, like for images.
+ */
+class TiledMap
+{
+public:
+  /// File extension of tiled maps, in place of the image format
+  static constexpr const char * FILE_EXTENSION = "tmap";
+  static constexpr uint32_t DEFAULT_TILE_SIZE = 256;
+
+  /**
+   * @brief Write an OccupancyGrid into a tiled map file
+   * @param map OccupancyGrid to write
+   * @param file_name Name of the tiled map file
+   * @param tile_size Number of cells per side of the tiles
+   * @return Content hash of the file, computed while it is written
+   * @throw std::runtime_error if the file could not be written
+   */
+  static std::string write(
+    const nav_msgs::msg::OccupancyGrid & map, const std::string & file_name,
+    uint32_t tile_size = DEFAULT_TILE_SIZE);
+
+  /**
+   * @brief Check whether a map file is a tiled map, from its extension
+   * @param file_name Name of the map file
+   * @return true if the file is a tiled map
+   */
+  static bool isTiledMapFile(const std::string & file_name);
+
+  /**
+   * @brief Open and memory-map a tiled map file
+   * @param file_name Name of the tiled map file
+   * @throw std::runtime_error if the file could not be opened or is not a valid tiled map
+   */
+  explicit TiledMap(const std::string & file_name);
+
+  /**
+   * @brief Unmap the tiled map file
+   */
+  ~TiledMap();
+
+  TiledMap(const TiledMap &) = delete;
+  TiledMap & operator=(const TiledMap &) = delete;
+
+  /**
+   * @brief Get the width of the map, in cells
+   */
+  uint32_t width() const {return width_;}
+
+  /**
+   * @brief Get the height of the map, in cells
+   */
+  uint32_t height() const {return height_;}
+
+  /**
+   * @brief Get the number of cells per side of the tiles
+   */
+  uint32_t tileSize() const {return tile_size_;}
+
+  /**
+   * @brief Copy a window of the map, reading only the tiles it overlaps
+   * @param x0 First column of the window
+   * @param y0 First row of the window
+   * @param width Number of columns of the window
+   * @param height Number of rows of the window
+   * @param data Output buffer of width * height cells, row-major
+   * @throw std::out_of_range if the window exceeds the map
+   */
+  void copyRegion(
+    uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, int8_t * data) const;
+
+protected:
+  /// Size of the header, keeping the tiles aligned on memory pages
+  static constexpr size_t HEADER_SIZE = 4096;
+
+  /**
+   * @brief Release the mapping of the file
+   */
+  void unmap();
+
+  const int8_t * tile(uint32_t tx, uint32_t ty) const
+  {
+    return tiles_ + (static_cast<size_t>(ty) * tiles_x_ + tx) * tile_size_ * tile_size_;
+  }
+
+  uint32_t width_{0};
+  uint32_t height_{0};
+  uint32_t tile_size_{0};
+  uint32_t tiles_x_{0};
+  uint32_t tiles_y_{0};
+
+  // Mapped file, or a copy of it where memory mapping is not available
+  void * mapping_{nullptr};
+  size_t mapping_size_{0};
+  std::vector<int8_t> buffer_;
+  const int8_t * tiles_{nullptr};
+};
+
+}  // namespace nav2_map_server
+
+#endif  // NAV2_MAP_SERVER__TILED_MAP_HPP_
@@ -34,12 +34,19 @@
 #ifndef _WIN32
 #include <libgen.h>
 #endif
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <fstream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
 
 #include "Magick++.h"
 #include "nav2_util/geometry_utils.hpp"
@@ -48,6 +55,9 @@
 #include "tf2/LinearMath/Matrix3x3.h"
 #include "tf2/LinearMath/Quaternion.h"
 #include "nav2_util/occ_grid_values.hpp"
+#include "nav2_util/thread_pool.hpp"
+#include "nav2_map_server/content_hash.hpp"
+#include "nav2_map_server/tiled_map.hpp"
 
 #ifdef _WIN32
 // https://github.com/rtv/Stage/blob/master/replace/dirname.c
@@ -181,6 +191,11 @@ LoadParameters loadMapYaml(const std::string & yaml_filename)
     load_parameters.negate = yaml_get_value<bool>(doc, "negate");
   }
 
+  auto content_hash_node = doc["content_hash"];
+  if (content_hash_node.IsDefined()) {
+    load_parameters.content_hash = content_hash_node.as<std::string>();
+  }
+
   std::cout << "[DEBUG] [map_io]: resolution: " << load_parameters.resolution << std::endl;
   std::cout << "[DEBUG] [map_io]: origin[0]: " << load_parameters.origin[0] << std::endl;
   std::cout << "[DEBUG] [map_io]: origin[1]: " << load_parameters.origin[1] << std::endl;
@@ -194,96 +209,189 @@ LoadParameters loadMapYaml(const std::string & yaml_filename)
   return load_parameters;
 }
 
-void loadMapFromFile(
+namespace
+{
+
+// Images with fewer pixels than this are converted by the calling thread only
+constexpr size_t MIN_PARALLEL_LOAD_PIXELS = 1u << 20;
+// Number of image rows read from the pixel cache at once
+constexpr size_t LOAD_BAND_ROWS = 64u;
+// Largest number of channel sums thresholded upfront, enough for 16 bits quanta
+constexpr size_t MAX_CELL_TABLE_SIZE = 1u << 20;
+
+/**
+ * @brief Lock the thread pool converting large maps, shared by all of the map loads and
+ * saves of the process and created along with the first of them
+ * @param lock Lock to hold for as long as the pool is used
+ * @return The pool, nullptr if another conversion is using it, in which case the calling
+ * thread converts the map on its own
+ */
+nav2_util::ThreadPool * lockConversionPool(std::unique_lock<std::mutex> & lock)
+{
+  static std::mutex pool_mutex;
+  static nav2_util::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+  lock = std::unique_lock<std::mutex>(pool_mutex, std::try_to_lock);
+  return lock.owns_lock() ? &pool : nullptr;
+}
+
+/**
+ * @brief Compute the occupancy of a map cell from its pixel, opaque in Scale mode
+ * @param load_parameters Parameters of the map
+ * @param sum Sum of the channels of the pixel
+ * @param num_channels Number of channels summed
+ * @return Occupancy of the map cell
+ */
+int8_t computeMapCell(
+  const LoadParameters & load_parameters, double sum, size_t num_channels)
+{
+  /// on a scale from 0.0 to 1.0 how bright is the pixel?
+  double shade = Magick::ColorGray::scaleQuantumToDouble(sum / num_channels);
+
+  // If negate is true, we consider blacker pixels free, and whiter
+  // pixels occupied. Otherwise, it's vice versa.
+  /// on a scale from 0.0 to 1.0, how occupied is the map cell (before thresholding)?
+  double occ = (load_parameters.negate ? shade : 1.0 - shade);
+
+  switch (load_parameters.mode) {
+    case MapMode::Trinary:
+      if (load_parameters.occupied_thresh < occ) {
+        return nav2_util::OCC_GRID_OCCUPIED;
+      } else if (occ < load_parameters.free_thresh) {
+        return nav2_util::OCC_GRID_FREE;
+      }
+      return nav2_util::OCC_GRID_UNKNOWN;
+    case MapMode::Scale:
+      if (load_parameters.occupied_thresh < occ) {
+        return nav2_util::OCC_GRID_OCCUPIED;
+      } else if (occ < load_parameters.free_thresh) {
+        return nav2_util::OCC_GRID_FREE;
+      }
+      return std::rint(
+        (occ - load_parameters.free_thresh) /
+        (load_parameters.occupied_thresh - load_parameters.free_thresh) * 100.0);
+    case MapMode::Raw: {
+        double occ_percent = std::round(shade * 255);
+        if (nav2_util::OCC_GRID_FREE <= occ_percent &&
+          occ_percent <= nav2_util::OCC_GRID_OCCUPIED)
+        {
+          return static_cast<int8_t>(occ_percent);
+        }
+        return nav2_util::OCC_GRID_UNKNOWN;
+      }
+    default:
+      throw std::runtime_error("Invalid map mode");
+  }
+}
+
+/**
+ * @brief Convert the pixels of a map image into the data of an OccupancyGrid
+ * @param load_parameters Parameters of the map
+ * @param msg Map whose size and data are set
+ */
+void loadImageData(
   const LoadParameters & load_parameters,
-  nav_msgs::msg::OccupancyGrid & map)
+  nav_msgs::msg::OccupancyGrid & msg)
 {
   Magick::InitializeMagick(nullptr);
-  nav_msgs::msg::OccupancyGrid msg;
-
-  std::cout << "[INFO] [map_io]: Loading image_file: " <<
-    load_parameters.image_file_name << std::endl;
   Magick::Image img(load_parameters.image_file_name);
 
-  // Copy the image data into the map structure
   msg.info.width = img.size().width();
   msg.info.height = img.size().height();
 
-  msg.info.resolution = load_parameters.resolution;
-  msg.info.origin.position.x = load_parameters.origin[0];
-  msg.info.origin.position.y = load_parameters.origin[1];
-  msg.info.origin.position.z = 0.0;
-  msg.info.origin.orientation = orientationAroundZAxis(load_parameters.origin[2]);
-
   // Allocate space to hold the data
   msg.data.resize(msg.info.width * msg.info.height);
 
-  // Copy pixel data into the map structure
-  for (size_t y = 0; y < msg.info.height; y++) {
-    for (size_t x = 0; x < msg.info.width; x++) {
-      auto pixel = img.pixelColor(x, y);
+  // Pixels only matter through the sum of their channels, and in Scale mode whether they
+  // are opaque. Unless quanta are too deep, all the possible sums are thresholded upfront.
+  const size_t num_channels =
+    (load_parameters.mode == MapMode::Trinary && img.matte()) ? 4u : 3u;
+  const size_t num_sums = num_channels * static_cast<size_t>(MaxRGB) + 1u;
+  const size_t num_pixels = static_cast<size_t>(msg.info.width) * msg.info.height;
+  std::vector<int8_t> cell_table;
+  if (num_sums <= MAX_CELL_TABLE_SIZE && num_sums < num_pixels) {
+    cell_table.resize(num_sums);
+    for (size_t sum = 0; sum < num_sums; sum++) {
+      cell_table[sum] = computeMapCell(load_parameters, static_cast<double>(sum), num_channels);
+    }
+  }
 
-      std::vector<Magick::Quantum> channels = {pixel.redQuantum(), pixel.greenQuantum(),
-        pixel.blueQuantum()};
-      if (load_parameters.mode == MapMode::Trinary && img.matte()) {
+  auto convert_pixel = [&](const Magick::PixelPacket & pixel) -> int8_t {
+      if (load_parameters.mode == MapMode::Scale && pixel.opacity != OpaqueOpacity) {
+        return nav2_util::OCC_GRID_UNKNOWN;
+      }
+      size_t sum = static_cast<size_t>(pixel.red) + pixel.green + pixel.blue;
+      if (num_channels == 4u) {
         // To preserve existing behavior, average in alpha with color channels in Trinary mode.
         // CAREFUL. alpha is inverted from what you might expect. High = transparent, low = opaque
-        channels.push_back(MaxRGB - pixel.alphaQuantum());
-      }
-      double sum = 0;
-      for (auto c : channels) {
-        sum += c;
+        sum += MaxRGB - pixel.opacity;
       }
-      /// on a scale from 0.0 to 1.0 how bright is the pixel?
-      double shade = Magick::ColorGray::scaleQuantumToDouble(sum / channels.size());
-
-      // If negate is true, we consider blacker pixels free, and whiter
-      // pixels occupied. Otherwise, it's vice versa.
-      /// on a scale from 0.0 to 1.0, how occupied is the map cell (before thresholding)?
-      double occ = (load_parameters.negate ? shade : 1.0 - shade);
-
-      int8_t map_cell;
-      switch (load_parameters.mode) {
-        case MapMode::Trinary:
-          if (load_parameters.occupied_thresh < occ) {
-            map_cell = nav2_util::OCC_GRID_OCCUPIED;
-          } else if (occ < load_parameters.free_thresh) {
-            map_cell = nav2_util::OCC_GRID_FREE;
-          } else {
-            map_cell = nav2_util::OCC_GRID_UNKNOWN;
-          }
-          break;
-        case MapMode::Scale:
-          if (pixel.alphaQuantum() != OpaqueOpacity) {
-            map_cell = nav2_util::OCC_GRID_UNKNOWN;
-          } else if (load_parameters.occupied_thresh < occ) {
-            map_cell = nav2_util::OCC_GRID_OCCUPIED;
-          } else if (occ < load_parameters.free_thresh) {
-            map_cell = nav2_util::OCC_GRID_FREE;
-          } else {
-            map_cell = std::rint(
-              (occ - load_parameters.free_thresh) /
-              (load_parameters.occupied_thresh - load_parameters.free_thresh) * 100.0);
-          }
-          break;
-        case MapMode::Raw: {
-            double occ_percent = std::round(shade * 255);
-            if (nav2_util::OCC_GRID_FREE <= occ_percent &&
-              occ_percent <= nav2_util::OCC_GRID_OCCUPIED)
-            {
-              map_cell = static_cast<int8_t>(occ_percent);
-            } else {
-              map_cell = nav2_util::OCC_GRID_UNKNOWN;
-            }
-            break;
+      return cell_table.empty() ?
+             computeMapCell(load_parameters, static_cast<double>(sum), num_channels) :
+             cell_table[sum];
+    };
+
+  // Each thread reads its rows in bands through its own view of the pixel cache, views
+  // being opened beforehand as this may modify the image
+  const size_t width = msg.info.width;
+  const size_t height = msg.info.height;
+  std::unique_lock<std::mutex> pool_lock;
+  nav2_util::ThreadPool * pool = nullptr;
+  if (num_pixels >= MIN_PARALLEL_LOAD_PIXELS) {
+    pool = lockConversionPool(pool_lock);
+  }
+  std::vector<std::unique_ptr<Magick::Pixels>> views;
+  for (size_t i = 0; i < (pool ? pool->size() : 1u); i++) {
+    views.push_back(std::make_unique<Magick::Pixels>(img));
+  }
+
+  nav2_util::parallelFor(
+    pool, height, [&](size_t begin, size_t end) {
+      Magick::Pixels & view = *views[nav2_util::chunkIndex(pool, height, begin)];
+      for (size_t y0 = begin; y0 < end; y0 += LOAD_BAND_ROWS) {
+        const size_t rows = std::min(LOAD_BAND_ROWS, end - y0);
+        const Magick::PixelPacket * pixels = view.getConst(
+          0, static_cast<int>(y0), static_cast<unsigned int>(width),
+          static_cast<unsigned int>(rows));
+        if (pixels == nullptr) {
+          throw std::runtime_error("Failed to read the pixels of the image");
+        }
+        for (size_t y = y0; y < y0 + rows; y++, pixels += width) {
+          int8_t * cells = &msg.data[width * (height - y - 1)];
+          for (size_t x = 0; x < width; x++) {
+            cells[x] = convert_pixel(pixels[x]);
           }
-        default:
-          throw std::runtime_error("Invalid map mode");
+        }
       }
-      msg.data[msg.info.width * (msg.info.height - y - 1) + x] = map_cell;
-    }
+    });
+}
+
+}  // namespace
+
+void loadMapFromFile(
+  const LoadParameters & load_parameters,
+  nav_msgs::msg::OccupancyGrid & map)
+{
+  nav_msgs::msg::OccupancyGrid msg;
+
+  std::cout << "[INFO] [map_io]: Loading image_file: " <<
+    load_parameters.image_file_name << std::endl;
+  if (TiledMap::isTiledMapFile(load_parameters.image_file_name)) {
+    // Tiled maps already hold occupancy values, so mode, thresholds and negate do not apply
+    TiledMap tiled_map(load_parameters.image_file_name);
+    msg.info.width = tiled_map.width();
+    msg.info.height = tiled_map.height();
+    msg.data.resize(static_cast<size_t>(msg.info.width) * msg.info.height);
+    tiled_map.copyRegion(0, 0, msg.info.width, msg.info.height, msg.data.data());
+  } else {
+    loadImageData(load_parameters, msg);
   }
 
+  msg.info.resolution = load_parameters.resolution;
+  msg.info.origin.position.x = load_parameters.origin[0];
+  msg.info.origin.position.y = load_parameters.origin[1];
+  msg.info.origin.position.z = 0.0;
+  msg.info.origin.orientation = orientationAroundZAxis(load_parameters.origin[2]);
+
   // Since loadMapFromFile() does not belong to any node, publishing in a system time.
   rclcpp::Clock clock(RCL_SYSTEM_TIME);
   msg.info.map_load_time = clock.now();
@@ -392,7 +500,7 @@ void checkSaveParameters(SaveParameters & save_parameters)
     save_parameters.image_format.begin(),
     [](unsigned char c) {return std::tolower(c);});
 
-  const std::vector<std::string> BLESSED_FORMATS{"bmp", "pgm", "png"};
+  const std::vector<std::string> BLESSED_FORMATS{"bmp", "pgm", "png", TiledMap::FILE_EXTENSION};
   if (
     std::find(BLESSED_FORMATS.begin(), BLESSED_FORMATS.end(), save_parameters.image_format) ==
     BLESSED_FORMATS.end())
@@ -412,6 +520,11 @@ void checkSaveParameters(SaveParameters & save_parameters)
   }
   const std::string FALLBACK_FORMAT = "png";
 
+  // Tiled maps are written without Magick, and store occupancy values whatever the mode
+  if (save_parameters.image_format == TiledMap::FILE_EXTENSION) {
+    return;
+  }
+
   try {
     Magick::CoderInfo info(save_parameters.image_format);
     if (!info.isWritable()) {
@@ -441,6 +554,257 @@ void checkSaveParameters(SaveParameters & save_parameters)
   }
 }
 
+namespace
+{
+
+// Maps with fewer cells than this are converted by the calling thread only
+constexpr size_t MIN_PARALLEL_SAVE_CELLS = 1u << 20;
+// Number of map rows converted and written at once
+constexpr size_t SAVE_BAND_ROWS = 256u;
+// Size of the blocks read when hashing a map file
+constexpr size_t HASH_BLOCK_SIZE = 1u << 20;
+
+/**
+ * @brief Compute the pixel of every possible map cell value
+ * @param save_parameters Map saving parameters
+ * @return Pixels indexed by the map cell values cast to uint8_t
+ */
+std::vector<Magick::PixelPacket> makePixelTable(const SaveParameters & save_parameters)
+{
+  int free_thresh_int = std::rint(save_parameters.free_thresh * 100.0);
+  int occupied_thresh_int = std::rint(save_parameters.occupied_thresh * 100.0);
+
+  std::vector<Magick::PixelPacket> pixel_table(256);
+  for (int value = INT8_MIN; value <= INT8_MAX; value++) {
+    const int8_t map_cell = static_cast<int8_t>(value);
+
+    Magick::Color pixel;
+
+    switch (save_parameters.mode) {
+      case MapMode::Trinary:
+        if (map_cell < 0 || 100 < map_cell) {
+          pixel = Magick::ColorGray(205 / 255.0);
+        } else if (map_cell <= free_thresh_int) {
+          pixel = Magick::ColorGray(254 / 255.0);
+        } else if (occupied_thresh_int <= map_cell) {
+          pixel = Magick::ColorGray(0 / 255.0);
+        } else {
+          pixel = Magick::ColorGray(205 / 255.0);
+        }
+        break;
+      case MapMode::Scale:
+        if (map_cell < 0 || 100 < map_cell) {
+          pixel = Magick::ColorGray{0.5};
+          pixel.alphaQuantum(TransparentOpacity);
+        } else {
+          pixel = Magick::ColorGray{(100.0 - map_cell) / 100.0};
+        }
+        break;
+      case MapMode::Raw:
+        Magick::Quantum q;
+        if (map_cell < 0 || 100 < map_cell) {
+          q = MaxRGB;
+        } else {
+          q = map_cell / 255.0 * MaxRGB;
+        }
+        pixel = Magick::Color(q, q, q);
+        break;
+      default:
+        std::cerr << "[ERROR] [map_io]: Map mode should be Trinary, Scale or Raw" << std::endl;
+        throw std::runtime_error("Invalid map mode");
+    }
+    pixel_table[static_cast<uint8_t>(map_cell)] = pixel;
+  }
+  return pixel_table;
+}
+
+/**
+ * @brief Convert a band of image rows from the map, splitting large bands between threads.
+ * Image rows run from the top of the map, while map rows run from its bottom.
+ * @param pool Pool converting large bands, may be nullptr
+ * @param map Occupancy grid data
+ * @param y0 First image row of the band
+ * @param rows Number of rows of the band
+ * @param convert_row Function converting a row of map cells into a row of the band
+ */
+template<typename ConvertRow>
+void convertBand(
+  nav2_util::ThreadPool * pool, const nav_msgs::msg::OccupancyGrid & map,
+  size_t y0, size_t rows, ConvertRow convert_row)
+{
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  nav2_util::parallelFor(
+    rows * width >= MIN_PARALLEL_SAVE_CELLS ? pool : nullptr, rows,
+    [&](size_t begin, size_t end) {
+      for (size_t row = begin; row < end; row++) {
+        convert_row(&map.data[width * (height - (y0 + row) - 1)], row);
+      }
+    });
+}
+
+/**
+ * @brief Lock the conversion pool for saving a map large enough to use it
+ * @param map Occupancy grid data
+ * @param lock Lock to hold for as long as the pool is used
+ * @return The pool, nullptr if the map is converted by the calling thread only
+ */
+nav2_util::ThreadPool * lockSavePool(
+  const nav_msgs::msg::OccupancyGrid & map, std::unique_lock<std::mutex> & lock)
+{
+  const size_t band_cells = std::min<size_t>(map.info.height, SAVE_BAND_ROWS) * map.info.width;
+  return band_cells >= MIN_PARALLEL_SAVE_CELLS ? lockConversionPool(lock) : nullptr;
+}
+
+/**
+ * @brief Stream the map into a binary PGM file band by band, without building an image
+ * @param map Occupancy grid data
+ * @param pixel_table Pixels of the map cell values
+ * @param file_name Name of the PGM file
+ * @return Content hash of the file, computed while it is written
+ * @throw std::runtime_error if the file could not be written
+ */
+std::string writePgmFile(
+  const nav_msgs::msg::OccupancyGrid & map,
+  const std::vector<Magick::PixelPacket> & pixel_table,
+  const std::string & file_name)
+{
+  // Grey levels are written on 8 bits, like images of depth 8
+  unsigned char grey_table[256];
+  for (size_t i = 0; i < 256; i++) {
+    grey_table[i] =
+      static_cast<unsigned char>(std::lround(pixel_table[i].red * 255.0 / MaxRGB));
+  }
+
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + file_name + " for writing");
+  }
+  std::stringstream header;
+  header << "P5\n" << map.info.width << " " << map.info.height << "\n255\n";
+  const std::string header_bytes = header.str();
+  file.write(header_bytes.data(), header_bytes.size());
+  ContentHash content_hash;
+  content_hash.update(header_bytes.data(), header_bytes.size());
+
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  std::unique_lock<std::mutex> pool_lock;
+  nav2_util::ThreadPool * pool = lockSavePool(map, pool_lock);
+  std::vector<char> band(std::min(height, SAVE_BAND_ROWS) * width);
+  for (size_t y0 = 0; y0 < height; y0 += SAVE_BAND_ROWS) {
+    const size_t rows = std::min(SAVE_BAND_ROWS, height - y0);
+    convertBand(
+      pool, map, y0, rows, [&](const int8_t * cells, size_t row) {
+        char * grey = &band[row * width];
+        for (size_t x = 0; x < width; x++) {
+          grey[x] = static_cast<char>(grey_table[static_cast<uint8_t>(cells[x])]);
+        }
+      });
+    file.write(band.data(), rows * width);
+    content_hash.update(band.data(), rows * width);
+  }
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + file_name);
+  }
+  return content_hash.toString();
+}
+
+/**
+ * @brief Write the map into an image of any format through the pixel cache, band by band.
+ * The whole image is built in memory and encoded before being written.
+ * @param map Occupancy grid data
+ * @param pixel_table Pixels of the map cell values
+ * @param save_parameters Map saving parameters
+ * @param file_name Name of the image file
+ * @return Content hash of the file, computed from the encoded image as it is written
+ * @throw std::runtime_error if the file could not be written
+ */
+std::string writeImageFile(
+  const nav_msgs::msg::OccupancyGrid & map,
+  const std::vector<Magick::PixelPacket> & pixel_table,
+  const SaveParameters & save_parameters,
+  const std::string & file_name)
+{
+  // should never see this color, so the initialization value is just for debugging
+  Magick::Image image({map.info.width, map.info.height}, "red");
+
+  // In scale mode, we need the alpha (matte) channel. Else, we don't.
+  // NOTE: GraphicsMagick seems to have trouble loading the alpha channel when saved with
+  // Magick::GreyscaleMatte, so we use TrueColorMatte instead.
+  image.type(
+    save_parameters.mode == MapMode::Scale ?
+    Magick::TrueColorMatteType : Magick::GrayscaleType);
+
+  // Since we only need to support 100 different pixel levels, 8 bits is fine
+  image.depth(8);
+
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  image.classType(Magick::DirectClass);
+  image.modifyImage();
+  std::unique_lock<std::mutex> pool_lock;
+  nav2_util::ThreadPool * pool = lockSavePool(map, pool_lock);
+  Magick::Pixels view(image);
+  for (size_t y0 = 0; y0 < height; y0 += SAVE_BAND_ROWS) {
+    const size_t rows = std::min(SAVE_BAND_ROWS, height - y0);
+    Magick::PixelPacket * pixels = view.get(
+      0, static_cast<int>(y0), static_cast<unsigned int>(width),
+      static_cast<unsigned int>(rows));
+    if (pixels == nullptr) {
+      throw std::runtime_error("Failed to access the pixels of the image");
+    }
+    convertBand(
+      pool, map, y0, rows, [&](const int8_t * cells, size_t row) {
+        Magick::PixelPacket * row_pixels = pixels + row * width;
+        for (size_t x = 0; x < width; x++) {
+          row_pixels[x] = pixel_table[static_cast<uint8_t>(cells[x])];
+        }
+      });
+    view.sync();
+  }
+
+  // Encode the image in memory, so that it is hashed as it is written
+  Magick::Blob blob;
+  image.magick(save_parameters.image_format);
+  image.write(&blob);
+
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + file_name + " for writing");
+  }
+  const char * data = static_cast<const char *>(blob.data());
+  file.write(data, blob.length());
+  if (!file) {
+    throw std::runtime_error("Failed to write " + file_name);
+  }
+  ContentHash content_hash;
+  content_hash.update(data, blob.length());
+  return content_hash.toString();
+}
+
+}  // namespace
+
+std::string computeMapContentHash(const std::string & file_name)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + file_name);
+  }
+
+  ContentHash content_hash;
+  std::vector<char> block(HASH_BLOCK_SIZE);
+  while (file) {
+    file.read(block.data(), block.size());
+    content_hash.update(block.data(), static_cast<size_t>(file.gcount()));
+  }
+  if (file.bad()) {
+    throw std::runtime_error("Failed to read " + file_name);
+  }
+  return content_hash.toString();
+}
+
 /**
  * @brief Tries to write map data into a file
  * @param map Occupancy grid data
@@ -456,68 +820,19 @@ void tryWriteMapToFile(
     map.info.resolution << " m/pix" << std::endl;
 
   std::string mapdatafile = save_parameters.map_file_name + "." + save_parameters.image_format;
-  {
-    // should never see this color, so the initialization value is just for debugging
-    Magick::Image image({map.info.width, map.info.height}, "red");
-
-    // In scale mode, we need the alpha (matte) channel. Else, we don't.
-    // NOTE: GraphicsMagick seems to have trouble loading the alpha channel when saved with
-    // Magick::GreyscaleMatte, so we use TrueColorMatte instead.
-    image.type(
-      save_parameters.mode == MapMode::Scale ?
-      Magick::TrueColorMatteType : Magick::GrayscaleType);
-
-    // Since we only need to support 100 different pixel levels, 8 bits is fine
-    image.depth(8);
-
-    int free_thresh_int = std::rint(save_parameters.free_thresh * 100.0);
-    int occupied_thresh_int = std::rint(save_parameters.occupied_thresh * 100.0);
-
-    for (size_t y = 0; y < map.info.height; y++) {
-      for (size_t x = 0; x < map.info.width; x++) {
-        int8_t map_cell = map.data[map.info.width * (map.info.height - y - 1) + x];
-
-        Magick::Color pixel;
-
-        switch (save_parameters.mode) {
-          case MapMode::Trinary:
-            if (map_cell < 0 || 100 < map_cell) {
-              pixel = Magick::ColorGray(205 / 255.0);
-            } else if (map_cell <= free_thresh_int) {
-              pixel = Magick::ColorGray(254 / 255.0);
-            } else if (occupied_thresh_int <= map_cell) {
-              pixel = Magick::ColorGray(0 / 255.0);
-            } else {
-              pixel = Magick::ColorGray(205 / 255.0);
-            }
-            break;
-          case MapMode::Scale:
-            if (map_cell < 0 || 100 < map_cell) {
-              pixel = Magick::ColorGray{0.5};
-              pixel.alphaQuantum(TransparentOpacity);
-            } else {
-              pixel = Magick::ColorGray{(100.0 - map_cell) / 100.0};
-            }
-            break;
-          case MapMode::Raw:
-            Magick::Quantum q;
-            if (map_cell < 0 || 100 < map_cell) {
-              q = MaxRGB;
-            } else {
-              q = map_cell / 255.0 * MaxRGB;
-            }
-            pixel = Magick::Color(q, q, q);
-            break;
-          default:
-            std::cerr << "[ERROR] [map_io]: Map mode should be Trinary, Scale or Raw" << std::endl;
-            throw std::runtime_error("Invalid map mode");
-        }
-        image.pixelColor(x, y, pixel);
-      }
-    }
-
+  std::string content_hash;
+  if (save_parameters.image_format == TiledMap::FILE_EXTENSION) {
+    std::cout << "[INFO] [map_io]: Writing tiled map occupancy data to " << mapdatafile <<
+      std::endl;
+    content_hash = TiledMap::write(map, mapdatafile);
+  } else {
     std::cout << "[INFO] [map_io]: Writing map occupancy data to " << mapdatafile << std::endl;
-    image.write(mapdatafile);
+    const auto pixel_table = makePixelTable(save_parameters);
+    if (save_parameters.image_format == "pgm") {
+      content_hash = writePgmFile(map, pixel_table, mapdatafile);
+    } else {
+      content_hash = writeImageFile(map, pixel_table, save_parameters, mapdatafile);
+    }
   }
 
   std::string mapmetadatafile = save_parameters.map_file_name + ".yaml";
@@ -543,6 +858,7 @@ void tryWriteMapToFile(
     e << YAML::Key << "negate" << YAML::Value << 0;
     e << YAML::Key << "occupied_thresh" << YAML::Value << save_parameters.occupied_thresh;
     e << YAML::Key << "free_thresh" << YAML::Value << save_parameters.free_thresh;
+    e << YAML::Key << "content_hash" << YAML::Value << content_hash;
 
     if (!e.good()) {
       std::cout <<
@@ -46,15 +46,21 @@
 
 #include "nav2_map_server/map_server.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <string>
 #include <memory>
 #include <fstream>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "yaml-cpp/yaml.h"
 #include "lifecycle_msgs/msg/state.hpp"
 #include "nav2_map_server/map_io.hpp"
+#include "nav2_util/geometry_utils.hpp"
+#include "tf2/utils.h"
 
 using namespace std::chrono_literals;
 using namespace std::placeholders;
@@ -63,7 +69,8 @@ namespace nav2_map_server
 {
 
 MapServer::MapServer(const rclcpp::NodeOptions & options)
-: nav2_util::LifecycleNode("map_server", "", options), map_available_(false)
+: nav2_util::LifecycleNode("map_server", "", options), map_available_(false),
+  serve_map_regions_(false)
 {
   RCLCPP_INFO(get_logger(), "Creating");
 
@@ -71,6 +78,7 @@ MapServer::MapServer(const rclcpp::NodeOptions & options)
   declare_parameter("yaml_filename", rclcpp::PARAMETER_STRING);
   declare_parameter("topic_name", "map");
   declare_parameter("frame_id", "map");
+  declare_parameter("serve_map_regions", false);
 }
 
 MapServer::~MapServer()
@@ -86,6 +94,7 @@ MapServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
   std::string yaml_filename = get_parameter("yaml_filename").as_string();
   std::string topic_name = get_parameter("topic_name").as_string();
   frame_id_ = get_parameter("frame_id").as_string();
+  serve_map_regions_ = get_parameter("serve_map_regions").as_bool();
 
   // only try to load map if parameter was set
   if (!yaml_filename.empty()) {
@@ -122,6 +131,11 @@ MapServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
     service_prefix + std::string(load_map_service_name_),
     std::bind(&MapServer::loadMapCallback, this, _1, _2, _3));
 
+  // Create a service that provides the occupancy grid around a region
+  map_region_service_ = create_service<nav2_msgs::srv::GetMapRegion>(
+    service_prefix + std::string(map_region_service_name_),
+    std::bind(&MapServer::getMapRegionCallback, this, _1, _2, _3));
+
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
@@ -130,9 +144,9 @@ MapServer::on_activate(const rclcpp_lifecycle::State & /*state*/)
 {
   RCLCPP_INFO(get_logger(), "Activating");
 
-  // Publish the map using the latched topic
+  // Publish the map using the latched topic, unless it is only read by regions
   occ_pub_->on_activate();
-  if (map_available_) {
+  if (map_available_ && !tiled_map_) {
     auto occ_grid = std::make_unique<nav_msgs::msg::OccupancyGrid>(msg_);
     occ_pub_->publish(std::move(occ_grid));
   }
@@ -164,8 +178,10 @@ MapServer::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   occ_pub_.reset();
   occ_service_.reset();
   load_map_service_.reset();
+  map_region_service_.reset();
   map_available_ = false;
   msg_ = nav_msgs::msg::OccupancyGrid();
+  tiled_map_.reset();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -191,6 +207,89 @@ void MapServer::getMapCallback(
   }
   RCLCPP_INFO(get_logger(), "Handling GetMap request");
   response->map = msg_;
+  if (tiled_map_) {
+    response->map.data.resize(static_cast<size_t>(msg_.info.width) * msg_.info.height);
+    copyMapRegion(0, 0, msg_.info.width, msg_.info.height, response->map.data.data());
+  }
+}
+
+void MapServer::getMapRegionCallback(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<nav2_msgs::srv::GetMapRegion::Request> request,
+  std::shared_ptr<nav2_msgs::srv::GetMapRegion::Response> response)
+{
+  response->success = false;
+  // if not in ACTIVE state, ignore request
+  if (get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Received GetMapRegion request but not in ACTIVE state, ignoring!");
+    return;
+  }
+  if (!map_available_ || request->min_x > request->max_x || request->min_y > request->max_y) {
+    RCLCPP_WARN(get_logger(), "Received GetMapRegion request without map or region, ignoring!");
+    return;
+  }
+  RCLCPP_DEBUG(get_logger(), "Handling GetMapRegion request");
+
+  // Bounding window, in cells, of the region expressed in the frame of the map origin
+  const auto & info = msg_.info;
+  const double yaw = tf2::getYaw(info.origin.orientation);
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+  double min_mx = info.width;
+  double min_my = info.height;
+  double max_mx = 0.0;
+  double max_my = 0.0;
+  for (const double x : {request->min_x, request->max_x}) {
+    for (const double y : {request->min_y, request->max_y}) {
+      const double dx = x - info.origin.position.x;
+      const double dy = y - info.origin.position.y;
+      const double mx = (cos_yaw * dx + sin_yaw * dy) / info.resolution;
+      const double my = (cos_yaw * dy - sin_yaw * dx) / info.resolution;
+      min_mx = std::min(min_mx, mx);
+      min_my = std::min(min_my, my);
+      max_mx = std::max(max_mx, mx);
+      max_my = std::max(max_my, my);
+    }
+  }
+  const auto x0 = static_cast<unsigned int>(std::max(std::floor(min_mx), 0.0));
+  const auto y0 = static_cast<unsigned int>(std::max(std::floor(min_my), 0.0));
+  const auto x1 = static_cast<unsigned int>(
+    std::min(std::ceil(max_mx), static_cast<double>(info.width)));
+  const auto y1 = static_cast<unsigned int>(
+    std::min(std::ceil(max_my), static_cast<double>(info.height)));
+  if (x0 >= x1 || y0 >= y1) {
+    RCLCPP_WARN(get_logger(), "Received GetMapRegion request outside of the map, ignoring!");
+    return;
+  }
+
+  response->map.header = msg_.header;
+  response->map.info = info;
+  response->map.info.width = x1 - x0;
+  response->map.info.height = y1 - y0;
+  response->map.info.origin.position.x +=
+    (cos_yaw * x0 - sin_yaw * y0) * info.resolution;
+  response->map.info.origin.position.y +=
+    (sin_yaw * x0 + cos_yaw * y0) * info.resolution;
+  response->map.data.resize(static_cast<size_t>(x1 - x0) * (y1 - y0));
+  copyMapRegion(x0, y0, x1 - x0, y1 - y0, response->map.data.data());
+  response->success = true;
+}
+
+void MapServer::copyMapRegion(
+  unsigned int x0, unsigned int y0, unsigned int width, unsigned int height,
+  int8_t * data) const
+{
+  if (tiled_map_) {
+    tiled_map_->copyRegion(x0, y0, width, height, data);
+    return;
+  }
+  for (unsigned int y = 0; y < height; y++) {
+    std::memcpy(
+      data + static_cast<size_t>(y) * width,
+      msg_.data.data() + static_cast<size_t>(y0 + y) * msg_.info.width + x0, width);
+  }
 }
 
 void MapServer::loadMapCallback(
@@ -208,7 +307,14 @@ void MapServer::loadMapCallback(
   }
   RCLCPP_INFO(get_logger(), "Handling LoadMap request");
   // Load from file
-  if (loadMapResponseFromYaml(request->map_url, response)) {
+  if (!loadMapResponseFromYaml(request->map_url, response)) {
+    return;
+  }
+  if (tiled_map_) {
+    // Tiled maps are not held whole, so copy all of their cells into the response
+    response->map.data.resize(static_cast<size_t>(msg_.info.width) * msg_.info.height);
+    copyMapRegion(0, 0, msg_.info.width, msg_.info.height, response->map.data.data());
+  } else {
     auto occ_grid = std::make_unique<nav_msgs::msg::OccupancyGrid>(msg_);
     occ_pub_->publish(std::move(occ_grid));  // publish new map
   }
@@ -218,7 +324,10 @@ bool MapServer::loadMapResponseFromYaml(
   const std::string & yaml_file,
   std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response)
 {
-  switch (loadMapFromYaml(yaml_file, msg_)) {
+  tiled_map_.reset();
+  const LOAD_MAP_STATUS status = serve_map_regions_ ?
+    loadTiledMapFromYaml(yaml_file) : loadMapFromYaml(yaml_file, msg_);
+  switch (status) {
     case MAP_DOES_NOT_EXIST:
       response->result = nav2_msgs::srv::LoadMap::Response::RESULT_MAP_DOES_NOT_EXIST;
       return false;
@@ -240,6 +349,52 @@ bool MapServer::loadMapResponseFromYaml(
   return true;
 }
 
+LOAD_MAP_STATUS MapServer::loadTiledMapFromYaml(const std::string & yaml_file)
+{
+  if (yaml_file.empty()) {
+    RCLCPP_ERROR(get_logger(), "YAML file name is empty, can't load!");
+    return MAP_DOES_NOT_EXIST;
+  }
+  LoadParameters load_parameters;
+  try {
+    load_parameters = loadMapYaml(yaml_file);
+  } catch (std::exception & e) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to parse map YAML loaded from file %s for reason: %s",
+      yaml_file.c_str(), e.what());
+    return INVALID_MAP_METADATA;
+  }
+  try {
+    if (!TiledMap::isTiledMapFile(load_parameters.image_file_name)) {
+      RCLCPP_WARN(
+        get_logger(), "Map %s is not tiled, loading it whole",
+        load_parameters.image_file_name.c_str());
+      loadMapFromFile(load_parameters, msg_);
+      return LOAD_MAP_SUCCESS;
+    }
+    auto tiled_map = std::make_unique<TiledMap>(load_parameters.image_file_name);
+    msg_ = nav_msgs::msg::OccupancyGrid();
+    msg_.info.width = tiled_map->width();
+    msg_.info.height = tiled_map->height();
+    msg_.info.resolution = load_parameters.resolution;
+    msg_.info.origin.position.x = load_parameters.origin[0];
+    msg_.info.origin.position.y = load_parameters.origin[1];
+    msg_.info.origin.orientation =
+      nav2_util::geometry_utils::orientationAroundZAxis(load_parameters.origin[2]);
+    tiled_map_ = std::move(tiled_map);
+  } catch (std::exception & e) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to load map file %s for reason: %s",
+      load_parameters.image_file_name.c_str(), e.what());
+    return INVALID_MAP_DATA;
+  }
+  RCLCPP_INFO(
+    get_logger(), "Serving regions of tiled map %s: %u X %u map @ %.3f m/cell",
+    load_parameters.image_file_name.c_str(), msg_.info.width, msg_.info.height,
+    msg_.info.resolution);
+  return LOAD_MAP_SUCCESS;
+}
+
 void MapServer::updateMsgHeader()
 {
   msg_.info.map_load_time = now();
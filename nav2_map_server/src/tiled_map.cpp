@@ -0,0 +1,221 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_map_server/tiled_map.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nav2_util/occ_grid_values.hpp"
+#include "nav2_map_server/content_hash.hpp"
+
+namespace nav2_map_server
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = {'N', 'A', 'V', '2', 'T', 'M', 'A', 'P'};
+constexpr uint32_t VERSION = 1;
+
+// Header fields are stored little-endian, whatever the host
+void encodeUint32(uint32_t value, char * out)
+{
+  for (int i = 0; i < 4; i++) {
+    out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+uint32_t decodeUint32(const char * in)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+  }
+  return value;
+}
+
+}  // namespace
+
+std::string TiledMap::write(
+  const nav_msgs::msg::OccupancyGrid & map, const std::string & file_name,
+  uint32_t tile_size)
+{
+  const uint32_t width = map.info.width;
+  const uint32_t height = map.info.height;
+  if (tile_size == 0 || map.data.size() != static_cast<size_t>(width) * height) {
+    throw std::runtime_error("Invalid map or tile size");
+  }
+
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + file_name + " for writing");
+  }
+
+  std::vector<char> header(HEADER_SIZE, 0);
+  std::copy(std::begin(MAGIC), std::end(MAGIC), header.begin());
+  encodeUint32(VERSION, &header[8]);
+  encodeUint32(tile_size, &header[12]);
+  encodeUint32(width, &header[16]);
+  encodeUint32(height, &header[20]);
+  file.write(header.data(), header.size());
+  ContentHash content_hash;
+  content_hash.update(header.data(), header.size());
+
+  const uint32_t tiles_x = (width + tile_size - 1) / tile_size;
+  const uint32_t tiles_y = (height + tile_size - 1) / tile_size;
+  std::vector<int8_t> tile(static_cast<size_t>(tile_size) * tile_size);
+  for (uint32_t ty = 0; ty < tiles_y; ty++) {
+    for (uint32_t tx = 0; tx < tiles_x; tx++) {
+      std::fill(tile.begin(), tile.end(), nav2_util::OCC_GRID_UNKNOWN);
+      const uint32_t x0 = tx * tile_size;
+      const uint32_t y0 = ty * tile_size;
+      const uint32_t columns = std::min(tile_size, width - x0);
+      const uint32_t rows = std::min(tile_size, height - y0);
+      for (uint32_t row = 0; row < rows; row++) {
+        const auto begin = map.data.begin() + static_cast<size_t>(y0 + row) * width + x0;
+        std::copy(begin, begin + columns, tile.begin() + static_cast<size_t>(row) * tile_size);
+      }
+      file.write(reinterpret_cast<const char *>(tile.data()), tile.size());
+      content_hash.update(reinterpret_cast<const char *>(tile.data()), tile.size());
+    }
+  }
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + file_name);
+  }
+  return content_hash.toString();
+}
+
+bool TiledMap::isTiledMapFile(const std::string & file_name)
+{
+  const std::string extension = std::string(".") + FILE_EXTENSION;
+  return file_name.size() >= extension.size() &&
+         file_name.compare(file_name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+TiledMap::TiledMap(const std::string & file_name)
+{
+  const char * data = nullptr;
+  size_t size = 0;
+#ifndef _WIN32
+  const int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open " + file_name);
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    mapping_size_ = static_cast<size_t>(file_stat.st_size);
+    mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping_ == MAP_FAILED) {
+      mapping_ = nullptr;
+    }
+  }
+  ::close(fd);
+  if (mapping_ == nullptr) {
+    throw std::runtime_error("Failed to map " + file_name);
+  }
+  data = static_cast<const char *>(mapping_);
+  size = mapping_size_;
+#else
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + file_name);
+  }
+  buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  data = reinterpret_cast<const char *>(buffer_.data());
+  size = buffer_.size();
+#endif
+
+  if (size < HEADER_SIZE || !std::equal(std::begin(MAGIC), std::end(MAGIC), data) ||
+    decodeUint32(data + 8) != VERSION)
+  {
+    unmap();
+    throw std::runtime_error(file_name + " is not a tiled map of version " +
+            std::to_string(VERSION));
+  }
+  tile_size_ = decodeUint32(data + 12);
+  width_ = decodeUint32(data + 16);
+  height_ = decodeUint32(data + 20);
+  if (tile_size_ == 0) {
+    unmap();
+    throw std::runtime_error(file_name + " has no tile size");
+  }
+  tiles_x_ = (width_ + tile_size_ - 1) / tile_size_;
+  tiles_y_ = (height_ + tile_size_ - 1) / tile_size_;
+  if (size - HEADER_SIZE <
+    static_cast<size_t>(tiles_x_) * tiles_y_ * tile_size_ * tile_size_)
+  {
+    unmap();
+    throw std::runtime_error(file_name + " is truncated");
+  }
+  tiles_ = reinterpret_cast<const int8_t *>(data + HEADER_SIZE);
+}
+
+TiledMap::~TiledMap()
+{
+  unmap();
+}
+
+void TiledMap::unmap()
+{
+#ifndef _WIN32
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+  }
+#endif
+  tiles_ = nullptr;
+}
+
+void TiledMap::copyRegion(
+  uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, int8_t * data) const
+{
+  if (x0 > width_ || width > width_ - x0 || y0 > height_ || height > height_ - y0) {
+    throw std::out_of_range("Region exceeds the tiled map");
+  }
+
+  // Rows of the region are filled tile by tile, so that each tile is paged in once
+  const uint32_t x1 = x0 + width;
+  const uint32_t y1 = y0 + height;
+  for (uint32_t ty = y0 / tile_size_; ty * tile_size_ < y1; ty++) {
+    const uint32_t tile_y0 = std::max(y0, ty * tile_size_);
+    const uint32_t tile_y1 = std::min(y1, (ty + 1) * tile_size_);
+    for (uint32_t tx = x0 / tile_size_; tx * tile_size_ < x1; tx++) {
+      const uint32_t tile_x0 = std::max(x0, tx * tile_size_);
+      const uint32_t tile_x1 = std::min(x1, (tx + 1) * tile_size_);
+      const int8_t * cells = tile(tx, ty);
+      for (uint32_t y = tile_y0; y < tile_y1; y++) {
+        const int8_t * row = cells + static_cast<size_t>(y - ty * tile_size_) * tile_size_;
+        std::memcpy(
+          data + static_cast<size_t>(y - y0) * width + (tile_x0 - x0),
+          row + (tile_x0 - tx * tile_size_), tile_x1 - tile_x0);
+      }
+    }
+  }
+}
+
+}  // namespace nav2_map_server
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <cmath>
 
 #include <string>
 #include <memory>
@@ -24,6 +25,7 @@
 #include "nav2_map_server/map_server.hpp"
 #include "nav2_util/lifecycle_service_client.hpp"
 #include "nav2_msgs/srv/load_map.hpp"
+#include "nav2_msgs/srv/get_map_region.hpp"
 using namespace std::chrono_literals;
 using namespace rclcpp;  // NOLINT
 
@@ -122,6 +124,50 @@ TEST_F(MapServerTestFixture, GetMap)
   verifyMapMsg(resp->map);
 }
 
+// Send map region getting service requests: a region covering the whole map, a single cell
+// and a region outside of the map
+TEST_F(MapServerTestFixture, GetMapRegion)
+{
+  RCLCPP_INFO(node_->get_logger(), "Testing GetMapRegion service");
+  auto req = std::make_shared<nav2_msgs::srv::GetMapRegion::Request>();
+  auto client = node_->create_client<nav2_msgs::srv::GetMapRegion>(
+    "/map_server/map_region");
+
+  RCLCPP_INFO(node_->get_logger(), "Waiting for map_region service");
+  ASSERT_TRUE(client->wait_for_service());
+
+  req->min_x = -100.0;
+  req->min_y = -100.0;
+  req->max_x = 100.0;
+  req->max_y = 100.0;
+  auto resp = send_request<nav2_msgs::srv::GetMapRegion>(node_, client, req);
+  ASSERT_TRUE(resp->success);
+  verifyMapMsg(resp->map);
+
+  // Center of the cell (3, 4) of the map, rotated by the yaw of its origin
+  const double mx = 3.5 * g_valid_image_res;
+  const double my = 4.5 * g_valid_image_res;
+  const double yaw = g_valid_origin[2];
+  req->min_x = req->max_x = g_valid_origin[0] + std::cos(yaw) * mx - std::sin(yaw) * my;
+  req->min_y = req->max_y = g_valid_origin[1] + std::sin(yaw) * mx + std::cos(yaw) * my;
+  resp = send_request<nav2_msgs::srv::GetMapRegion>(node_, client, req);
+  ASSERT_TRUE(resp->success);
+  ASSERT_EQ(resp->map.info.width, 1u);
+  ASSERT_EQ(resp->map.info.height, 1u);
+  EXPECT_EQ(resp->map.data[0], g_valid_image_content[4 * g_valid_image_width + 3]);
+  EXPECT_NEAR(
+    resp->map.info.origin.position.x,
+    g_valid_origin[0] + (std::cos(yaw) * 3.0 - std::sin(yaw) * 4.0) * g_valid_image_res, 1e-6);
+  EXPECT_NEAR(
+    resp->map.info.origin.position.y,
+    g_valid_origin[1] + (std::sin(yaw) * 3.0 + std::cos(yaw) * 4.0) * g_valid_image_res, 1e-6);
+
+  req->min_x = req->max_x = 100.0;
+  req->min_y = req->max_y = 100.0;
+  resp = send_request<nav2_msgs::srv::GetMapRegion>(node_, client, req);
+  EXPECT_FALSE(resp->success);
+}
+
 // Send map loading service request and verify obtained OccupancyGrid
 TEST_F(MapServerTestFixture, LoadMap)
 {
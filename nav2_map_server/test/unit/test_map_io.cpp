@@ -32,6 +32,7 @@
 /* Author: Brian Gerkey */
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <filesystem>
 #include <stdexcept>
 #include <string>
@@ -39,11 +40,16 @@
 #include <memory>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <random>
 
+#include "Magick++.h"
 #include "yaml-cpp/yaml.h"
 #include "nav2_map_server/map_io.hpp"
 #include "nav2_map_server/map_server.hpp"
+#include "nav2_map_server/tiled_map.hpp"
 #include "nav2_util/lifecycle_node.hpp"
+#include "nav2_util/occ_grid_values.hpp"
 #include "test_constants/test_constants.h"
 
 #define TEST_DIR TEST_DIRECTORY
@@ -197,6 +203,73 @@ TEST_F(MapIOTester, loadSaveValidBMP)
   verifyMapMsg(map_msg);
 }
 
+// Load a valid reference PGM file. Save obtained OccupancyGrid message into a tmp tiled map
+// file. Then load back saved tmp file and check for consistency.
+// Succeeds all steps were passed without a problem or expection.
+TEST_F(MapIOTester, loadSaveValidTiledMap)
+{
+  // 1. Load reference map file
+  LoadParameters loadParameters;
+  fillLoadParameters(path(TEST_DIR) / path(g_valid_pgm_file), loadParameters);
+
+  nav_msgs::msg::OccupancyGrid map_msg;
+  ASSERT_NO_THROW(loadMapFromFile(loadParameters, map_msg));
+
+  // 2. Save OccupancyGrid into a tmp file
+  SaveParameters saveParameters;
+  fillSaveParameters(path(g_tmp_dir) / path(g_valid_map_name), "TMAP", saveParameters);
+
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+
+  // 3. Load saved map and verify it
+  LOAD_MAP_STATUS status = loadMapFromYaml(path(g_tmp_dir) / path(g_valid_yaml_file), map_msg);
+  ASSERT_EQ(status, LOAD_MAP_SUCCESS);
+
+  verifyMapMsg(map_msg);
+}
+
+// Write a map into tiles smaller than the map, and not dividing its size.
+// Read back windows of the map straddling the tiles and compare them with the map.
+TEST_F(MapIOTester, readTiledMapRegions)
+{
+  nav_msgs::msg::OccupancyGrid map_msg;
+  map_msg.info.width = 53;
+  map_msg.info.height = 37;
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(-1, 100);
+  for (unsigned int i = 0; i < map_msg.info.width * map_msg.info.height; i++) {
+    map_msg.data.push_back(static_cast<int8_t>(value(generator)));
+  }
+
+  const std::string file_name = path(g_tmp_dir) / path("tiled_map.tmap");
+  ASSERT_NO_THROW(TiledMap::write(map_msg, file_name, 16));
+  ASSERT_TRUE(TiledMap::isTiledMapFile(file_name));
+
+  TiledMap tiled_map(file_name);
+  ASSERT_EQ(tiled_map.width(), map_msg.info.width);
+  ASSERT_EQ(tiled_map.height(), map_msg.info.height);
+  ASSERT_EQ(tiled_map.tileSize(), 16u);
+
+  for (unsigned int y0 = 0; y0 < map_msg.info.height; y0 += 7) {
+    for (unsigned int x0 = 0; x0 < map_msg.info.width; x0 += 11) {
+      const unsigned int width = std::min(20u, map_msg.info.width - x0);
+      const unsigned int height = std::min(18u, map_msg.info.height - y0);
+      std::vector<int8_t> region(width * height);
+      tiled_map.copyRegion(x0, y0, width, height, region.data());
+      for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+          ASSERT_EQ(
+            region[y * width + x], map_msg.data[(y0 + y) * map_msg.info.width + x0 + x]);
+        }
+      }
+    }
+  }
+
+  std::vector<int8_t> region(16);
+  EXPECT_THROW(tiled_map.copyRegion(50, 0, 4, 4, region.data()), std::out_of_range);
+  EXPECT_THROW(TiledMap(path(TEST_DIR) / path(g_valid_pgm_file)), std::runtime_error);
+}
+
 // Load map from a valid file. Trying to save map with different modes.
 // Succeeds all steps were passed without a problem or expection.
 TEST_F(MapIOTester, loadSaveMapModes)
@@ -232,6 +305,262 @@ TEST_F(MapIOTester, loadSaveMapModes)
   verifyMapMsg(map_msg);
 }
 
+// Reference conversion of an image into an OccupancyGrid, reading pixels one by one
+std::vector<int8_t> referenceMapData(const LoadParameters & load_parameters)
+{
+  Magick::Image img(load_parameters.image_file_name);
+  const size_t width = img.size().width();
+  const size_t height = img.size().height();
+  std::vector<int8_t> data(width * height);
+  for (size_t y = 0; y < height; y++) {
+    for (size_t x = 0; x < width; x++) {
+      auto pixel = img.pixelColor(x, y);
+      std::vector<Magick::Quantum> channels = {pixel.redQuantum(), pixel.greenQuantum(),
+        pixel.blueQuantum()};
+      if (load_parameters.mode == MapMode::Trinary && img.matte()) {
+        channels.push_back(MaxRGB - pixel.alphaQuantum());
+      }
+      double sum = 0;
+      for (auto c : channels) {
+        sum += c;
+      }
+      double shade = Magick::ColorGray::scaleQuantumToDouble(sum / channels.size());
+      double occ = (load_parameters.negate ? shade : 1.0 - shade);
+
+      int8_t map_cell;
+      if (load_parameters.mode == MapMode::Raw) {
+        double occ_percent = std::round(shade * 255);
+        map_cell = (0 <= occ_percent && occ_percent <= 100) ?
+          static_cast<int8_t>(occ_percent) : nav2_util::OCC_GRID_UNKNOWN;
+      } else if (load_parameters.mode == MapMode::Scale && pixel.alphaQuantum() != OpaqueOpacity) {
+        map_cell = nav2_util::OCC_GRID_UNKNOWN;
+      } else if (load_parameters.occupied_thresh < occ) {
+        map_cell = nav2_util::OCC_GRID_OCCUPIED;
+      } else if (occ < load_parameters.free_thresh) {
+        map_cell = nav2_util::OCC_GRID_FREE;
+      } else if (load_parameters.mode == MapMode::Scale) {
+        map_cell = std::rint(
+          (occ - load_parameters.free_thresh) /
+          (load_parameters.occupied_thresh - load_parameters.free_thresh) * 100.0);
+      } else {
+        map_cell = nav2_util::OCC_GRID_UNKNOWN;
+      }
+      data[width * (height - y - 1) + x] = map_cell;
+    }
+  }
+  return data;
+}
+
+// Load a large image with random colors and transparency, converted on several threads,
+// in all modes. Succeeds if the map matches the one converted pixel by pixel.
+TEST_F(MapIOTester, loadLargeImageModes)
+{
+  // Large enough to be converted on several threads, with partial pixel bands
+  const size_t width = 1201;
+  const size_t height = 1003;
+  Magick::InitializeMagick(nullptr);
+  Magick::Image img(Magick::Geometry(width, height), Magick::Color(0, 0, 0, 0));
+  img.matte(true);
+  {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> level(0, 255);
+    Magick::Pixels view(img);
+    Magick::PixelPacket * pixels = view.get(0, 0, width, height);
+    for (size_t i = 0; i < width * height; i++) {
+      const int gray = level(gen);
+      // Mostly gray and opaque pixels, as in maps, and some colored or transparent ones
+      pixels[i].red = pixels[i].green = pixels[i].blue = gray * (MaxRGB / 255);
+      pixels[i].opacity = OpaqueOpacity;
+      if (i % 7 == 0) {
+        pixels[i].green = level(gen) * (MaxRGB / 255);
+      }
+      if (i % 11 == 0) {
+        pixels[i].opacity = level(gen) * (MaxRGB / 255);
+      }
+    }
+    view.sync();
+  }
+  const std::string image_file = path(g_tmp_dir) / path("large_test_map.png");
+  img.write(image_file);
+
+  LoadParameters loadParameters;
+  fillLoadParameters(image_file, loadParameters);
+  for (auto mode : {MapMode::Trinary, MapMode::Scale, MapMode::Raw}) {
+    for (bool negate : {false, true}) {
+      loadParameters.mode = mode;
+      loadParameters.negate = negate;
+
+      nav_msgs::msg::OccupancyGrid map_msg;
+      ASSERT_NO_THROW(loadMapFromFile(loadParameters, map_msg));
+      ASSERT_EQ(map_msg.info.width, width);
+      ASSERT_EQ(map_msg.info.height, height);
+      ASSERT_EQ(map_msg.data, referenceMapData(loadParameters)) <<
+        "mode: " << map_mode_to_string(mode) << ", negate: " << negate;
+    }
+  }
+}
+
+// Random map cells, with all of the occupancy values and some out of range ones
+nav_msgs::msg::OccupancyGrid makeRandomMap(unsigned int width, unsigned int height)
+{
+  nav_msgs::msg::OccupancyGrid map_msg;
+  map_msg.info.width = width;
+  map_msg.info.height = height;
+  map_msg.info.resolution = g_valid_image_res;
+  map_msg.info.origin.orientation.w = 1.0;
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(-3, 103);
+  for (unsigned int i = 0; i < width * height; i++) {
+    map_msg.data.push_back(static_cast<int8_t>(value(generator)));
+  }
+  return map_msg;
+}
+
+// Reference image of a map, written pixel by pixel through GraphicsMagick
+void writeReferenceImage(
+  const nav_msgs::msg::OccupancyGrid & map, const SaveParameters & save_parameters,
+  const std::string & file_name)
+{
+  Magick::Image image({map.info.width, map.info.height}, "red");
+  image.type(
+    save_parameters.mode == MapMode::Scale ?
+    Magick::TrueColorMatteType : Magick::GrayscaleType);
+  image.depth(8);
+
+  int free_thresh_int = std::rint(save_parameters.free_thresh * 100.0);
+  int occupied_thresh_int = std::rint(save_parameters.occupied_thresh * 100.0);
+  for (size_t y = 0; y < map.info.height; y++) {
+    for (size_t x = 0; x < map.info.width; x++) {
+      int8_t map_cell = map.data[map.info.width * (map.info.height - y - 1) + x];
+      Magick::Color pixel;
+      if (save_parameters.mode == MapMode::Trinary) {
+        if (map_cell < 0 || 100 < map_cell) {
+          pixel = Magick::ColorGray(205 / 255.0);
+        } else if (map_cell <= free_thresh_int) {
+          pixel = Magick::ColorGray(254 / 255.0);
+        } else if (occupied_thresh_int <= map_cell) {
+          pixel = Magick::ColorGray(0 / 255.0);
+        } else {
+          pixel = Magick::ColorGray(205 / 255.0);
+        }
+      } else if (save_parameters.mode == MapMode::Scale) {
+        if (map_cell < 0 || 100 < map_cell) {
+          pixel = Magick::ColorGray{0.5};
+          pixel.alphaQuantum(TransparentOpacity);
+        } else {
+          pixel = Magick::ColorGray{(100.0 - map_cell) / 100.0};
+        }
+      } else {
+        Magick::Quantum q;
+        if (map_cell < 0 || 100 < map_cell) {
+          q = MaxRGB;
+        } else {
+          q = map_cell / 255.0 * MaxRGB;
+        }
+        pixel = Magick::Color(q, q, q);
+      }
+      image.pixelColor(x, y, pixel);
+    }
+  }
+  image.write(file_name);
+}
+
+std::vector<char> readFileBytes(const std::string & file_name)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Save maps in every mode as PGM files, streamed without an intermediate image.
+// Succeeds if the files are the same, byte for byte, as written by GraphicsMagick.
+TEST_F(MapIOTester, saveStreamedPGMLikeGraphicsMagick)
+{
+  Magick::InitializeMagick(nullptr);
+  const nav_msgs::msg::OccupancyGrid map_msg = makeRandomMap(157, 91);
+  const std::string map_name = path(g_tmp_dir) / path("streamed_map");
+  const std::string reference_name = path(g_tmp_dir) / path("reference_map.pgm");
+  for (auto mode : {MapMode::Trinary, MapMode::Scale, MapMode::Raw}) {
+    SaveParameters saveParameters;
+    fillSaveParameters(map_name, "pgm", saveParameters);
+    saveParameters.mode = mode;
+    ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+    writeReferenceImage(map_msg, saveParameters, reference_name);
+
+    const std::vector<char> reference = readFileBytes(reference_name);
+    ASSERT_FALSE(reference.empty());
+    EXPECT_EQ(readFileBytes(map_name + ".pgm"), reference) <<
+      "mode: " << map_mode_to_string(mode);
+  }
+}
+
+// Save a map larger than a band of rows with random cells, converted on several threads,
+// as a PGM file streamed without an intermediate image. Load it back and check that it
+// holds the map cells.
+TEST_F(MapIOTester, saveLargeStreamedPGM)
+{
+  nav_msgs::msg::OccupancyGrid map_msg = makeRandomMap(1201, 1003);
+  for (auto & cell : map_msg.data) {
+    cell = std::clamp<int8_t>(cell, nav2_util::OCC_GRID_UNKNOWN, nav2_util::OCC_GRID_OCCUPIED);
+  }
+
+  const std::string map_name = path(g_tmp_dir) / path("large_map");
+  SaveParameters saveParameters;
+  fillSaveParameters(map_name, "pgm", saveParameters);
+  saveParameters.mode = MapMode::Raw;
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+
+  LoadParameters loadParameters;
+  ASSERT_NO_THROW(loadParameters = loadMapYaml(map_name + ".yaml"));
+  nav_msgs::msg::OccupancyGrid loaded_msg;
+  ASSERT_NO_THROW(loadMapFromFile(loadParameters, loaded_msg));
+  ASSERT_EQ(loaded_msg.info.width, map_msg.info.width);
+  ASSERT_EQ(loaded_msg.info.height, map_msg.info.height);
+  for (size_t i = 0; i < map_msg.data.size(); i++) {
+    ASSERT_EQ(loaded_msg.data[i], map_msg.data[i]) << "at cell " << i;
+  }
+}
+
+// Save a map larger than a band of rows in every format, streamed or not, and verify that
+// the YAML file records the hash of the map file, computed while it was written.
+TEST_F(MapIOTester, saveMapWithContentHash)
+{
+  Magick::InitializeMagick(nullptr);
+  nav_msgs::msg::OccupancyGrid map_msg = makeRandomMap(1201, 1003);
+  for (auto & cell : map_msg.data) {
+    cell = std::clamp<int8_t>(cell, nav2_util::OCC_GRID_UNKNOWN, nav2_util::OCC_GRID_OCCUPIED);
+  }
+
+  const std::string map_name = path(g_tmp_dir) / path("hashed_map");
+  const std::string yaml_name = map_name + ".yaml";
+  std::string previous_hash;
+  for (const std::string format : {"pgm", "png", "bmp", "tmap"}) {
+    SaveParameters saveParameters;
+    fillSaveParameters(map_name, format, saveParameters);
+    saveParameters.mode = MapMode::Raw;
+    ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+
+    LoadParameters loadParameters;
+    ASSERT_NO_THROW(loadParameters = loadMapYaml(yaml_name));
+    ASSERT_EQ(loadParameters.content_hash.size(), 16u);
+    EXPECT_EQ(loadParameters.content_hash, computeMapContentHash(map_name + "." + format)) <<
+      "format: " << format;
+    EXPECT_NE(loadParameters.content_hash, previous_hash);
+    previous_hash = loadParameters.content_hash;
+  }
+
+  // Saving the same map again gives the same hash
+  SaveParameters saveParameters;
+  fillSaveParameters(map_name, "pgm", saveParameters);
+  saveParameters.mode = MapMode::Raw;
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+  LoadParameters loadParameters;
+  ASSERT_NO_THROW(loadParameters = loadMapYaml(yaml_name));
+  const std::string pgm_hash = loadParameters.content_hash;
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+  ASSERT_NO_THROW(loadParameters = loadMapYaml(yaml_name));
+  EXPECT_EQ(loadParameters.content_hash, pgm_hash);
+}
+
 // Try to load an invalid file with different ways.
 // Succeeds if all cases are got expected fail behaviours.
 TEST_F(MapIOTester, loadInvalidFile)
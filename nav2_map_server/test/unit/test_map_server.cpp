@@ -0,0 +1,97 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_constants/test_constants.h"
+#include "nav2_map_server/map_io.hpp"
+#include "nav2_map_server/map_server.hpp"
+
+using std::filesystem::path;
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+class MapServerWrapper : public nav2_map_server::MapServer
+{
+public:
+  explicit MapServerWrapper(const rclcpp::NodeOptions & options)
+  : MapServer(options)
+  {
+  }
+
+  std::shared_ptr<nav2_msgs::srv::LoadMap::Response> loadMap(const std::string & map_url)
+  {
+    auto request = std::make_shared<nav2_msgs::srv::LoadMap::Request>();
+    request->map_url = map_url;
+    auto response = std::make_shared<nav2_msgs::srv::LoadMap::Response>();
+    loadMapCallback(nullptr, request, response);
+    return response;
+  }
+};
+
+// Load a tiled map through the LoadMap service while serving map regions.
+// Succeeds if the response holds all of the map cells.
+TEST(MapServerTest, LoadTiledMapServingRegions)
+{
+  nav_msgs::msg::OccupancyGrid map_msg;
+  map_msg.info.width = g_valid_image_width;
+  map_msg.info.height = g_valid_image_height;
+  map_msg.info.resolution = g_valid_image_res;
+  map_msg.info.origin.orientation.w = 1.0;
+  for (unsigned int i = 0; i < g_valid_image_width * g_valid_image_height; i++) {
+    map_msg.data.push_back(static_cast<int8_t>(g_valid_image_content[i]));
+  }
+
+  const std::string map_name = path(g_tmp_dir) / path("region_map");
+  nav2_map_server::SaveParameters save_parameters;
+  save_parameters.map_file_name = map_name;
+  save_parameters.image_format = "tmap";
+  save_parameters.free_thresh = g_default_free_thresh;
+  save_parameters.occupied_thresh = g_default_occupied_thresh;
+  ASSERT_TRUE(nav2_map_server::saveMapToFile(map_msg, save_parameters));
+
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(
+  {
+    {"yaml_filename", std::string("")},
+    {"serve_map_regions", true}
+  });
+  auto map_server = std::make_shared<MapServerWrapper>(options);
+  map_server->configure();
+  map_server->activate();
+
+  auto response = map_server->loadMap(map_name + ".yaml");
+  ASSERT_EQ(response->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  ASSERT_EQ(response->map.info.width, g_valid_image_width);
+  ASSERT_EQ(response->map.info.height, g_valid_image_height);
+  ASSERT_EQ(response->map.data.size(), map_msg.data.size());
+  for (size_t i = 0; i < map_msg.data.size(); i++) {
+    ASSERT_EQ(response->map.data[i], map_msg.data[i]) << "at cell " << i;
+  }
+
+  map_server->deactivate();
+  map_server->cleanup();
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <geometry_msgs/msg/pose_stamped.hpp>
+#include <nav_msgs/msg/path.hpp>
+
+#include <nav2_costmap_2d/costmap_2d.hpp>
+#include <nav2_costmap_2d/costmap_2d_ros.hpp>
+
+#include <xtensor/xmath.hpp>
+#include <xtensor/xnoalias.hpp>
+#include <xtensor/xrandom.hpp>
+#include <xtensor/xview.hpp>
+
+#include "nav2_mppi_controller/critic_data.hpp"
+#include "nav2_mppi_controller/motion_models.hpp"
+#include "nav2_mppi_controller/critics/constraint_critic.hpp"
+#include "nav2_mppi_controller/critics/cost_critic.hpp"
+#include "nav2_mppi_controller/critics/goal_angle_critic.hpp"
+#include "nav2_mppi_controller/critics/goal_critic.hpp"
+#include "nav2_mppi_controller/critics/obstacles_critic.hpp"
+#include "nav2_mppi_controller/critics/path_align_critic.hpp"
+#include "nav2_mppi_controller/critics/path_angle_critic.hpp"
+#include "nav2_mppi_controller/critics/path_follow_critic.hpp"
+#include "nav2_mppi_controller/critics/prefer_forward_critic.hpp"
+#include "nav2_mppi_controller/critics/twirling_critic.hpp"
+#include "nav2_mppi_controller/critics/velocity_deadband_critic.hpp"
+#include "nav2_mppi_controller/tools/parameters_handler.hpp"
+#include "nav2_mppi_controller/tools/utils.hpp"
+
+#include "utils.hpp"
+
+class RosLockGuard
+{
+public:
+  RosLockGuard() {rclcpp::init(0, nullptr);}
+  ~RosLockGuard() {rclcpp::shutdown();}
+};
+
+RosLockGuard g_rclcpp;
+
+using namespace mppi;  // NOLINT
+
+/**
+ * Scores a batch of trajectories fanning out from the robot along a straight path
+ * with a single critic, isolating its cost from the rest of the optimizer.
+ * Arguments are the batch size and the number of time steps.
+ */
+template<typename CriticT>
+void prepareAndRunCriticBenchmark(bool consider_footprint, benchmark::State & state)
+{
+  const auto batch_size = static_cast<unsigned int>(state.range(0));
+  const auto time_steps = static_cast<unsigned int>(state.range(1));
+  unsigned int path_points = 50u;
+  float model_dt = 0.05f;
+
+  TestCostmapSettings costmap_settings{};
+  auto costmap_ros = getDummyCostmapRos(costmap_settings);
+  auto costmap = costmap_ros->getCostmap();
+  TestPose start_pose = costmap_settings.getCenterPose();
+  double path_step = costmap_settings.resolution;
+
+  unsigned int offset = 4;
+  auto [obst_x, obst_y] = costmap_settings.getCenterIJ();
+  addObstacle(costmap, {obst_x - offset, obst_y - offset, offset * 2, 250});
+
+  auto node = getDummyNode(rclcpp::NodeOptions{});
+  node->declare_parameter(
+    "mppi.critic.consider_footprint", rclcpp::ParameterValue(consider_footprint));
+  node->declare_parameter("mppi.critic.offset_from_furthest", rclcpp::ParameterValue(0));
+  node->declare_parameter("mppi.critic.threshold_to_consider", rclcpp::ParameterValue(0.0));
+  ParametersHandler param_handler(node);
+  CriticT critic;
+  critic.on_configure(node, "mppi", "mppi.critic", costmap_ros, &param_handler);
+
+  // Trajectories fanning out from the robot at various speeds and turning rates
+  models::State rollout_state;
+  rollout_state.reset(batch_size, time_steps);
+  rollout_state.pose = getDummyPointStamped(node, start_pose);
+  rollout_state.cvx = xt::random::randn<float>({batch_size, time_steps}, 0.3f, 0.2f);
+  rollout_state.cwz = xt::random::randn<float>({batch_size, time_steps}, 0.0f, 0.4f);
+  rollout_state.vx = rollout_state.cvx;
+  rollout_state.wz = rollout_state.cwz;
+
+  models::Trajectories trajectories;
+  trajectories.reset(batch_size, time_steps);
+  xt::noalias(trajectories.yaws) = xt::cumsum(rollout_state.wz * model_dt, {1});
+  xt::noalias(trajectories.x) = start_pose.x +
+    xt::cumsum(rollout_state.vx * xt::cos(trajectories.yaws) * model_dt, {1});
+  xt::noalias(trajectories.y) = start_pose.y +
+    xt::cumsum(rollout_state.vx * xt::sin(trajectories.yaws) * model_dt, {1});
+
+  TestPathSettings path_settings{start_pose, path_points, path_step, 0.0};
+  models::Path path = utils::toTensor(getIncrementalDummyPath(node, path_settings));
+  xt::xtensor<float, 1> costs = xt::zeros<float>({batch_size});
+
+  CriticData data =
+  {rollout_state, trajectories, path, costs, model_dt, false, nullptr, nullptr,
+    std::nullopt, std::nullopt};
+  data.motion_model = std::make_shared<DiffDriveMotionModel>();
+
+  for (auto _ : state) {
+    data.fail_flag = false;
+    data.furthest_reached_path_point.reset();
+    data.path_pts_valid.reset();
+    critic.score(data);
+    benchmark::DoNotOptimize(costs.data());
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(state.iterations()) * batch_size * time_steps);
+}
+
+static void BM_ConstraintCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::ConstraintCritic>(false, state);
+}
+
+static void BM_CostCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::CostCritic>(false, state);
+}
+
+static void BM_CostCriticFootprint(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::CostCritic>(true, state);
+}
+
+static void BM_GoalCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::GoalCritic>(false, state);
+}
+
+static void BM_GoalAngleCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::GoalAngleCritic>(false, state);
+}
+
+static void BM_ObstaclesCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::ObstaclesCritic>(false, state);
+}
+
+static void BM_ObstaclesCriticFootprint(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::ObstaclesCritic>(true, state);
+}
+
+static void BM_PathAlignCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::PathAlignCritic>(false, state);
+}
+
+static void BM_PathAngleCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::PathAngleCritic>(false, state);
+}
+
+static void BM_PathFollowCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::PathFollowCritic>(false, state);
+}
+
+static void BM_PreferForwardCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::PreferForwardCritic>(false, state);
+}
+
+static void BM_TwirlingCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::TwirlingCritic>(false, state);
+}
+
+static void BM_VelocityDeadbandCritic(benchmark::State & state)
+{
+  prepareAndRunCriticBenchmark<critics::VelocityDeadbandCritic>(false, state);
+}
+
+// Sweep of batch sizes and time steps around the default 1000 x 56
+static void CriticSweep(benchmark::internal::Benchmark * b)
+{
+  b->ArgNames({"batch_size", "time_steps"});
+  b->ArgsProduct({{500, 1000, 2000}, {28, 56, 84}});
+  b->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_ConstraintCritic)->Apply(CriticSweep);
+BENCHMARK(BM_CostCritic)->Apply(CriticSweep);
+BENCHMARK(BM_CostCriticFootprint)->Apply(CriticSweep);
+BENCHMARK(BM_GoalCritic)->Apply(CriticSweep);
+BENCHMARK(BM_GoalAngleCritic)->Apply(CriticSweep);
+BENCHMARK(BM_ObstaclesCritic)->Apply(CriticSweep);
+BENCHMARK(BM_ObstaclesCriticFootprint)->Apply(CriticSweep);
+BENCHMARK(BM_PathAlignCritic)->Apply(CriticSweep);
+BENCHMARK(BM_PathAngleCritic)->Apply(CriticSweep);
+BENCHMARK(BM_PathFollowCritic)->Apply(CriticSweep);
+BENCHMARK(BM_PreferForwardCritic)->Apply(CriticSweep);
+BENCHMARK(BM_TwirlingCritic)->Apply(CriticSweep);
+BENCHMARK(BM_VelocityDeadbandCritic)->Apply(CriticSweep);
+
+BENCHMARK_MAIN();
@@ -15,7 +15,6 @@
 #include <benchmark/benchmark.h>
 #include <string>
 
-#include "gtest/gtest.h"
 #include <geometry_msgs/msg/pose_stamped.hpp>
 #include <geometry_msgs/msg/twist.hpp>
 #include <nav_msgs/msg/path.hpp>
@@ -27,6 +26,7 @@
 
 #include <xtensor/xarray.hpp>
 #include <xtensor/xio.hpp>
+#include <xtensor/xrandom.hpp>
 #include <xtensor/xview.hpp>
 
 #include "nav2_mppi_controller/optimizer.hpp"
@@ -47,10 +47,9 @@ RosLockGuard g_rclcpp;
 
 void prepareAndRunBenchmark(
   bool consider_footprint, std::string motion_model,
-  std::vector<std::string> critics, benchmark::State & state)
+  std::vector<std::string> critics, benchmark::State & state,
+  int batch_size = 300, int time_steps = 12)
 {
-  int batch_size = 300;
-  int time_steps = 12;
   unsigned int path_points = 50u;
   int iteration_count = 2;
   double lookahead_distance = 10.0;
@@ -197,6 +196,145 @@ static void BM_PathAngleCritic(benchmark::State & state)
   prepareAndRunBenchmark(consider_footprint, motion_model, critics, state);
 }
 
+static void BM_OptimizerSweep(benchmark::State & state)
+{
+  bool consider_footprint = true;
+  std::string motion_model = "DiffDrive";
+  std::vector<std::string> critics = {{"GoalCritic"}, {"GoalAngleCritic"}, {"ObstaclesCritic"},
+    {"PathAngleCritic"}, {"PathFollowCritic"}, {"PreferForwardCritic"}};
+
+  prepareAndRunBenchmark(
+    consider_footprint, motion_model, critics, state,
+    static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+}
+
+/**
+ * Exposes the trajectory rollout of the optimizer to measure the motion models
+ * in isolation of the critics
+ */
+class RolloutBenchmarkOptimizer : public mppi::Optimizer
+{
+public:
+  void rollout(
+    const geometry_msgs::msg::PoseStamped & pose, const geometry_msgs::msg::Twist & speed,
+    const nav_msgs::msg::Path & path)
+  {
+    prepare(pose, speed, path, nullptr);
+    generateNoisedTrajectories();
+  }
+};
+
+void prepareAndRunRolloutBenchmark(std::string motion_model, benchmark::State & state)
+{
+  int batch_size = static_cast<int>(state.range(0));
+  int time_steps = static_cast<int>(state.range(1));
+  unsigned int path_points = 50u;
+  int iteration_count = 1;
+  double lookahead_distance = 10.0;
+  std::vector<std::string> critics = {};
+
+  TestCostmapSettings costmap_settings{};
+  auto costmap_ros = getDummyCostmapRos(costmap_settings);
+  TestPose start_pose = costmap_settings.getCenterPose();
+  double path_step = costmap_settings.resolution;
+  TestPathSettings path_settings{start_pose, path_points, path_step, path_step};
+  TestOptimizerSettings optimizer_settings{batch_size, time_steps, iteration_count,
+    lookahead_distance, motion_model, false};
+
+  auto node = getDummyNode(optimizer_settings, critics);
+  auto parameters_handler = std::make_unique<mppi::ParametersHandler>(node);
+  RolloutBenchmarkOptimizer optimizer;
+  optimizer.initialize(node, node->get_name(), costmap_ros, parameters_handler.get());
+
+  auto pose = getDummyPointStamped(node, start_pose);
+  auto velocity = getDummyTwist();
+  auto path = getIncrementalDummyPath(node, path_settings);
+
+  for (auto _ : state) {
+    optimizer.rollout(pose, velocity, path);
+    benchmark::DoNotOptimize(optimizer.getGeneratedTrajectories().x.data());
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(state.iterations()) * batch_size * time_steps);
+}
+
+static void BM_RolloutDiffDrive(benchmark::State & state)
+{
+  prepareAndRunRolloutBenchmark("DiffDrive", state);
+}
+
+static void BM_RolloutOmni(benchmark::State & state)
+{
+  prepareAndRunRolloutBenchmark("Omni", state);
+}
+
+static void BM_RolloutAckermann(benchmark::State & state)
+{
+  prepareAndRunRolloutBenchmark("Ackermann", state);
+}
+
+// Sweep of batch sizes and time steps around the default 1000 x 56
+static void BatchTimeStepsSweep(benchmark::internal::Benchmark * b)
+{
+  b->ArgNames({"batch_size", "time_steps"});
+  b->ArgsProduct({{500, 1000, 2000}, {28, 56, 84}});
+}
+
+/**
+ * Exposes the trajectory integration of the optimizer to compare the fused
+ * kernel against the tensor expression path
+ */
+class IntegrationBenchmarkOptimizer : public mppi::Optimizer
+{
+public:
+  void integrate(
+    mppi::models::Trajectories & trajectories, const mppi::models::State & state, bool fused)
+  {
+    if (fused) {
+      integrateStateVelocitiesFused(trajectories, state, scratch_);
+    } else {
+      integrateStateVelocities(trajectories, state);
+    }
+  }
+
+private:
+  xt::xtensor<float, 2> scratch_;
+};
+
+static void BM_IntegrateStateVelocities(benchmark::State & state)
+{
+  // Runtime switch: 0 uses the xtensor expression path, 1 uses the fused kernel
+  const bool fused = state.range(0) != 0;
+  int batch_size = 2000;
+  int time_steps = 56;
+  int iteration_count = 1;
+  double lookahead_distance = 10.0;
+  std::vector<std::string> critics = {};
+
+  TestCostmapSettings costmap_settings{};
+  auto costmap_ros = getDummyCostmapRos(costmap_settings);
+  TestOptimizerSettings optimizer_settings{batch_size, time_steps, iteration_count,
+    lookahead_distance, "Omni", false};
+  auto node = getDummyNode(optimizer_settings, critics);
+  auto parameters_handler = std::make_unique<mppi::ParametersHandler>(node);
+  IntegrationBenchmarkOptimizer optimizer;
+  optimizer.initialize(node, node->get_name(), costmap_ros, parameters_handler.get());
+
+  mppi::models::State rollout_state;
+  rollout_state.reset(batch_size, time_steps);
+  rollout_state.vx = xt::random::randn<float>({batch_size, time_steps}, 0.3f, 0.2f);
+  rollout_state.vy = xt::random::randn<float>({batch_size, time_steps}, 0.0f, 0.2f);
+  rollout_state.wz = xt::random::randn<float>({batch_size, time_steps}, 0.0f, 0.4f);
+  mppi::models::Trajectories trajectories;
+  trajectories.reset(batch_size, time_steps);
+
+  for (auto _ : state) {
+    optimizer.integrate(trajectories, rollout_state, fused);
+    benchmark::DoNotOptimize(trajectories.x.data());
+  }
+}
+
 BENCHMARK(BM_DiffDrivePointFootprint)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_DiffDrive)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_Omni)->Unit(benchmark::kMillisecond);
@@ -210,4 +348,12 @@ BENCHMARK(BM_ObstaclesCritic)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_ObstaclesCriticPointFootprint)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_TwilringCritic)->Unit(benchmark::kMillisecond);
 
+BENCHMARK(BM_OptimizerSweep)->Apply(BatchTimeStepsSweep)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RolloutDiffDrive)->Apply(BatchTimeStepsSweep)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RolloutOmni)->Apply(BatchTimeStepsSweep)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RolloutAckermann)->Apply(BatchTimeStepsSweep)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_IntegrateStateVelocities)->ArgName("fused")->Arg(0)->Arg(1)->Unit(
+  benchmark::kMicrosecond);
+
 BENCHMARK_MAIN();
@@ -31,6 +31,8 @@
 #include "nav2_mppi_controller/models/trajectories.hpp"
 #include "nav2_mppi_controller/models/path.hpp"
 #include "nav2_mppi_controller/motion_models.hpp"
+#include "nav2_util/thread_pool.hpp"
+#include "nav2_mppi_controller/tools/trajectory_cost_cache.hpp"
 
 
 namespace mppi
@@ -55,6 +57,8 @@ struct CriticData
   std::shared_ptr<MotionModel> motion_model;
   std::optional<std::vector<bool>> path_pts_valid;
   std::optional<size_t> furthest_reached_path_point;
+  nav2_util::ThreadPool * thread_pool{nullptr};
+  TrajectoryCostCache * cost_cache{nullptr};
 };
 
 }  // namespace mppi
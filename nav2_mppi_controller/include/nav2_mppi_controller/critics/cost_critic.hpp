@@ -23,6 +23,7 @@
 
 #include "nav2_mppi_controller/critic_function.hpp"
 #include "nav2_mppi_controller/models/state.hpp"
+#include "nav2_mppi_controller/tools/trajectory_cost_cache.hpp"
 #include "nav2_mppi_controller/tools/utils.hpp"
 
 namespace mppi::critics
@@ -51,21 +52,23 @@ protected:
   /**
     * @brief Checks if cost represents a collision
     * @param cost Point cost at pose center
-    * @param x X of pose
-    * @param y Y of pose
-    * @param theta theta of pose
+    * @param cost_cache Costmap lookups cache for the trajectories
+    * @param trajectories Trajectories to score
+    * @param i Trajectory index
+    * @param j Point index in the trajectory
+    * @param footprint Robot footprint, only used if considering the footprint
     * @return bool if in collision
     */
-  inline bool inCollision(float cost, float x, float y, float theta)
+  inline bool inCollision(
+    float cost, TrajectoryCostCache & cost_cache, const models::Trajectories & trajectories,
+    size_t i, size_t j, const nav2_costmap_2d::Footprint & footprint)
   {
     // If consider_footprint_ check footprint scort for collision
     float score_cost = cost;
     if (consider_footprint_ &&
       (cost >= possible_collision_cost_ || possible_collision_cost_ < 1.0f))
     {
-      score_cost = static_cast<float>(collision_checker_.footprintCostAtPose(
-          static_cast<double>(x), static_cast<double>(y), static_cast<double>(theta),
-          costmap_ros_->getRobotFootprint()));
+      score_cost = cost_cache.footprintCost(trajectories, i, j, footprint);
     }
 
     switch (static_cast<unsigned char>(score_cost)) {
@@ -89,42 +92,8 @@ protected:
     */
   inline float findCircumscribedCost(std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap);
 
-  /**
-    * @brief An implementation of worldToMap fully using floats
-    * @param wx Float world X coord
-    * @param wy Float world Y coord
-    * @param mx unsigned int map X coord
-    * @param my unsigned into map Y coord
-    * @return if successsful
-    */
-  inline bool worldToMapFloat(float wx, float wy, unsigned int & mx, unsigned int & my) const
-  {
-    if (wx < origin_x_ || wy < origin_y_) {
-      return false;
-    }
-
-    mx = static_cast<unsigned int>((wx - origin_x_) / resolution_);
-    my = static_cast<unsigned int>((wy - origin_y_) / resolution_);
-
-    if (mx < size_x_ && my < size_y_) {
-      return true;
-    }
-    return false;
-  }
-
-  /**
-    * @brief A local implementation of getIndex
-    * @param mx unsigned int map X coord
-    * @param my unsigned into map Y coord
-    * @return Index
-    */
-  inline unsigned int getIndex(unsigned int mx, unsigned int my) const
-  {
-    return my * size_x_ + mx;
-  }
-
-  nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>
-  collision_checker_{nullptr};
+  // Used when no costmap lookups cache is shared through the critic data
+  TrajectoryCostCache cost_cache_;
   float possible_collision_cost_;
 
   bool consider_footprint_{true};
@@ -136,9 +105,6 @@ protected:
   float weight_{0};
   unsigned int trajectory_point_step_;
 
-  float origin_x_, origin_y_, resolution_;
-  unsigned int size_x_, size_y_;
-
   float near_goal_distance_;
   std::string inflation_layer_name_;
 
@@ -22,6 +22,7 @@
 #include "nav2_costmap_2d/inflation_layer.hpp"
 #include "nav2_mppi_controller/critic_function.hpp"
 #include "nav2_mppi_controller/models/state.hpp"
+#include "nav2_mppi_controller/tools/trajectory_cost_cache.hpp"
 #include "nav2_mppi_controller/tools/utils.hpp"
 
 namespace mppi::critics
@@ -58,13 +59,17 @@ protected:
   inline bool inCollision(float cost) const;
 
   /**
-    * @brief cost at a robot pose
-    * @param x X of pose
-    * @param y Y of pose
-    * @param theta theta of pose
+    * @brief cost at a robot pose of a trajectory
+    * @param cost_cache Costmap lookups cache for the trajectories
+    * @param trajectories Trajectories to score
+    * @param i Trajectory index
+    * @param j Point index in the trajectory
+    * @param footprint Robot footprint, only used if considering the footprint
     * @return Collision information at pose
     */
-  inline CollisionCost costAtPose(float x, float y, float theta);
+  inline CollisionCost costAtPose(
+    TrajectoryCostCache & cost_cache, const models::Trajectories & trajectories,
+    size_t i, size_t j, const nav2_costmap_2d::Footprint & footprint);
 
   /**
     * @brief Distance to obstacle from cost
@@ -83,8 +88,8 @@ protected:
   float findCircumscribedCost(std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap);
 
 protected:
-  nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>
-  collision_checker_{nullptr};
+  // Used when no costmap lookups cache is shared through the critic data
+  TrajectoryCostCache cost_cache_;
 
   bool consider_footprint_{true};
   float collision_cost_{0};
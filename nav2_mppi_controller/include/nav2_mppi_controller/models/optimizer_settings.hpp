@@ -36,7 +36,14 @@ struct OptimizerSettings
   unsigned int batch_size{0u};
   unsigned int time_steps{0u};
   unsigned int iteration_count{0u};
+  unsigned int num_threads{1u};
+  unsigned int min_batch_size{0u};
+  float ess_shrink_ratio{0.0f};
+  float ess_expand_ratio{0.0f};
+  double time_budget{0.0};
   bool shift_control_sequence{false};
+  bool fused_integration{false};
+  bool adaptive_sampling{false};
   size_t retry_attempt_limit{0};
 };
 
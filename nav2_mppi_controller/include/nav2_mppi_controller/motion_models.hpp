@@ -15,6 +15,7 @@
 #ifndef NAV2_MPPI_CONTROLLER__MOTION_MODELS_HPP_
 #define NAV2_MPPI_CONTROLLER__MOTION_MODELS_HPP_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -33,6 +34,7 @@
 #pragma GCC diagnostic pop
 
 #include "nav2_mppi_controller/tools/parameters_handler.hpp"
+#include "nav2_util/thread_pool.hpp"
 
 namespace mppi
 {
@@ -65,11 +67,36 @@ public:
     model_dt_ = model_dt;
   }
 
+  /**
+   * @brief Set the thread pool used by predict() to split the batch, nullptr to
+   * process it on the calling thread
+   * @param thread_pool Thread pool, owned by the caller
+   */
+  void setThreadPool(nav2_util::ThreadPool * thread_pool)
+  {
+    thread_pool_ = thread_pool;
+  }
+
   /**
    * @brief With input velocities, find the vehicle's output velocities
    * @param state Contains control velocities to use to populate vehicle velocities
    */
   virtual void predict(models::State & state)
+  {
+    nav2_util::parallelFor(
+      thread_pool_, state.vx.shape(0),
+      [&](size_t begin, size_t end) {predictRange(state, begin, end);});
+  }
+
+  /**
+   * @brief With input velocities, find the vehicle's output velocities for a
+   * contiguous range of the batch. Rows are independent, so ranges may be
+   * processed concurrently.
+   * @param state Contains control velocities to use to populate vehicle velocities
+   * @param begin First batch index to process
+   * @param end One past the last batch index to process
+   */
+  virtual void predictRange(models::State & state, size_t begin, size_t end)
   {
     // Previously completed via tensor views, but found to be 10x slower
     // using namespace xt::placeholders;  // NOLINT
@@ -87,7 +114,7 @@ public:
     float min_delta_vx = model_dt_ * control_constraints_.ax_min;
     float max_delta_vy = model_dt_ * control_constraints_.ay_max;
     float max_delta_wz = model_dt_ * control_constraints_.az_max;
-    for (unsigned int i = 0; i != state.vx.shape(0); i++) {
+    for (size_t i = begin; i != end; i++) {
       float vx_last = state.vx(i, 0);
       float vy_last = state.vy(i, 0);
       float wz_last = state.wz(i, 0);
@@ -125,6 +152,7 @@ public:
   virtual void applyConstraints(models::ControlSequence & /*control_sequence*/) {}
 
 protected:
+  nav2_util::ThreadPool * thread_pool_{nullptr};
   float model_dt_{0.0};
   models::ControlConstraints control_constraints_{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
     0.0f};
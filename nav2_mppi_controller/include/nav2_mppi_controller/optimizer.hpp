@@ -45,6 +45,8 @@
 #include "nav2_mppi_controller/models/path.hpp"
 #include "nav2_mppi_controller/tools/noise_generator.hpp"
 #include "nav2_mppi_controller/tools/parameters_handler.hpp"
+#include "nav2_util/thread_pool.hpp"
+#include "nav2_mppi_controller/tools/trajectory_cost_cache.hpp"
 #include "nav2_mppi_controller/tools/utils.hpp"
 
 namespace mppi
@@ -104,6 +106,20 @@ public:
    */
   models::Trajectories & getGeneratedTrajectories();
 
+  /**
+   * @brief Get the effective sample size of the last control sequence update,
+   * 1 / sum(w^2) of the softmax weights of the samples
+   * @return Effective sample size
+   */
+  float getEffectiveSampleSize() const;
+
+  /**
+   * @brief Get the number of samples currently used per iteration, which may be lower
+   * than the batch_size parameter when adaptive sampling is enabled
+   * @return Number of samples
+   */
+  unsigned int getBatchSize() const;
+
   /**
    * @brief Get the optimal trajectory for a cycle for visualization
    * @return Optimal trajectory
@@ -196,6 +212,35 @@ protected:
     models::Trajectories & trajectories,
     const models::State & state) const;
 
+  /**
+   * @brief Rollout velocities in state to poses using the fused single-pass kernel,
+   * splitting the batch across the thread pool
+   * @param trajectories to rollout
+   * @param state fill state
+   * @param scratch Heading buffers of two rows per thread, resized if too small
+   */
+  void integrateStateVelocitiesFused(
+    models::Trajectories & trajectories,
+    const models::State & state,
+    xt::xtensor<float, 2> & scratch) const;
+
+  /**
+   * @brief Rollout velocities in state to poses using the fused single-pass kernel
+   * for a contiguous range of the batch. Yaws, headings and positions of each sample
+   * are computed in one pass over its row, with vectorized heading trigonometry.
+   * @param trajectories to rollout, already sized as the state
+   * @param state fill state
+   * @param begin First batch index to process
+   * @param end One past the last batch index to process
+   * @param yaw_cos Scratch buffer of at least time_steps elements
+   * @param yaw_sin Scratch buffer of at least time_steps elements
+   */
+  void integrateStateVelocitiesFused(
+    models::Trajectories & trajectories,
+    const models::State & state,
+    size_t begin, size_t end,
+    float * yaw_cos, float * yaw_sin) const;
+
   /**
    * @brief Rollout velocities in state to poses
    * @param trajectories to rollout
@@ -231,6 +276,26 @@ protected:
    */
   void setOffset(double controller_frequency);
 
+  /**
+   * @brief (Re)create the worker pool used to split the batch across threads
+   * if the requested number of threads changed
+   */
+  void resetThreadPool();
+
+  /**
+   * @brief Adapt the number of samples for the next cycle to the effective sample size
+   * of the last update, the fail flag and the time budget. The samples are resized at
+   * the start of the next cycle, so that this cycle's trajectories can be visualized.
+   * @param elapsed Time spent in the last cycle's optimization, in seconds
+   */
+  void adaptBatchSize(double elapsed);
+
+  /**
+   * @brief Resize the samples, costs and trajectories to a new number of samples
+   * @param batch_size Number of samples
+   */
+  void setBatchSize(unsigned int batch_size);
+
   /**
    * @brief Perform fallback behavior to try to recover from a set of trajectories in collision
    * @param fail Whether the system failed to recover from
@@ -248,6 +313,8 @@ protected:
   ParametersHandler * parameters_handler_;
   CriticManager critic_manager_;
   NoiseGenerator noise_generator_;
+  std::unique_ptr<nav2_util::ThreadPool> thread_pool_;
+  TrajectoryCostCache cost_cache_;
 
   models::OptimizerSettings settings_;
 
@@ -257,6 +324,11 @@ protected:
   models::Trajectories generated_trajectories_;
   models::Path path_;
   xt::xtensor<float, 1> costs_;
+  unsigned int active_batch_size_{0u};
+  unsigned int next_batch_size_{0u};
+  float effective_sample_size_{0.0f};
+  // Per-thread heading scratch rows for the fused integration kernel
+  xt::xtensor<float, 2> integration_scratch_;
 
   CriticData critics_data_ =
   {state_, generated_trajectories_, path_, costs_, settings_.model_dt, false, nullptr, nullptr,
@@ -72,7 +72,8 @@ public:
   void generateNextNoises();
 
   /**
-   * @brief set noised control_sequence to state controls
+   * @brief set noised control_sequence to state controls. If the state holds fewer
+   * samples than generated, the leading noises are used
    * @return noises vx, vy, wz
    */
   void setNoisedControls(models::State & state, const models::ControlSequence & control_sequence);
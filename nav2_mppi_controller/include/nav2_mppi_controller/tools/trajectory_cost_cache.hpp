@@ -0,0 +1,175 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_MPPI_CONTROLLER__TOOLS__TRAJECTORY_COST_CACHE_HPP_
+#define NAV2_MPPI_CONTROLLER__TOOLS__TRAJECTORY_COST_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// xtensor creates warnings that needs to be ignored as we are building with -Werror
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#include <xtensor/xtensor.hpp>
+#pragma GCC diagnostic pop
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/footprint_collision_checker.hpp"
+#include "nav2_mppi_controller/models/trajectories.hpp"
+
+namespace mppi
+{
+
+/**
+ * @class mppi::TrajectoryCostCache
+ * @brief Per-cycle cache of the costmap lookups at the candidate trajectories' points.
+ * It is shared by the costmap-based critics so that the map conversion, cost and footprint
+ * cost of each point are computed at most once per set of trajectories, lazily on first use.
+ * Entries are invalidated with a generation counter rather than cleared. Concurrent access
+ * is safe as long as each trajectory is only accessed by a single thread at a time.
+ */
+class TrajectoryCostCache
+{
+public:
+  /// Cost returned for trajectory points outside of the costmap bounds
+  static constexpr float OFF_MAP_COST = -1.0f;
+
+  /**
+    * @brief Constructor for mppi::TrajectoryCostCache
+    */
+  TrajectoryCostCache() = default;
+
+  /**
+    * @brief Set the costmap to read costs from
+    * @param costmap Costmap to use
+    */
+  void setCostmap(nav2_costmap_2d::Costmap2D * costmap)
+  {
+    costmap_ = costmap;
+    collision_checker_.setCostmap(costmap);
+  }
+
+  /**
+    * @brief Invalidate all entries for a new set of trajectories, resizing the cache
+    * if needed and capturing the current costmap geometry
+    * @param batch_size Number of trajectories
+    * @param time_steps Number of points per trajectory
+    */
+  void invalidate(size_t batch_size, size_t time_steps)
+  {
+    if (point_stamps_.shape(0) != batch_size || point_stamps_.shape(1) != time_steps) {
+      point_costs_ = xt::zeros<float>({batch_size, time_steps});
+      footprint_costs_ = xt::zeros<float>({batch_size, time_steps});
+      point_stamps_ = xt::zeros<uint32_t>({batch_size, time_steps});
+      footprint_stamps_ = xt::zeros<uint32_t>({batch_size, time_steps});
+      generation_ = 0u;
+    }
+
+    if (++generation_ == 0u) {
+      // Generation counter wrapped around, stale stamps may now alias the new generation
+      point_stamps_.fill(0u);
+      footprint_stamps_.fill(0u);
+      generation_ = 1u;
+    }
+
+    origin_x_ = static_cast<float>(costmap_->getOriginX());
+    origin_y_ = static_cast<float>(costmap_->getOriginY());
+    resolution_ = static_cast<float>(costmap_->getResolution());
+    size_x_ = costmap_->getSizeInCellsX();
+    size_y_ = costmap_->getSizeInCellsY();
+    char_map_ = costmap_->getCharMap();
+  }
+
+  /**
+    * @brief Get the costmap cost at the center of a trajectory point
+    * @param trajectories Trajectories the cache was invalidated for
+    * @param i Trajectory index
+    * @param j Point index in the trajectory
+    * @return Cost at the point, or OFF_MAP_COST if outside of the costmap
+    */
+  inline float pointCost(const models::Trajectories & trajectories, size_t i, size_t j)
+  {
+    if (point_stamps_(i, j) != generation_) {
+      unsigned int mx = 0u, my = 0u;
+      if (worldToMapFloat(trajectories.x(i, j), trajectories.y(i, j), mx, my)) {
+        point_costs_(i, j) = static_cast<float>(char_map_[my * size_x_ + mx]);
+      } else {
+        point_costs_(i, j) = OFF_MAP_COST;
+      }
+      point_stamps_(i, j) = generation_;
+    }
+    return point_costs_(i, j);
+  }
+
+  /**
+    * @brief Get the footprint cost of the robot at a trajectory point
+    * @param trajectories Trajectories the cache was invalidated for
+    * @param i Trajectory index
+    * @param j Point index in the trajectory
+    * @param footprint Robot footprint, identical for all users within a cycle
+    * @return Footprint cost at the pose
+    */
+  inline float footprintCost(
+    const models::Trajectories & trajectories, size_t i, size_t j,
+    const nav2_costmap_2d::Footprint & footprint)
+  {
+    if (footprint_stamps_(i, j) != generation_) {
+      footprint_costs_(i, j) = static_cast<float>(collision_checker_.footprintCostAtPose(
+          static_cast<double>(trajectories.x(i, j)), static_cast<double>(trajectories.y(i, j)),
+          static_cast<double>(trajectories.yaws(i, j)), footprint));
+      footprint_stamps_(i, j) = generation_;
+    }
+    return footprint_costs_(i, j);
+  }
+
+protected:
+  /**
+    * @brief An implementation of worldToMap fully using floats
+    * @param wx Float world X coord
+    * @param wy Float world Y coord
+    * @param mx unsigned int map X coord
+    * @param my unsigned into map Y coord
+    * @return if successsful
+    */
+  inline bool worldToMapFloat(float wx, float wy, unsigned int & mx, unsigned int & my) const
+  {
+    if (wx < origin_x_ || wy < origin_y_) {
+      return false;
+    }
+
+    mx = static_cast<unsigned int>((wx - origin_x_) / resolution_);
+    my = static_cast<unsigned int>((wy - origin_y_) / resolution_);
+
+    return mx < size_x_ && my < size_y_;
+  }
+
+  nav2_costmap_2d::Costmap2D * costmap_{nullptr};
+  nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>
+  collision_checker_{nullptr};
+
+  xt::xtensor<float, 2> point_costs_;
+  xt::xtensor<float, 2> footprint_costs_;
+  xt::xtensor<uint32_t, 2> point_stamps_;
+  xt::xtensor<uint32_t, 2> footprint_stamps_;
+  uint32_t generation_{0u};
+
+  float origin_x_{0.0f}, origin_y_{0.0f}, resolution_{1.0f};
+  unsigned int size_x_{0u}, size_y_{0u};
+  const unsigned char * char_map_{nullptr};
+};
+
+}  // namespace mppi
+
+#endif  // NAV2_MPPI_CONTROLLER__TOOLS__TRAJECTORY_COST_CACHE_HPP_
@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <cmath>
 #include "nav2_mppi_controller/critics/cost_critic.hpp"
 
@@ -40,7 +41,7 @@ void CostCritic::initialize()
     };
   parameters_handler_->addDynamicParamCallback(name_ + ".cost_weight", weightDynamicCb);
 
-  collision_checker_.setCostmap(costmap_);
+  cost_cache_.setCostmap(costmap_);
   possible_collision_cost_ = findCircumscribedCost(costmap_ros_);
 
   if (possible_collision_cost_ < 1.0f) {
@@ -97,19 +98,12 @@ float CostCritic::findCircumscribedCost(
 void CostCritic::score(CriticData & data)
 {
   using xt::evaluation_strategy::immediate;
-  using xt::placeholders::_;
   if (!enabled_) {
     return;
   }
 
   // Setup cost information for various parts of the critic
   is_tracking_unknown_ = costmap_ros_->getLayeredCostmap()->isTrackingUnknown();
-  auto * costmap = collision_checker_.getCostmap();
-  origin_x_ = static_cast<float>(costmap->getOriginX());
-  origin_y_ = static_cast<float>(costmap->getOriginY());
-  resolution_ = static_cast<float>(costmap->getResolution());
-  size_x_ = costmap->getSizeInCellsX();
-  size_y_ = costmap->getSizeInCellsY();
 
   if (consider_footprint_) {
     // footprint may have changed since initialization if user has dynamic footprints
@@ -123,63 +117,74 @@ void CostCritic::score(CriticData & data)
   }
 
   auto && repulsive_cost = xt::xtensor<float, 1>::from_shape({data.costs.shape(0)});
-  bool all_trajectories_collide = true;
+  std::atomic<bool> all_trajectories_collide{true};
 
   const size_t traj_len = floor(data.trajectories.x.shape(1) / trajectory_point_step_);
-  const auto traj_x =
-    xt::view(data.trajectories.x, xt::all(), xt::range(0, _, trajectory_point_step_));
-  const auto traj_y =
-    xt::view(data.trajectories.y, xt::all(), xt::range(0, _, trajectory_point_step_));
-  const auto traj_yaw = xt::view(
-    data.trajectories.yaws, xt::all(), xt::range(0, _, trajectory_point_step_));
-
-  for (size_t i = 0; i < data.trajectories.x.shape(0); ++i) {
-    bool trajectory_collide = false;
-    float pose_cost = 0.0f;
-    float & traj_cost = repulsive_cost[i];
-    traj_cost = 0.0f;
-
-    for (size_t j = 0; j < traj_len; j++) {
-      float Tx = traj_x(i, j);
-      float Ty = traj_y(i, j);
-      unsigned int x_i = 0u, y_i = 0u;
-
-      // The getCost doesn't use orientation
-      // The footprintCostAtPose will always return "INSCRIBED" if footprint is over it
-      // So the center point has more information than the footprint
-      if (!worldToMapFloat(Tx, Ty, x_i, y_i)) {
-        if (!is_tracking_unknown_) {
-          traj_cost = collision_cost_;
-          trajectory_collide = true;
-          break;
-        }
-        pose_cost = 255.0f;  // NO_INFORMATION in float
-      } else {
-        pose_cost = static_cast<float>(costmap->getCost(getIndex(x_i, y_i)));
-        if (pose_cost < 1.0f) {
-          continue;  // In free space
-        }
-        if (inCollision(pose_cost, Tx, Ty, traj_yaw(i, j))) {
-          traj_cost = collision_cost_;
-          trajectory_collide = true;
-          break;
+  const auto & traj = data.trajectories;
+
+  // Use the costmap lookups shared between critics for these trajectories, if available
+  TrajectoryCostCache * cost_cache = data.cost_cache;
+  if (!cost_cache) {
+    cost_cache_.invalidate(traj.x.shape(0), traj.x.shape(1));
+    cost_cache = &cost_cache_;
+  }
+
+  nav2_costmap_2d::Footprint footprint;
+  if (consider_footprint_) {
+    footprint = costmap_ros_->getRobotFootprint();
+  }
+
+  auto scoreTrajectories = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        bool trajectory_collide = false;
+        float pose_cost = 0.0f;
+        float & traj_cost = repulsive_cost[i];
+        traj_cost = 0.0f;
+
+        for (size_t j = 0; j < traj_len; j++) {
+          // Strided trajectory points, accessed directly to be safe to share across threads
+          const size_t j_strided = j * trajectory_point_step_;
+
+          // The getCost doesn't use orientation
+          // The footprintCostAtPose will always return "INSCRIBED" if footprint is over it
+          // So the center point has more information than the footprint
+          pose_cost = cost_cache->pointCost(traj, i, j_strided);
+          if (pose_cost == TrajectoryCostCache::OFF_MAP_COST) {
+            if (!is_tracking_unknown_) {
+              traj_cost = collision_cost_;
+              trajectory_collide = true;
+              break;
+            }
+            pose_cost = 255.0f;  // NO_INFORMATION in float
+          } else {
+            if (pose_cost < 1.0f) {
+              continue;  // In free space
+            }
+            if (inCollision(pose_cost, *cost_cache, traj, i, j_strided, footprint)) {
+              traj_cost = collision_cost_;
+              trajectory_collide = true;
+              break;
+            }
+          }
+
+          // Let near-collision trajectory points be punished severely
+          // Note that we collision check based on the footprint actual,
+          // but score based on the center-point cost regardless
+          if (pose_cost >= 253.0f /*INSCRIBED_INFLATED_OBSTACLE in float*/) {
+            traj_cost += critical_cost_;
+          } else if (!near_goal) {  // Generally prefer trajectories further from obstacles
+            traj_cost += pose_cost;
+          }
         }
-      }
 
-      // Let near-collision trajectory points be punished severely
-      // Note that we collision check based on the footprint actual,
-      // but score based on the center-point cost regardless
-      if (pose_cost >= 253.0f /*INSCRIBED_INFLATED_OBSTACLE in float*/) {
-        traj_cost += critical_cost_;
-      } else if (!near_goal) {  // Generally prefer trajectories further from obstacles
-        traj_cost += pose_cost;
+        if (!trajectory_collide) {
+          all_trajectories_collide.store(false, std::memory_order_relaxed);
+        }
       }
-    }
+    };
 
-    if (!trajectory_collide) {
-      all_trajectories_collide = false;
-    }
-  }
+  // Trajectories are scored independently, so the batch may be split across threads
+  nav2_util::parallelFor(data.thread_pool, data.trajectories.x.shape(0), scoreTrajectories);
 
   if (power_ > 1u) {
     data.costs += xt::pow(
@@ -188,7 +193,7 @@ void CostCritic::score(CriticData & data)
     data.costs += std::move(repulsive_cost) * (weight_ / static_cast<float>(traj_len));
   }
 
-  data.fail_flag = all_trajectories_collide;
+  data.fail_flag = all_trajectories_collide.load();
 }
 
 }  // namespace mppi::critics
@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <cmath>
 #include "nav2_mppi_controller/critics/obstacles_critic.hpp"
 #include "nav2_costmap_2d/inflation_layer.hpp"
@@ -31,7 +32,7 @@ void ObstaclesCritic::initialize()
   getParam(near_goal_distance_, "near_goal_distance", 0.5f);
   getParam(inflation_layer_name_, "inflation_layer_name", std::string(""));
 
-  collision_checker_.setCostmap(costmap_);
+  cost_cache_.setCostmap(costmap_);
   possible_collision_cost_ = findCircumscribedCost(costmap_ros_);
 
   if (possible_collision_cost_ < 1.0f) {
@@ -123,46 +124,65 @@ void ObstaclesCritic::score(CriticData & data)
   auto && raw_cost = xt::xtensor<float, 1>::from_shape({data.costs.shape(0)});
   auto && repulsive_cost = xt::xtensor<float, 1>::from_shape({data.costs.shape(0)});
 
-  const size_t traj_len = data.trajectories.x.shape(1);
-  bool all_trajectories_collide = true;
-  for (size_t i = 0; i < data.trajectories.x.shape(0); ++i) {
-    bool trajectory_collide = false;
-    float traj_cost = 0.0f;
-    const auto & traj = data.trajectories;
-    CollisionCost pose_cost;
-    raw_cost[i] = 0.0f;
-    repulsive_cost[i] = 0.0f;
-
-    for (size_t j = 0; j < traj_len; j++) {
-      pose_cost = costAtPose(traj.x(i, j), traj.y(i, j), traj.yaws(i, j));
-      if (pose_cost.cost < 1.0f) {continue;}  // In free space
-
-      if (inCollision(pose_cost.cost)) {
-        trajectory_collide = true;
-        break;
-      }
-
-      // Cannot process repulsion if inflation layer does not exist
-      if (inflation_radius_ == 0.0f || inflation_scale_factor_ == 0.0f) {
-        continue;
-      }
-
-      const float dist_to_obj = distanceToObstacle(pose_cost);
+  // Use the costmap lookups shared between critics for these trajectories, if available
+  const auto & traj = data.trajectories;
+  const size_t traj_len = traj.x.shape(1);
+  TrajectoryCostCache * cost_cache = data.cost_cache;
+  if (!cost_cache) {
+    cost_cache_.invalidate(traj.x.shape(0), traj_len);
+    cost_cache = &cost_cache_;
+  }
 
-      // Let near-collision trajectory points be punished severely
-      if (dist_to_obj < collision_margin_distance_) {
-        traj_cost += (collision_margin_distance_ - dist_to_obj);
-      }
+  nav2_costmap_2d::Footprint footprint;
+  if (consider_footprint_) {
+    footprint = costmap_ros_->getRobotFootprint();
+  }
 
-      // Generally prefer trajectories further from obstacles
-      if (!near_goal) {
-        repulsive_cost[i] += inflation_radius_ - dist_to_obj;
+  std::atomic<bool> all_trajectories_collide{true};
+  auto scoreTrajectories = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        bool trajectory_collide = false;
+        float traj_cost = 0.0f;
+        CollisionCost pose_cost;
+        raw_cost[i] = 0.0f;
+        repulsive_cost[i] = 0.0f;
+
+        for (size_t j = 0; j < traj_len; j++) {
+          pose_cost = costAtPose(*cost_cache, traj, i, j, footprint);
+          if (pose_cost.cost < 1.0f) {continue;}  // In free space
+
+          if (inCollision(pose_cost.cost)) {
+            trajectory_collide = true;
+            break;
+          }
+
+          // Cannot process repulsion if inflation layer does not exist
+          if (inflation_radius_ == 0.0f || inflation_scale_factor_ == 0.0f) {
+            continue;
+          }
+
+          const float dist_to_obj = distanceToObstacle(pose_cost);
+
+          // Let near-collision trajectory points be punished severely
+          if (dist_to_obj < collision_margin_distance_) {
+            traj_cost += (collision_margin_distance_ - dist_to_obj);
+          }
+
+          // Generally prefer trajectories further from obstacles
+          if (!near_goal) {
+            repulsive_cost[i] += inflation_radius_ - dist_to_obj;
+          }
+        }
+
+        if (!trajectory_collide) {
+          all_trajectories_collide.store(false, std::memory_order_relaxed);
+        }
+        raw_cost[i] = trajectory_collide ? collision_cost_ : traj_cost;
       }
-    }
+    };
 
-    if (!trajectory_collide) {all_trajectories_collide = false;}
-    raw_cost[i] = trajectory_collide ? collision_cost_ : traj_cost;
-  }
+  // Trajectories are scored independently, so the batch may be split across threads
+  nav2_util::parallelFor(data.thread_pool, traj.x.shape(0), scoreTrajectories);
 
   // Normalize repulsive cost by trajectory length & lowest score to not overweight importance
   // This is a preferential cost, not collision cost, to be tuned relative to desired behaviors
@@ -179,7 +199,7 @@ void ObstaclesCritic::score(CriticData & data)
       (repulsion_weight_ * repulsive_cost_normalized);
   }
 
-  data.fail_flag = all_trajectories_collide;
+  data.fail_flag = all_trajectories_collide.load();
 }
 
 /**
@@ -205,23 +225,23 @@ bool ObstaclesCritic::inCollision(float cost) const
   return false;
 }
 
-CollisionCost ObstaclesCritic::costAtPose(float x, float y, float theta)
+CollisionCost ObstaclesCritic::costAtPose(
+  TrajectoryCostCache & cost_cache, const models::Trajectories & trajectories,
+  size_t i, size_t j, const nav2_costmap_2d::Footprint & footprint)
 {
   CollisionCost collision_cost;
   float & cost = collision_cost.cost;
   collision_cost.using_footprint = false;
-  unsigned int x_i, y_i;
-  if (!collision_checker_.worldToMap(x, y, x_i, y_i)) {
+  cost = cost_cache.pointCost(trajectories, i, j);
+  if (cost == TrajectoryCostCache::OFF_MAP_COST) {
     cost = nav2_costmap_2d::NO_INFORMATION;
     return collision_cost;
   }
-  cost = collision_checker_.pointCost(x_i, y_i);
 
   if (consider_footprint_ &&
     (cost >= possible_collision_cost_ || possible_collision_cost_ < 1.0f))
   {
-    cost = static_cast<float>(collision_checker_.footprintCostAtPose(
-        x, y, theta, costmap_ros_->getRobotFootprint()));
+    cost = cost_cache.footprintCost(trajectories, i, j, footprint);
     collision_cost.using_footprint = true;
   }
 
@@ -75,15 +75,14 @@ void PathAlignCritic::score(CriticData & data)
   // Find integrated distance in the path
   std::vector<float> path_integrated_distances(path_segments_count, 0.0f);
   std::vector<utils::Pose2D> path(path_segments_count);
-  float dx = 0.0f, dy = 0.0f;
   for (unsigned int i = 1; i != path_segments_count; i++) {
     auto & pose = path[i - 1];
     pose.x = data.path.x(i - 1);
     pose.y = data.path.y(i - 1);
     pose.theta = data.path.yaws(i - 1);
 
-    dx = data.path.x(i) - pose.x;
-    dy = data.path.y(i) - pose.y;
+    const float dx = data.path.x(i) - pose.x;
+    const float dy = data.path.y(i) - pose.y;
     path_integrated_distances[i] = path_integrated_distances[i - 1] + sqrtf(dx * dx + dy * dy);
   }
 
@@ -93,62 +92,61 @@ void PathAlignCritic::score(CriticData & data)
   final_pose.y = data.path.y(path_segments_count - 1);
   final_pose.theta = data.path.yaws(path_segments_count - 1);
 
-  float summed_path_dist = 0.0f, dyaw = 0.0f;
-  unsigned int num_samples = 0u;
-  unsigned int path_pt = 0u;
-  float traj_integrated_distance = 0.0f;
-
   // Get strided trajectory information
-  const auto T_x = xt::view(
-    data.trajectories.x, xt::all(),
-    xt::range(0, _, trajectory_point_step_));
-  const auto T_y = xt::view(
-    data.trajectories.y, xt::all(),
-    xt::range(0, _, trajectory_point_step_));
-  const auto T_yaw = xt::view(
-    data.trajectories.yaws, xt::all(),
-    xt::range(0, _, trajectory_point_step_));
-  const auto traj_sampled_size = T_x.shape(1);
-
-  for (size_t t = 0; t < batch_size; ++t) {
-    summed_path_dist = 0.0f;
-    num_samples = 0u;
-    traj_integrated_distance = 0.0f;
-    path_pt = 0u;
-    float Tx_m1 = T_x(t, 0);
-    float Ty_m1 = T_y(t, 0);
-    for (size_t p = 1; p < traj_sampled_size; p++) {
-      const float Tx = T_x(t, p);
-      const float Ty = T_y(t, p);
-      dx = Tx - Tx_m1;
-      dy = Ty - Ty_m1;
-      Tx_m1 = Tx;
-      Ty_m1 = Ty;
-      traj_integrated_distance += sqrtf(dx * dx + dy * dy);
-      path_pt = utils::findClosestPathPt(
-        path_integrated_distances, traj_integrated_distance, path_pt);
-
-      // The nearest path point to align to needs to be not in collision, else
-      // let the obstacle critic take over in this region due to dynamic obstacles
-      if (path_pts_valid[path_pt]) {
-        const auto & pose = path[path_pt];
-        dx = pose.x - Tx;
-        dy = pose.y - Ty;
-        num_samples++;
-        if (use_path_orientations_) {
-          dyaw = angles::shortest_angular_distance(pose.theta, T_yaw(t, p));
-          summed_path_dist += sqrtf(dx * dx + dy * dy + dyaw * dyaw);
+  const auto & traj = data.trajectories;
+  const size_t step = static_cast<size_t>(trajectory_point_step_);
+  const size_t traj_sampled_size = (traj.x.shape(1) + step - 1) / step;
+
+  auto scoreTrajectories = [&](size_t begin, size_t end) {
+      float summed_path_dist = 0.0f, dyaw = 0.0f, dx = 0.0f, dy = 0.0f;
+      unsigned int num_samples = 0u;
+      unsigned int path_pt = 0u;
+      float traj_integrated_distance = 0.0f;
+
+      for (size_t t = begin; t < end; ++t) {
+        summed_path_dist = 0.0f;
+        num_samples = 0u;
+        traj_integrated_distance = 0.0f;
+        path_pt = 0u;
+        float Tx_m1 = traj.x(t, 0);
+        float Ty_m1 = traj.y(t, 0);
+        for (size_t p = 1; p < traj_sampled_size; p++) {
+          const size_t p_strided = p * step;
+          const float Tx = traj.x(t, p_strided);
+          const float Ty = traj.y(t, p_strided);
+          dx = Tx - Tx_m1;
+          dy = Ty - Ty_m1;
+          Tx_m1 = Tx;
+          Ty_m1 = Ty;
+          traj_integrated_distance += sqrtf(dx * dx + dy * dy);
+          path_pt = utils::findClosestPathPt(
+            path_integrated_distances, traj_integrated_distance, path_pt);
+
+          // The nearest path point to align to needs to be not in collision, else
+          // let the obstacle critic take over in this region due to dynamic obstacles
+          if (path_pts_valid[path_pt]) {
+            const auto & pose = path[path_pt];
+            dx = pose.x - Tx;
+            dy = pose.y - Ty;
+            num_samples++;
+            if (use_path_orientations_) {
+              dyaw = angles::shortest_angular_distance(pose.theta, traj.yaws(t, p_strided));
+              summed_path_dist += sqrtf(dx * dx + dy * dy + dyaw * dyaw);
+            } else {
+              summed_path_dist += sqrtf(dx * dx + dy * dy);
+            }
+          }
+        }
+        if (num_samples > 0u) {
+          cost[t] = summed_path_dist / static_cast<float>(num_samples);
         } else {
-          summed_path_dist += sqrtf(dx * dx + dy * dy);
+          cost[t] = 0.0f;
         }
       }
-    }
-    if (num_samples > 0u) {
-      cost[t] = summed_path_dist / static_cast<float>(num_samples);
-    } else {
-      cost[t] = 0.0f;
-    }
-  }
+    };
+
+  // Trajectories are scored independently, so the batch may be split across threads
+  nav2_util::parallelFor(data.thread_pool, batch_size, scoreTrajectories);
 
   if (power_ > 1u) {
     data.costs += xt::pow(std::move(cost) * weight_, power_);
@@ -19,6 +19,7 @@
 #include <xtensor/xmath.hpp>
 #include <xtensor/xrandom.hpp>
 #include <xtensor/xnoalias.hpp>
+#include <xtensor/xview.hpp>
 
 namespace mppi
 {
@@ -68,9 +69,19 @@ void NoiseGenerator::setNoisedControls(
 {
   std::unique_lock<std::mutex> guard(noise_lock_);
 
-  xt::noalias(state.cvx) = control_sequence.vx + noises_vx_;
-  xt::noalias(state.cvy) = control_sequence.vy + noises_vy_;
-  xt::noalias(state.cwz) = control_sequence.wz + noises_wz_;
+  const size_t batch_size = state.cvx.shape(0);
+  if (batch_size == noises_vx_.shape(0)) {
+    xt::noalias(state.cvx) = control_sequence.vx + noises_vx_;
+    xt::noalias(state.cvy) = control_sequence.vy + noises_vy_;
+    xt::noalias(state.cwz) = control_sequence.wz + noises_wz_;
+    return;
+  }
+
+  // Adaptive sampling uses fewer samples than generated, use the leading ones
+  const auto rows = xt::range(0, batch_size);
+  xt::noalias(state.cvx) = control_sequence.vx + xt::view(noises_vx_, rows, xt::all());
+  xt::noalias(state.cvy) = control_sequence.vy + xt::view(noises_vy_, rows, xt::all());
+  xt::noalias(state.cwz) = control_sequence.wz + xt::view(noises_wz_, rows, xt::all());
 }
 
 void NoiseGenerator::reset(mppi::models::OptimizerSettings & settings, bool is_holonomic)
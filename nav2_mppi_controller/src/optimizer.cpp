@@ -14,15 +14,19 @@
 
 #include "nav2_mppi_controller/optimizer.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cmath>
 #include <xtensor/xmath.hpp>
 #include <xtensor/xrandom.hpp>
 #include <xtensor/xnoalias.hpp>
+#include <xsimd/xsimd.hpp>
 
 #include "nav2_core/controller_exceptions.hpp"
 #include "nav2_costmap_2d/costmap_filters/filter_values.hpp"
@@ -49,6 +53,8 @@ void Optimizer::initialize(
 
   getParams();
 
+  cost_cache_.setCostmap(costmap_);
+  critics_data_.cost_cache = &cost_cache_;
   critic_manager_.on_configure(parent_, name_, costmap_ros_, parameters_handler_);
   noise_generator_.initialize(settings_, isHolonomic(), name_, parameters_handler_);
 
@@ -85,6 +91,13 @@ void Optimizer::getParams()
   getParam(s.sampling_std.vy, "vy_std", 0.2f);
   getParam(s.sampling_std.wz, "wz_std", 0.4f);
   getParam(s.retry_attempt_limit, "retry_attempt_limit", 1);
+  getParam(s.num_threads, "num_threads", 1);
+  getParam(s.fused_integration, "fused_integration", false);
+  getParam(s.adaptive_sampling, "adaptive_sampling", false);
+  getParam(s.min_batch_size, "min_batch_size", 200);
+  getParam(s.ess_shrink_ratio, "ess_shrink_ratio", 0.05f);
+  getParam(s.ess_expand_ratio, "ess_expand_ratio", 0.25f);
+  getParam(s.time_budget, "time_budget", 0.0);
 
   s.base_constraints.ax_max = std::abs(s.base_constraints.ax_max);
   if (s.base_constraints.ax_min > 0.0) {
@@ -128,6 +141,9 @@ void Optimizer::setOffset(double controller_frequency)
 
 void Optimizer::reset()
 {
+  active_batch_size_ = settings_.batch_size;
+  next_batch_size_ = settings_.batch_size;
+  effective_sample_size_ = static_cast<float>(settings_.batch_size);
   state_.reset(settings_.batch_size, settings_.time_steps);
   control_sequence_.reset(settings_.time_steps);
   control_history_[0] = {0.0f, 0.0f, 0.0f};
@@ -141,9 +157,29 @@ void Optimizer::reset()
   generated_trajectories_.reset(settings_.batch_size, settings_.time_steps);
 
   noise_generator_.reset(settings_, isHolonomic());
+  resetThreadPool();
   RCLCPP_INFO(logger_, "Optimizer reset");
 }
 
+void Optimizer::resetThreadPool()
+{
+  unsigned int num_threads = settings_.num_threads;
+  if (num_threads == 0u) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  if (!thread_pool_ || thread_pool_->size() != num_threads) {
+    thread_pool_ = std::make_unique<nav2_util::ThreadPool>(num_threads);
+    RCLCPP_INFO(logger_, "Optimizer using %u thread(s) for trajectory rollouts", num_threads);
+  }
+
+  critics_data_.thread_pool = num_threads > 1u ? thread_pool_.get() : nullptr;
+  if (motion_model_) {
+    motion_model_->setThreadPool(critics_data_.thread_pool);
+  }
+  integration_scratch_ = xt::zeros<float>({2u * num_threads, settings_.time_steps});
+}
+
 bool Optimizer::isHolonomic() const
 {
   return motion_model_->isHolonomic();
@@ -172,11 +208,74 @@ geometry_msgs::msg::TwistStamped Optimizer::evalControl(
 
 void Optimizer::optimize()
 {
+  using clock = std::chrono::steady_clock;
+  const auto start = clock::now();
+  double elapsed = 0.0;
+
+  // Resize for the batch size adapted in the last cycle, only now that the last cycle's
+  // trajectories are no longer used for visualization
+  setBatchSize(next_batch_size_);
+
   for (size_t i = 0; i < settings_.iteration_count; ++i) {
     generateNoisedTrajectories();
     critic_manager_.evalTrajectoriesScores(critics_data_);
     updateControlSequence();
+
+    // Skip the remaining iterations if the next one is expected to overrun the budget
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    if (settings_.time_budget > 0.0 &&
+      elapsed * static_cast<double>(i + 2) / static_cast<double>(i + 1) > settings_.time_budget)
+    {
+      break;
+    }
+  }
+
+  if (settings_.adaptive_sampling) {
+    adaptBatchSize(elapsed);
+  }
+}
+
+void Optimizer::adaptBatchSize(double elapsed)
+{
+  auto & s = settings_;
+  const float ess_ratio = effective_sample_size_ / static_cast<float>(active_batch_size_);
+
+  // Concentrated weights mean few samples contribute to the update, so fewer are needed
+  // while they stay concentrated. Spread weights or a failure call for more exploration.
+  double batch_size = static_cast<double>(active_batch_size_);
+  if (critics_data_.fail_flag) {
+    batch_size = static_cast<double>(s.batch_size);
+  } else if (ess_ratio > s.ess_expand_ratio) {
+    batch_size *= 1.5;
+  } else if (ess_ratio < s.ess_shrink_ratio) {
+    batch_size *= 0.75;
   }
+
+  // Cost of a cycle is roughly linear in the number of samples
+  if (s.time_budget > 0.0 && elapsed > 0.0) {
+    batch_size = std::min(
+      batch_size, static_cast<double>(active_batch_size_) * s.time_budget / elapsed);
+  }
+
+  const unsigned int min_batch_size = std::clamp(s.min_batch_size, 1u, s.batch_size);
+  next_batch_size_ =
+    std::clamp(static_cast<unsigned int>(batch_size), min_batch_size, s.batch_size);
+}
+
+void Optimizer::setBatchSize(unsigned int batch_size)
+{
+  if (batch_size == active_batch_size_) {
+    return;
+  }
+
+  RCLCPP_DEBUG(
+    logger_, "Optimizer batch size changed from %u to %u (effective sample size %.1f)",
+    active_batch_size_, batch_size, effective_sample_size_);
+
+  active_batch_size_ = batch_size;
+  state_.reset(batch_size, settings_.time_steps);
+  costs_ = xt::zeros<float>({batch_size});
+  generated_trajectories_.reset(batch_size, settings_.time_steps);
 }
 
 bool Optimizer::fallback(bool fail)
@@ -241,7 +340,15 @@ void Optimizer::generateNoisedTrajectories()
   noise_generator_.setNoisedControls(state_, control_sequence_);
   noise_generator_.generateNextNoises();
   updateStateVelocities(state_);
-  integrateStateVelocities(generated_trajectories_, state_);
+  if (settings_.fused_integration) {
+    integrateStateVelocitiesFused(generated_trajectories_, state_, integration_scratch_);
+  } else {
+    integrateStateVelocities(generated_trajectories_, state_);
+  }
+
+  // New trajectories, so costmap lookups shared by critics need to be recomputed
+  cost_cache_.invalidate(
+    generated_trajectories_.x.shape(0), generated_trajectories_.x.shape(1));
 }
 
 void Optimizer::applyControlSequenceConstraints()
@@ -338,6 +445,31 @@ void Optimizer::integrateStateVelocities(
   xt::noalias(traj_y) = state_.pose.pose.position.y + xt::cumsum(dy * settings_.model_dt, 0);
 }
 
+void Optimizer::integrateStateVelocitiesFused(
+  models::Trajectories & trajectories,
+  const models::State & state,
+  xt::xtensor<float, 2> & scratch) const
+{
+  const size_t batch_size = state.vx.shape(0);
+  const size_t time_steps = state.vx.shape(1);
+  if (trajectories.x.shape() != state.vx.shape()) {
+    trajectories.reset(batch_size, time_steps);
+  }
+
+  const size_t num_threads = thread_pool_ ? thread_pool_->size() : 1u;
+  if (scratch.shape(0) < 2u * num_threads || scratch.shape(1) < time_steps) {
+    scratch = xt::zeros<float>({2u * num_threads, time_steps});
+  }
+
+  nav2_util::parallelFor(
+    critics_data_.thread_pool, batch_size,
+    [&](size_t begin, size_t end) {
+      const size_t idx = nav2_util::chunkIndex(critics_data_.thread_pool, batch_size, begin);
+      integrateStateVelocitiesFused(
+        trajectories, state, begin, end, &scratch(2u * idx, 0), &scratch(2u * idx + 1u, 0));
+    });
+}
+
 void Optimizer::integrateStateVelocities(
   models::Trajectories & trajectories,
   const models::State & state) const
@@ -366,6 +498,70 @@ void Optimizer::integrateStateVelocities(
     xt::cumsum(dy * settings_.model_dt, {1});
 }
 
+void Optimizer::integrateStateVelocitiesFused(
+  models::Trajectories & trajectories,
+  const models::State & state,
+  size_t begin, size_t end,
+  float * yaw_cos, float * yaw_sin) const
+{
+  using batch = xsimd::batch<float>;
+  constexpr size_t simd_size = batch::size;
+
+  const bool is_holo = isHolonomic();
+  const float dt = settings_.model_dt;
+  const size_t time_steps = state.vx.shape(1);
+  const float initial_yaw = static_cast<float>(tf2::getYaw(state.pose.pose.orientation));
+  const float initial_cos = cosf(initial_yaw);
+  const float initial_sin = sinf(initial_yaw);
+  const double initial_x = state.pose.pose.position.x;
+  const double initial_y = state.pose.pose.position.y;
+
+  for (size_t i = begin; i != end; i++) {
+    const float * vx = &state.vx(i, 0);
+    const float * vy = &state.vy(i, 0);
+    const float * wz = &state.wz(i, 0);
+    float * traj_x = &trajectories.x(i, 0);
+    float * traj_y = &trajectories.y(i, 0);
+    float * traj_yaws = &trajectories.yaws(i, 0);
+
+    // Yaws are the cumulative sum of the angular displacements
+    float yaw = 0.0f;
+    for (size_t j = 0; j != time_steps; j++) {
+      yaw += wz[j] * dt;
+      traj_yaws[j] = yaw + initial_yaw;
+    }
+
+    // Each step is travelled with the heading of the previous one
+    yaw_cos[0] = initial_cos;
+    yaw_sin[0] = initial_sin;
+    size_t t = 1;
+    for (; t + simd_size <= time_steps; t += simd_size) {
+      const auto [sin_batch, cos_batch] = xsimd::sincos(batch::load_unaligned(traj_yaws + t - 1));
+      cos_batch.store_unaligned(yaw_cos + t);
+      sin_batch.store_unaligned(yaw_sin + t);
+    }
+    for (; t < time_steps; t++) {
+      yaw_cos[t] = cosf(traj_yaws[t - 1]);
+      yaw_sin[t] = sinf(traj_yaws[t - 1]);
+    }
+
+    // Positions are the cumulative sum of the displacements in the odometric frame
+    float x = 0.0f, y = 0.0f;
+    for (size_t j = 0; j != time_steps; j++) {
+      float dx = vx[j] * yaw_cos[j];
+      float dy = vx[j] * yaw_sin[j];
+      if (is_holo) {
+        dx -= vy[j] * yaw_sin[j];
+        dy += vy[j] * yaw_cos[j];
+      }
+      x += dx * dt;
+      y += dy * dt;
+      traj_x[j] = static_cast<float>(initial_x + x);
+      traj_y[j] = static_cast<float>(initial_y + y);
+    }
+  }
+}
+
 xt::xtensor<float, 2> Optimizer::getOptimizedTrajectory()
 {
   const bool is_holo = isHolonomic();
@@ -409,6 +605,7 @@ void Optimizer::updateControlSequence()
   auto && exponents = xt::eval(xt::exp(-1 / settings_.temperature * costs_normalized));
   auto && softmaxes = xt::eval(exponents / xt::sum(exponents, immediate));
   auto && softmaxes_extened = xt::eval(xt::view(softmaxes, xt::all(), xt::newaxis()));
+  effective_sample_size_ = 1.0f / xt::sum(softmaxes * softmaxes, immediate)();
 
   xt::noalias(control_sequence_.vx) = xt::sum(state_.cvx * softmaxes_extened, 0, immediate);
   xt::noalias(control_sequence_.wz) = xt::sum(state_.cwz * softmaxes_extened, 0, immediate);
@@ -450,6 +647,7 @@ void Optimizer::setMotionModel(const std::string & model)
               "or Ackermann"));
   }
   motion_model_->initialize(settings_.constraints, settings_.model_dt);
+  motion_model_->setThreadPool(critics_data_.thread_pool);
 }
 
 void Optimizer::setSpeedLimit(double speed_limit, bool percentage)
@@ -484,4 +682,14 @@ models::Trajectories & Optimizer::getGeneratedTrajectories()
   return generated_trajectories_;
 }
 
+float Optimizer::getEffectiveSampleSize() const
+{
+  return effective_sample_size_;
+}
+
+unsigned int Optimizer::getBatchSize() const
+{
+  return active_batch_size_;
+}
+
 }  // namespace mppi
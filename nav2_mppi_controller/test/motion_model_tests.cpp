@@ -20,6 +20,7 @@
 #include "nav2_mppi_controller/motion_models.hpp"
 #include "nav2_mppi_controller/models/state.hpp"
 #include "nav2_mppi_controller/models/control_sequence.hpp"
+#include "nav2_util/thread_pool.hpp"
 
 // Tests motion models
 
@@ -177,3 +178,29 @@ TEST(MotionModelTests, AckermannTest)
   // Check it cleanly destructs
   model.reset();
 }
+
+class CustomPredictMotionModel : public DiffDriveMotionModel
+{
+public:
+  void predict(models::State & state) override
+  {
+    predicted_rows = state.vx.shape(0);
+  }
+
+  size_t predicted_rows{0};
+};
+
+TEST(MotionModelTests, CustomPredictTest)
+{
+  models::State state;
+  state.reset(100, 10);
+  nav2_util::ThreadPool pool(4);
+
+  // Motion models overriding predict() are still called through the base class,
+  // whether or not the optimizer provides a thread pool
+  auto custom_model = std::make_shared<CustomPredictMotionModel>();
+  std::shared_ptr<MotionModel> model = custom_model;
+  model->setThreadPool(&pool);
+  model->predict(state);
+  EXPECT_EQ(custom_model->predicted_rows, 100u);
+}
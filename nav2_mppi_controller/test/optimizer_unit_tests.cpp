@@ -15,8 +15,11 @@
 #include <chrono>
 #include <thread>
 
+#include <xtensor/xrandom.hpp>
+
 #include "gtest/gtest.h"
 #include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_mppi_controller/optimizer.hpp"
 
 // Tests main optimizer functions
@@ -222,6 +225,42 @@ public:
   {
     return integrateStateVelocities(traj, state);
   }
+
+  void integrateStateVelocitiesFusedWrapper(
+    models::Trajectories & traj,
+    const models::State & state)
+  {
+    xt::xtensor<float, 2> scratch;
+    integrateStateVelocitiesFused(traj, state, scratch);
+  }
+
+  void setAdaptiveSampling(unsigned int min_batch_size, double time_budget)
+  {
+    settings_.adaptive_sampling = true;
+    settings_.min_batch_size = min_batch_size;
+    settings_.time_budget = time_budget;
+  }
+
+  void adaptBatchSizeWrapper(float effective_sample_size, bool fail, double elapsed)
+  {
+    effective_sample_size_ = effective_sample_size;
+    critics_data_.fail_flag = fail;
+    adaptBatchSize(elapsed);
+    // As done at the start of the next cycle
+    setBatchSize(next_batch_size_);
+  }
+
+  void adaptNextBatchSizeWrapper(float effective_sample_size, bool fail, double elapsed)
+  {
+    effective_sample_size_ = effective_sample_size;
+    critics_data_.fail_flag = fail;
+    adaptBatchSize(elapsed);
+  }
+
+  const xt::xtensor<float, 1> & getCosts()
+  {
+    return costs_;
+  }
 };
 
 TEST(OptimizerTests, BasicInitializedFunctions)
@@ -652,3 +691,205 @@ TEST(OptimizerTests, integrateStateVelocitiesTests)
     EXPECT_NEAR(traj.y(1, i), y, 1e-6);
   }
 }
+
+TEST(OptimizerTests, fusedIntegrateStateVelocitiesTests)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("my_node");
+  OptimizerTester optimizer_tester;
+  node->declare_parameter("controller_frequency", rclcpp::ParameterValue(30.0));
+  node->declare_parameter("mppic.batch_size", rclcpp::ParameterValue(1000));
+  node->declare_parameter("mppic.model_dt", rclcpp::ParameterValue(0.1));
+  node->declare_parameter("mppic.time_steps", rclcpp::ParameterValue(50));
+  node->declare_parameter("mppic.num_threads", rclcpp::ParameterValue(3));
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
+    "dummy_costmap", "", "dummy_costmap", true);
+  ParametersHandler param_handler(node);
+  rclcpp_lifecycle::State lstate;
+  costmap_ros->on_configure(lstate);
+  optimizer_tester.initialize(node, "mppic", costmap_ros, &param_handler);
+  optimizer_tester.resetMotionModel();
+  optimizer_tester.testSetOmniModel();
+
+  // Random velocities from a non-zero initial pose
+  models::State state;
+  state.reset(1000, 50);
+  state.pose.pose.position.x = 1.5;
+  state.pose.pose.position.y = -2.0;
+  state.pose.pose.orientation.z = sin(0.4);
+  state.pose.pose.orientation.w = cos(0.4);
+  state.vx = xt::random::randn<float>({1000, 50}, 0.3f, 0.2f);
+  state.vy = xt::random::randn<float>({1000, 50}, 0.0f, 0.2f);
+  state.wz = xt::random::randn<float>({1000, 50}, 0.0f, 0.5f);
+
+  // The fused kernel should match the tensor expression path
+  models::Trajectories fused_traj, tensor_traj;
+  optimizer_tester.integrateStateVelocitiesFusedWrapper(fused_traj, state);
+  optimizer_tester.integrateStateVelocitiesWrapper(tensor_traj, state);
+
+  ASSERT_EQ(fused_traj.x.shape(), tensor_traj.x.shape());
+  EXPECT_TRUE(xt::allclose(fused_traj.yaws, tensor_traj.yaws, 1e-5, 1e-5));
+  EXPECT_TRUE(xt::allclose(fused_traj.x, tensor_traj.x, 1e-5, 1e-5));
+  EXPECT_TRUE(xt::allclose(fused_traj.y, tensor_traj.y, 1e-5, 1e-5));
+}
+
+TEST(OptimizerTests, adaptiveSamplingTests)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("my_node");
+  OptimizerTester optimizer_tester;
+  node->declare_parameter("mppic.batch_size", rclcpp::ParameterValue(1000));
+  node->declare_parameter("mppic.time_steps", rclcpp::ParameterValue(50));
+  node->declare_parameter("controller_frequency", rclcpp::ParameterValue(30.0));
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
+    "dummy_costmap", "", "dummy_costmap", true);
+  ParametersHandler param_handler(node);
+  rclcpp_lifecycle::State lstate;
+  costmap_ros->on_configure(lstate);
+  optimizer_tester.initialize(node, "mppic", costmap_ros, &param_handler);
+  optimizer_tester.setAdaptiveSampling(300u, 0.0);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 1000u);
+
+  // Concentrated weights shrink the batch down to the minimum, resizing the samples
+  optimizer_tester.adaptBatchSizeWrapper(10.0f, false, 0.01);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 750u);
+  EXPECT_EQ(optimizer_tester.getGeneratedTrajectories().x.shape(0), 750u);
+  for (unsigned int i = 0; i != 10; i++) {
+    optimizer_tester.adaptBatchSizeWrapper(1.0f, false, 0.01);
+  }
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 300u);
+
+  // Weights in between the thresholds keep the batch
+  optimizer_tester.adaptBatchSizeWrapper(30.0f, false, 0.01);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 300u);
+
+  // Spread weights grow it, a failure restores the full batch
+  optimizer_tester.adaptBatchSizeWrapper(200.0f, false, 0.01);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 450u);
+  optimizer_tester.adaptBatchSizeWrapper(10.0f, true, 0.01);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 1000u);
+
+  // The time budget caps growth proportionally to the last cycle's duration
+  optimizer_tester.setAdaptiveSampling(300u, 0.02);
+  optimizer_tester.adaptBatchSizeWrapper(1000.0f, false, 0.04);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 500u);
+
+  // Trajectories are still generated with fewer samples than the noises
+  geometry_msgs::msg::PoseStamped pose;
+  geometry_msgs::msg::Twist speed;
+  nav_msgs::msg::Path path;
+  path.poses.resize(17);
+  EXPECT_NO_THROW(optimizer_tester.evalControl(pose, speed, path, nullptr));
+  EXPECT_GT(optimizer_tester.getEffectiveSampleSize(), 0.0f);
+  EXPECT_LE(optimizer_tester.getEffectiveSampleSize(), 500.0f + 1e-3f);
+
+  // Reset restores the full batch
+  optimizer_tester.reset();
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 1000u);
+}
+
+TEST(OptimizerTests, adaptiveSamplingKeepsGeneratedTrajectoriesTests)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("my_node");
+  OptimizerTester optimizer_tester;
+  node->declare_parameter("mppic.batch_size", rclcpp::ParameterValue(1000));
+  node->declare_parameter("mppic.time_steps", rclcpp::ParameterValue(50));
+  node->declare_parameter("controller_frequency", rclcpp::ParameterValue(30.0));
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
+    "dummy_costmap", "", "dummy_costmap", true);
+  ParametersHandler param_handler(node);
+  rclcpp_lifecycle::State lstate;
+  costmap_ros->on_configure(lstate);
+  optimizer_tester.initialize(node, "mppic", costmap_ros, &param_handler);
+  optimizer_tester.setAdaptiveSampling(300u, 0.0);
+
+  // A changed batch size leaves the last cycle's trajectories as they are
+  optimizer_tester.adaptNextBatchSizeWrapper(10.0f, false, 0.01);
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 1000u);
+  EXPECT_EQ(optimizer_tester.getGeneratedTrajectories().x.shape(0), 1000u);
+
+  // And is applied by the next cycle, whose trajectories are kept after it adapts the
+  // batch size again, for visualization
+  geometry_msgs::msg::PoseStamped pose;
+  geometry_msgs::msg::Twist speed;
+  nav_msgs::msg::Path path;
+  path.poses.resize(17);
+  EXPECT_NO_THROW(optimizer_tester.evalControl(pose, speed, path, nullptr));
+  EXPECT_EQ(optimizer_tester.getBatchSize(), 750u);
+  auto & trajectories = optimizer_tester.getGeneratedTrajectories();
+  EXPECT_EQ(trajectories.x.shape(0), 750u);
+  EXPECT_EQ(trajectories.y.shape(0), 750u);
+  EXPECT_EQ(trajectories.yaws.shape(0), 750u);
+  EXPECT_EQ(trajectories.x.shape(1), 50u);
+}
+
+TEST(OptimizerTests, parallelScoringMatchesSerialTests)
+{
+  // Obstacles on both sides of a straight path, so that the trajectories get various costs
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
+    "dummy_costmap", "", "dummy_costmap", true);
+  rclcpp_lifecycle::State lstate;
+  costmap_ros->on_configure(lstate);
+  auto costmap = costmap_ros->getCostmap();
+  for (unsigned int i = 20; i < 30; i++) {
+    for (unsigned int j = 15; j < 20; j++) {
+      costmap->setCost(i, j, nav2_costmap_2d::LETHAL_OBSTACLE);
+      costmap->setCost(i, j + 13, 200);
+    }
+  }
+
+  geometry_msgs::msg::PoseStamped pose;
+  pose.pose.position.x = 1.0;
+  pose.pose.position.y = 2.3;
+  geometry_msgs::msg::Twist speed;
+  speed.linear.x = 0.2;
+  nav_msgs::msg::Path path;
+  for (unsigned int i = 0; i < 30; i++) {
+    geometry_msgs::msg::PoseStamped path_pose;
+    path_pose.pose.position.x = 1.0 + 0.1 * i;
+    path_pose.pose.position.y = 2.3;
+    path.poses.push_back(path_pose);
+  }
+
+  // Optimizers differing only by their number of threads, drawing the same noises
+  std::vector<std::shared_ptr<rclcpp_lifecycle::LifecycleNode>> nodes;
+  std::vector<std::unique_ptr<ParametersHandler>> param_handlers;
+  std::vector<std::unique_ptr<OptimizerTester>> optimizers;
+  for (int num_threads : {1, 4}) {
+    auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>(
+      "my_node_" + std::to_string(num_threads));
+    node->declare_parameter("mppic.batch_size", rclcpp::ParameterValue(1000));
+    node->declare_parameter("mppic.time_steps", rclcpp::ParameterValue(50));
+    node->declare_parameter("mppic.num_threads", rclcpp::ParameterValue(num_threads));
+    node->declare_parameter(
+      "mppic.critics", rclcpp::ParameterValue(
+        std::vector<std::string>{"CostCritic", "ObstaclesCritic", "PathAlignCritic"}));
+    node->declare_parameter("controller_frequency", rclcpp::ParameterValue(30.0));
+    param_handlers.push_back(std::make_unique<ParametersHandler>(node));
+    optimizers.push_back(std::make_unique<OptimizerTester>());
+    xt::random::seed(42);
+    optimizers.back()->initialize(node, "mppic", costmap_ros, param_handlers.back().get());
+    nodes.push_back(node);
+  }
+
+  // The costs, the control sequence and the control of a few cycles are identical
+  for (int cycle = 0; cycle < 3; cycle++) {
+    auto serial_control = optimizers[0]->evalControl(pose, speed, path, nullptr);
+    auto parallel_control = optimizers[1]->evalControl(pose, speed, path, nullptr);
+
+    EXPECT_EQ(optimizers[0]->getCosts(), optimizers[1]->getCosts()) << "at cycle " << cycle;
+    EXPECT_GT(xt::amax(optimizers[0]->getCosts())(), xt::amin(optimizers[0]->getCosts())());
+    EXPECT_EQ(
+      optimizers[0]->grabControlSequence().vx, optimizers[1]->grabControlSequence().vx);
+    EXPECT_EQ(
+      optimizers[0]->grabControlSequence().wz, optimizers[1]->grabControlSequence().wz);
+    EXPECT_EQ(serial_control.twist.linear.x, parallel_control.twist.linear.x);
+    EXPECT_EQ(serial_control.twist.angular.z, parallel_control.twist.angular.z);
+    EXPECT_EQ(
+      optimizers[0]->getGeneratedTrajectories().x, optimizers[1]->getGeneratedTrajectories().x);
+    EXPECT_EQ(
+      optimizers[0]->getGeneratedTrajectories().y, optimizers[1]->getGeneratedTrajectories().y);
+  }
+
+  for (auto & optimizer : optimizers) {
+    optimizer->shutdown();
+  }
+}
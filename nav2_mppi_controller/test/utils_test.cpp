@@ -24,6 +24,7 @@
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_mppi_controller/tools/utils.hpp"
 #include "nav2_mppi_controller/models/path.hpp"
+#include "nav2_mppi_controller/tools/trajectory_cost_cache.hpp"
 
 // Tests noise generator object
 
@@ -446,3 +447,57 @@ TEST(UtilsTests, RemovePosesAfterPathInversionTest)
   EXPECT_EQ(path.poses.size(), 11u);
   EXPECT_EQ(path.poses.back().pose.position.x, 10);
 }
+
+TEST(UtilsTests, TrajectoryCostCacheTest)
+{
+  // 10x10 cells at 10cm resolution, origin at (0, 0)
+  nav2_costmap_2d::Costmap2D costmap(10, 10, 0.1, 0.0, 0.0, 0);
+  costmap.setCost(2, 3, 100);
+  costmap.setCost(5, 5, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  models::Trajectories trajectories;
+  trajectories.reset(2, 3);
+  trajectories.x(0, 0) = 0.25;
+  trajectories.y(0, 0) = 0.35;
+  trajectories.x(0, 1) = 0.55;
+  trajectories.y(0, 1) = 0.55;
+  trajectories.x(0, 2) = -1.0;  // off of the map
+  trajectories.x(1, 2) = 0.05;
+  trajectories.y(1, 2) = 1.5;  // off of the map
+
+  TrajectoryCostCache cache;
+  cache.setCostmap(&costmap);
+  cache.invalidate(2, 3);
+  EXPECT_EQ(cache.pointCost(trajectories, 0, 0), 100.0f);
+  EXPECT_EQ(cache.pointCost(trajectories, 0, 1), 254.0f);
+  EXPECT_EQ(cache.pointCost(trajectories, 0, 2), TrajectoryCostCache::OFF_MAP_COST);
+  EXPECT_EQ(cache.pointCost(trajectories, 1, 0), 0.0f);
+  EXPECT_EQ(cache.pointCost(trajectories, 1, 2), TrajectoryCostCache::OFF_MAP_COST);
+
+  // A small square footprint centered on the lethal cell is in collision
+  nav2_costmap_2d::Footprint footprint(4);
+  footprint[0].x = 0.05;
+  footprint[0].y = 0.05;
+  footprint[1].x = 0.05;
+  footprint[1].y = -0.05;
+  footprint[2].x = -0.05;
+  footprint[2].y = -0.05;
+  footprint[3].x = -0.05;
+  footprint[3].y = 0.05;
+  EXPECT_EQ(cache.footprintCost(trajectories, 0, 1, footprint), 254.0f);
+  EXPECT_EQ(cache.footprintCost(trajectories, 1, 0, footprint), 0.0f);
+
+  // Lookups are cached until invalidated for a new set of trajectories
+  costmap.setCost(2, 3, 50);
+  costmap.setCost(5, 5, 0);
+  EXPECT_EQ(cache.pointCost(trajectories, 0, 0), 100.0f);
+  EXPECT_EQ(cache.footprintCost(trajectories, 0, 1, footprint), 254.0f);
+  cache.invalidate(2, 3);
+  EXPECT_EQ(cache.pointCost(trajectories, 0, 0), 50.0f);
+  EXPECT_EQ(cache.footprintCost(trajectories, 0, 1, footprint), 0.0f);
+
+  // Resizing the trajectories resizes the cache
+  trajectories.reset(4, 5);
+  cache.invalidate(4, 5);
+  EXPECT_EQ(cache.pointCost(trajectories, 3, 4), 0.0f);
+}
@@ -89,6 +89,26 @@ public:
     const geometry_msgs::msg::PoseStamped & goal,
     std::function<bool()> cancel_checker) override;
 
+  /**
+   * @brief Whether separate instances of the planner may plan at the same time
+   * @return True, each instance has its own navigation function
+   */
+  bool supportsConcurrentPlanning() override {return true;}
+
+  /**
+   * @brief Creating a plan from start and goal poses on a given costmap
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param cancel_checker Function to check if the task has been canceled
+   * @param costmap Costmap to plan on instead of the configured one
+   * @return nav_msgs::Path of the generated path
+   */
+  nav_msgs::msg::Path createPlanOnCostmap(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker,
+    nav2_costmap_2d::Costmap2D & costmap) override;
+
 protected:
   /**
    * @brief Compute a plan given start and goal poses, provided in global world frame.
@@ -199,6 +199,25 @@ nav_msgs::msg::Path NavfnPlanner::createPlan(
   return path;
 }
 
+nav_msgs::msg::Path NavfnPlanner::createPlanOnCostmap(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  std::function<bool()> cancel_checker,
+  nav2_costmap_2d::Costmap2D & costmap)
+{
+  // Plan on the given costmap, restoring the configured one whatever the outcome
+  nav2_costmap_2d::Costmap2D * configured_costmap = costmap_;
+  costmap_ = &costmap;
+  try {
+    nav_msgs::msg::Path path = createPlan(start, goal, cancel_checker);
+    costmap_ = configured_costmap;
+    return path;
+  } catch (...) {
+    costmap_ = configured_costmap;
+    throw;
+  }
+}
+
 bool
 NavfnPlanner::isPlannerOutOfDate()
 {
@@ -16,6 +16,7 @@
 #define NAV2_PLANNER__PLANNER_SERVER_HPP_
 
 #include <chrono>
+#include <exception>
 #include <string>
 #include <memory>
 #include <vector>
@@ -24,6 +25,7 @@
 
 #include "geometry_msgs/msg/point.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
+#include "builtin_interfaces/msg/duration.hpp"
 #include "nav_msgs/msg/path.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_msgs/action/compute_path_to_pose.hpp"
@@ -78,7 +80,42 @@ public:
     const std::string & planner_id,
     std::function<bool()> cancel_checker);
 
+  /**
+   * @brief Method to get a plan through a set of poses, leg by leg. Each leg starts
+   * where the previous leg's path ends.
+   * @param start starting pose
+   * @param goals goal poses, in order
+   * @param planner_id The planner to plan with
+   * @param cancel_checker A function to check if the action has been canceled
+   * @param leg_times Planning time of each leg
+   * @param curr_start Start of the last leg planned, for error reporting
+   * @param curr_goal Goal of the last leg planned, for error reporting
+   * @return Path through all goals
+   */
+  nav_msgs::msg::Path planThroughPoses(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::string & planner_id,
+    std::function<bool()> cancel_checker,
+    std::vector<builtin_interfaces::msg::Duration> & leg_times,
+    geometry_msgs::msg::PoseStamped & curr_start,
+    geometry_msgs::msg::PoseStamped & curr_goal);
+
 protected:
+  /**
+   * @struct nav2_planner::PlannerServer::LegPlan
+   * @brief A leg through poses planned ahead of stitching
+   */
+  struct LegPlan
+  {
+    geometry_msgs::msg::PoseStamped start;
+    geometry_msgs::msg::PoseStamped goal;
+    nav_msgs::msg::Path path;
+    builtin_interfaces::msg::Duration planning_time;
+    std::exception_ptr exception;
+    bool planned{false};
+  };
+
   /**
    * @brief Configure member variables and initializes planner
    * @param state Reference to LifeCycle node state
@@ -199,6 +236,24 @@ protected:
    */
   void computePlanThroughPoses();
 
+  /**
+   * @brief Plan the legs through poses concurrently when the planner supports it, one
+   * thread per planner instance. Each leg starts at the previous viapoint and plans on
+   * its own copy of the costmap. Legs are taken in order, so once a leg fails no later
+   * leg is started.
+   * @param start starting pose
+   * @param goals goal poses, in order
+   * @param planner_id The planner to plan with
+   * @param cancel_checker A function to check if the action has been canceled
+   * @param legs Legs planned, empty if they could not be planned concurrently
+   */
+  void planLegsConcurrently(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::string & planner_id,
+    std::function<bool()> cancel_checker,
+    std::vector<LegPlan> & legs);
+
   /**
    * @brief The service callback to determine if the path is still valid
    * @param request to the service
@@ -243,6 +298,11 @@ protected:
   std::vector<std::string> planner_ids_;
   std::vector<std::string> planner_types_;
   double max_planner_duration_;
+  // Additional planner instances to plan legs through poses concurrently
+  std::vector<PlannerMap> leg_planners_;
+  int through_poses_planning_threads_;
+  // Distance from the end of the previous leg within which a leg planned ahead is reused
+  double through_poses_leg_tolerance_;
   std::string planner_ids_concat_;
 
   // TF buffer
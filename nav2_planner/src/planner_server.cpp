@@ -23,6 +23,10 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <functional>
 
 #include "builtin_interfaces/msg/duration.hpp"
 #include "lifecycle_msgs/msg/state.hpp"
@@ -53,6 +57,8 @@ PlannerServer::PlannerServer(const rclcpp::NodeOptions & options)
   declare_parameter("planner_plugins", default_ids_);
   declare_parameter("expected_planner_frequency", 1.0);
   declare_parameter("action_server_result_timeout", 10.0);
+  declare_parameter("through_poses_planning_threads", 1);
+  declare_parameter("through_poses_leg_tolerance", 0.25);
 
   get_parameter("planner_plugins", planner_ids_);
   if (planner_ids_ == default_ids_) {
@@ -74,6 +80,7 @@ PlannerServer::~PlannerServer()
    * never called.
    */
   planners_.clear();
+  leg_planners_.clear();
   costmap_thread_.reset();
 }
 
@@ -131,6 +138,54 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
     get_logger(),
     "Planner Server has %s planners available.", planner_ids_concat_.c_str());
 
+  get_parameter("through_poses_planning_threads", through_poses_planning_threads_);
+  if (through_poses_planning_threads_ < 1) {
+    RCLCPP_WARN(
+      get_logger(),
+      "The through poses planning threads parameter is %i. The value should be at least 1,"
+      " planning legs sequentially instead.", through_poses_planning_threads_);
+    through_poses_planning_threads_ = 1;
+  }
+  get_parameter("through_poses_leg_tolerance", through_poses_leg_tolerance_);
+
+  // Each additional thread requires its own planner instances, since plugins are not
+  // reentrant. Only planners supporting concurrent planning get them.
+  leg_planners_.resize(through_poses_planning_threads_ - 1);
+  for (size_t i = 0; i != planner_ids_.size(); i++) {
+    if (leg_planners_.empty()) {
+      break;
+    }
+    if (!planners_[planner_ids_[i]]->supportsConcurrentPlanning()) {
+      RCLCPP_INFO(
+        get_logger(), "Planner %s does not support concurrent planning, "
+        "its legs through poses are planned sequentially.", planner_ids_[i].c_str());
+      continue;
+    }
+    for (auto & leg_planners : leg_planners_) {
+      try {
+        nav2_core::GlobalPlanner::Ptr planner =
+          gp_loader_.createUniqueInstance(planner_types_[i]);
+        planner->configure(node, planner_ids_[i], tf_, costmap_ros_);
+        leg_planners.insert({planner_ids_[i], planner});
+      } catch (const std::exception & ex) {
+        RCLCPP_FATAL(
+          get_logger(), "Failed to create global planner for through poses planning. "
+          "Exception: %s", ex.what());
+        return nav2_util::CallbackReturn::FAILURE;
+      }
+    }
+  }
+
+  if (!leg_planners_.empty() && leg_planners_.front().empty()) {
+    leg_planners_.clear();
+  }
+
+  if (!leg_planners_.empty()) {
+    RCLCPP_INFO(
+      get_logger(), "Planning through poses with up to %i legs in parallel.",
+      through_poses_planning_threads_);
+  }
+
   double expected_planner_frequency;
   get_parameter("expected_planner_frequency", expected_planner_frequency);
   if (expected_planner_frequency > 0) {
@@ -189,6 +244,12 @@ PlannerServer::on_activate(const rclcpp_lifecycle::State & /*state*/)
     it->second->activate();
   }
 
+  for (auto & leg_planners : leg_planners_) {
+    for (it = leg_planners.begin(); it != leg_planners.end(); ++it) {
+      it->second->activate();
+    }
+  }
+
   auto node = shared_from_this();
 
   is_path_valid_service_ = node->create_service<nav2_msgs::srv::IsPathValid>(
@@ -230,6 +291,12 @@ PlannerServer::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
     it->second->deactivate();
   }
 
+  for (auto & leg_planners : leg_planners_) {
+    for (it = leg_planners.begin(); it != leg_planners.end(); ++it) {
+      it->second->deactivate();
+    }
+  }
+
   dyn_params_handler_.reset();
 
   // destroy bond connection
@@ -255,7 +322,14 @@ PlannerServer::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
     it->second->cleanup();
   }
 
+  for (auto & leg_planners : leg_planners_) {
+    for (it = leg_planners.begin(); it != leg_planners.end(); ++it) {
+      it->second->cleanup();
+    }
+  }
+
   planners_.clear();
+  leg_planners_.clear();
   costmap_thread_.reset();
   costmap_ = nullptr;
   return nav2_util::CallbackReturn::SUCCESS;
@@ -398,38 +472,9 @@ void PlannerServer::computePlanThroughPoses()
         return action_server_poses_->is_cancel_requested();
       };
 
-    // Get consecutive paths through these points
-    for (unsigned int i = 0; i != goal->goals.size(); i++) {
-      // Get starting point
-      if (i == 0) {
-        curr_start = start;
-      } else {
-        // pick the end of the last planning task as the start for the next one
-        // to allow for path tolerance deviations
-        curr_start = concat_path.poses.back();
-        curr_start.header = concat_path.header;
-      }
-      curr_goal = goal->goals[i];
-
-      // Transform them into the global frame
-      if (!transformPosesToGlobalFrame(curr_start, curr_goal)) {
-        throw nav2_core::PlannerTFError("Unable to transform poses to global frame");
-      }
-
-      // Get plan from start -> goal
-      nav_msgs::msg::Path curr_path = getPlan(
-        curr_start, curr_goal, goal->planner_id,
-        cancel_checker);
-
-      if (!validatePath<ActionThroughPoses>(curr_goal, curr_path, goal->planner_id)) {
-        throw nav2_core::NoValidPathCouldBeFound(goal->planner_id + " generated a empty path");
-      }
-
-      // Concatenate paths together
-      concat_path.poses.insert(
-        concat_path.poses.end(), curr_path.poses.begin(), curr_path.poses.end());
-      concat_path.header = curr_path.header;
-    }
+    concat_path = planThroughPoses(
+      start, goal->goals, goal->planner_id, cancel_checker, result->leg_planning_times,
+      curr_start, curr_goal);
 
     // Publish the plan for visualization purposes
     result->path = concat_path;
@@ -623,6 +668,156 @@ PlannerServer::getPlan(
   return nav_msgs::msg::Path();
 }
 
+nav_msgs::msg::Path
+PlannerServer::planThroughPoses(
+  const geometry_msgs::msg::PoseStamped & start,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::string & planner_id,
+  std::function<bool()> cancel_checker,
+  std::vector<builtin_interfaces::msg::Duration> & leg_times,
+  geometry_msgs::msg::PoseStamped & curr_start,
+  geometry_msgs::msg::PoseStamped & curr_goal)
+{
+  nav_msgs::msg::Path concat_path;
+  leg_times.clear();
+
+  // Legs planned ahead concurrently, each one starting at the previous viapoint
+  std::vector<LegPlan> legs;
+  planLegsConcurrently(start, goals, planner_id, cancel_checker, legs);
+
+  // Get consecutive paths through these points
+  for (unsigned int i = 0; i != goals.size(); i++) {
+    // Get starting point
+    if (i == 0) {
+      curr_start = start;
+    } else {
+      // pick the end of the last planning task as the start for the next one
+      // to allow for path tolerance deviations
+      curr_start = concat_path.poses.back();
+      curr_start.header = concat_path.header;
+    }
+    curr_goal = goals[i];
+
+    // Transform them into the global frame
+    if (!transformPosesToGlobalFrame(curr_start, curr_goal)) {
+      throw nav2_core::PlannerTFError("Unable to transform poses to global frame");
+    }
+
+    // Use the leg planned ahead if it starts close enough to where the previous leg ended,
+    // otherwise plan it from there now. The previous leg may end off its goal, either
+    // within the planner tolerance or facing the final approach orientation.
+    nav_msgs::msg::Path curr_path;
+    if (i < legs.size() && legs[i].planned &&
+      nav2_util::geometry_utils::euclidean_distance(legs[i].start, curr_start) <=
+      through_poses_leg_tolerance_)
+    {
+      if (legs[i].exception) {
+        std::rethrow_exception(legs[i].exception);
+      }
+      curr_path = legs[i].path;
+      leg_times.push_back(legs[i].planning_time);
+    } else {
+      auto leg_start_time = this->now();
+      curr_path = getPlan(curr_start, curr_goal, planner_id, cancel_checker);
+      leg_times.push_back(this->now() - leg_start_time);
+    }
+
+    if (!validatePath<ActionThroughPoses>(curr_goal, curr_path, planner_id)) {
+      throw nav2_core::NoValidPathCouldBeFound(planner_id + " generated a empty path");
+    }
+
+    // Concatenate paths together
+    concat_path.poses.insert(
+      concat_path.poses.end(), curr_path.poses.begin(), curr_path.poses.end());
+    concat_path.header = curr_path.header;
+  }
+
+  return concat_path;
+}
+
+void
+PlannerServer::planLegsConcurrently(
+  const geometry_msgs::msg::PoseStamped & start,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::string & planner_id,
+  std::function<bool()> cancel_checker,
+  std::vector<LegPlan> & legs)
+{
+  legs.clear();
+
+  // Resolve the planner as getPlan() does, it must support concurrent planning
+  std::string id = planner_id;
+  if (planners_.find(id) == planners_.end() && planners_.size() == 1 && id.empty()) {
+    id = planners_.begin()->first;
+  }
+  if (goals.size() < 2 || leg_planners_.empty() ||
+    leg_planners_.front().find(id) == leg_planners_.front().end())
+  {
+    return;
+  }
+
+  const size_t num_legs = goals.size();
+  legs.resize(num_legs);
+  for (size_t i = 0; i != num_legs; i++) {
+    geometry_msgs::msg::PoseStamped leg_start = i == 0 ? start : goals[i - 1];
+    geometry_msgs::msg::PoseStamped leg_goal = goals[i];
+    if (!transformPosesToGlobalFrame(leg_start, leg_goal)) {
+      // Left to the sequential pass, which reports the error in order
+      legs.clear();
+      return;
+    }
+    legs[i].start = leg_start;
+    legs[i].goal = leg_goal;
+  }
+
+  // All legs plan on the same costmap contents. Each one gets its own copy since planners
+  // may lock or modify the costmap they plan on.
+  nav2_costmap_2d::Costmap2D snapshot;
+  {
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+    snapshot = *costmap_;
+  }
+
+  std::atomic<size_t> next_leg{0};
+  std::atomic<size_t> first_failed_leg{num_legs};
+
+  auto plan_legs = [&](nav2_core::GlobalPlanner::Ptr planner) {
+      for (size_t i = next_leg++; i < num_legs && i < first_failed_leg; i = next_leg++) {
+        LegPlan & leg = legs[i];
+        auto leg_start_time = this->now();
+        try {
+          nav2_costmap_2d::Costmap2D leg_costmap(snapshot);
+          leg.path = planner->createPlanOnCostmap(
+            leg.start, leg.goal, cancel_checker, leg_costmap);
+        } catch (...) {
+          leg.exception = std::current_exception();
+        }
+        leg.planning_time = this->now() - leg_start_time;
+        leg.planned = true;
+
+        // Later legs are not needed past a failure
+        if (leg.exception || leg.path.poses.empty()) {
+          size_t failed_leg = first_failed_leg;
+          while (i < failed_leg && !first_failed_leg.compare_exchange_weak(failed_leg, i)) {
+          }
+        }
+      }
+    };
+
+  // The calling thread plans with the primary planner, the others with their own instances
+  const size_t num_workers = std::min(leg_planners_.size(), num_legs - 1);
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t i = 0; i != num_workers; i++) {
+    workers.emplace_back(plan_legs, leg_planners_[i][id]);
+  }
+  plan_legs(planners_[id]);
+
+  for (auto & worker : workers) {
+    worker.join();
+  }
+}
+
 void
 PlannerServer::publishPlan(const nav_msgs::msg::Path & path)
 {
@@ -34,6 +34,7 @@
 #include "nav2_smac_planner/node_hybrid.hpp"
 #include "nav2_smac_planner/node_lattice.hpp"
 #include "nav2_smac_planner/node_basic.hpp"
+#include "nav2_smac_planner/node_pool.hpp"
 #include "nav2_smac_planner/types.hpp"
 #include "nav2_smac_planner/constants.hpp"
 
@@ -209,9 +210,17 @@ protected:
   /**
    * @brief Adds node to graph
    * @param index Node index to add
+   * @return Node pointer, nullptr if the node pool is full
    */
   inline NodePtr addToGraph(const uint64_t & index);
 
+  /**
+   * @brief Get a node already in the graph
+   * @param index Node index
+   * @return Node reference
+   */
+  inline NodeT & getFromGraph(const uint64_t & index);
+
   /**
    * @brief Check if this node is the goal node
    * @param node Node pointer to check if its the goal node
@@ -267,6 +276,7 @@ protected:
   NodePtr _goal;
 
   Graph _graph;
+  std::unique_ptr<NodePool<NodeT>> _node_pool;
   NodeQueue _queue;
 
   MotionModel _motion_model;
@@ -123,10 +123,19 @@ private:
    */
   bool outsideRange(const unsigned int & max, const float & value);
 
+  /**
+   * @brief Check if the footprint stencils were made for another costmap resolution or width
+   * @return boolean if the stencils need to be made again
+   */
+  bool stencilsOutOfDate();
+
 protected:
   std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_;
   std::vector<nav2_costmap_2d::Footprint> oriented_footprints_;
   nav2_costmap_2d::Footprint unoriented_footprint_;
+  // Costmap properties the footprint stencils were made for
+  double stencils_resolution_{0.0};
+  unsigned int stencils_size_x_{0};
   float footprint_cost_;
   bool footprint_is_radius_;
   std::vector<float> angles_;
@@ -434,6 +434,19 @@ public:
     const unsigned int & start_x, const unsigned int & start_y,
     const unsigned int & goal_x, const unsigned int & goal_y);
 
+  /**
+   * @brief Update the obstacle heuristic state for a new planning request to the same goal,
+   * keeping the wavefront computed so far where it is not affected by the costmap cells
+   * changed since and expanding it again from there. Falls back to a reset if the costmap
+   * was resized.
+   * @param costmap_ros Costmap to use
+   * @param goal_coords Coordinates to start heuristic expansion at
+   */
+  static void updateObstacleHeuristic(
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros,
+    const unsigned int & start_x, const unsigned int & start_y,
+    const unsigned int & goal_x, const unsigned int & goal_y);
+
   /**
    * @brief Using the inflation layer, find the footprint's adjusted cost
    * if the robot is non-circular
@@ -482,6 +495,8 @@ public:
   // Wavefront lookup and queue for continuing to expand as needed
   static LookupTable obstacle_heuristic_lookup_table;
   static ObstacleHeuristicQueue obstacle_heuristic_queue;
+  // Costmap the wavefront was computed on, to repair it on costmap changes
+  static std::vector<unsigned char> obstacle_heuristic_costmap;
 
   static std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros;
   static std::shared_ptr<nav2_costmap_2d::InflationLayer> inflation_layer;
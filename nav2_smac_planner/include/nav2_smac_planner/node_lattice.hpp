@@ -361,6 +361,20 @@ public:
     NodeHybrid::resetObstacleHeuristic(costmap_ros, start_x, start_y, goal_x, goal_y);
   }
 
+  /**
+   * @brief Update the wavefront heuristic for a new planning request to the same goal
+   * @param costmap Costmap to use
+   * @param goal_coords Coordinates to start heuristic expansion at
+   */
+  static void updateObstacleHeuristic(
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros,
+    const unsigned int & start_x, const unsigned int & start_y,
+    const unsigned int & goal_x, const unsigned int & goal_y)
+  {
+    // State Lattice and Hybrid-A* share this heuristics
+    NodeHybrid::updateObstacleHeuristic(costmap_ros, start_x, start_y, goal_x, goal_y);
+  }
+
   /**
    * @brief Compute the Obstacle heuristic
    * @param node_coords Coordinates to get heuristic at
@@ -0,0 +1,268 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__NODE_POOL_HPP_
+#define NAV2_SMAC_PLANNER__NODE_POOL_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::NodePool
+ * @brief A graph of search nodes backed by a pool of node storage reused across
+ * planning requests. Nodes are looked up by index in an open addressing table whose
+ * entries are invalidated by a generation counter, so clearing the graph is O(1) and
+ * does not free or reallocate any memory. The number of nodes is bounded by a cap.
+ */
+template<typename NodeT>
+class NodePool
+{
+public:
+  typedef NodeT * NodePtr;
+
+  /**
+   * @brief A constructor for nav2_smac_planner::NodePool
+   * @param max_nodes Maximum number of nodes the graph may contain
+   * @param expected_nodes Number of nodes to size the table for, it grows past it as needed
+   */
+  explicit NodePool(const size_t & max_nodes, const size_t & expected_nodes = 0)
+  : _max_nodes(std::min<size_t>(max_nodes, std::numeric_limits<uint32_t>::max())),
+    _size(0),
+    _generation(1)
+  {
+    _slots.resize(slotsFor(std::min(expected_nodes, _max_nodes)));
+  }
+
+  /**
+   * @brief Get the maximum number of nodes to fit in a memory budget
+   * @param max_memory Memory budget, in bytes
+   * @return Maximum number of nodes
+   */
+  static size_t maxNodesForMemory(const size_t & max_memory)
+  {
+    // The table is doubled to keep the load factor under 1/2, so it may reach 4 slots
+    // per node, and while growing the previous table of up to 2 slots per node is still held
+    return max_memory / (sizeof(NodeT) + 6 * sizeof(Slot));
+  }
+
+  /**
+   * @brief Grow the table to hold a number of nodes without rehashing
+   * @param expected_nodes Number of nodes
+   */
+  void reserve(const size_t & expected_nodes)
+  {
+    const size_t num_slots = slotsFor(std::min(expected_nodes, _max_nodes));
+    if (num_slots > _slots.size()) {
+      rehash(num_slots);
+    }
+  }
+
+  /**
+   * @brief Clear the graph, keeping the node storage for reuse
+   */
+  void clear()
+  {
+    _size = 0;
+    if (++_generation == 0) {
+      // Generation wrapped around, stale slots may now alias the new generation
+      for (auto & slot : _slots) {
+        slot.generation = 0;
+      }
+      _generation = 1;
+    }
+  }
+
+  /**
+   * @brief Whether the graph contains no nodes
+   * @return If empty
+   */
+  bool empty() const
+  {
+    return _size == 0;
+  }
+
+  /**
+   * @brief Get the number of nodes in the graph
+   * @return Number of nodes
+   */
+  size_t size() const
+  {
+    return _size;
+  }
+
+  /**
+   * @brief Get the number of nodes allocated in the pool, in use or not
+   * @return Number of nodes allocated
+   */
+  size_t capacity() const
+  {
+    return _nodes.size();
+  }
+
+  /**
+   * @brief Get the memory used by the node storage and the lookup table
+   * @return Memory used, in bytes
+   */
+  size_t memoryUsage() const
+  {
+    return _nodes.size() * sizeof(NodeT) + _slots.size() * sizeof(Slot);
+  }
+
+  /**
+   * @brief Find a node in the graph
+   * @param index Node index
+   * @return Node pointer, nullptr if not in the graph
+   */
+  NodePtr find(const uint64_t & index)
+  {
+    const Slot & slot = _slots[findSlot(index)];
+    return slot.generation == _generation ? &_nodes[slot.node] : nullptr;
+  }
+
+  /**
+   * @brief Get a node in the graph, throwing if not in it
+   * @param index Node index
+   * @return Node reference
+   */
+  NodeT & at(const uint64_t & index)
+  {
+    NodePtr node = find(index);
+    if (!node) {
+      throw std::out_of_range("Node is not in the graph.");
+    }
+    return *node;
+  }
+
+  /**
+   * @brief Get a node from the graph, adding it if not already in it
+   * @param index Node index
+   * @return Node pointer, nullptr if the maximum number of nodes is reached
+   */
+  NodePtr emplace(const uint64_t & index)
+  {
+    size_t slot_idx = findSlot(index);
+    if (_slots[slot_idx].generation == _generation) {
+      return &_nodes[_slots[slot_idx].node];
+    }
+
+    if (_size >= _max_nodes) {
+      return nullptr;
+    }
+
+    // Keep the load factor under 1/2 for short probe sequences
+    if (2 * (_size + 1) > _slots.size()) {
+      rehash(2 * _slots.size());
+      slot_idx = findSlot(index);
+    }
+
+    // Reuse the storage of a node from a prior planning request if available
+    if (_size < _nodes.size()) {
+      _nodes[_size] = NodeT(index);
+    } else {
+      _nodes.emplace_back(index);
+    }
+
+    Slot & slot = _slots[slot_idx];
+    slot.index = index;
+    slot.node = static_cast<uint32_t>(_size);
+    slot.generation = _generation;
+    return &_nodes[_size++];
+  }
+
+protected:
+  /**
+   * @struct nav2_smac_planner::NodePool::Slot
+   * @brief Entry of the open addressing table, valid if of the current generation
+   */
+  struct Slot
+  {
+    uint64_t index{0};
+    uint32_t node{0};
+    uint32_t generation{0};
+  };
+
+  static constexpr size_t MIN_SLOTS = 64;
+
+  /**
+   * @brief Get the number of slots of a table holding a number of nodes
+   * @param num_nodes Number of nodes
+   * @return Number of slots, a power of 2
+   */
+  static size_t slotsFor(const size_t & num_nodes)
+  {
+    size_t num_slots = MIN_SLOTS;
+    while (num_slots < 2 * num_nodes) {
+      num_slots *= 2;
+    }
+    return num_slots;
+  }
+
+  /**
+   * @brief Hash a node index, fibonacci hashing to spread nearby indices apart
+   * @param index Node index
+   * @return Hash
+   */
+  inline size_t hash(const uint64_t & index) const
+  {
+    return static_cast<size_t>((index * 11400714819323198485ull) >> 20);
+  }
+
+  /**
+   * @brief Find the slot of a node index, or the free slot to insert it into
+   * @param index Node index
+   * @return Slot index
+   */
+  inline size_t findSlot(const uint64_t & index) const
+  {
+    const size_t mask = _slots.size() - 1;
+    size_t slot_idx = hash(index) & mask;
+    while (_slots[slot_idx].generation == _generation && _slots[slot_idx].index != index) {
+      slot_idx = (slot_idx + 1) & mask;
+    }
+    return slot_idx;
+  }
+
+  /**
+   * @brief Grow the table, reinserting the nodes of the current generation
+   * @param num_slots New number of slots, a power of 2
+   */
+  void rehash(const size_t & num_slots)
+  {
+    std::vector<Slot> old_slots(num_slots);
+    old_slots.swap(_slots);
+    for (const auto & slot : old_slots) {
+      if (slot.generation == _generation) {
+        _slots[findSlot(slot.index)] = slot;
+      }
+    }
+  }
+
+  size_t _max_nodes;
+  size_t _size;
+  uint32_t _generation;
+  std::vector<Slot> _slots;
+  std::deque<NodeT> _nodes;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__NODE_POOL_HPP_
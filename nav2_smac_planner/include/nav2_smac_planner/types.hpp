@@ -51,6 +51,8 @@ struct SearchInfo
   bool allow_primitive_interpolation{false};
   bool downsample_obstacle_heuristic{true};
   bool use_quadratic_cost_penalty{false};
+  bool use_node_pool{false};
+  int node_pool_max_memory{512};
 };
 
 /**
@@ -48,7 +48,14 @@ AStarAlgorithm<NodeT>::AStarAlgorithm(
   _goal(nullptr),
   _motion_model(motion_model)
 {
-  _graph.reserve(100000);
+  if (_search_info.use_node_pool) {
+    const size_t max_memory =
+      static_cast<size_t>(std::max(_search_info.node_pool_max_memory, 1)) * 1024 * 1024;
+    _node_pool = std::make_unique<NodePool<NodeT>>(
+      NodePool<NodeT>::maxNodesForMemory(max_memory));
+  } else {
+    _graph.reserve(100000);
+  }
 }
 
 template<typename NodeT>
@@ -126,6 +133,10 @@ template<typename NodeT>
 typename AStarAlgorithm<NodeT>::NodePtr AStarAlgorithm<NodeT>::addToGraph(
   const uint64_t & index)
 {
+  if (_node_pool) {
+    return _node_pool->emplace(index);
+  }
+
   auto iter = _graph.find(index);
   if (iter != _graph.end()) {
     return &(iter->second);
@@ -134,6 +145,16 @@ typename AStarAlgorithm<NodeT>::NodePtr AStarAlgorithm<NodeT>::addToGraph(
   return &(_graph.emplace(index, NodeT(index)).first->second);
 }
 
+template<typename NodeT>
+NodeT & AStarAlgorithm<NodeT>::getFromGraph(const uint64_t & index)
+{
+  if (_node_pool) {
+    return _node_pool->at(index);
+  }
+
+  return _graph.at(index);
+}
+
 template<>
 void AStarAlgorithm<Node2D>::setStart(
   const float & mx,
@@ -227,6 +248,10 @@ void AStarAlgorithm<NodeT>::setGoal(
 
     NodeT::resetObstacleHeuristic(
       _collision_checker->getCostmapROS(), _start->pose.x, _start->pose.y, mx, my);
+  } else if (_start) {
+    // Same goal, only repair the cached heuristic where the costmap changed
+    NodeT::updateObstacleHeuristic(
+      _collision_checker->getCostmapROS(), _start->pose.x, _start->pose.y, mx, my);
   }
 
   _goal_coordinates = goal_coords;
@@ -237,7 +262,7 @@ template<typename NodeT>
 bool AStarAlgorithm<NodeT>::areInputsValid()
 {
   // Check if graph was filled in
-  if (_graph.empty()) {
+  if (_node_pool ? _node_pool->empty() : _graph.empty()) {
     throw std::runtime_error("Failed to compute path, no costmap given.");
   }
 
@@ -299,8 +324,9 @@ bool AStarAlgorithm<NodeT>::createPath(
         return false;
       }
 
+      // Nodes past the node pool's memory cap are treated as invalid
       neighbor_rtn = addToGraph(index);
-      return true;
+      return neighbor_rtn != nullptr;
     };
 
   while (iterations < getMaxIterations() && !_queue.empty()) {
@@ -350,7 +376,7 @@ bool AStarAlgorithm<NodeT>::createPath(
       // Optimization: Let us find when in tolerance and refine within reason
       approach_iterations++;
       if (approach_iterations >= getOnApproachMaxIterations()) {
-        return _graph.at(_best_heuristic_node.second).backtracePath(path);
+        return getFromGraph(_best_heuristic_node.second).backtracePath(path);
       }
     }
 
@@ -379,7 +405,7 @@ bool AStarAlgorithm<NodeT>::createPath(
 
   if (_best_heuristic_node.first < getToleranceHeuristic()) {
     // If we run out of search options, return the path that is closest, if within tolerance.
-    return _graph.at(_best_heuristic_node.second).backtracePath(path);
+    return getFromGraph(_best_heuristic_node.second).backtracePath(path);
   }
 
   return false;
@@ -445,6 +471,11 @@ void AStarAlgorithm<NodeT>::clearQueue()
 template<typename NodeT>
 void AStarAlgorithm<NodeT>::clearGraph()
 {
+  if (_node_pool) {
+    _node_pool->clear();
+    return;
+  }
+
   Graph g;
   std::swap(_graph, g);
   _graph.reserve(100000);
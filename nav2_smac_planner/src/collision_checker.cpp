@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
+#include <cmath>
+
 #include "nav2_smac_planner/collision_checker.hpp"
 
 namespace nav2_smac_planner
@@ -62,7 +64,7 @@ void GridCollisionChecker::setFootprint(
   }
 
   // No change, no updates required
-  if (footprint == unoriented_footprint_) {
+  if (footprint == unoriented_footprint_ && !stencilsOutOfDate()) {
     return;
   }
 
@@ -88,9 +90,22 @@ void GridCollisionChecker::setFootprint(
     oriented_footprints_.push_back(oriented_footprint);
   }
 
+  // Precompute the cells covered by the footprint outline in each orientation bin
+  if (costmap_) {
+    setFootprintStencils(footprint, angles_.size());
+    stencils_resolution_ = costmap_->getResolution();
+    stencils_size_x_ = costmap_->getSizeInCellsX();
+  }
+
   unoriented_footprint_ = footprint;
 }
 
+bool GridCollisionChecker::stencilsOutOfDate()
+{
+  return costmap_ && (stencils_resolution_ != costmap_->getResolution() ||
+         stencils_size_x_ != costmap_->getSizeInCellsX());
+}
+
 bool GridCollisionChecker::inCollision(
   const float & x,
   const float & y,
@@ -105,9 +120,6 @@ bool GridCollisionChecker::inCollision(
   }
 
   // Assumes setFootprint already set
-  double wx, wy;
-  costmap_->mapToWorld(static_cast<double>(x), static_cast<double>(y), wx, wy);
-
   if (!footprint_is_radius_) {
     // if footprint, then we check for the footprint's points, but first see
     // if the robot is even potentially in an inscribed collision
@@ -139,20 +151,24 @@ bool GridCollisionChecker::inCollision(
     }
 
     // if possible inscribed, need to check actual footprint pose.
-    // Use precomputed oriented footprints are done on initialization,
-    // offset by translation value to collision check
-    geometry_msgs::msg::Point new_pt;
-    const nav2_costmap_2d::Footprint & oriented_footprint = oriented_footprints_[angle_bin];
-    nav2_costmap_2d::Footprint current_footprint;
-    current_footprint.reserve(oriented_footprint.size());
-    for (unsigned int i = 0; i < oriented_footprint.size(); ++i) {
-      new_pt.x = wx + oriented_footprint[i].x;
-      new_pt.y = wy + oriented_footprint[i].y;
-      current_footprint.push_back(new_pt);
+    // Poses at a cell center are checked with the stencils precomputed for that
+    // orientation bin, others with the footprint placed exactly at the pose
+    const unsigned int bin = static_cast<unsigned int>(angle_bin);
+    if (x - std::floor(x) == 0.5f && y - std::floor(y) == 0.5f) {
+      footprint_cost_ = static_cast<float>(footprintCostAtCell(
+          static_cast<unsigned int>(x), static_cast<unsigned int>(y), bin));
+    } else {
+      const double resolution = costmap_->getResolution();
+      const double wx = costmap_->getOriginX() + static_cast<double>(x) * resolution;
+      const double wy = costmap_->getOriginY() + static_cast<double>(y) * resolution;
+      nav2_costmap_2d::Footprint current_footprint = oriented_footprints_[bin];
+      for (auto & point : current_footprint) {
+        point.x += wx;
+        point.y += wy;
+      }
+      footprint_cost_ = static_cast<float>(footprintCost(current_footprint));
     }
 
-    footprint_cost_ = static_cast<float>(footprintCost(current_footprint));
-
     if (footprint_cost_ == UNKNOWN && traverse_unknown) {
       return false;
     }
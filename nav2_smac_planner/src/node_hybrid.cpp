@@ -16,6 +16,7 @@
 
 #include <math.h>
 #include <chrono>
+#include <cmath>
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -44,6 +45,7 @@ std::shared_ptr<nav2_costmap_2d::Costmap2DROS> NodeHybrid::costmap_ros = nullptr
 std::shared_ptr<nav2_costmap_2d::InflationLayer> NodeHybrid::inflation_layer = nullptr;
 
 ObstacleHeuristicQueue NodeHybrid::obstacle_heuristic_queue;
+std::vector<unsigned char> NodeHybrid::obstacle_heuristic_costmap;
 
 // Each of these tables are the projected motion models through
 // time and space applied to the search on the current node in
@@ -532,6 +534,126 @@ void NodeHybrid::resetObstacleHeuristic(
   // initialize goal cell with a very small value to differentiate it from 0.0 (~uninitialized)
   // the negative value means the cell is in the open set
   obstacle_heuristic_lookup_table[goal_index] = -0.00001f;
+
+  // Keep the costs the wavefront is computed on to find the cells changed on later updates
+  const unsigned char * char_map = costmap->getCharMap();
+  obstacle_heuristic_costmap.assign(
+    char_map, char_map + costmap->getSizeInCellsX() * costmap->getSizeInCellsY());
+}
+
+void NodeHybrid::updateObstacleHeuristic(
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_i,
+  const unsigned int & start_x, const unsigned int & start_y,
+  const unsigned int & goal_x, const unsigned int & goal_y)
+{
+  auto costmap = costmap_ros_i->getCostmap();
+  const unsigned int costmap_size_x = costmap->getSizeInCellsX();
+  const unsigned int costmap_size_y = costmap->getSizeInCellsY();
+  const bool & downsample_H = motion_table.downsample_obstacle_heuristic;
+  const unsigned int factor = downsample_H ? 2u : 1u;
+  const unsigned int size_x = (costmap_size_x + factor - 1) / factor;
+  const unsigned int size_y = (costmap_size_y + factor - 1) / factor;
+
+  // A new or resized costmap invalidates the whole wavefront
+  if (costmap_ros_i != costmap_ros ||
+    obstacle_heuristic_costmap.size() != costmap_size_x * costmap_size_y ||
+    obstacle_heuristic_lookup_table.size() != size_x * size_y)
+  {
+    resetObstacleHeuristic(costmap_ros_i, start_x, start_y, goal_x, goal_y);
+    return;
+  }
+
+  // Costs were computed from the goal and increase along any path, so a cell whose cost
+  // is lower than a lower bound on the cost of all the cells around the changed ones
+  // cannot have its shortest path going through them, before or after the change.
+  // Closed cells have an exact cost, others at least the octile distance to the goal.
+  const unsigned int goal_hx = goal_x / factor;
+  const unsigned int goal_hy = goal_y / factor;
+  const float sqrt2_minus_1 = sqrtf(2.0f) - 1.0f;
+  auto lowerBound = [&](const unsigned int & hx, const unsigned int & hy) -> float
+    {
+      const float cost = obstacle_heuristic_lookup_table[hy * size_x + hx];
+      if (cost > 0.0f) {
+        return cost;
+      }
+      const float dx = std::abs(static_cast<float>(hx) - static_cast<float>(goal_hx));
+      const float dy = std::abs(static_cast<float>(hy) - static_cast<float>(goal_hy));
+      return std::max(dx, dy) + sqrt2_minus_1 * std::min(dx, dy);
+    };
+
+  const unsigned char * char_map = costmap->getCharMap();
+  float threshold = std::numeric_limits<float>::max();
+  bool changed = false;
+  for (unsigned int my = 0; my != costmap_size_y; my++) {
+    const unsigned int row = my * costmap_size_x;
+    if (std::memcmp(
+        char_map + row, obstacle_heuristic_costmap.data() + row, costmap_size_x) == 0)
+    {
+      continue;
+    }
+
+    changed = true;
+    for (unsigned int mx = 0; mx != costmap_size_x; mx++) {
+      if (char_map[row + mx] == obstacle_heuristic_costmap[row + mx]) {
+        continue;
+      }
+      obstacle_heuristic_costmap[row + mx] = char_map[row + mx];
+
+      // Neighbors of the changed cell are relaxed through it, so include them
+      const unsigned int hx = mx / factor;
+      const unsigned int hy = my / factor;
+      for (unsigned int ny = hy > 0 ? hy - 1 : 0; ny <= std::min(hy + 1, size_y - 1); ny++) {
+        for (unsigned int nx = hx > 0 ? hx - 1 : 0; nx <= std::min(hx + 1, size_x - 1); nx++) {
+          threshold = std::min(threshold, lowerBound(nx, ny));
+        }
+      }
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  // Invalidate the cells that may be affected and restart the wavefront from the border
+  // of the ones kept, which are reopened with their exact cost
+  for (auto & cost : obstacle_heuristic_lookup_table) {
+    if (cost <= 0.0f || cost >= threshold) {
+      cost = 0.0f;
+    }
+  }
+
+  obstacle_heuristic_queue.clear();
+  for (unsigned int hy = 0; hy != size_y; hy++) {
+    for (unsigned int hx = 0; hx != size_x; hx++) {
+      float & cost = obstacle_heuristic_lookup_table[hy * size_x + hx];
+      if (cost <= 0.0f) {
+        continue;
+      }
+
+      bool is_border = false;
+      for (unsigned int ny = hy > 0 ? hy - 1 : 0;
+        !is_border && ny <= std::min(hy + 1, size_y - 1); ny++)
+      {
+        for (unsigned int nx = hx > 0 ? hx - 1 : 0; nx <= std::min(hx + 1, size_x - 1); nx++) {
+          if (obstacle_heuristic_lookup_table[ny * size_x + nx] == 0.0f) {
+            is_border = true;
+            break;
+          }
+        }
+      }
+
+      if (is_border) {
+        // Priorities are recomputed for the current start when the wavefront is expanded
+        cost = -cost;
+        obstacle_heuristic_queue.emplace_back(0.0f, hy * size_x + hx);
+      }
+    }
+  }
+
+  if (obstacle_heuristic_queue.empty()) {
+    // Nothing to keep, e.g. the goal's surroundings changed
+    resetObstacleHeuristic(costmap_ros_i, start_x, start_y, goal_x, goal_y);
+  }
 }
 
 float NodeHybrid::adjustedFootprintCost(const float & cost)
@@ -156,6 +156,12 @@ void SmacPlannerHybrid::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".max_planning_time", rclcpp::ParameterValue(5.0));
   node->get_parameter(name + ".max_planning_time", _max_planning_time);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_node_pool", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_node_pool", _search_info.use_node_pool);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".node_pool_max_memory", rclcpp::ParameterValue(512));
+  node->get_parameter(name + ".node_pool_max_memory", _search_info.node_pool_max_memory);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".lookup_table_size", rclcpp::ParameterValue(20.0));
   node->get_parameter(name + ".lookup_table_size", _lookup_table_size);
@@ -581,7 +587,10 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
         reinit_smoother = true;
       }
     } else if (type == ParameterType::PARAMETER_BOOL) {
-      if (name == _name + ".downsample_costmap") {
+      if (name == _name + ".use_node_pool") {
+        reinit_a_star = true;
+        _search_info.use_node_pool = parameter.as_bool();
+      } else if (name == _name + ".downsample_costmap") {
         reinit_downsampler = true;
         _downsample_costmap = parameter.as_bool();
       } else if (name == _name + ".allow_unknown") {
@@ -604,7 +613,10 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
         reinit_a_star = true;
       }
     } else if (type == ParameterType::PARAMETER_INTEGER) {
-      if (name == _name + ".downsampling_factor") {
+      if (name == _name + ".node_pool_max_memory") {
+        reinit_a_star = true;
+        _search_info.node_pool_max_memory = parameter.as_int();
+      } else if (name == _name + ".downsampling_factor") {
         reinit_a_star = true;
         reinit_downsampler = true;
         _downsampling_factor = parameter.as_int();
@@ -132,6 +132,12 @@ void SmacPlannerLattice::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".max_planning_time", rclcpp::ParameterValue(5.0));
   node->get_parameter(name + ".max_planning_time", _max_planning_time);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_node_pool", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_node_pool", _search_info.use_node_pool);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".node_pool_max_memory", rclcpp::ParameterValue(512));
+  node->get_parameter(name + ".node_pool_max_memory", _search_info.node_pool_max_memory);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".lookup_table_size", rclcpp::ParameterValue(20.0));
   node->get_parameter(name + ".lookup_table_size", _lookup_table_size);
@@ -485,7 +491,10 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
         _search_info.analytic_expansion_max_cost = static_cast<float>(parameter.as_double());
       }
     } else if (type == ParameterType::PARAMETER_BOOL) {
-      if (name == _name + ".allow_unknown") {
+      if (name == _name + ".use_node_pool") {
+        reinit_a_star = true;
+        _search_info.use_node_pool = parameter.as_bool();
+      } else if (name == _name + ".allow_unknown") {
         reinit_a_star = true;
         _allow_unknown = parameter.as_bool();
       } else if (name == _name + ".cache_obstacle_heuristic") {
@@ -505,7 +514,10 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
         reinit_a_star = true;
       }
     } else if (type == ParameterType::PARAMETER_INTEGER) {
-      if (name == _name + ".max_iterations") {
+      if (name == _name + ".node_pool_max_memory") {
+        reinit_a_star = true;
+        _search_info.node_pool_max_memory = parameter.as_int();
+      } else if (name == _name + ".max_iterations") {
         reinit_a_star = true;
         _max_iterations = parameter.as_int();
         if (_max_iterations <= 0) {
@@ -26,6 +26,7 @@
 #include "nav2_smac_planner/node_hybrid.hpp"
 #include "nav2_smac_planner/node_lattice.hpp"
 #include "nav2_smac_planner/a_star.hpp"
+#include "nav2_smac_planner/node_pool.hpp"
 #include "nav2_smac_planner/collision_checker.hpp"
 #include "ament_index_cpp/get_package_share_directory.hpp"
 
@@ -218,6 +219,133 @@ TEST(AStarTest, test_a_star_se2)
   nav2_smac_planner::NodeHybrid::destroyStaticAssets();
 }
 
+TEST(AStarTest, test_node_pool)
+{
+  nav2_smac_planner::NodePool<nav2_smac_planner::Node2D> pool(3);
+  EXPECT_TRUE(pool.empty());
+  EXPECT_EQ(pool.find(5u), nullptr);
+  EXPECT_THROW(pool.at(5u), std::out_of_range);
+
+  auto node = pool.emplace(5u);
+  ASSERT_NE(node, nullptr);
+  EXPECT_EQ(node->getIndex(), 5u);
+  EXPECT_EQ(pool.emplace(5u), node);
+  EXPECT_EQ(pool.find(5u), node);
+  node->setAccumulatedCost(10.0f);
+
+  // Capped to the maximum number of nodes
+  EXPECT_NE(pool.emplace(6u), nullptr);
+  EXPECT_NE(pool.emplace(7u), nullptr);
+  EXPECT_EQ(pool.emplace(8u), nullptr);
+  EXPECT_EQ(pool.size(), 3u);
+
+  // Clearing invalidates the nodes but keeps their storage for reuse
+  pool.clear();
+  EXPECT_TRUE(pool.empty());
+  EXPECT_EQ(pool.find(5u), nullptr);
+  auto reused = pool.emplace(8u);
+  EXPECT_EQ(reused, node);
+  EXPECT_EQ(reused->getIndex(), 8u);
+  EXPECT_EQ(reused->getAccumulatedCost(), std::numeric_limits<float>::max());
+  EXPECT_EQ(pool.capacity(), 3u);
+
+  // Growth of the lookup table keeps the nodes
+  nav2_smac_planner::NodePool<nav2_smac_planner::Node2D> large_pool(1000000);
+  for (uint64_t i = 0; i != 300000; i++) {
+    large_pool.emplace(i * 7u);
+  }
+  EXPECT_EQ(large_pool.size(), 300000u);
+  EXPECT_EQ(large_pool.at(299999u * 7u).getIndex(), 299999u * 7u);
+  EXPECT_EQ(large_pool.find(1u), nullptr);
+
+  // The table is sized from the expected number of nodes, not eagerly allocated
+  nav2_smac_planner::NodePool<nav2_smac_planner::Node2D> small_pool(1000000, 10);
+  EXPECT_LT(small_pool.memoryUsage(), 4096u);
+  small_pool.reserve(1000);
+  EXPECT_GE(small_pool.memoryUsage(), 2000u * 16u);
+
+  // A pool filled up to the nodes fitting a memory budget stays within it,
+  // including the table grown to its worst case load factor
+  for (const size_t max_memory : {100000u, 1000000u, 3000000u}) {
+    const size_t max_nodes =
+      nav2_smac_planner::NodePool<nav2_smac_planner::Node2D>::maxNodesForMemory(max_memory);
+    nav2_smac_planner::NodePool<nav2_smac_planner::Node2D> budget_pool(max_nodes);
+    for (uint64_t i = 0; i != max_nodes + 10; i++) {
+      budget_pool.emplace(i);
+    }
+    EXPECT_EQ(budget_pool.size(), max_nodes);
+    EXPECT_LE(budget_pool.memoryUsage(), max_memory);
+  }
+}
+
+TEST(AStarTest, test_a_star_se2_node_pool)
+{
+  auto lnode = std::make_shared<rclcpp_lifecycle::LifecycleNode>("test");
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 20.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.use_node_pool = true;
+  unsigned int size_theta = 72;
+  info.cost_penalty = 1.7;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star(
+    nav2_smac_planner::MotionModel::DUBIN, info);
+  int max_iterations = 10000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  int terminal_checking_interval = 5000;
+  double max_planning_time = 120.0;
+
+  a_star.initialize(
+    false, max_iterations, it_on_approach, terminal_checking_interval,
+    max_planning_time, 401, size_theta);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // Convert raw costmap into a costmap ros object
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>();
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto costmap = costmap_ros->getCostmap();
+  *costmap = *costmapA;
+
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmap_ros, size_theta, lnode);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  auto dummy_cancel_checker = []() {
+      return false;
+    };
+
+  // Same search as with the hash map graph, repeated to reuse the pooled nodes
+  for (unsigned int attempt = 0; attempt != 2; attempt++) {
+    int num_it = 0;
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(10u, 10u, 0u);
+    a_star.setGoal(80u, 80u, 40u);
+    nav2_smac_planner::NodeHybrid::CoordinateVector path;
+    EXPECT_TRUE(a_star.createPath(path, num_it, tolerance, dummy_cancel_checker));
+    EXPECT_EQ(num_it, 3146);
+    EXPECT_EQ(path.size(), 63u);
+    for (unsigned int i = 0; i != path.size(); i++) {
+      EXPECT_EQ(costmapA->getCost(path[i].x, path[i].y), 0);
+    }
+  }
+
+  delete costmapA;
+  nav2_smac_planner::NodeHybrid::destroyStaticAssets();
+}
+
 TEST(AStarTest, test_a_star_lattice)
 {
   auto lnode = std::make_shared<rclcpp_lifecycle::LifecycleNode>("test");
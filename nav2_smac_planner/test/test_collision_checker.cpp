@@ -213,3 +213,123 @@ TEST(collision_footprint, test_point_and_line_cost)
   EXPECT_NEAR(right_value, 254.0, 0.001);
   delete costmap_;
 }
+
+TEST(collision_footprint, test_footprint_stencils_match_footprint)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testF");
+  nav2_costmap_2d::Costmap2D * costmap_ = new nav2_costmap_2d::Costmap2D(
+    100, 100, 0.1, 0, 0.0, 0);
+
+  // Costs below inscribed, so the footprint is always checked, with a few lethal cells
+  for (unsigned int i = 0; i != 100; i++) {
+    for (unsigned int j = 0; j != 100; j++) {
+      costmap_->setCost(i, j, (i * 37 + j * 91) % 200);
+    }
+  }
+  costmap_->setCost(55, 52, 254);
+  costmap_->setCost(44, 47, 254);
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -0.33;
+  p1.y = 0.21;
+  geometry_msgs::msg::Point p2;
+  p2.x = 0.33;
+  p2.y = 0.21;
+  geometry_msgs::msg::Point p3;
+  p3.x = 0.33;
+  p3.y = -0.21;
+  geometry_msgs::msg::Point p4;
+  p4.x = -0.33;
+  p4.y = -0.21;
+
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+
+  // Convert raw costmap into a costmap ros object
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>();
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto costmap = costmap_ros->getCostmap();
+  *costmap = *costmap_;
+
+  nav2_smac_planner::GridCollisionChecker collision_checker(costmap_ros, 16, node);
+  collision_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+  const std::vector<float> & angles = collision_checker.getPrecomputedAngles();
+
+  // The footprint stencils used at cell centers cover the same cells as rasterizing
+  // the footprint, and other poses are checked exactly where they are
+  for (float x : {45.5f, 50.5f, 54.5f, 50.3f, 47.75f, 49.0f}) {
+    for (float y : {45.5f, 48.5f, 52.5f, 49.6f, 50.0f}) {
+      for (unsigned int bin = 0; bin != angles.size(); bin++) {
+        const double wx = costmap->getOriginX() + x * costmap->getResolution();
+        const double wy = costmap->getOriginY() + y * costmap->getResolution();
+        const double expected = collision_checker.footprintCostAtPose(
+          wx, wy, angles[bin], footprint);
+        collision_checker.inCollision(x, y, static_cast<float>(bin), false);
+        EXPECT_NEAR(collision_checker.getCost(), expected, 0.001) <<
+          "x " << x << " y " << y << " bin " << bin;
+      }
+    }
+  }
+
+  // Stencils are made again when the costmap is resized
+  costmap->resizeMap(120, 100, 0.1, 0.0, 0.0);
+  for (unsigned int i = 0; i != 120; i++) {
+    for (unsigned int j = 0; j != 100; j++) {
+      costmap->setCost(i, j, 10);
+    }
+  }
+  costmap->setCost(53, 50, 100);
+  collision_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+  collision_checker.inCollision(50.5f, 50.5f, 0.0f, false);
+  EXPECT_NEAR(collision_checker.getCost(), 100.0, 0.001);
+  collision_checker.inCollision(50.5f, 50.5f, 4.0f, false);
+  EXPECT_NEAR(collision_checker.getCost(), 10.0, 0.001);
+  delete costmap_;
+}
+
+TEST(collision_footprint, test_fractional_pose_next_to_obstacle)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testF");
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>();
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto costmap = costmap_ros->getCostmap();
+  costmap->resizeMap(100, 100, 0.1, 0.0, 0.0);
+  for (unsigned int i = 0; i != 100; i++) {
+    for (unsigned int j = 0; j != 100; j++) {
+      costmap->setCost(i, j, 10);
+    }
+  }
+  costmap->setCost(53, 50, 254);
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -0.33;
+  p1.y = 0.21;
+  geometry_msgs::msg::Point p2;
+  p2.x = 0.33;
+  p2.y = 0.21;
+  geometry_msgs::msg::Point p3;
+  p3.x = 0.33;
+  p3.y = -0.21;
+  geometry_msgs::msg::Point p4;
+  p4.x = -0.33;
+  p4.y = -0.21;
+
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+
+  nav2_smac_planner::GridCollisionChecker collision_checker(costmap_ros, 16, node);
+  collision_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+
+  // Within its cell, the pose reaches the lethal cell that a footprint placed
+  // at the cell's center would miss
+  EXPECT_LT(collision_checker.footprintCostAtCell(49, 50, 0), 254.0);
+  EXPECT_TRUE(collision_checker.inCollision(49.9f, 50.5f, 0.0f, false));
+  EXPECT_NEAR(
+    collision_checker.getCost(),
+    collision_checker.footprintCostAtPose(4.99, 5.05, 0.0, footprint), 0.001);
+  EXPECT_NEAR(collision_checker.getCost(), 254.0, 0.001);
+
+  // And is not in collision when it falls short of it
+  EXPECT_FALSE(collision_checker.inCollision(49.6f, 50.5f, 0.0f, false));
+  EXPECT_NEAR(
+    collision_checker.getCost(),
+    collision_checker.footprintCostAtPose(4.96, 5.05, 0.0, footprint), 0.001);
+}
@@ -239,6 +239,85 @@ TEST(NodeHybridTest, test_obstacle_heuristic)
   nav2_smac_planner::NodeHybrid::destroyStaticAssets();
 }
 
+TEST(NodeHybridTest, test_obstacle_heuristic_update)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("test");
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // 0.4m/5cm resolution costmap
+  info.cost_penalty = 1.7;
+  info.retrospective_penalty = 0.0;
+  unsigned int size_theta = 72;
+
+  nav2_smac_planner::NodeHybrid::initMotionModel(
+    nav2_smac_planner::MotionModel::DUBIN, 100, 100, size_theta, info);
+
+  // Convert raw costmap into a costmap ros object
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>();
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto costmap = costmap_ros->getCostmap();
+  *costmap = nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost with a passage on each side
+  for (unsigned int i = 20; i <= 80; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmap->setCost(i, j, 254);
+    }
+  }
+
+  nav2_smac_planner::NodeHybrid::Coordinates start(10, 50, 0);
+  nav2_smac_planner::NodeHybrid::Coordinates other(50, 80, 0);
+  nav2_smac_planner::NodeHybrid::Coordinates goal(90, 51, 0);
+
+  // Repairing the heuristic after a costmap change must match a full recomputation
+  auto expectRepairedMatchesReset = [&]() {
+      nav2_smac_planner::NodeHybrid::updateObstacleHeuristic(
+        costmap_ros, start.x, start.y, goal.x, goal.y);
+      float start_cost = nav2_smac_planner::NodeHybrid::getObstacleHeuristic(
+        start, goal, info.cost_penalty);
+      float other_cost = nav2_smac_planner::NodeHybrid::getObstacleHeuristic(
+        other, goal, info.cost_penalty);
+
+      nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+        costmap_ros, start.x, start.y, goal.x, goal.y);
+      EXPECT_NEAR(
+        start_cost, nav2_smac_planner::NodeHybrid::getObstacleHeuristic(
+          start, goal, info.cost_penalty), 1e-3);
+      EXPECT_NEAR(
+        other_cost, nav2_smac_planner::NodeHybrid::getObstacleHeuristic(
+          other, goal, info.cost_penalty), 1e-3);
+      return start_cost;
+    };
+
+  nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+    costmap_ros, start.x, start.y, goal.x, goal.y);
+  float initial_cost = nav2_smac_planner::NodeHybrid::getObstacleHeuristic(
+    start, goal, info.cost_penalty);
+
+  // No change keeps the same heuristic
+  EXPECT_NEAR(expectRepairedMatchesReset(), initial_cost, 1e-3);
+
+  // Block the lower passage, which increases the cost
+  for (unsigned int j = 0; j < 40; ++j) {
+    costmap->setCost(50, j, 254);
+  }
+  float blocked_cost = expectRepairedMatchesReset();
+  EXPECT_GT(blocked_cost, initial_cost);
+
+  // Unblock it, which decreases it back
+  for (unsigned int j = 0; j < 40; ++j) {
+    costmap->setCost(50, j, 0);
+  }
+  EXPECT_NEAR(expectRepairedMatchesReset(), initial_cost, 1e-3);
+
+  // Changes close to the goal invalidate most of the wavefront
+  costmap->setCost(88, 52, 100);
+  expectRepairedMatchesReset();
+
+  nav2_smac_planner::NodeHybrid::destroyStaticAssets();
+}
+
 TEST(NodeHybridTest, test_node_debin_neighbors)
 {
   nav2_smac_planner::SearchInfo info;
@@ -31,6 +31,7 @@
 #include "visualization_msgs/msg/marker.hpp"
 #include "nav2_util/costmap.hpp"
 #include "nav2_util/node_thread.hpp"
+#include "nav2_core/global_planner.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "geometry_msgs/msg/transform_stamped.hpp"
 #include "tf2_msgs/msg/tf_message.hpp"
@@ -40,6 +41,58 @@
 namespace nav2_system_tests
 {
 
+// Forwards to a planner, counting the plans it makes on the costmap it was configured with
+class CountingPlanner : public nav2_core::GlobalPlanner
+{
+public:
+  explicit CountingPlanner(nav2_core::GlobalPlanner::Ptr planner)
+  : planner_(planner)
+  {
+  }
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+    std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros) override
+  {
+    planner_->configure(parent, name, tf, costmap_ros);
+  }
+
+  void cleanup() override {planner_->cleanup();}
+
+  void activate() override {planner_->activate();}
+
+  void deactivate() override {planner_->deactivate();}
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override
+  {
+    plan_count++;
+    return planner_->createPlan(start, goal, cancel_checker);
+  }
+
+  bool supportsConcurrentPlanning() override
+  {
+    return planner_->supportsConcurrentPlanning();
+  }
+
+  nav_msgs::msg::Path createPlanOnCostmap(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker,
+    nav2_costmap_2d::Costmap2D & costmap) override
+  {
+    return planner_->createPlanOnCostmap(start, goal, cancel_checker, costmap);
+  }
+
+  size_t plan_count{0};
+
+private:
+  nav2_core::GlobalPlanner::Ptr planner_;
+};
+
 class NavFnPlannerTester : public nav2_planner::PlannerServer
 {
 public:
@@ -120,6 +173,20 @@ public:
   {
     on_configure(state);
   }
+
+  // Plan legs through poses sequentially from now on
+  void disableConcurrentLegs()
+  {
+    leg_planners_.clear();
+  }
+
+  // Count the plans of a planner other than the ones of legs planned concurrently
+  std::shared_ptr<CountingPlanner> countPlans(const std::string & planner_id)
+  {
+    auto counting_planner = std::make_shared<CountingPlanner>(planners_[planner_id]);
+    planners_[planner_id] = counting_planner;
+    return counting_planner;
+  }
 };
 
 enum class TaskStatus : int8_t
@@ -353,6 +353,115 @@ TEST(testPluginMap, SmacHybridAStarCancel)
   testCancel("nav2_smac_planner::SmacPlannerHybrid");
 }
 
+TEST(testPluginMap, NavFnThroughPosesConcurrentLegs)
+{
+  auto obj = std::make_shared<nav2_system_tests::NavFnPlannerTester>();
+  rclcpp_lifecycle::State state;
+  obj->set_parameter(rclcpp::Parameter("GridBased.plugin", "nav2_navfn_planner::NavfnPlanner"));
+  obj->set_parameter(rclcpp::Parameter("through_poses_planning_threads", 3));
+  obj->onConfigure(state);
+
+  geometry_msgs::msg::PoseStamped start;
+  start.pose.position.x = 0.5;
+  start.pose.position.y = 0.5;
+  start.header.frame_id = "map";
+
+  std::vector<geometry_msgs::msg::PoseStamped> goals(3, start);
+  goals[0].pose.position.y = 1.0;
+  goals[1].pose.position.x = 1.0;
+  goals[1].pose.position.y = 1.0;
+  goals[2].pose.position.x = 1.0;
+  goals[2].pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(-M_PI_2);
+
+  auto dummy_cancel_checker = []() {return false;};
+  std::vector<builtin_interfaces::msg::Duration> leg_times;
+  geometry_msgs::msg::PoseStamped curr_start, curr_goal;
+
+  auto concurrent_path = obj->planThroughPoses(
+    start, goals, "GridBased", dummy_cancel_checker, leg_times, curr_start, curr_goal);
+  EXPECT_EQ(leg_times.size(), goals.size());
+  ASSERT_GT(concurrent_path.poses.size(), goals.size());
+
+  // Each leg ends at its goal and the next leg starts where it ended
+  size_t leg = 0;
+  for (size_t i = 0; i != concurrent_path.poses.size() && leg != goals.size(); i++) {
+    const auto & pose = concurrent_path.poses[i].pose;
+    if (pose.position.x == goals[leg].pose.position.x &&
+      pose.position.y == goals[leg].pose.position.y)
+    {
+      EXPECT_EQ(pose.orientation, goals[leg].pose.orientation);
+      if (++leg != goals.size()) {
+        ASSERT_LT(i + 1, concurrent_path.poses.size());
+        EXPECT_NEAR(concurrent_path.poses[i + 1].pose.position.x, pose.position.x, 0.1);
+        EXPECT_NEAR(concurrent_path.poses[i + 1].pose.position.y, pose.position.y, 0.1);
+      }
+    }
+  }
+  EXPECT_EQ(leg, goals.size());
+  EXPECT_EQ(concurrent_path.poses.back().pose, goals.back().pose);
+
+  // Planning the legs concurrently gives the same path as planning them in sequence
+  obj->disableConcurrentLegs();
+  auto sequential_path = obj->planThroughPoses(
+    start, goals, "GridBased", dummy_cancel_checker, leg_times, curr_start, curr_goal);
+  EXPECT_EQ(leg_times.size(), goals.size());
+  ASSERT_EQ(sequential_path.poses.size(), concurrent_path.poses.size());
+  for (size_t i = 0; i != sequential_path.poses.size(); i++) {
+    EXPECT_EQ(sequential_path.poses[i].pose, concurrent_path.poses[i].pose);
+  }
+
+  obj->onCleanup(state);
+}
+
+TEST(testPluginMap, NavFnThroughPosesReusesConcurrentLegs)
+{
+  // The legs end facing their final approach, not with the orientation of their goal
+  auto obj = std::make_shared<nav2_system_tests::NavFnPlannerTester>();
+  rclcpp_lifecycle::State state;
+  obj->set_parameter(rclcpp::Parameter("GridBased.plugin", "nav2_navfn_planner::NavfnPlanner"));
+  obj->set_parameter(rclcpp::Parameter("through_poses_planning_threads", 3));
+  obj->declare_parameter(
+    "GridBased.use_final_approach_orientation", rclcpp::ParameterValue(true));
+  obj->set_parameter(rclcpp::Parameter("GridBased.use_final_approach_orientation", true));
+  obj->onConfigure(state);
+  auto counting_planner = obj->countPlans("GridBased");
+
+  geometry_msgs::msg::PoseStamped start;
+  start.pose.position.x = 0.5;
+  start.pose.position.y = 0.5;
+  start.header.frame_id = "map";
+
+  std::vector<geometry_msgs::msg::PoseStamped> goals(3, start);
+  goals[0].pose.position.y = 1.0;
+  goals[0].pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(M_PI);
+  goals[1].pose.position.x = 1.0;
+  goals[1].pose.position.y = 1.0;
+  goals[1].pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(M_PI);
+  goals[2].pose.position.x = 1.0;
+
+  auto dummy_cancel_checker = []() {return false;};
+  std::vector<builtin_interfaces::msg::Duration> leg_times;
+  geometry_msgs::msg::PoseStamped curr_start, curr_goal;
+
+  // All the legs planned ahead are used, none is planned again
+  auto concurrent_path = obj->planThroughPoses(
+    start, goals, "GridBased", dummy_cancel_checker, leg_times, curr_start, curr_goal);
+  EXPECT_EQ(leg_times.size(), goals.size());
+  ASSERT_GT(concurrent_path.poses.size(), goals.size());
+  EXPECT_EQ(counting_planner->plan_count, 0u);
+
+  // Planned in sequence instead, every leg is planned
+  obj->disableConcurrentLegs();
+  auto sequential_path = obj->planThroughPoses(
+    start, goals, "GridBased", dummy_cancel_checker, leg_times, curr_start, curr_goal);
+  EXPECT_EQ(counting_planner->plan_count, goals.size());
+  ASSERT_EQ(sequential_path.poses.size(), concurrent_path.poses.size());
+  for (size_t i = 0; i != sequential_path.poses.size(); i++) {
+    EXPECT_EQ(sequential_path.poses[i].pose.position, concurrent_path.poses[i].pose.position);
+  }
+
+  obj->onCleanup(state);
+}
 
 int main(int argc, char ** argv)
 {
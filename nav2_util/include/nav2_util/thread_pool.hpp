@@ -0,0 +1,264 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__THREAD_POOL_HPP_
+#define NAV2_UTIL__THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nav2_util
+{
+
+/**
+ * @class nav2_util::ThreadPool
+ * @brief Persistent pool of workers splitting a range, such as a batch of trajectories or
+ * the rows of a costmap, into contiguous chunks. Each chunk is always processed with the
+ * same code as the serial path, so independent work gives identical results for any
+ * number of threads. Calls on a pool must not be made concurrently or be nested.
+ */
+class ThreadPool
+{
+public:
+  using RangeFunction = std::function<void (size_t, size_t)>;
+
+  /**
+    * @brief Constructor for nav2_util::ThreadPool
+    * @param num_threads Total number of threads, including the calling thread
+    */
+  explicit ThreadPool(unsigned int num_threads = 1u)
+  : num_threads_(std::max(num_threads, 1u))
+  {
+    threads_.reserve(num_threads_ - 1u);
+    for (unsigned int i = 0; i != num_threads_ - 1u; i++) {
+      threads_.emplace_back(&ThreadPool::workerThread, this, i + 1u);
+    }
+  }
+
+  /**
+    * @brief Destructor for nav2_util::ThreadPool
+    */
+  ~ThreadPool()
+  {
+    {
+      std::unique_lock<std::mutex> guard(lock_);
+      active_ = false;
+    }
+    start_cond_.notify_all();
+    for (auto & thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /**
+    * @brief Get the total number of threads used, including the calling thread
+    * @return Number of threads
+    */
+  unsigned int size() const
+  {
+    return num_threads_;
+  }
+
+  /**
+    * @brief Get the index of the chunk starting at a given position when splitting [0, n),
+    * which is unique per concurrently running thread and smaller than size(). Useful to
+    * select per-thread preallocated scratch buffers.
+    * @param n Size of the range
+    * @param begin Start of the chunk
+    * @return Index of the chunk
+    */
+  size_t chunkIndex(size_t n, size_t begin) const
+  {
+    const size_t chunk = (n + num_threads_ - 1u) / num_threads_;
+    return chunk == 0u ? 0u : begin / chunk;
+  }
+
+  /**
+    * @brief Split [0, n) into one contiguous chunk per thread and block until all
+    * chunks are processed. The calling thread processes the first chunk.
+    * @param n Size of the range
+    * @param fn Function processing the half-open range [begin, end)
+    */
+  void parallelFor(size_t n, const RangeFunction & fn)
+  {
+    if (threads_.empty() || n < 2u * size()) {
+      fn(0, n);
+      return;
+    }
+    dispatch(n, fn);
+  }
+
+  /**
+    * @brief Run n coarse, independent tasks concurrently and block until all of them are
+    * done. Unlike parallelFor(), tasks are dispatched to workers even when there are fewer
+    * tasks than threads. The calling thread runs the first task(s).
+    * @param n Number of tasks
+    * @param fn Function running the task of a given index
+    */
+  void parallelTasks(size_t n, const std::function<void(size_t)> & fn)
+  {
+    const RangeFunction range_fn = [&fn](size_t begin, size_t end) {
+        for (size_t i = begin; i != end; i++) {
+          fn(i);
+        }
+      };
+    if (threads_.empty() || n < 2u) {
+      range_fn(0, n);
+      return;
+    }
+    dispatch(n, range_fn);
+  }
+
+protected:
+  /**
+    * @brief Process [0, n) over all threads and block until all chunks are processed
+    * @param n Size of the range
+    * @param fn Function processing the half-open range [begin, end)
+    */
+  void dispatch(size_t n, const RangeFunction & fn)
+  {
+    {
+      std::unique_lock<std::mutex> guard(lock_);
+      fn_ = &fn;
+      range_size_ = n;
+      pending_ = threads_.size();
+      exception_ = nullptr;
+      ++generation_;
+    }
+    start_cond_.notify_all();
+
+    std::exception_ptr exception;
+    try {
+      runChunk(0);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> guard(lock_);
+    done_cond_.wait(guard, [this]() {return pending_ == 0;});
+    fn_ = nullptr;
+    if (!exception) {
+      exception = exception_;
+    }
+    guard.unlock();
+
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  /**
+    * @brief Process the chunk of the current range owned by a thread
+    * @param idx Index of the thread, 0 being the calling thread
+    */
+  void runChunk(size_t idx)
+  {
+    const size_t chunk = (range_size_ + num_threads_ - 1u) / num_threads_;
+    const size_t begin = std::min(idx * chunk, range_size_);
+    const size_t end = std::min(begin + chunk, range_size_);
+    if (begin != end) {
+      (*fn_)(begin, end);
+    }
+  }
+
+  /**
+    * @brief Worker loop waiting for new ranges to process
+    * @param idx Index of the thread
+    */
+  void workerThread(size_t idx)
+  {
+    size_t last_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> guard(lock_);
+        start_cond_.wait(
+          guard, [&]() {return !active_ || generation_ != last_generation;});
+        if (!active_) {
+          return;
+        }
+        last_generation = generation_;
+      }
+
+      std::exception_ptr exception;
+      try {
+        runChunk(idx);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+
+      {
+        std::unique_lock<std::mutex> guard(lock_);
+        if (exception && !exception_) {
+          exception_ = exception;
+        }
+        --pending_;
+      }
+      done_cond_.notify_one();
+    }
+  }
+
+  const unsigned int num_threads_;
+  std::vector<std::thread> threads_;
+  std::mutex lock_;
+  std::condition_variable start_cond_;
+  std::condition_variable done_cond_;
+  const RangeFunction * fn_{nullptr};
+  size_t range_size_{0};
+  size_t pending_{0};
+  size_t generation_{0};
+  bool active_{true};
+  std::exception_ptr exception_;
+};
+
+/**
+  * @brief Get the index of the chunk starting at a given position, see ThreadPool::chunkIndex
+  * @param pool Pool used, may be nullptr
+  * @param n Size of the range
+  * @param begin Start of the chunk
+  * @return Index of the chunk, 0 when no pool is used
+  */
+inline size_t chunkIndex(const ThreadPool * pool, size_t n, size_t begin)
+{
+  return pool ? pool->chunkIndex(n, begin) : 0u;
+}
+
+/**
+  * @brief Run a range function over [0, n) on a pool, if available, or inline otherwise
+  * @param pool Pool to use, may be nullptr
+  * @param n Size of the range
+  * @param fn Function processing the half-open range [begin, end)
+  */
+inline void parallelFor(ThreadPool * pool, size_t n, const ThreadPool::RangeFunction & fn)
+{
+  if (pool) {
+    pool->parallelFor(n, fn);
+  } else {
+    fn(0, n);
+  }
+}
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__THREAD_POOL_HPP_
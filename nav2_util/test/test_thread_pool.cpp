@@ -0,0 +1,110 @@
+// Copyright (c) 2024 Open Navigation LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "nav2_util/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+using nav2_util::ThreadPool;
+
+TEST(ThreadPool, ParallelForCoversRangeOnce)
+{
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4u);
+
+  for (size_t n : {0u, 1u, 7u, 8u, 1000u}) {
+    std::vector<int> visits(n, 0);
+    std::vector<std::atomic<int>> chunks(pool.size());
+    pool.parallelFor(
+      n, [&](size_t begin, size_t end) {
+        EXPECT_LE(begin, end);
+        chunks[pool.chunkIndex(n, begin)]++;
+        for (size_t i = begin; i != end; i++) {
+          visits[i]++;
+        }
+      });
+    for (size_t i = 0; i != n; i++) {
+      EXPECT_EQ(visits[i], 1);
+    }
+    // Each chunk index is used by a single chunk
+    for (auto & chunk : chunks) {
+      EXPECT_LE(chunk.load(), 1);
+    }
+  }
+}
+
+TEST(ThreadPool, SmallRangesRunInline)
+{
+  ThreadPool pool(4);
+  size_t calls = 0;
+  pool.parallelFor(
+    7, [&](size_t begin, size_t end) {
+      EXPECT_EQ(begin, 0u);
+      EXPECT_EQ(end, 7u);
+      calls++;
+    });
+  EXPECT_EQ(calls, 1u);
+
+  // A pool of a single thread or no pool at all processes the whole range inline
+  ThreadPool single_pool(1);
+  EXPECT_EQ(single_pool.size(), 1u);
+  nav2_util::parallelFor(
+    &single_pool, 1000, [&](size_t begin, size_t end) {
+      EXPECT_EQ(begin, 0u);
+      EXPECT_EQ(end, 1000u);
+      calls++;
+    });
+  nav2_util::parallelFor(nullptr, 1000, [&](size_t, size_t) {calls++;});
+  EXPECT_EQ(calls, 3u);
+  EXPECT_EQ(nav2_util::chunkIndex(nullptr, 1000, 500), 0u);
+}
+
+TEST(ThreadPool, ParallelTasks)
+{
+  ThreadPool pool(3);
+  for (size_t n : {0u, 1u, 2u, 5u}) {
+    std::vector<std::atomic<int>> runs(n);
+    pool.parallelTasks(n, [&](size_t i) {runs[i]++;});
+    for (size_t i = 0; i != n; i++) {
+      EXPECT_EQ(runs[i].load(), 1);
+    }
+  }
+}
+
+TEST(ThreadPool, ExceptionsPropagate)
+{
+  ThreadPool pool(4);
+  EXPECT_THROW(
+    pool.parallelFor(
+      1000, [](size_t begin, size_t) {
+        if (begin != 0u) {
+          throw std::runtime_error("worker failure");
+        }
+      }),
+    std::runtime_error);
+  EXPECT_THROW(
+    pool.parallelTasks(2, [](size_t) {throw std::runtime_error("task failure");}),
+    std::runtime_error);
+
+  // The pool is still usable afterwards
+  std::atomic<size_t> sum{0};
+  pool.parallelFor(
+    1000, [&](size_t begin, size_t end) {
+      sum += end - begin;
+    });
+  EXPECT_EQ(sum.load(), 1000u);
+}